@@ -0,0 +1,141 @@
+#include "analyzer/analyzerfanout.h"
+
+#include <algorithm>
+#include <cstring>
+#include <functional>
+
+#include "util/logger.h"
+#include "util/sample.h"
+
+namespace {
+
+mixxx::Logger kLogger("AnalyzerFanOut");
+
+} // anonymous namespace
+
+AnalyzerFanOut::AnalyzerFanOut(
+        SINT blockCapacity,
+        int blockCount)
+        : m_submittedCount(0),
+          m_stopping(false) {
+    DEBUG_ASSERT(blockCount > 0);
+    m_blocks.reserve(blockCount);
+    for (int i = 0; i < blockCount; ++i) {
+        m_blocks.emplace_back(blockCapacity);
+    }
+}
+
+AnalyzerFanOut::~AnalyzerFanOut() {
+    stop();
+}
+
+void AnalyzerFanOut::start(std::vector<AnalyzerWithState>* pAnalyzers) {
+    DEBUG_ASSERT(pAnalyzers);
+    VERIFY_OR_DEBUG_ASSERT(!isRunning()) {
+        return;
+    }
+    m_stopping = false;
+    m_submittedCount = 0;
+    m_workers.reserve(pAnalyzers->size());
+    for (auto& analyzer : *pAnalyzers) {
+        m_workers.push_back(std::make_unique<Worker>(&analyzer));
+    }
+    for (const auto& pWorker : m_workers) {
+        pWorker->thread = std::thread(&AnalyzerFanOut::runWorker, this, pWorker.get());
+    }
+    kLogger.debug() << "Started" << m_workers.size() << "worker threads";
+}
+
+void AnalyzerFanOut::stop() {
+    if (!isRunning()) {
+        return;
+    }
+    waitUntilProcessed();
+    {
+        std::lock_guard<std::mutex> locked(m_mutex);
+        m_stopping = true;
+    }
+    m_blockSubmitted.notify_all();
+    for (const auto& pWorker : m_workers) {
+        pWorker->thread.join();
+    }
+    m_workers.clear();
+}
+
+std::uint64_t AnalyzerFanOut::minProcessedCount() const {
+    std::uint64_t minCount = m_submittedCount;
+    for (const auto& pWorker : m_workers) {
+        minCount = std::min(minCount, pWorker->processedCount);
+    }
+    return minCount;
+}
+
+mixxx::SampleBuffer::WritableSlice AnalyzerFanOut::nextBlock() {
+    std::unique_lock<std::mutex> locked(m_mutex);
+    m_blockProcessed.wait(locked, [this] {
+        return m_submittedCount - minProcessedCount() < m_blocks.size();
+    });
+    return mixxx::SampleBuffer::WritableSlice(blockAt(m_submittedCount).buffer);
+}
+
+void AnalyzerFanOut::submitBlock(const CSAMPLE* pSamples, SINT sampleCount) {
+    {
+        std::lock_guard<std::mutex> locked(m_mutex);
+        // The block is not accessed by any worker until it has been submitted
+        Block& block = blockAt(m_submittedCount);
+        VERIFY_OR_DEBUG_ASSERT(sampleCount <= block.buffer.size()) {
+            sampleCount = block.buffer.size();
+        }
+        CSAMPLE* const pBlockSamples = block.buffer.data();
+        // std::less provides a total order even for unrelated pointers
+        const std::less<const CSAMPLE*> less;
+        if (!less(pSamples, pBlockSamples) &&
+                less(pSamples, pBlockSamples + block.buffer.size())) {
+            // The samples have been decoded into the block, but not
+            // necessarily at its start. SampleUtil::copy() must not be
+            // used for overlapping ranges.
+            const SINT offset = pSamples - pBlockSamples;
+            VERIFY_OR_DEBUG_ASSERT(offset + sampleCount <= block.buffer.size()) {
+                sampleCount = block.buffer.size() - offset;
+            }
+            if (offset > 0) {
+                std::memmove(pBlockSamples, pSamples, sampleCount * sizeof(CSAMPLE));
+            }
+        } else {
+            SampleUtil::copy(pBlockSamples, pSamples, sampleCount);
+        }
+        block.sampleCount = sampleCount;
+        ++m_submittedCount;
+    }
+    m_blockSubmitted.notify_all();
+}
+
+void AnalyzerFanOut::waitUntilProcessed() {
+    std::unique_lock<std::mutex> locked(m_mutex);
+    m_blockProcessed.wait(locked, [this] {
+        return minProcessedCount() == m_submittedCount;
+    });
+}
+
+void AnalyzerFanOut::runWorker(Worker* pWorker) {
+    std::unique_lock<std::mutex> locked(m_mutex);
+    while (true) {
+        m_blockSubmitted.wait(locked, [this, pWorker] {
+            return m_stopping || pWorker->processedCount < m_submittedCount;
+        });
+        if (pWorker->processedCount == m_submittedCount) {
+            DEBUG_ASSERT(m_stopping);
+            return;
+        }
+        const Block& block = blockAt(pWorker->processedCount);
+        locked.unlock();
+        // The block is shared read-only and not reused before all
+        // workers have processed it
+        pWorker->pAnalyzer->processSamples(
+                block.buffer.data(),
+                block.sampleCount);
+        locked.lock();
+        ++pWorker->processedCount;
+        m_blockProcessed.notify_one();
+    }
+}
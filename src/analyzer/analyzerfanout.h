@@ -0,0 +1,101 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "analyzer/analyzer.h"
+#include "util/samplebuffer.h"
+
+/// Runs multiple analyzers concurrently on the same decoded audio data.
+///
+/// Each analyzer is driven by a dedicated worker thread. Decoded blocks
+/// of audio data are stored in a ring of buffers that are shared
+/// read-only by all workers. A buffer is reused after all workers have
+/// processed it, i.e. decoding continues while the analyzers are busy
+/// and the wall time per track is bounded by the slowest analyzer
+/// instead of the sum of all analyzers.
+///
+/// All methods except the constructor must be invoked from the same
+/// thread that also owns the analyzers.
+class AnalyzerFanOut final {
+  public:
+    AnalyzerFanOut(
+            SINT blockCapacity,
+            int blockCount);
+    AnalyzerFanOut(const AnalyzerFanOut&) = delete;
+    AnalyzerFanOut(AnalyzerFanOut&&) = delete;
+    ~AnalyzerFanOut();
+
+    /// Starts a worker thread for each analyzer. The analyzers must
+    /// neither be moved nor destroyed until stop() returns.
+    void start(std::vector<AnalyzerWithState>* pAnalyzers);
+
+    /// Waits until all submitted blocks have been processed and
+    /// joins all worker threads.
+    void stop();
+
+    bool isRunning() const {
+        return !m_workers.empty();
+    }
+
+    /// Returns the buffer for the next block. Blocks the calling
+    /// thread while all buffers are still in use.
+    mixxx::SampleBuffer::WritableSlice nextBlock();
+
+    /// Passes the samples to all analyzers. If the samples are not
+    /// stored at the start of the buffer that has been returned by
+    /// nextBlock() they are copied into this buffer. The samples may
+    /// be located anywhere within this buffer.
+    void submitBlock(const CSAMPLE* pSamples, SINT sampleCount);
+
+    /// Blocks the calling thread until all analyzers have processed
+    /// all submitted blocks. Needs to be invoked before finishing or
+    /// cancelling the analyzers.
+    void waitUntilProcessed();
+
+  private:
+    struct Block {
+        explicit Block(SINT capacity)
+                : buffer(capacity),
+                  sampleCount(0) {
+        }
+        mixxx::SampleBuffer buffer;
+        SINT sampleCount;
+    };
+
+    struct Worker {
+        explicit Worker(AnalyzerWithState* pAnalyzer)
+                : pAnalyzer(pAnalyzer),
+                  processedCount(0) {
+        }
+        AnalyzerWithState* pAnalyzer;
+        // Guarded by m_mutex
+        std::uint64_t processedCount;
+        std::thread thread;
+    };
+
+    void runWorker(Worker* pWorker);
+
+    // The number of blocks that have been processed by all workers.
+    // Must be invoked while holding m_mutex.
+    std::uint64_t minProcessedCount() const;
+
+    Block& blockAt(std::uint64_t sequenceNumber) {
+        return m_blocks[sequenceNumber % m_blocks.size()];
+    }
+
+    std::vector<Block> m_blocks;
+    // Workers are never moved after their threads have been started
+    std::vector<std::unique_ptr<Worker>> m_workers;
+
+    std::mutex m_mutex;
+    std::condition_variable m_blockSubmitted;
+    std::condition_variable m_blockProcessed;
+    // Guarded by m_mutex
+    std::uint64_t m_submittedCount;
+    bool m_stopping;
+};
@@ -36,6 +36,10 @@ mixxx::Logger kLogger("AnalyzerThread");
 // continuous feedback.
 const mixxx::Duration kBusyProgressInhibitDuration = mixxx::Duration::fromMillis(60);
 
+// The number of decoded blocks that are buffered for parallel analyzers.
+// Allows the slowest analyzer to fall behind the others temporarily.
+constexpr int kParallelAnalyzerBlockCount = 8;
+
 void deleteAnalyzerThread(AnalyzerThread* plainPtr) {
     if (plainPtr) {
         plainPtr->deleteAfterFinished();
@@ -120,6 +124,13 @@ void AnalyzerThread::doRun() {
     DEBUG_ASSERT(!m_analyzers.empty());
     kLogger.debug() << "Activated" << m_analyzers.size() << "analyzers";
 
+    if ((m_modeFlags & AnalyzerModeFlags::ParallelAnalyzers) && m_analyzers.size() > 1) {
+        m_pAnalyzerFanOut = std::make_unique<AnalyzerFanOut>(
+                mixxx::kAnalysisSamplesPerChunk,
+                kParallelAnalyzerBlockCount);
+        m_pAnalyzerFanOut->start(&m_analyzers);
+    }
+
     m_lastBusyProgressEmittedTimer.start();
 
     mixxx::AudioSource::OpenParams openParams;
@@ -154,6 +165,11 @@ void AnalyzerThread::doRun() {
         if (processTrack) {
             const auto analysisResult = analyzeAudioSource(audioSource);
             DEBUG_ASSERT(analysisResult != AnalysisResult::Pending);
+            if (m_pAnalyzerFanOut) {
+                // All pending blocks need to be processed before
+                // finishing or cancelling the analyzers
+                m_pAnalyzerFanOut->waitUntilProcessed();
+            }
             if (analysisResult == AnalysisResult::Finished) {
                 // The analysis has been finished, and is either complete without
                 // any errors or partial if it has been aborted due to a corrupt
@@ -181,6 +197,10 @@ void AnalyzerThread::doRun() {
     DEBUG_ASSERT(!m_currentTrack);
     DEBUG_ASSERT(isStopping());
 
+    if (m_pAnalyzerFanOut) {
+        m_pAnalyzerFanOut->stop();
+        m_pAnalyzerFanOut.reset();
+    }
     m_analyzers.clear();
 
     kLogger.debug() << "Exiting worker thread";
@@ -248,12 +268,17 @@ AnalyzerThread::AnalysisResult AnalyzerThread::analyzeAudioSource(
                         math_min(mixxx::kAnalysisFramesPerChunk, remainingFrameRange.length()));
         DEBUG_ASSERT(!chunkFrameRange.empty());
 
-        // Request the next chunk of audio data
+        // Request the next chunk of audio data. Parallel analyzers might
+        // still be busy with previous chunks that are stored in other
+        // buffers.
         const auto readableSampleFrames =
                 audioSourceProxy.readSampleFrames(
                         mixxx::WritableSampleFrames(
                                 chunkFrameRange,
-                                mixxx::SampleBuffer::WritableSlice(m_sampleBuffer)));
+                                m_pAnalyzerFanOut
+                                        ? m_pAnalyzerFanOut->nextBlock()
+                                        : mixxx::SampleBuffer::WritableSlice(
+                                                  m_sampleBuffer)));
         // The returned range fits into the requested range
         DEBUG_ASSERT(readableSampleFrames.frameIndexRange().isSubrangeOf(chunkFrameRange));
 
@@ -297,7 +322,13 @@ AnalyzerThread::AnalysisResult AnalyzerThread::analyzeAudioSource(
         }
 
         // 2nd: step: Analyze chunk of decoded audio data
-        if (!readableSampleFrames.frameIndexRange().empty()) {
+        if (readableSampleFrames.frameIndexRange().empty()) {
+            // Nothing to analyze
+        } else if (m_pAnalyzerFanOut) {
+            m_pAnalyzerFanOut->submitBlock(
+                    readableSampleFrames.readableData(),
+                    readableSampleFrames.readableLength());
+        } else {
             for (auto&& analyzer : m_analyzers) {
                 analyzer.processSamples(
                         readableSampleFrames.readableData(),
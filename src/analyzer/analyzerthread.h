@@ -3,6 +3,7 @@
 #include <vector>
 
 #include "analyzer/analyzer.h"
+#include "analyzer/analyzerfanout.h"
 #include "analyzer/analyzerprogress.h"
 #include "preferences/usersettings.h"
 #include "rigtorp/SPSCQueue.h"
@@ -20,6 +21,9 @@ enum AnalyzerModeFlags {
     WithBeats = 0x01,
     WithWaveform = 0x02,
     LowPriority = 0x04,
+    // Run the analyzers of each track concurrently on separate threads
+    // to reduce the latency for a single track
+    ParallelAnalyzers = 0x08,
     All = WithBeats | WithWaveform,
 };
 
@@ -116,6 +120,9 @@ class AnalyzerThread : public WorkerThread {
 
     std::vector<AnalyzerWithState> m_analyzers;
 
+    // Only used with AnalyzerModeFlags::ParallelAnalyzers
+    std::unique_ptr<AnalyzerFanOut> m_pAnalyzerFanOut;
+
     mixxx::SampleBuffer m_sampleBuffer;
 
     TrackPointer m_currentTrack;
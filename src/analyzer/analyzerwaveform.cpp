@@ -88,58 +88,112 @@ bool AnalyzerWaveform::initialize(TrackPointer tio, int sampleRate, int totalSam
 }
 
 bool AnalyzerWaveform::shouldAnalyze(TrackPointer tio) const {
-    ConstWaveformPointer pTrackWaveform = tio->getWaveform();
-    ConstWaveformPointer pTrackWaveformSummary = tio->getWaveformSummary();
-    ConstWaveformPointer pLoadedTrackWaveform;
-    ConstWaveformPointer pLoadedTrackWaveformSummary;
-
     TrackId trackId = tio->getId();
-    bool missingWaveform = pTrackWaveform.isNull();
-    bool missingWavesummary = pTrackWaveformSummary.isNull();
+    bool missingWaveform = tio->getWaveform().isNull();
+    bool missingWavesummary = tio->getWaveformSummary().isNull();
 
     if (trackId.isValid() && (missingWaveform || missingWavesummary)) {
-        QList<AnalysisDao::AnalysisInfo> analyses =
+        const QList<AnalysisDao::AnalysisInfo> analyses =
                 m_analysisDao.getAnalysesForTrack(trackId);
 
-        QListIterator<AnalysisDao::AnalysisInfo> it(analyses);
-        while (it.hasNext()) {
-            const AnalysisDao::AnalysisInfo& analysis = it.next();
-            WaveformFactory::VersionClass vc;
-
+        // Select the analyses to load, preferring the current over
+        // legacy versions that need to be converted
+        int waveformIndex = -1;
+        int wavesummaryIndex = -1;
+        WaveformFactory::VersionClass waveformVc = WaveformFactory::VC_REMOVE;
+        WaveformFactory::VersionClass wavesummaryVc = WaveformFactory::VC_REMOVE;
+        for (int i = 0; i < analyses.size(); ++i) {
+            const AnalysisDao::AnalysisInfo& analysis = analyses.at(i);
             if (analysis.type == AnalysisDao::TYPE_WAVEFORM) {
-                vc = WaveformFactory::waveformVersionToVersionClass(analysis.version);
-                if (missingWaveform && vc == WaveformFactory::VC_USE) {
-                    pLoadedTrackWaveform = ConstWaveformPointer(
-                            WaveformFactory::loadWaveformFromAnalysis(analysis));
-                    missingWaveform = false;
-                } else if (vc != WaveformFactory::VC_KEEP) {
-                    // remove all other Analysis except that one we should keep
-                    m_analysisDao.deleteAnalysis(analysis.analysisId);
+                const auto vc = WaveformFactory::waveformVersionToVersionClass(
+                        analysis.version);
+                if ((vc == WaveformFactory::VC_USE && waveformVc != WaveformFactory::VC_USE) ||
+                        (vc == WaveformFactory::VC_CONVERT && waveformIndex < 0)) {
+                    waveformIndex = i;
+                    waveformVc = vc;
                 }
             }
             if (analysis.type == AnalysisDao::TYPE_WAVESUMMARY) {
-                vc = WaveformFactory::waveformSummaryVersionToVersionClass(analysis.version);
-                if (missingWavesummary && vc == WaveformFactory::VC_USE) {
-                    pLoadedTrackWaveformSummary = ConstWaveformPointer(
-                            WaveformFactory::loadWaveformFromAnalysis(analysis));
-                    missingWavesummary = false;
-                } else if (vc != WaveformFactory::VC_KEEP) {
-                    // remove all other Analysis except that one we should keep
-                    m_analysisDao.deleteAnalysis(analysis.analysisId);
+                const auto vc = WaveformFactory::waveformSummaryVersionToVersionClass(
+                        analysis.version);
+                if ((vc == WaveformFactory::VC_USE && wavesummaryVc != WaveformFactory::VC_USE) ||
+                        (vc == WaveformFactory::VC_CONVERT && wavesummaryIndex < 0)) {
+                    wavesummaryIndex = i;
+                    wavesummaryVc = vc;
+                }
+            }
+        }
+
+        // Remove all other analyses except those we should keep
+        for (int i = 0; i < analyses.size(); ++i) {
+            const AnalysisDao::AnalysisInfo& analysis = analyses.at(i);
+            WaveformFactory::VersionClass vc;
+            if (analysis.type == AnalysisDao::TYPE_WAVEFORM) {
+                if (i == waveformIndex) {
+                    continue;
+                }
+                vc = WaveformFactory::waveformVersionToVersionClass(analysis.version);
+            } else if (analysis.type == AnalysisDao::TYPE_WAVESUMMARY) {
+                if (i == wavesummaryIndex) {
+                    continue;
                 }
+                vc = WaveformFactory::waveformSummaryVersionToVersionClass(analysis.version);
+            } else {
+                continue;
+            }
+            if (vc != WaveformFactory::VC_KEEP) {
+                m_analysisDao.deleteAnalysis(analysis.analysisId);
+            }
+        }
+
+        // Load the small summary first, so the overview is displayed
+        // while the waveform is still loading.
+        WaveformPointer pLoadedTrackWaveformSummary;
+        if (missingWavesummary && wavesummaryIndex >= 0) {
+            pLoadedTrackWaveformSummary = WaveformFactory::loadWaveformFromAnalysis(
+                    analyses.at(wavesummaryIndex));
+            if (pLoadedTrackWaveformSummary) {
+                tio->setWaveformSummary(pLoadedTrackWaveformSummary);
+                missingWavesummary = false;
             }
         }
+        // The waveform is displayed progressively while its data is
+        // copied from the memory-mapped file.
+        WaveformPointer pLoadedTrackWaveform;
+        if (missingWaveform && waveformIndex >= 0) {
+            pLoadedTrackWaveform = WaveformFactory::loadWaveformFromAnalysis(
+                    analyses.at(waveformIndex),
+                    [&tio](const WaveformPointer& pWaveform) {
+                        tio->setWaveform(pWaveform);
+                    });
+            if (pLoadedTrackWaveform) {
+                tio->setWaveform(pLoadedTrackWaveform);
+                missingWaveform = false;
+            }
+        }
+
+        // Store legacy analyses again in the current version, replacing
+        // the previous files.
+        if (pLoadedTrackWaveform && pLoadedTrackWaveformSummary &&
+                (waveformVc == WaveformFactory::VC_CONVERT ||
+                        wavesummaryVc == WaveformFactory::VC_CONVERT)) {
+            kLogger.debug() << "loadStored - Converting stored waveform of track" << trackId;
+            pLoadedTrackWaveform->setVersion(WAVEFORM_CURRENT_VERSION);
+            pLoadedTrackWaveform->setDescription(WAVEFORM_CURRENT_DESCRIPTION);
+            pLoadedTrackWaveform->setSaveState(Waveform::SaveState::SavePending);
+            pLoadedTrackWaveformSummary->setVersion(WAVEFORMSUMMARY_CURRENT_VERSION);
+            pLoadedTrackWaveformSummary->setDescription(WAVEFORMSUMMARY_CURRENT_DESCRIPTION);
+            pLoadedTrackWaveformSummary->setSaveState(Waveform::SaveState::SavePending);
+            m_analysisDao.saveTrackAnalyses(
+                    trackId,
+                    pLoadedTrackWaveform,
+                    pLoadedTrackWaveformSummary);
+        }
     }
 
     // If we don't need to calculate the waveform/wavesummary, skip.
     if (!missingWaveform && !missingWavesummary) {
         kLogger.debug() << "loadStored - Stored waveform loaded";
-        if (pLoadedTrackWaveform) {
-            tio->setWaveform(pLoadedTrackWaveform);
-        }
-        if (pLoadedTrackWaveformSummary) {
-            tio->setWaveformSummary(pLoadedTrackWaveformSummary);
-        }
         return false;
     }
     return true;
@@ -1,5 +1,6 @@
 #include "analyzer/trackanalysisscheduler.h"
 
+#include "control/controlproxy.h"
 #include "library/library.h"
 #include "library/trackcollection.h"
 #include "moc_trackanalysisscheduler.cpp"
@@ -14,6 +15,18 @@ constexpr QThread::Priority kWorkerThreadPriority = QThread::LowPriority;
 // Maximum frequency of progress updates
 constexpr std::chrono::milliseconds kProgressInhibitDuration(100);
 
+// The interval for adjusting the number of active workers
+// to the engine load
+constexpr int kEngineLoadUpdateIntervalMillis = 500;
+
+// The fraction of the audio buffer duration spent in the audio callback.
+// Workers are removed above the upper and added below the lower threshold.
+constexpr double kHighAudioLatencyUsage = 0.6;
+constexpr double kLowAudioLatencyUsage = 0.3;
+
+// All workers are paused for this duration after an audio buffer underflow
+constexpr std::chrono::seconds kOverloadPauseDuration(10);
+
 void deleteTrackAnalysisScheduler(TrackAnalysisScheduler* plainPtr) {
     if (plainPtr) {
         // Trigger stop
@@ -53,7 +66,14 @@ TrackAnalysisScheduler::TrackAnalysisScheduler(
           m_currentTrackNumber(0),
           m_dequeuedTracksCount(0),
           // The first signal should always be emitted
-          m_lastProgressEmittedAt(Clock::now() - kProgressInhibitDuration) {
+          m_lastProgressEmittedAt(Clock::now() - kProgressInhibitDuration),
+          m_suspended(true),
+          m_activeWorkerCount(numWorkerThreads),
+          m_pAudioLatencyUsage(nullptr),
+          m_pAudioLatencyOverloadCount(nullptr),
+          m_pNumDecks(nullptr),
+          m_lastAudioLatencyOverloadCount(0),
+          m_pausedUntil(Clock::now()) {
     VERIFY_OR_DEBUG_ASSERT(numWorkerThreads > 0) {
             kLogger.warning()
                     << "Invalid number of worker threads:"
@@ -81,6 +101,27 @@ TrackAnalysisScheduler::TrackAnalysisScheduler(
         worker.thread()->suspend();
         worker.thread()->start(kWorkerThreadPriority);
     }
+
+    if (modeFlags & AnalyzerModeFlags::LowPriority) {
+        m_pAudioLatencyUsage = new ControlProxy(
+                ConfigKey("[Master]", "audio_latency_usage"),
+                this,
+                ControlFlag::NoAssertIfMissing);
+        m_pAudioLatencyOverloadCount = new ControlProxy(
+                ConfigKey("[Master]", "audio_latency_overload_count"),
+                this,
+                ControlFlag::NoAssertIfMissing);
+        m_pNumDecks = new ControlProxy(
+                ConfigKey("[Master]", "num_decks"),
+                this,
+                ControlFlag::NoAssertIfMissing);
+        m_lastAudioLatencyOverloadCount = m_pAudioLatencyOverloadCount->get();
+        connect(&m_engineLoadTimer,
+                &QTimer::timeout,
+                this,
+                &TrackAnalysisScheduler::slotUpdateActiveWorkerCount);
+        m_engineLoadTimer.start(kEngineLoadUpdateIntervalMillis);
+    }
 }
 
 TrackAnalysisScheduler::~TrackAnalysisScheduler() {
@@ -194,7 +235,11 @@ void TrackAnalysisScheduler::onWorkerThreadProgress(
         DEBUG_ASSERT(!trackId.isValid());
         DEBUG_ASSERT(analyzerProgress == kAnalyzerProgressUnknown);
         worker.onAnalyzerProgress(analyzerProgress);
-        submitNextTrack(&worker);
+        // Paused workers receive their next track after they
+        // have been resumed and become idle again
+        if (isWorkerActive(threadId)) {
+            submitNextTrack(&worker);
+        }
         break;
     case AnalyzerThreadState::Busy:
         DEBUG_ASSERT(trackId.isValid());
@@ -256,16 +301,99 @@ int TrackAnalysisScheduler::scheduleTracksById(const QList<TrackId>& trackIds) {
 
 void TrackAnalysisScheduler::suspend() {
     kLogger.debug() << "Suspending";
-    for (auto& worker: m_workers) {
-        worker.suspendThread();
-    }
+    m_suspended = true;
+    applyActiveWorkerCount();
 }
 
 void TrackAnalysisScheduler::resume() {
     kLogger.debug() << "Resuming";
-    for (auto& worker: m_workers) {
-        worker.resumeThread();
+    m_suspended = false;
+    applyActiveWorkerCount();
+}
+
+void TrackAnalysisScheduler::applyActiveWorkerCount() {
+    for (int threadId = 0; threadId < static_cast<int>(m_workers.size()); ++threadId) {
+        if (isWorkerActive(threadId)) {
+            m_workers[threadId].resumeThread();
+        } else {
+            m_workers[threadId].suspendThread();
+        }
+    }
+}
+
+bool TrackAnalysisScheduler::isAnyDeckPlaying() {
+    const int numDecks = static_cast<int>(m_pNumDecks->get());
+    while (static_cast<int>(m_deckPlayControls.size()) < numDecks) {
+        m_deckPlayControls.push_back(new ControlProxy(
+                QString("[Channel%1]").arg(static_cast<int>(m_deckPlayControls.size()) + 1),
+                QStringLiteral("play"),
+                this,
+                ControlFlag::NoAssertIfMissing));
+    }
+    for (int i = 0; i < numDecks; ++i) {
+        if (m_deckPlayControls[i]->toBool()) {
+            return true;
+        }
+    }
+    return false;
+}
+
+//static
+int TrackAnalysisScheduler::adjustActiveWorkerCount(
+        int activeWorkerCount,
+        int maxWorkerCount,
+        bool anyDeckPlaying,
+        double audioLatencyUsage) {
+    if (!anyDeckPlaying) {
+        return maxWorkerCount;
+    }
+    // All workers have been paused after an overload. A single worker is
+    // resumed independent of the load, otherwise the analysis would never
+    // continue while the load stays above the low threshold.
+    if (activeWorkerCount < 1) {
+        return math_min(1, maxWorkerCount);
+    }
+    if (audioLatencyUsage > kHighAudioLatencyUsage) {
+        return math_max(1, activeWorkerCount - 1);
+    }
+    // Additional workers are only added below the low threshold
+    if (audioLatencyUsage < kLowAudioLatencyUsage) {
+        return math_min(maxWorkerCount, activeWorkerCount + 1);
+    }
+    return activeWorkerCount;
+}
+
+void TrackAnalysisScheduler::slotUpdateActiveWorkerCount() {
+    int activeWorkerCount = m_activeWorkerCount;
+    const auto now = Clock::now();
+    const double overloadCount = m_pAudioLatencyOverloadCount->get();
+    if (overloadCount > m_lastAudioLatencyOverloadCount) {
+        // The engine has missed its deadline
+        activeWorkerCount = 0;
+        m_pausedUntil = now + kOverloadPauseDuration;
+    } else if (now < m_pausedUntil) {
+        // Keep all workers paused for a while
+    } else {
+        const bool anyDeckPlaying = isAnyDeckPlaying();
+        activeWorkerCount = adjustActiveWorkerCount(
+                activeWorkerCount,
+                static_cast<int>(m_workers.size()),
+                anyDeckPlaying,
+                anyDeckPlaying ? m_pAudioLatencyUsage->get() : 0.0);
+    }
+    // The overload count is reset when the sound devices are reopened
+    m_lastAudioLatencyOverloadCount = overloadCount;
+
+    if (activeWorkerCount == m_activeWorkerCount) {
+        return;
     }
+    kLogger.debug()
+            << "Changing the number of active workers from"
+            << m_activeWorkerCount
+            << "to"
+            << activeWorkerCount;
+    m_activeWorkerCount = activeWorkerCount;
+    applyActiveWorkerCount();
 }
 
 bool TrackAnalysisScheduler::submitNextTrack(Worker* worker) {
@@ -318,6 +446,7 @@ bool TrackAnalysisScheduler::submitNextTrack(Worker* worker) {
 
 void TrackAnalysisScheduler::stop() {
     kLogger.debug() << "Stopping";
+    m_engineLoadTimer.stop();
     for (auto& worker: m_workers) {
         worker.stopThread();
     }
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <QList>
+#include <QTimer>
 
 #include <deque>
 #include <set>
@@ -12,6 +13,7 @@
 
 
 // forward declaration(s)
+class ControlProxy;
 class Library;
 
 class TrackAnalysisScheduler : public QObject {
@@ -25,6 +27,10 @@ class TrackAnalysisScheduler : public QObject {
         NullPointer();
     };
 
+    // Batch analysis with AnalyzerModeFlags::LowPriority adjusts the number
+    // of active worker threads to the load of the audio engine, up to
+    // numWorkerThreads. Workers are paused if the engine is close to missing
+    // its deadline and all workers are active while no deck is playing.
     static Pointer createInstance(
             Library* library,
             int numWorkerThreads,
@@ -46,11 +52,23 @@ class TrackAnalysisScheduler : public QObject {
     // Returns the scheduled tracks that have not yet been analyzed.
     // Includes both queued tracks as well as pending tracks that are
     // currently being analyzed. The result may contain duplicates.
-    // TODO(XXX): Use this function for implementing the feature
-    // "Suspend and resume batch analysis"
-    // https://bugs.launchpad.net/mixxx/+bug/1443181
+    // Used for resuming a batch analysis after restarting.
     QList<TrackId> stopAndCollectScheduledTrackIds();
 
+    int activeWorkerCount() const {
+        return m_activeWorkerCount;
+    }
+
+    // Returns the number of workers that should be active for the current
+    // load of the audio engine while the workers are not paused after an
+    // overload. At least one worker is active after the pause.
+    // Used by slotUpdateActiveWorkerCount().
+    static int adjustActiveWorkerCount(
+            int activeWorkerCount,
+            int maxWorkerCount,
+            bool anyDeckPlaying,
+            double audioLatencyUsage);
+
   public slots:
     void suspend();
 
@@ -70,6 +88,7 @@ class TrackAnalysisScheduler : public QObject {
 
   private slots:
     void onWorkerThreadProgress(int threadId, AnalyzerThreadState threadState, TrackId trackId, AnalyzerProgress analyzerProgress);
+    void slotUpdateActiveWorkerCount();
 
   private:
     // Owns an analyzer thread and buffers the most recent progress update
@@ -141,6 +160,14 @@ class TrackAnalysisScheduler : public QObject {
     bool submitNextTrack(Worker* worker);
     void emitProgressOrFinished();
 
+    bool isWorkerActive(int threadId) const {
+        return !m_suspended && threadId < m_activeWorkerCount;
+    }
+    // Suspends or resumes the worker threads according to
+    // m_activeWorkerCount and m_suspended
+    void applyActiveWorkerCount();
+    bool isAnyDeckPlaying();
+
     bool allTracksFinished() const {
         return m_queuedTrackIds.empty() &&
                 m_pendingTrackIds.empty();
@@ -164,4 +191,19 @@ class TrackAnalysisScheduler : public QObject {
 
     typedef std::chrono::steady_clock Clock;
     Clock::time_point m_lastProgressEmittedAt;
+
+    // Suspended by the owner, independent of the engine load
+    bool m_suspended;
+
+    int m_activeWorkerCount;
+
+    // Only used if the number of active workers follows the engine load
+    QTimer m_engineLoadTimer;
+    ControlProxy* m_pAudioLatencyUsage;
+    ControlProxy* m_pAudioLatencyOverloadCount;
+    ControlProxy* m_pNumDecks;
+    std::vector<ControlProxy*> m_deckPlayControls;
+    double m_lastAudioLatencyOverloadCount;
+    // Workers remain paused until this time after an overload
+    Clock::time_point m_pausedUntil;
 };
@@ -0,0 +1,229 @@
+#include "broadcast/broadcastencodergroup.h"
+
+#include "encoder/encoderbroadcastsettings.h"
+#include "engine/engine.h"
+#include "recording/defs_recording.h"
+#include "util/logger.h"
+
+namespace {
+
+const mixxx::Logger kLogger("BroadcastEncoderGroup");
+
+// The encoded audio that is kept for slow and reconnecting connections
+constexpr int kBufferSeconds = 10;
+
+// Another reader takes over the encoder if the driving reader has not
+// processed any samples for this long, e.g. while blocked by the server.
+constexpr mixxx::Duration kDrivingReaderTimeout = mixxx::Duration::fromMillis(500);
+
+// The encoder time is reported for each minute of encoded audio
+constexpr int kReportIntervalSeconds = 60;
+
+QMutex s_groupsMutex;
+QHash<QString, std::weak_ptr<BroadcastEncoderGroup>> s_groups;
+
+} // anonymous namespace
+
+BroadcastEncoderGroup::Reader::Reader(std::shared_ptr<BroadcastEncoderGroup> pGroup)
+        : m_pGroup(std::move(pGroup)),
+          m_nextSequence(0) {
+    {
+        QMutexLocker locker(&m_pGroup->m_packetMutex);
+        m_nextSequence = m_pGroup->endSequence();
+    }
+    QMutexLocker locker(&m_pGroup->m_encoderMutex);
+    ++m_pGroup->m_readerCount;
+}
+
+BroadcastEncoderGroup::Reader::~Reader() {
+    QMutexLocker locker(&m_pGroup->m_encoderMutex);
+    if (m_pGroup->m_pDrivingReader == this) {
+        m_pGroup->m_pDrivingReader = nullptr;
+    }
+    --m_pGroup->m_readerCount;
+}
+
+void BroadcastEncoderGroup::Reader::process(const CSAMPLE* pBuffer, int iBufferSize) {
+    m_pGroup->encode(this, pBuffer, iBufferSize);
+}
+
+int BroadcastEncoderGroup::Reader::read(QVector<QByteArray>* pPackets) {
+    return m_pGroup->readPackets(&m_nextSequence, pPackets);
+}
+
+void BroadcastEncoderGroup::Reader::suspend() {
+    m_pGroup->releaseEncoder(this);
+}
+
+//static
+QString BroadcastEncoderGroup::groupKey(
+        const BroadcastProfilePtr& pProfile,
+        mixxx::audio::SampleRate sampleRate) {
+    const EncoderBroadcastSettings settings(pProfile);
+    QString key = QStringLiteral("%1 %2 kbps %3 ch %4 Hz")
+                          .arg(settings.getFormat(),
+                                  QString::number(settings.getQuality()),
+                                  QString::number(static_cast<int>(
+                                          settings.getChannelMode())),
+                                  QString::number(static_cast<int>(sampleRate)));
+    if (settings.getFormat() != ENCODING_MP3) {
+        // Each Ogg stream needs its own headers
+        key += QStringLiteral(" for ") + pProfile->getProfileName();
+    }
+    return key;
+}
+
+//static
+std::unique_ptr<BroadcastEncoderGroup::Reader> BroadcastEncoderGroup::attach(
+        const BroadcastProfilePtr& pProfile,
+        mixxx::audio::SampleRate sampleRate,
+        QString* pErrorMessage) {
+    const QString key = groupKey(pProfile, sampleRate);
+
+    QMutexLocker locker(&s_groupsMutex);
+    std::shared_ptr<BroadcastEncoderGroup> pGroup = s_groups.value(key).lock();
+    if (pGroup) {
+        kLogger.debug() << pProfile->getProfileName() << "shares encoder" << key;
+        return std::make_unique<Reader>(std::move(pGroup));
+    }
+
+    const EncoderSettingsPointer pSettings =
+            std::make_shared<EncoderBroadcastSettings>(pProfile);
+    const int bufferCapacityBytes = pSettings->getQuality() * 1000 / 8 * kBufferSeconds;
+    pGroup = std::shared_ptr<BroadcastEncoderGroup>(
+            new BroadcastEncoderGroup(key, sampleRate, bufferCapacityBytes));
+    pGroup->m_pEncoder = EncoderFactory::getFactory().createEncoder(
+            pSettings, pGroup.get());
+    // TODO(XXX): Use mixxx::audio::SampleRate instead of int in initEncoder
+    if (pGroup->m_pEncoder->initEncoder(static_cast<int>(sampleRate), *pErrorMessage) < 0) {
+        // The group unregisters itself when being deleted
+        locker.unlock();
+        pGroup.reset();
+        return nullptr;
+    }
+    s_groups.insert(key, pGroup);
+    kLogger.debug() << pProfile->getProfileName() << "creates encoder" << key;
+    return std::make_unique<Reader>(std::move(pGroup));
+}
+
+BroadcastEncoderGroup::BroadcastEncoderGroup(
+        const QString& key,
+        mixxx::audio::SampleRate sampleRate,
+        int bufferCapacityBytes)
+        : m_key(key),
+          m_sampleRate(sampleRate),
+          m_pDrivingReader(nullptr),
+          m_encodedSamples(0),
+          m_reportedSamples(0),
+          m_readerCount(0),
+          m_firstSequence(0),
+          m_bufferCapacityBytes(bufferCapacityBytes),
+          m_bufferedBytes(0) {
+}
+
+BroadcastEncoderGroup::~BroadcastEncoderGroup() {
+    // The encoder might write its remaining packets while being deleted
+    m_pEncoder.reset();
+
+    QMutexLocker locker(&s_groupsMutex);
+    auto it = s_groups.find(m_key);
+    // The key might already have been taken by a new group
+    if (it != s_groups.end() && it.value().expired()) {
+        s_groups.erase(it);
+    }
+}
+
+void BroadcastEncoderGroup::encode(
+        const Reader* pReader, const CSAMPLE* pBuffer, int iBufferSize) {
+    QMutexLocker locker(&m_encoderMutex);
+    if (m_pDrivingReader != pReader) {
+        if (m_pDrivingReader &&
+                m_drivingReaderTimer.elapsed() < kDrivingReaderTimeout) {
+            return;
+        }
+        kLogger.debug() << m_key << "is driven by another connection";
+        m_pDrivingReader = pReader;
+    }
+    m_drivingReaderTimer.start();
+
+    PerformanceTimer timer;
+    timer.start();
+    m_pEncoder->encodeBuffer(pBuffer, iBufferSize);
+    m_encoderTime += timer.elapsed();
+    m_encodedSamples += iBufferSize;
+
+    const qint64 reportIntervalSamples = static_cast<qint64>(m_sampleRate) *
+            static_cast<int>(mixxx::kEngineChannelCount) * kReportIntervalSeconds;
+    if (m_encodedSamples - m_reportedSamples >= reportIntervalSamples) {
+        kLogger.info()
+                << m_key << "encoded"
+                << kReportIntervalSeconds << "s of audio for"
+                << m_readerCount << "connection(s) in"
+                << m_encoderTime;
+        m_reportedSamples = m_encodedSamples;
+        m_encoderTime = mixxx::Duration::empty();
+    }
+}
+
+void BroadcastEncoderGroup::releaseEncoder(const Reader* pReader) {
+    QMutexLocker locker(&m_encoderMutex);
+    if (m_pDrivingReader == pReader) {
+        m_pDrivingReader = nullptr;
+    }
+}
+
+int BroadcastEncoderGroup::readPackets(
+        qint64* pNextSequence, QVector<QByteArray>* pPackets) {
+    QMutexLocker locker(&m_packetMutex);
+    int skippedPackets = 0;
+    if (*pNextSequence < m_firstSequence) {
+        skippedPackets = static_cast<int>(m_firstSequence - *pNextSequence);
+        *pNextSequence = m_firstSequence;
+    }
+    for (auto i = static_cast<std::size_t>(*pNextSequence - m_firstSequence);
+            i < m_packets.size();
+            ++i) {
+        pPackets->append(m_packets[i]);
+    }
+    *pNextSequence = endSequence();
+    return skippedPackets;
+}
+
+qint64 BroadcastEncoderGroup::endSequence() const {
+    // Only invoked while m_packetMutex is locked
+    return m_firstSequence + static_cast<qint64>(m_packets.size());
+}
+
+void BroadcastEncoderGroup::write(const unsigned char* header,
+        const unsigned char* body,
+        int headerLen,
+        int bodyLen) {
+    QByteArray packet;
+    packet.reserve(headerLen + bodyLen);
+    if (headerLen > 0) {
+        packet.append(reinterpret_cast<const char*>(header), headerLen);
+    }
+    packet.append(reinterpret_cast<const char*>(body), bodyLen);
+
+    QMutexLocker locker(&m_packetMutex);
+    m_bufferedBytes += packet.size();
+    m_packets.push_back(std::move(packet));
+    while (m_bufferedBytes > m_bufferCapacityBytes && m_packets.size() > 1) {
+        m_bufferedBytes -= m_packets.front().size();
+        m_packets.pop_front();
+        ++m_firstSequence;
+    }
+}
+
+// These are not used for streaming, but the interface requires them
+int BroadcastEncoderGroup::tell() {
+    return -1;
+}
+
+void BroadcastEncoderGroup::seek(int pos) {
+    Q_UNUSED(pos);
+}
+
+int BroadcastEncoderGroup::filelen() {
+    return 0;
+}
@@ -0,0 +1,125 @@
+#pragma once
+
+#include <QByteArray>
+#include <QHash>
+#include <QMutex>
+#include <QString>
+#include <QVector>
+#include <deque>
+#include <memory>
+
+#include "audio/types.h"
+#include "encoder/encoder.h"
+#include "encoder/encodercallback.h"
+#include "preferences/broadcastprofile.h"
+#include "util/duration.h"
+#include "util/performancetimer.h"
+
+/// Encodes the master mix once for all broadcast connections that use
+/// the same encoder settings.
+///
+/// The encoded packets are stored in a ring that is shared by all
+/// connections of the group. Each connection reads the packets with its
+/// own Reader. The ring holds a few seconds of audio and is never blocked
+/// by a slow connection: packets that a Reader has not read before they
+/// are evicted are skipped. The same packets are kept while an MP3
+/// connection reconnects, i.e. it continues with the audio that has been
+/// encoded in the meantime.
+///
+/// Only MP3 streams are shared. Ogg streams start with headers that
+/// every server needs to receive first, so each connection gets a
+/// group of its own, which is replaced when reconnecting.
+class BroadcastEncoderGroup : public EncoderCallback {
+  public:
+    /// Reads the encoded packets of a group on behalf of a single
+    /// connection. Not thread-safe, it must only be used by the thread
+    /// of the connection.
+    class Reader {
+      public:
+        explicit Reader(std::shared_ptr<BroadcastEncoderGroup> pGroup);
+        ~Reader();
+
+        const std::shared_ptr<BroadcastEncoderGroup>& group() const {
+            return m_pGroup;
+        }
+
+        /// Encodes the samples if this reader currently drives the
+        /// encoder of the group. The samples of all other readers are
+        /// discarded, because they are identical.
+        void process(const CSAMPLE* pBuffer, int iBufferSize);
+
+        /// Appends all packets that have been encoded since the last
+        /// invocation. Returns the number of packets that have been
+        /// skipped, because they have been evicted before.
+        int read(QVector<QByteArray>* pPackets);
+
+        /// Hands over the encoder to the other readers of the group
+        /// while the connection is down. The read position is kept.
+        void suspend();
+
+      private:
+        const std::shared_ptr<BroadcastEncoderGroup> m_pGroup;
+        qint64 m_nextSequence;
+    };
+
+    /// Returns a reader of the group for the settings of the profile.
+    /// The group is created and its encoder is initialized if it does
+    /// not exist yet. Returns nullptr if the encoder could not be
+    /// initialized.
+    static std::unique_ptr<Reader> attach(
+            const BroadcastProfilePtr& pProfile,
+            mixxx::audio::SampleRate sampleRate,
+            QString* pErrorMessage);
+
+    /// Connections with the same key share a group.
+    static QString groupKey(
+            const BroadcastProfilePtr& pProfile,
+            mixxx::audio::SampleRate sampleRate);
+
+    ~BroadcastEncoderGroup() override;
+
+    const QString& key() const {
+        return m_key;
+    }
+
+    // EncoderCallback
+    void write(const unsigned char* header,
+            const unsigned char* body,
+            int headerLen,
+            int bodyLen) override;
+    int tell() override;
+    void seek(int pos) override;
+    int filelen() override;
+
+  private:
+    BroadcastEncoderGroup(
+            const QString& key,
+            mixxx::audio::SampleRate sampleRate,
+            int bufferCapacityBytes);
+
+    void encode(const Reader* pReader, const CSAMPLE* pBuffer, int iBufferSize);
+    void releaseEncoder(const Reader* pReader);
+    int readPackets(qint64* pNextSequence, QVector<QByteArray>* pPackets);
+    qint64 endSequence() const;
+
+    const QString m_key;
+    const mixxx::audio::SampleRate m_sampleRate;
+
+    // Guards the encoder and the state of the reader that drives it
+    QMutex m_encoderMutex;
+    EncoderPointer m_pEncoder;
+    const Reader* m_pDrivingReader;
+    PerformanceTimer m_drivingReaderTimer;
+    mixxx::Duration m_encoderTime;
+    qint64 m_encodedSamples;
+    qint64 m_reportedSamples;
+    int m_readerCount;
+
+    // Guards the ring of encoded packets. The packets are implicitly
+    // shared with the readers and must not be modified.
+    mutable QMutex m_packetMutex;
+    std::deque<QByteArray> m_packets;
+    qint64 m_firstSequence;
+    const int m_bufferCapacityBytes;
+    int m_bufferedBytes;
+};
@@ -2,14 +2,21 @@
 
 #include "control/controlobject.h"
 #include "moc_control.cpp"
+#include "util/performancetimer.h"
 #include "util/stat.h"
 
+namespace {
+
+// The innermost ScopedLookupStats of the current thread
+thread_local ControlDoublePrivate::ScopedLookupStats* s_pLookupStats = nullptr;
+
+} // anonymous namespace
+
 //static
 UserSettingsPointer ControlDoublePrivate::s_pUserConfig;
 
 //static
-QHash<ConfigKey, QWeakPointer<ControlDoublePrivate>> ControlDoublePrivate::s_qCOHash
-        GUARDED_BY(ControlDoublePrivate::s_qCOHashMutex);
+ControlRegistry ControlDoublePrivate::s_registry;
 
 //static
 QHash<ConfigKey, ConfigKey> ControlDoublePrivate::s_qCOAliasHash
@@ -60,10 +67,9 @@ void ControlDoublePrivate::initialize(double defaultValue) {
 }
 
 ControlDoublePrivate::~ControlDoublePrivate() {
-    s_qCOHashMutex.lock();
-    //qDebug() << "ControlDoublePrivate::s_qCOHash.remove(" << m_key.group << "," << m_key.item << ")";
-    s_qCOHash.remove(m_key);
-    s_qCOHashMutex.unlock();
+    // The registry only references this control weakly, i.e. it
+    // is considered missing from now on and will be replaced or
+    // dropped eventually.
 
     if (m_bPersistInConfiguration) {
         UserSettingsPointer pConfig = ControlDoublePrivate::s_pUserConfig;
@@ -77,20 +83,32 @@ ControlDoublePrivate::~ControlDoublePrivate() {
 void ControlDoublePrivate::insertAlias(const ConfigKey& alias, const ConfigKey& key) {
     MMutexLocker locker(&s_qCOHashMutex);
 
-    auto it = s_qCOHash.constFind(key);
-    if (it == s_qCOHash.constEnd()) {
-        qWarning() << "WARNING: ControlDoublePrivate::insertAlias called for null control" << key;
-        return;
-    }
-
-    QSharedPointer<ControlDoublePrivate> pControl = it.value();
+    QSharedPointer<ControlDoublePrivate> pControl = s_registry.lookup(key);
     if (pControl.isNull()) {
-        qWarning() << "WARNING: ControlDoublePrivate::insertAlias called for expired control" << key;
+        qWarning() << "WARNING: ControlDoublePrivate::insertAlias called for null or expired control" << key;
         return;
     }
 
     s_qCOAliasHash.insert(key, alias);
-    s_qCOHash.insert(alias, pControl);
+    s_registry.insert(alias, pControl);
+}
+
+// static
+QHash<ConfigKey, ConfigKey> ControlDoublePrivate::getControlAliases() {
+    MMutexLocker locker(&s_qCOHashMutex);
+    // Implicitly shared classes can safely be copied across threads
+    return s_qCOAliasHash;
+}
+
+ControlDoublePrivate::ScopedLookupStats::ScopedLookupStats()
+        : m_pParent(s_pLookupStats),
+          m_count(0) {
+    s_pLookupStats = this;
+}
+
+ControlDoublePrivate::ScopedLookupStats::~ScopedLookupStats() {
+    DEBUG_ASSERT(s_pLookupStats == this);
+    s_pLookupStats = m_pParent;
 }
 
 // static
@@ -108,31 +126,31 @@ QSharedPointer<ControlDoublePrivate> ControlDoublePrivate::getControl(
         return nullptr;
     }
 
-    // Scope for MMutexLocker.
-    {
-        const MMutexLocker locker(&s_qCOHashMutex);
-        const auto it = s_qCOHash.find(key);
-        if (it != s_qCOHash.end()) {
-            auto pControl = it.value().lock();
-            if (pControl) {
-                // Control object already exists
-                VERIFY_OR_DEBUG_ASSERT(!pCreatorCO) {
-                    qWarning()
-                            << "ControlObject"
-                            << key.group << key.item
-                            << "already created";
-                    return nullptr;
-                }
-                return pControl;
-            } else {
-                // The weak pointer has become invalid and can be cleaned up
-                s_qCOHash.erase(it);
-            }
+    // Lookups don't lock s_qCOHashMutex
+    ScopedLookupStats* const pLookupStats = s_pLookupStats;
+    PerformanceTimer timer;
+    if (pLookupStats) {
+        timer.start();
+    }
+    auto pControl = s_registry.lookup(key);
+    if (pLookupStats) {
+        ++pLookupStats->m_count;
+        pLookupStats->m_duration += timer.elapsed();
+    }
+    if (pControl) {
+        // Control object already exists
+        VERIFY_OR_DEBUG_ASSERT(!pCreatorCO) {
+            qWarning()
+                    << "ControlObject"
+                    << key.group << key.item
+                    << "already created";
+            return nullptr;
         }
+        return pControl;
     }
 
     if (pCreatorCO) {
-        auto pControl = QSharedPointer<ControlDoublePrivate>(
+        pControl = QSharedPointer<ControlDoublePrivate>(
                 new ControlDoublePrivate(key,
                         pCreatorCO,
                         bIgnoreNops,
@@ -140,8 +158,8 @@ QSharedPointer<ControlDoublePrivate> ControlDoublePrivate::getControl(
                         bPersist,
                         defaultValue));
         const MMutexLocker locker(&s_qCOHashMutex);
-        //qDebug() << "ControlDoublePrivate::s_qCOHash.insert(" << key.group << "," << key.item << ")";
-        s_qCOHash.insert(key, pControl);
+        //qDebug() << "ControlDoublePrivate::s_registry.insert(" << key.group << "," << key.item << ")";
+        s_registry.insert(key, pControl);
         return pControl;
     }
 
@@ -155,34 +173,13 @@ QSharedPointer<ControlDoublePrivate> ControlDoublePrivate::getControl(
 
 // static
 QList<QSharedPointer<ControlDoublePrivate>> ControlDoublePrivate::getAllInstances() {
-    QList<QSharedPointer<ControlDoublePrivate>> result;
-    MMutexLocker locker(&s_qCOHashMutex);
-    result.reserve(s_qCOHash.size());
-    for (auto it = s_qCOHash.begin(); it != s_qCOHash.end(); ++it) {
-        auto pControl = it.value().lock();
-        if (pControl) {
-            result.append(std::move(pControl));
-        } else {
-            // The weak pointer has become invalid and can be cleaned up
-            s_qCOHash.erase(it);
-        }
-    }
-    return result;
+    return s_registry.instances();
 }
 
 // static
 QList<QSharedPointer<ControlDoublePrivate>> ControlDoublePrivate::takeAllInstances() {
-    QList<QSharedPointer<ControlDoublePrivate>> result;
     MMutexLocker locker(&s_qCOHashMutex);
-    result.reserve(s_qCOHash.size());
-    for (auto it = s_qCOHash.begin(); it != s_qCOHash.end(); ++it) {
-        auto pControl = it.value().lock();
-        if (pControl) {
-            result.append(std::move(pControl));
-        }
-    }
-    s_qCOHash.clear();
-    return result;
+    return s_registry.takeInstances();
 }
 
 void ControlDoublePrivate::deleteCreatorCO() {
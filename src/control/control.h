@@ -7,8 +7,11 @@
 #include <QString>
 
 #include "control/controlbehavior.h"
+#include "control/controlregistry.h"
 #include "control/controlvalue.h"
 #include "preferences/usersettings.h"
+#include "util/class.h"
+#include "util/duration.h"
 #include "util/mutex.h"
 
 class ControlObject;
@@ -60,13 +63,38 @@ class ControlDoublePrivate : public QObject {
 
     // Returns a list of all existing instances.
     static QList<QSharedPointer<ControlDoublePrivate>> getAllInstances();
-    // Clears all existing instances and returns them as a list.
+    // Clears all existing instances and returns them as a list. Must only be
+    // invoked when no other thread is accessing controls, e.g. on shutdown.
     static QList<QSharedPointer<ControlDoublePrivate>> takeAllInstances();
 
-    static QHash<ConfigKey, ConfigKey> getControlAliases() {
-        // Implicitly shared classes can safely be copied across threads
-        return s_qCOAliasHash;
-    }
+    static QHash<ConfigKey, ConfigKey> getControlAliases();
+
+    // Counts all lookups by getControl() on the current thread and measures
+    // the time spent in them while in scope, e.g. for profiling how long
+    // loading a skin spends with resolving controls. Scopes can be nested,
+    // lookups are only accounted to the innermost scope.
+    class ScopedLookupStats {
+      public:
+        ScopedLookupStats();
+        ~ScopedLookupStats();
+
+        int count() const {
+            return m_count;
+        }
+
+        mixxx::Duration duration() const {
+            return m_duration;
+        }
+
+      private:
+        friend class ControlDoublePrivate;
+
+        ScopedLookupStats* const m_pParent;
+        int m_count;
+        mixxx::Duration m_duration;
+
+        DISALLOW_COPY_AND_ASSIGN(ScopedLookupStats);
+    };
 
     const QString& name() const {
         return m_name;
@@ -214,13 +242,15 @@ class ControlDoublePrivate : public QObject {
     // configuration object would be arduous.
     static UserSettingsPointer s_pUserConfig;
 
-    // Hash of ControlDoublePrivate instantiations.
-    static QHash<ConfigKey, QWeakPointer<ControlDoublePrivate>> s_qCOHash;
+    // All ControlDoublePrivate instantiations including aliases. Lookups
+    // don't need to lock s_qCOHashMutex.
+    static ControlRegistry s_registry;
 
     // Hash of aliases between ConfigKeys. Solely used for looking up the first
     // alias associated with a key.
     static QHash<ConfigKey, ConfigKey> s_qCOAliasHash;
 
-    // Mutex guarding access to s_qCOHash and s_qCOAliasHash.
+    // Mutex serializing modifications of s_registry and guarding access to
+    // s_qCOAliasHash.
     static MMutex s_qCOHashMutex;
 };
@@ -0,0 +1,124 @@
+#include "control/controlregistry.h"
+
+#include "control/control.h"
+#include "util/assert.h"
+
+namespace {
+
+// Enough for all controls of a typical configuration with 4 decks
+// without growing.
+constexpr int kInitialCapacity = 1 << 14;
+
+} // anonymous namespace
+
+ControlRegistry::Table::Table(int capacity)
+        : mask(static_cast<uint>(capacity - 1)),
+          slots(new std::atomic<Atom*>[capacity]),
+          size(0) {
+    DEBUG_ASSERT((capacity & (capacity - 1)) == 0);
+    for (int i = 0; i < capacity; ++i) {
+        slots[i].store(nullptr, std::memory_order_relaxed);
+    }
+}
+
+ControlRegistry::ControlRegistry() {
+    m_tables.push_back(std::make_unique<Table>(kInitialCapacity));
+    m_pTable.store(m_tables.back().get(), std::memory_order_release);
+}
+
+ControlRegistry::~ControlRegistry() = default;
+
+// static
+uint ControlRegistry::findSlot(
+        const Table& table,
+        const ConfigKey& key,
+        uint hash,
+        const Atom** ppAtom) {
+    // The load factor is at most 0.5, i.e. each probe sequence
+    // ends with an empty slot
+    uint index = hash & table.mask;
+    while (true) {
+        const Atom* pAtom = table.slots[index].load(std::memory_order_acquire);
+        if (!pAtom || (pAtom->hash == hash && pAtom->key == key)) {
+            *ppAtom = pAtom;
+            return index;
+        }
+        index = (index + 1) & table.mask;
+    }
+}
+
+QSharedPointer<ControlDoublePrivate> ControlRegistry::lookup(const ConfigKey& key) const {
+    // The slot might be modified concurrently, only the atom that
+    // has been found while probing is valid.
+    const Atom* pAtom;
+    findSlot(*currentTable(), key, qHash(key), &pAtom);
+    if (!pAtom) {
+        return nullptr;
+    }
+    return pAtom->pControl.lock();
+}
+
+void ControlRegistry::insert(
+        const ConfigKey& key,
+        const QWeakPointer<ControlDoublePrivate>& pControl) {
+    if (2 * (currentTable()->size + 1) > static_cast<int>(currentTable()->mask + 1)) {
+        grow();
+    }
+    Table* pTable = currentTable();
+    const uint hash = qHash(key);
+    const Atom* pPreviousAtom;
+    const uint index = findSlot(*pTable, key, hash, &pPreviousAtom);
+    m_atoms.push_back(std::make_unique<Atom>(key, hash, pControl));
+    // The previous atom (if any) is retired and remains valid for
+    // concurrent readers
+    pTable->slots[index].store(m_atoms.back().get(), std::memory_order_release);
+    if (!pPreviousAtom) {
+        ++pTable->size;
+    }
+}
+
+void ControlRegistry::grow() {
+    const Table* pOldTable = currentTable();
+    auto pNewTable = std::make_unique<Table>(2 * static_cast<int>(pOldTable->mask + 1));
+    for (uint i = 0; i <= pOldTable->mask; ++i) {
+        Atom* pAtom = pOldTable->slots[i].load(std::memory_order_relaxed);
+        if (!pAtom || pAtom->pControl.isNull()) {
+            // Controls that have been deleted in the meantime are dropped
+            continue;
+        }
+        const Atom* pPreviousAtom;
+        const uint index = findSlot(*pNewTable, pAtom->key, pAtom->hash, &pPreviousAtom);
+        DEBUG_ASSERT(!pPreviousAtom);
+        pNewTable->slots[index].store(pAtom, std::memory_order_relaxed);
+        ++pNewTable->size;
+    }
+    // Publish the new table after it has been filled entirely. The old
+    // table is retired.
+    m_pTable.store(pNewTable.get(), std::memory_order_release);
+    m_tables.push_back(std::move(pNewTable));
+}
+
+QList<QSharedPointer<ControlDoublePrivate>> ControlRegistry::instances() const {
+    QList<QSharedPointer<ControlDoublePrivate>> result;
+    const Table* pTable = currentTable();
+    for (uint i = 0; i <= pTable->mask; ++i) {
+        const Atom* pAtom = pTable->slots[i].load(std::memory_order_acquire);
+        if (!pAtom) {
+            continue;
+        }
+        auto pControl = pAtom->pControl.lock();
+        if (pControl) {
+            result.append(std::move(pControl));
+        }
+    }
+    return result;
+}
+
+QList<QSharedPointer<ControlDoublePrivate>> ControlRegistry::takeInstances() {
+    QList<QSharedPointer<ControlDoublePrivate>> result = instances();
+    m_tables.clear();
+    m_atoms.clear();
+    m_tables.push_back(std::make_unique<Table>(kInitialCapacity));
+    m_pTable.store(m_tables.back().get(), std::memory_order_release);
+    return result;
+}
@@ -0,0 +1,99 @@
+#pragma once
+
+#include <QList>
+#include <QSharedPointer>
+#include <atomic>
+#include <memory>
+#include <vector>
+
+#include "preferences/configobject.h"
+#include "util/class.h"
+
+class ControlDoublePrivate;
+
+// A hash table of ControlDoublePrivate instances that is optimized for
+// concurrent lookups, e.g. while loading a skin or from controller scripts.
+//
+// Lookups never block and do not modify any shared state. They may run
+// concurrently with each other and with insertions. Insertions must be
+// serialized by the caller.
+//
+// Each ConfigKey is interned as an immutable atom that references the
+// control. The table uses open addressing with linear probing and is never
+// modified except for publishing atoms in empty or replaced slots. Atoms and
+// tables that have been replaced are retired instead of deleted, because
+// readers might still access them. This only happens if a control is created
+// again for the same key (e.g. when reloading a skin) or if the table grows.
+// The retired memory is only released by takeInstances() on shutdown.
+class ControlRegistry {
+  public:
+    ControlRegistry();
+    ~ControlRegistry();
+
+    // Returns nullptr if no control exists for the key or if it has
+    // already been deleted.
+    QSharedPointer<ControlDoublePrivate> lookup(const ConfigKey& key) const;
+
+    // Inserts or replaces the control for the key. Must not be invoked
+    // concurrently with other modifications.
+    void insert(const ConfigKey& key,
+            const QWeakPointer<ControlDoublePrivate>& pControl);
+
+    // Returns all controls that have not been deleted yet. Controls with
+    // multiple keys (see aliases) are returned multiple times.
+    QList<QSharedPointer<ControlDoublePrivate>> instances() const;
+
+    // Removes all controls and returns those that have not been deleted
+    // yet. Releases the memory of all retired atoms and tables, i.e. must
+    // neither be invoked concurrently with lookups nor with modifications.
+    QList<QSharedPointer<ControlDoublePrivate>> takeInstances();
+
+  private:
+    struct Atom {
+        Atom(const ConfigKey& key,
+                uint hash,
+                const QWeakPointer<ControlDoublePrivate>& pControl)
+                : key(key),
+                  hash(hash),
+                  pControl(pControl) {
+        }
+
+        const ConfigKey key;
+        const uint hash;
+        const QWeakPointer<ControlDoublePrivate> pControl;
+    };
+
+    struct Table {
+        explicit Table(int capacity);
+
+        // The capacity is a power of 2
+        const uint mask;
+        const std::unique_ptr<std::atomic<Atom*>[]> slots;
+        // The number of occupied slots, only accessed by the writer
+        int size;
+    };
+
+    // Returns the index of the slot that contains the key or the index
+    // of the empty slot where it should be inserted. The atom that has
+    // been found for the key is returned in ppAtom, nullptr if none.
+    static uint findSlot(
+            const Table& table,
+            const ConfigKey& key,
+            uint hash,
+            const Atom** ppAtom);
+
+    Table* currentTable() const {
+        return m_pTable.load(std::memory_order_acquire);
+    }
+
+    void grow();
+
+    std::atomic<Table*> m_pTable;
+
+    // Owns all tables and atoms including those that have been retired.
+    // Only accessed by the writer.
+    std::vector<std::unique_ptr<Table>> m_tables;
+    std::vector<std::unique_ptr<Atom>> m_atoms;
+
+    DISALLOW_COPY_AND_ASSIGN(ControlRegistry);
+};
@@ -1,6 +1,9 @@
 #pragma once
 
+#include <atomic>
+#include <cstring>
 #include <limits>
+#include <type_traits>
 
 #include <QAtomicInt>
 #include <QObject>
@@ -66,14 +69,17 @@ class ControlRingValue {
     mutable QAtomicInt m_readerSlots;
 };
 
-// Ring buffer based implementation for all Types sizeof(T) > sizeof(void*)
-
-// An implementation of ControlValueAtomicBase for non-atomic types T. Uses a
-// ring-buffer of ControlRingValues and a read pointer and write pointer to
-// provide getValue()/setValue() methods which *sacrifice perfect consistency*
+// The former implementation of ControlValueAtomicBase for non-atomic types T.
+// Uses a ring-buffer of ControlRingValues and a read pointer and write pointer
+// to provide getValue()/setValue() methods which *sacrifice perfect consistency*
 // for the benefit of wait-free read/write access to a value.
-template <typename T, int cRingSize, bool ATOMIC = false>
-class ControlValueAtomicBase {
+//
+// Each getValue() needs two atomic read-modify-write operations on the
+// reader slots, which makes concurrent readers contend for the same cache
+// line. Only kept for comparing it with ControlValueSeqLockAtomic in
+// benchmarks.
+template<typename T, int cRingSize>
+class ControlValueRingAtomic {
   public:
     inline T getValue() const {
         T value;
@@ -106,8 +112,8 @@ class ControlValueAtomicBase {
         m_readIndex = index;
     }
 
-  protected:
-    ControlValueAtomicBase() : m_readIndex(0), m_writeIndex(1) {
+    ControlValueRingAtomic()
+            : m_readIndex(0), m_writeIndex(1) {
         // NOTE(rryan): Wrapping max with parentheses avoids conflict with the
         // max macro defined in windows.h.
         DEBUG_ASSERT(((std::numeric_limits<unsigned int>::max)() % cRingSize) == (cRingSize - 1));
@@ -121,39 +127,144 @@ class ControlValueAtomicBase {
     QAtomicInt m_writeIndex;
 };
 
+// An implementation of ControlValueAtomicBase for non-atomic, trivially
+// copyable types T. Like ControlValueRingAtomic it uses a ring buffer of
+// slots and *sacrifices perfect consistency*, i.e. concurrent writers might
+// publish their values out of order.
+//
+// Each slot is protected by a sequence lock: A writer claims the next slot,
+// makes its sequence odd while writing and publishes the slot afterwards.
+// Readers copy the most recently published slot without modifying any shared
+// state and retry if its sequence has changed in the meantime. Because writers
+// never write the published slot, a reader only needs to retry if the ring has
+// been overwritten entirely while it was copying the value. A reader never
+// waits for a writer that has been interrupted, as long as cRingSize is larger
+// than the number of threads that write concurrently.
+template<typename T, int cRingSize>
+class ControlValueSeqLockAtomic {
+    static_assert(std::is_trivially_copyable<T>::value,
+            "The value is copied byte-wise");
+
+  public:
+    inline T getValue() const {
+        Words words;
+        while (true) {
+            const Slot& slot = m_slots[m_readIndex.load(std::memory_order_acquire)];
+            const unsigned int sequence = slot.sequence.load(std::memory_order_acquire);
+            if (sequence & 1) {
+                // The slot is overwritten, a more recent value has been
+                // published in the meantime
+                continue;
+            }
+            for (int i = 0; i < kWordCount; ++i) {
+                words[i] = slot.words[i].load(std::memory_order_relaxed);
+            }
+            // The copy must be completed before checking the sequence again
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (slot.sequence.load(std::memory_order_relaxed) == sequence) {
+                break;
+            }
+        }
+        T value;
+        std::memcpy(&value, words, sizeof(T));
+        return value;
+    }
+
+    inline void setValue(const T& value) {
+        Words words = {};
+        std::memcpy(words, &value, sizeof(T));
+        unsigned int index;
+        unsigned int sequence;
+        do {
+            index = m_writeIndex.fetch_add(1, std::memory_order_relaxed) % cRingSize;
+            sequence = m_slots[index].sequence.load(std::memory_order_relaxed);
+            // This will be repeated if another writer is writing the same
+            // slot at the same time. Writing to the next slot will fix it.
+        } while ((sequence & 1) ||
+                !m_slots[index].sequence.compare_exchange_strong(
+                        sequence, sequence + 1, std::memory_order_relaxed));
+        Slot& slot = m_slots[index];
+        // Readers must not see the new words before the odd sequence
+        std::atomic_thread_fence(std::memory_order_release);
+        for (int i = 0; i < kWordCount; ++i) {
+            slot.words[i].store(words[i], std::memory_order_relaxed);
+        }
+        slot.sequence.store(sequence + 2, std::memory_order_release);
+        m_readIndex.store(index, std::memory_order_release);
+    }
+
+  protected:
+    ControlValueSeqLockAtomic()
+            : m_readIndex(0),
+              m_writeIndex(1) {
+        // NOTE(rryan): Wrapping max with parentheses avoids conflict with the
+        // max macro defined in windows.h.
+        DEBUG_ASSERT(((std::numeric_limits<unsigned int>::max)() % cRingSize) == (cRingSize - 1));
+        setValue(T());
+    }
+
+  private:
+    typedef quintptr Word;
+    static constexpr int kWordCount = (sizeof(T) + sizeof(Word) - 1) / sizeof(Word);
+    typedef Word Words[kWordCount];
+
+    struct Slot {
+        Slot()
+                : sequence(0) {
+        }
+        std::atomic<unsigned int> sequence;
+        std::atomic<Word> words[kWordCount];
+    };
+
+    // Padding is used instead of alignas() to avoid depending on aligned
+    // operator new. The write index is modified by every writer and must
+    // not share a cache line with the state that is polled by readers.
+    static constexpr size_t kCacheLineSize = 64;
+
+    std::atomic<unsigned int> m_readIndex;
+    Slot m_slots[cRingSize];
+    char m_padding0[kCacheLineSize];
+    std::atomic<unsigned int> m_writeIndex;
+    char m_padding1[kCacheLineSize - sizeof(std::atomic<unsigned int>)];
+};
+
+// Sequence lock based implementation for all Types sizeof(T) > sizeof(void*)
+template<typename T, int cRingSize, bool ATOMIC = false>
+class ControlValueAtomicBase : public ControlValueSeqLockAtomic<T, cRingSize> {
+  protected:
+    ControlValueAtomicBase() = default;
+};
+
 // Specialized template for types that are deemed to be atomic on the target
-// architecture. Instead of using a read/write ring to guarantee atomicity,
-// direct assignment/read of an aligned member variable is used.
-template <typename T>
-class ControlValueAtomicBase<T, true> {
+// architecture. Instead of using a ring buffer to guarantee atomicity, the
+// value is stored in a lock-free std::atomic. Plain loads and stores of a
+// non-atomic member would be a data race, which the compiler is free to
+// break up or elide.
+template<typename T, int cRingSize>
+class ControlValueAtomicBase<T, cRingSize, true> {
+    static_assert(std::atomic<T>::is_always_lock_free,
+            "Reading and writing the value must never block");
+
   public:
     inline T getValue() const {
-        return m_value;
+        return m_value.load(std::memory_order_acquire);
     }
 
     inline T getValueOnce() {
-        return std::move(m_value);
+        return m_value.load(std::memory_order_acquire);
     }
 
     inline void setValue(const T& value) {
-        m_value = value;
+        m_value.store(value, std::memory_order_release);
     }
 
   protected:
-    ControlValueAtomicBase() = default;
+    ControlValueAtomicBase()
+            : m_value(T()) {
+    }
 
   private:
-#if defined(__GNUC__)
-    T m_value __attribute__((aligned(sizeof(void*))));
-#elif defined(_MSC_VER)
-#ifdef _WIN64
-    T __declspec(align(8)) m_value;
-#else
-    T __declspec(align(4)) m_value;
-#endif
-#else
-    T m_value;
-#endif
+    std::atomic<T> m_value;
 };
 
 // ControlValueAtomic is a wrapper around ControlValueAtomicBase which uses the
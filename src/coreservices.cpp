@@ -23,6 +23,7 @@
 #include "mixer/playermanager.h"
 #include "preferences/settingsmanager.h"
 #include "soundio/soundmanager.h"
+#include "sources/seekindexcache.h"
 #include "sources/soundsourceproxy.h"
 #include "util/db/dbconnectionpooled.h"
 #include "util/font.h"
@@ -129,6 +130,10 @@ void CoreServices::initialize(QApplication* pApp) {
         qCritical() << "Failed to register any SoundSource providers";
         return;
     }
+    // Seek indexes are stored next to the analysis data
+    mixxx::SeekIndexCache::setDirectory(
+            m_pSettingsManager->settings()->getSettingsPath() +
+            QStringLiteral("/analysis/seekindex/"));
 
     Version::logBuildDetails();
 
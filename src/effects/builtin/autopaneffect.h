@@ -59,6 +59,8 @@ class RampedSample {
 
 static const int panMaxDelay = 3300; // allows a 30 Hz filter at 97346;
 // static const int panMaxDelay = 50000; // high for debug;
+// panMaxDelay at the lowest supported sample rate
+static constexpr double kPanMaxDelaySeconds = panMaxDelay / 44100.0;
 
 class AutoPanGroupState : public EffectState {
   public:
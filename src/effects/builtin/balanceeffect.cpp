@@ -23,6 +23,7 @@ EffectManifestPointer BalanceEffect::getManifest() {
     pManifest->setDescription(QObject::tr(
         "Adjust the left/right balance and stereo width"));
     pManifest->setEffectRampsFromDry(true);
+    pManifest->setMaxOutputDelaySeconds(0.0);
 
     EffectManifestParameterPointer balance = pManifest->addParameter();
     balance->setId("balance");
@@ -20,6 +20,7 @@ EffectManifestPointer Bessel4LVMixEQEffect::getManifest() {
         "A Bessel 4th-order filter isolator with Lipshitz and Vanderkooy mix (bit perfect unity, roll-off -24 dB/octave).") + " " + EqualizerUtil::adjustFrequencyShelvesTip());
     pManifest->setIsMixingEQ(true);
     pManifest->setEffectRampsFromDry(true);
+    pManifest->setMaxOutputDelaySeconds(LVMixEQEffectGroupStateConstants::kMaxDelaySeconds);
 
     EqualizerUtil::createCommonParameters(pManifest.data(), false);
     return pManifest;
@@ -31,6 +31,7 @@ EffectManifestPointer EchoEffect::getManifest() {
 
     pManifest->setAddDryToWet(true);
     pManifest->setEffectRampsFromDry(true);
+    pManifest->setMaxOutputDelaySeconds(EchoGroupState::kMaxDelaySeconds);
 
     pManifest->setId(getId());
     pManifest->setName(QObject::tr("Echo"));
@@ -22,6 +22,7 @@ EffectManifestPointer FilterEffect::getManifest() {
     pManifest->setDescription(QObject::tr(
         "Allows only high or low frequencies to play."));
     pManifest->setEffectRampsFromDry(true);
+    pManifest->setMaxOutputDelaySeconds(0.0);
 
     EffectManifestParameterPointer lpf = pManifest->addParameter();
     lpf->setId("lpf");
@@ -31,6 +31,7 @@ EffectManifestPointer FlangerEffect::getManifest() {
     pManifest->setDescription(QObject::tr(
         "Mixes the input with a delayed, pitch modulated copy of itself to create comb filtering"));
     pManifest->setMetaknobDefault(1.0);
+    pManifest->setMaxOutputDelaySeconds(kMaxDelayMs / 1000);
 
     EffectManifestParameterPointer speed = pManifest->addParameter();
     speed->setId("speed");
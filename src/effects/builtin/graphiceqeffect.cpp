@@ -20,6 +20,7 @@ EffectManifestPointer GraphicEQEffect::getManifest() {
         "An 8-band graphic equalizer based on biquad filters"));
     pManifest->setEffectRampsFromDry(true);
     pManifest->setIsMasterEQ(true);
+    pManifest->setMaxOutputDelaySeconds(0.0);
 
     // Display rounded center frequencies for each filter
     float centerFrequencies[8] = {45, 100, 220, 500, 1100, 2500,
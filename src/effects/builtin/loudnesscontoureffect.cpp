@@ -31,6 +31,7 @@ EffectManifestPointer LoudnessContourEffect::getManifest() {
         "Amplifies low and high frequencies at low volumes to compensate for reduced sensitivity of the human ear."));
     pManifest->setEffectRampsFromDry(true);
     pManifest->setMetaknobDefault(-kMaxLoGain / 2);
+    pManifest->setMaxOutputDelaySeconds(0.0);
 
     EffectManifestParameterPointer loudness = pManifest->addParameter();
     loudness->setId("loudness");
@@ -12,6 +12,8 @@ class LVMixEQEffectGroupStateConstants {
     LVMixEQEffectGroupStateConstants() = delete;
 
     static constexpr SINT kMaxDelay = 3300; // allows a 30 Hz filter at 97346;
+    // kMaxDelay at the lowest supported sample rate
+    static constexpr double kMaxDelaySeconds = kMaxDelay / 44100.0;
     static constexpr SINT kRampDone = -1;
     static constexpr double kStartupLoFreq = 246;
     static constexpr double kStartupHiFreq = 2484;
@@ -21,6 +21,9 @@ EffectManifestPointer MetronomeEffect::getManifest() {
     pManifest->setAuthor("The Mixxx Team");
     pManifest->setVersion("1.0");
     pManifest->setDescription(QObject::tr("Adds a metronome click sound to the stream"));
+    // The clicks are generated regardless of the input, so the effect is
+    // never skipped for silent input
+    pManifest->setMaxOutputDelaySeconds(-1.0);
 
     // Period
     // The maximum is at 128 + 1 allowing 128 as max value and
@@ -26,6 +26,7 @@ EffectManifestPointer PhaserEffect::getManifest() {
         "Mixes the input signal with a copy passed through a series of "
         "all-pass filters to create comb filtering"));
     pManifest->setEffectRampsFromDry(true);
+    pManifest->setMaxOutputDelaySeconds(0.0);
 
     EffectManifestParameterPointer period = pManifest->addParameter();
     period->setId("lfo_period");
@@ -63,6 +63,7 @@ EffectManifestPointer ThreeBandBiquadEQEffect::getManifest() {
         " " + EqualizerUtil::adjustFrequencyShelvesTip());
     pManifest->setEffectRampsFromDry(true);
     pManifest->setIsMixingEQ(true);
+    pManifest->setMaxOutputDelaySeconds(0.0);
 
     EqualizerUtil::createCommonParameters(pManifest.data(), true);
     return pManifest;
@@ -20,6 +20,8 @@ EffectManifestPointer WhiteNoiseEffect::getManifest() {
     pManifest->setVersion("1.0");
     pManifest->setDescription(QObject::tr("Mix white noise with the input signal"));
     pManifest->setEffectRampsFromDry(true);
+    // Adds noise to silent input as well
+    pManifest->setMaxOutputDelaySeconds(-1.0);
 
     // This is dry/wet parameter
     EffectManifestParameterPointer intensity = pManifest->addParameter();
@@ -41,11 +41,6 @@ constexpr int kNumEffectsPerUnit = 4;
 // enable this when debugging the effects system.
 constexpr bool kEffectDebugOutput = false;
 
-class EffectState;
-// For sending EffectStates along the MessagePipe
-typedef ChannelHandleMap<EffectState*> EffectStatesMap;
-typedef std::array<EffectStatesMap, kNumEffectsPerUnit> EffectStatesMapArray;
-
 class EffectRack;
 typedef QSharedPointer<EffectRack> EffectRackPointer;
 
@@ -42,8 +42,8 @@ Effect::~Effect() {
     }
 }
 
-EffectState* Effect::createState(const mixxx::EngineParameters& bufferParameters) {
-    return m_pEngineEffect->createState(bufferParameters);
+void Effect::reserveStatesForInputChannel() {
+    m_pEngineEffect->reserveStatesForInputChannel();
 }
 
 void Effect::addToEngine(EngineEffectChain* pChain, int iIndex,
@@ -10,7 +10,6 @@
 #include "effects/effectinstantiator.h"
 #include "util/class.h"
 
-class EffectState;
 class EffectProcessor;
 class EngineEffectChain;
 class EngineEffect;
@@ -30,7 +29,7 @@ class Effect : public QObject {
            EffectInstantiatorPointer pInstantiator);
     virtual ~Effect();
 
-    EffectState* createState(const mixxx::EngineParameters& bufferParameters);
+    void reserveStatesForInputChannel();
 
     EffectManifestPointer getManifest() const;
 
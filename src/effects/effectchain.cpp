@@ -11,6 +11,7 @@
 #include "moc_effectchain.cpp"
 #include "util/defs.h"
 #include "util/sample.h"
+#include "util/timer.h"
 #include "util/xml.h"
 
 EffectChain::EffectChain(EffectsManager* pEffectsManager, const QString& id,
@@ -35,6 +36,8 @@ EffectChain::~EffectChain() {
 }
 
 void EffectChain::addToEngine(EngineEffectRack* pRack, int iIndex) {
+    // Includes allocating the EffectStates of all effects
+    ScopedTimer t("EffectChain::addToEngine");
     m_pEngineEffectChain = new EngineEffectChain(m_id,
         m_pEffectsManager->registeredInputChannels(),
         m_pEffectsManager->registeredOutputChannels());
@@ -60,6 +63,7 @@ void EffectChain::removeFromEngine(EngineEffectRack* pRack, int iIndex) {
     if (!m_bAddedToEngine) {
         return;
     }
+    ScopedTimer t("EffectChain::removeFromEngine");
 
     // Order doesn't matter when removing.
     for (int i = 0; i < m_effects.size(); ++i) {
@@ -164,50 +168,30 @@ void EffectChain::enableForInputChannel(const ChannelHandleAndGroup& handleGroup
         m_enabledInputChannels.insert(handleGroup);
     }
 
-    // The allocation of EffectStates below may be expensive, so avoid it if
+    // Reserving the EffectStates below may allocate memory, so avoid it if
     // not needed.
     if (!m_bAddedToEngine || bWasAlreadyEnabled) {
         return;
     }
 
+    // Make sure that the EffectProcessors can acquire EffectStates in the
+    // realtime audio callback thread without allocating memory there. The
+    // states are usually taken from the pools, which have been filled when
+    // loading the effects or by input channels that have been disabled.
+    for (const auto& pEffect : qAsConst(m_effects)) {
+        if (pEffect) {
+            if (kEffectDebugOutput) {
+                qDebug() << debugString() << "EffectChain::enableForInputChannel reserving EffectStates for input" << handleGroup;
+            }
+            pEffect->reserveStatesForInputChannel();
+        }
+    }
+
     EffectsRequest* request = new EffectsRequest();
     request->type = EffectsRequest::ENABLE_EFFECT_CHAIN_FOR_INPUT_CHANNEL;
     request->pTargetChain = m_pEngineEffectChain;
     request->EnableInputChannelForChain.pChannelHandle = &handleGroup.handle();
 
-    // Allocate EffectStates here in the main thread to avoid allocating
-    // memory in the realtime audio callback thread. Pointers to the
-    // EffectStates are passed to the EffectRequest and the EffectProcessorImpls
-    // store the pointers. The containers of EffectState* pointers get deleted
-    // by ~EffectsRequest, but the EffectStates are managed by EffectProcessorImpl.
-    auto* pEffectStatesMapArray = new EffectStatesMapArray;
-
-    //TODO: get actual configuration of engine
-    const mixxx::EngineParameters bufferParameters(
-          mixxx::audio::SampleRate(96000),
-          MAX_BUFFER_LEN / mixxx::kEngineChannelCount);
-
-    for (int i = 0; i < m_effects.size(); ++i) {
-        auto& statesMap = (*pEffectStatesMapArray)[i];
-        if (m_effects[i] != nullptr) {
-            for (const auto& outputChannel : m_pEffectsManager->registeredOutputChannels()) {
-                if (kEffectDebugOutput) {
-                    qDebug() << debugString() << "EffectChain::enableForInputChannel creating EffectState for input" << handleGroup << "output" << outputChannel;
-                }
-                statesMap.insert(outputChannel.handle(),
-                        m_effects[i]->createState(bufferParameters));
-            }
-        } else {
-            for (EffectState* pState : statesMap) {
-                if (pState != nullptr) {
-                    delete pState;
-                }
-            }
-            statesMap.clear();
-        }
-    }
-    request->EnableInputChannelForChain.pEffectStatesMapArray = pEffectStatesMapArray;
-
     m_pEffectsManager->writeRequest(request);
     emit channelStatusChanged(handleGroup.name(), true);
 }
@@ -28,7 +28,9 @@ class EffectManifest final {
           m_isMasterEQ(false),
           m_effectRampsFromDry(false),
           m_bAddDryToWet(false),
-          m_metaknobDefault(0.5) {
+          m_metaknobDefault(0.5),
+          m_pooledInputChannels(-1),
+          m_maxOutputDelaySeconds(-1.0) {
     }
 
     const QString& id() const {
@@ -134,6 +136,31 @@ class EffectManifest final {
         m_bAddDryToWet = addDryToWet;
     }
 
+    // The number of input channels for which EffectStates are allocated in
+    // advance when the effect is loaded, in addition to the enabled ones.
+    // Negative if the EffectsBackend should choose it when registering the
+    // effect.
+    int pooledInputChannels() const {
+        return m_pooledInputChannels;
+    }
+    void setPooledInputChannels(int pooledInputChannels) {
+        m_pooledInputChannels = pooledInputChannels;
+    }
+
+    // The longest time by which the effect may delay its input, e.g. the
+    // maximum delay time of an echo. An effect with silent input is kept
+    // processing for at least this long after its output has become
+    // silent, so that delayed output is not cut off. Negative if the
+    // effect may produce output at any time after its input has become
+    // silent, e.g. a generator like the metronome, which prevents skipping
+    // it. This is the default, so effects need to opt in to be skipped.
+    double maxOutputDelaySeconds() const {
+        return m_maxOutputDelaySeconds;
+    }
+    void setMaxOutputDelaySeconds(double maxOutputDelaySeconds) {
+        m_maxOutputDelaySeconds = maxOutputDelaySeconds;
+    }
+
     double metaknobDefault() const {
         return m_metaknobDefault;
     }
@@ -193,4 +220,6 @@ class EffectManifest final {
     bool m_effectRampsFromDry;
     bool m_bAddDryToWet;
     double m_metaknobDefault;
+    int m_pooledInputChannels;
+    double m_maxOutputDelaySeconds;
 };
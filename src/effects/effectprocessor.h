@@ -4,10 +4,12 @@
 #include <QHash>
 #include <QDebug>
 #include <QPair>
+#include <memory>
 
 #include "util/types.h"
 #include "engine/engine.h"
 #include "effects/defs.h"
+#include "effects/effectstatepool.h"
 #include "engine/effects/groupfeaturestate.h"
 #include "engine/effects/message.h"
 #include "engine/channelhandle.h"
@@ -19,9 +21,10 @@ class EngineEffect;
 // an EffectProcessorImpl subclass. Separating state from the DSP code allows
 // memory allocation and deletion, which is slow, to be done on the main thread
 // instead of potentially blocking the audio engine callback thread and causing
-// audible glitches. EffectStates allocated on the main thread are passed as
-// pointers to the EffectProcessorImpl in the audio callback thread via the
-// effect MessagePipe FIFO (see EngineEffectsManager::onCallbackStart).
+// audible glitches. EffectStates allocated on the main thread are kept in an
+// EffectStatePool, from which the EffectProcessorImpl in the audio callback
+// thread acquires them when an input channel is enabled (see
+// EngineEffectsManager::onCallbackStart).
 
 // Each EffectState instance is responsible for one routing of input signal to
 // output signal. The base EffectProcessorImpl class handles the management
@@ -31,11 +34,13 @@ class EngineEffect;
 
 // Input signals can be any EngineChannel, but output channels are hardcoded in
 // EngineMaster as the post-fader processing for the master mix and pre-fader
-// processing for headphones. EffectStates are allocated when an input signal is
-// enabled for a chain. Also, when a new effect is loaded to a chain,
-// EffectStates are only allocated for input signals that are enabled at that
-// time. This allows for scaling up to an arbitrary number of input signals
-// without wasting a lot of memory.
+// processing for headphones. When a new effect is loaded to a chain,
+// EffectStates are allocated for the input signals that are enabled at that
+// time and for EffectManifest::pooledInputChannels() more input signals.
+// Further EffectStates are only allocated when the pool runs out of states
+// while enabling an input signal, and the states of disabled input signals
+// are reused. This allows for scaling up to an arbitrary number of input
+// signals without wasting a lot of memory.
 class EffectState {
   public:
     EffectState(const mixxx::EngineParameters& bufferParameters) {
@@ -56,13 +61,18 @@ class EffectProcessor {
     virtual void initialize(
             const QSet<ChannelHandleAndGroup>& activeInputChannels,
             EffectsManager* pEffectsManager,
-            const mixxx::EngineParameters& bufferParameters) = 0;
-    virtual EffectState* createState(const mixxx::EngineParameters& bufferParameters) = 0;
-    virtual bool loadStatesForInputChannel(const ChannelHandle* inputChannel,
-          const EffectStatesMap* pStatesMap) = 0;
+            const mixxx::EngineParameters& bufferParameters,
+            int pooledInputChannels) = 0;
+    // Called from main thread before the audio thread is requested to enable
+    // an input channel. Only allocates memory if the pool has run out of states.
+    virtual void reserveStatesForInputChannel() = 0;
+    // Called from the audio thread. Acquires the states that have been
+    // reserved before.
+    virtual bool loadStatesForInputChannel(const ChannelHandle* inputChannel) = 0;
     // Called from main thread for garbage collection after the last audio thread
-    // callback executes process() with EffectEnableState::Disabling
-    virtual void deleteStatesForInputChannel(const ChannelHandle* inputChannel) = 0;
+    // callback executes process() with EffectEnableState::Disabling. The
+    // states are returned to the pool.
+    virtual void releaseStatesForInputChannel(const ChannelHandle* inputChannel) = 0;
 
     // Take a buffer of audio samples as pInput, process the buffer according to
     // Effect-specific logic, and output it to the buffer pOutput. Both pInput
@@ -117,6 +127,7 @@ class EffectProcessorImpl : public EffectProcessor {
             inputChannelHandleNumber++;
         }
         m_channelStateMatrix.clear();
+        // The pooled states are deleted with m_pStatePool
     };
 
     // NOTE: Subclasses must implement the following static methods for
@@ -158,7 +169,8 @@ class EffectProcessorImpl : public EffectProcessor {
 
     void initialize(const QSet<ChannelHandleAndGroup>& activeInputChannels,
             EffectsManager* pEffectsManager,
-            const mixxx::EngineParameters& bufferParameters) final {
+            const mixxx::EngineParameters& bufferParameters,
+            int pooledInputChannels) final {
         for (const ChannelHandleAndGroup& inputChannel : activeInputChannels) {
             if (kEffectDebugOutput) {
                 qDebug() << this << "EffectProcessorImpl::initialize allocating "
@@ -178,14 +190,25 @@ class EffectProcessorImpl : public EffectProcessor {
         }
         m_pEffectsManager = pEffectsManager;
         DEBUG_ASSERT(m_pEffectsManager != nullptr);
+
+        // Room for the states of all input channels, so that the states
+        // of disabled input channels can always be returned to the pool
+        const int outputChannelCount = m_pEffectsManager->registeredOutputChannels().size();
+        const int poolCapacity = (m_pEffectsManager->registeredInputChannels().size() +
+                                         pooledInputChannels) *
+                outputChannelCount;
+        m_pStatePool = std::make_unique<EffectStatePool>(poolCapacity,
+                [this, bufferParameters]() -> EffectState* {
+                    return createSpecificState(bufferParameters);
+                });
+        m_pStatePool->fill(pooledInputChannels * outputChannelCount);
     };
 
-    EffectState* createState(const mixxx::EngineParameters& bufferParameters) final {
-        return createSpecificState(bufferParameters);
+    void reserveStatesForInputChannel() final {
+        m_pStatePool->reserve(m_pEffectsManager->registeredOutputChannels().size());
     };
 
-    bool loadStatesForInputChannel(const ChannelHandle* inputChannel,
-              const EffectStatesMap* pStatesMap) final {
+    bool loadStatesForInputChannel(const ChannelHandle* inputChannel) final {
           if (kEffectDebugOutput) {
               qDebug() << "EffectProcessorImpl::loadStatesForInputChannel" << this
                        << "input" << *inputChannel;
@@ -195,17 +218,12 @@ class EffectProcessorImpl : public EffectProcessor {
           // object with a ChannelHandle key, but it actually backed by a
           // QVarLengthArray, not a QMap. So it is okay that
           // m_channelStateMatrix may be accessed concurrently in the main
-          // thread in deleteStatesForInputChannel.
-
-          // Can't directly cast a ChannelHandleMap from containing the base
-          // EffectState* type to EffectSpecificState* type, so iterate through
-          // pStatesMap to build a new ChannelHandleMap with
-          // dynamic_cast'ed states.
+          // thread in releaseStatesForInputChannel.
           ChannelHandleMap<EffectSpecificState*>& effectSpecificStatesMap =
                   m_channelStateMatrix[*inputChannel];
 
-          // deleteStatesForInputChannel should have been called before a new
-          // map of EffectStates was sent to this function, or this is the first
+          // releaseStatesForInputChannel should have been called before new
+          // EffectStates are loaded by this function, or this is the first
           // time states are being loaded for this input channel, so
           // effectSpecificStatesMap should be empty and this loop should
           // not go through any iterations.
@@ -222,9 +240,10 @@ class EffectProcessorImpl : public EffectProcessor {
                            << this << "output" << outputChannel;
               }
 
-              auto pState = dynamic_cast<EffectSpecificState*>(
-                        pStatesMap->at(outputChannel.handle()));
+              // All states in the pool have been created by createSpecificState()
+              auto pState = static_cast<EffectSpecificState*>(m_pStatePool->acquire());
               VERIFY_OR_DEBUG_ASSERT(pState != nullptr) {
+                    // process() allocates the missing state
                     return false;
               }
               effectSpecificStatesMap.insert(outputChannel.handle(), pState);
@@ -233,9 +252,9 @@ class EffectProcessorImpl : public EffectProcessor {
     };
 
     // Called from main thread for garbage collection after an input channel is disabled
-    void deleteStatesForInputChannel(const ChannelHandle* inputChannel) final {
+    void releaseStatesForInputChannel(const ChannelHandle* inputChannel) final {
           if (kEffectDebugOutput) {
-              qDebug() << "EffectProcessorImpl::deleteStatesForInputChannel"
+              qDebug() << "EffectProcessorImpl::releaseStatesForInputChannel"
                        << this << *inputChannel;
           }
 
@@ -252,10 +271,10 @@ class EffectProcessorImpl : public EffectProcessor {
                       continue;
                 }
                 if (kEffectDebugOutput) {
-                      qDebug() << "EffectProcessorImpl::deleteStatesForInputChannel"
-                               << this << "deleting state" << pState;
+                      qDebug() << "EffectProcessorImpl::releaseStatesForInputChannel"
+                               << this << "releasing state" << pState;
                 }
-                delete pState;
+                m_pStatePool->release(pState);
           }
           stateMap.clear();
     };
@@ -272,4 +291,5 @@ class EffectProcessorImpl : public EffectProcessor {
 
     EffectsManager* m_pEffectsManager;
     ChannelHandleMap<ChannelHandleMap<EffectSpecificState*>> m_channelStateMatrix;
+    std::unique_ptr<EffectStatePool> m_pStatePool;
 };
@@ -5,6 +5,14 @@
 #include "effects/effectsmanager.h"
 #include "moc_effectsbackend.cpp"
 
+namespace {
+
+// Enough for enabling an effect for another deck without allocating
+// its states first
+constexpr int kDefaultPooledInputChannels = 1;
+
+} // anonymous namespace
+
 EffectsBackend::EffectsBackend(QObject* pParent,
                                EffectBackendType type)
         : QObject(pParent),
@@ -25,6 +33,15 @@ void EffectsBackend::registerEffect(const QString& id,
     }
 
     pManifest->setBackendType(m_type);
+    if (pManifest->pooledInputChannels() < 0) {
+        // The equalizers are loaded for a single deck, which is already
+        // enabled when they are loaded. Only the other effects are moved
+        // between input channels.
+        pManifest->setPooledInputChannels(
+                pManifest->isMixingEQ() || pManifest->isMasterEQ()
+                        ? 0
+                        : kDefaultPooledInputChannels);
+    }
 
     m_registeredEffects[id] = RegisteredEffect(pManifest, pInstantiator);
     m_effectIds.append(id);
@@ -12,11 +12,15 @@
 #include "engine/effects/engineeffectsmanager.h"
 #include "moc_effectsmanager.cpp"
 #include "util/assert.h"
+#include "util/stat.h"
 
 namespace {
 constexpr QChar kEffectGroupSeparator = '_';
 constexpr QChar kGroupClose = ']';
 const unsigned int kEffectMessagPipeFifoSize = 2048;
+// The requests that have been sent to the engine and not been answered yet
+const QString kActiveRequestsStatTag =
+        QStringLiteral("EffectsManager: active requests");
 } // anonymous namespace
 
 EffectsManager::EffectsManager(QObject* pParent,
@@ -433,6 +437,11 @@ bool EffectsManager::writeRequest(EffectsRequest* request) {
     // TODO(XXX) use preallocated requests to avoid delete calls from engine
     if (m_pRequestPipe->writeMessage(request)) {
         m_activeRequests[request->request_id] = request;
+        Stat::track(kActiveRequestsStatTag,
+                Stat::UNSPECIFIED,
+                Stat::experimentFlags(Stat::COUNT | Stat::AVERAGE |
+                        Stat::MIN | Stat::MAX),
+                m_activeRequests.size());
         return true;
     }
     delete request;
@@ -489,9 +498,9 @@ void EffectsManager::collectGarbage(const EffectsRequest* pRequest) {
         delete pRequest->RemoveEffectRack.pRack;
     } else if (pRequest->type == EffectsRequest::DISABLE_EFFECT_CHAIN_FOR_INPUT_CHANNEL) {
         if (kEffectDebugOutput) {
-            qDebug() << debugString() << "deleting states for input channel" << pRequest->DisableInputChannelForChain.pChannelHandle << "for EngineEffectChain" << pRequest->pTargetChain;
+            qDebug() << debugString() << "releasing states for input channel" << pRequest->DisableInputChannelForChain.pChannelHandle << "for EngineEffectChain" << pRequest->pTargetChain;
         }
-        pRequest->pTargetChain->deleteStatesForInputChannel(
+        pRequest->pTargetChain->releaseStatesForInputChannel(
                 pRequest->DisableInputChannelForChain.pChannelHandle);
     }
 }
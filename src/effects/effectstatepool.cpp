@@ -0,0 +1,91 @@
+#include "effects/effectstatepool.h"
+
+#include <algorithm>
+
+#include "effects/effectprocessor.h"
+#include "util/assert.h"
+#include "util/stat.h"
+
+namespace {
+
+const QString kAllocatedStatesStatTag =
+        QStringLiteral("EffectStatePool: allocated states");
+
+} // anonymous namespace
+
+EffectStatePool::EffectStatePool(int capacity, CreateStateFunction createState)
+        : m_createState(std::move(createState)),
+          m_states(capacity),
+          m_unreservedStates(0) {
+}
+
+EffectStatePool::~EffectStatePool() {
+    EffectState* pState;
+    while (m_states.read(&pState, 1) == 1) {
+        delete pState;
+    }
+}
+
+void EffectStatePool::fill(int count) {
+    int allocatedStates = 0;
+    while (m_unreservedStates < count) {
+        if (!push(m_createState())) {
+            break;
+        }
+        ++m_unreservedStates;
+        ++allocatedStates;
+    }
+    if (allocatedStates > 0) {
+        Stat::track(kAllocatedStatesStatTag,
+                Stat::COUNTER,
+                Stat::experimentFlags(Stat::COUNT | Stat::SUM | Stat::MAX),
+                allocatedStates);
+    }
+}
+
+void EffectStatePool::reserve(int count) {
+    fill(count);
+    // If the pool is full the engine is not able to acquire all states
+    // and falls back to allocating the missing ones.
+    m_unreservedStates = std::max(m_unreservedStates - count, 0);
+}
+
+EffectState* EffectStatePool::acquire() {
+    EffectState* pState;
+    if (m_states.read(&pState, 1) != 1) {
+        return nullptr;
+    }
+    return pState;
+}
+
+void EffectStatePool::release(EffectState* pState) {
+    VERIFY_OR_DEBUG_ASSERT(pState) {
+        return;
+    }
+    // The state still contains the delay lines and filter histories of its
+    // previous input channel. Not all effects clear them when being enabled
+    // and states of output channels that have not been processed never got
+    // a Disabling pass. A new state is created instead of reusing it, so
+    // that acquire() always returns a clean state.
+    delete pState;
+    if (m_states.writeAvailable() < 1) {
+        return;
+    }
+    if (push(m_createState())) {
+        ++m_unreservedStates;
+        Stat::track(kAllocatedStatesStatTag,
+                Stat::COUNTER,
+                Stat::experimentFlags(Stat::COUNT | Stat::SUM | Stat::MAX),
+                1);
+    }
+}
+
+bool EffectStatePool::push(EffectState* pState) {
+    if (m_states.write(&pState, 1) != 1) {
+        // The pool is full, which is only the case if more input channels
+        // have been registered than expected.
+        delete pState;
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,61 @@
+#pragma once
+
+#include <functional>
+
+#include "util/class.h"
+#include "util/fifo.h"
+
+class EffectState;
+
+/// Keeps EffectStates of an EffectProcessor ready for the audio engine.
+///
+/// The states are allocated and deleted in the main thread. The engine
+/// acquires them when an input channel is enabled for the effect, without
+/// allocating memory and without waiting for the main thread. When the
+/// input channel is disabled again, the main thread returns the states to
+/// the pool, which replaces them with new states for the next input
+/// channel. Reusing the released states would carry over the delay lines
+/// and filter histories of the previous input channel.
+///
+/// The main thread must reserve() the states before it requests the engine
+/// to acquire them, so that acquire() never runs out of states.
+class EffectStatePool {
+  public:
+    typedef std::function<EffectState*()> CreateStateFunction;
+
+    EffectStatePool(int capacity, CreateStateFunction createState);
+    ~EffectStatePool();
+
+    /// Allocates states until count states are available in addition to
+    /// those that have been reserved. Only called from the main thread.
+    void fill(int count);
+
+    /// Makes sure that the engine can acquire count more states.
+    /// Only called from the main thread.
+    void reserve(int count);
+
+    /// Returns a reserved state in O(1) or nullptr if none is available.
+    /// Only called from the audio engine thread.
+    EffectState* acquire();
+
+    /// Takes back a state that is no longer processed by the engine and
+    /// replaces it with a new one. Only called from the main thread.
+    void release(EffectState* pState);
+
+    /// The number of states in the pool, including the reserved ones
+    int size() const {
+        return m_states.readAvailable();
+    }
+
+  private:
+    bool push(EffectState* pState);
+
+    const CreateStateFunction m_createState;
+    // Single producer (main thread), single consumer (engine thread)
+    FIFO<EffectState*> m_states;
+    // The number of states in the pool that have not been reserved. Only
+    // accessed by the main thread.
+    int m_unreservedStates;
+
+    DISALLOW_COPY_AND_ASSIGN(EffectStatePool);
+};
@@ -61,7 +61,8 @@ LV2EffectProcessor::~LV2EffectProcessor() {
 void LV2EffectProcessor::initialize(
         const QSet<ChannelHandleAndGroup>& activeInputChannels,
         EffectsManager* pEffectsManager,
-        const mixxx::EngineParameters& bufferParameters) {
+        const mixxx::EngineParameters& bufferParameters,
+        int pooledInputChannels) {
     Q_UNUSED(pEffectsManager);
     Q_UNUSED(bufferParameters);
 
@@ -87,6 +88,16 @@ void LV2EffectProcessor::initialize(
     }
     m_pEffectsManager = pEffectsManager;
     DEBUG_ASSERT(m_pEffectsManager != nullptr);
+
+    const int outputChannelCount = m_pEffectsManager->registeredOutputChannels().size();
+    const int poolCapacity = (m_pEffectsManager->registeredInputChannels().size() +
+                                     pooledInputChannels) *
+            outputChannelCount;
+    m_pStatePool = std::make_unique<EffectStatePool>(poolCapacity,
+            [this, bufferParameters]() -> EffectState* {
+                return createGroupState(bufferParameters);
+            });
+    m_pStatePool->fill(pooledInputChannels * outputChannelCount);
 }
 
 void LV2EffectProcessor::process(const ChannelHandle& inputHandle,
@@ -161,12 +172,11 @@ LV2EffectGroupState* LV2EffectProcessor::createGroupState(const mixxx::EnginePar
     return pState;
 };
 
-EffectState* LV2EffectProcessor::createState(const mixxx::EngineParameters& bufferParameters) {
-    return createGroupState(bufferParameters);
-};
+void LV2EffectProcessor::reserveStatesForInputChannel() {
+    m_pStatePool->reserve(m_pEffectsManager->registeredOutputChannels().size());
+}
 
-bool LV2EffectProcessor::loadStatesForInputChannel(const ChannelHandle* inputChannel,
-      const EffectStatesMap* pStatesMap) {
+bool LV2EffectProcessor::loadStatesForInputChannel(const ChannelHandle* inputChannel) {
     if (kEffectDebugOutput) {
         qDebug() << "LV2EffectProcessor::loadStatesForInputChannel" << this
                  << "input" << *inputChannel;
@@ -176,17 +186,12 @@ bool LV2EffectProcessor::loadStatesForInputChannel(const ChannelHandle* inputCha
     // object with a ChannelHandle key, but it actually backed by a
     // QVarLengthArray, not a QMap. So it is okay that
     // m_channelStateMatrix may be accessed concurrently in the main
-    // thread in deleteStatesForInputChannel.
-
-    // Can't directly cast a ChannelHandleMap from containing the base
-    // EffectState* type to EffectSpecificState* type, so iterate through
-    // pStatesMap to build a new ChannelHandleMap with
-    // dynamic_cast'ed states.
+    // thread in releaseStatesForInputChannel.
     ChannelHandleMap<LV2EffectGroupState*>& effectSpecificStatesMap =
             m_channelStateMatrix[*inputChannel];
 
-    // deleteStatesForInputChannel should have been called before a new
-    // map of EffectStates was sent to this function, or this is the first
+    // releaseStatesForInputChannel should have been called before new
+    // EffectStates are loaded by this function, or this is the first
     // time states are being loaded for this input channel, so
     // effectSpecificStatesMap should be empty and this loop should
     // not go through any iterations.
@@ -204,9 +209,10 @@ bool LV2EffectProcessor::loadStatesForInputChannel(const ChannelHandle* inputCha
                      << this << "output" << outputChannel;
         }
 
-        auto* pState = dynamic_cast<LV2EffectGroupState*>(
-                pStatesMap->at(outputChannel.handle()));
+        // All states in the pool have been created by createGroupState()
+        auto* pState = static_cast<LV2EffectGroupState*>(m_pStatePool->acquire());
         VERIFY_OR_DEBUG_ASSERT(pState != nullptr) {
+              // process() allocates the missing state
               return false;
         }
         effectSpecificStatesMap.insert(outputChannel.handle(), pState);
@@ -216,9 +222,9 @@ bool LV2EffectProcessor::loadStatesForInputChannel(const ChannelHandle* inputCha
 
 // Called from main thread for garbage collection after the last audio thread
 // callback executes process() with EffectEnableState::Disabling
-void LV2EffectProcessor::deleteStatesForInputChannel(const ChannelHandle* inputChannel) {
+void LV2EffectProcessor::releaseStatesForInputChannel(const ChannelHandle* inputChannel) {
     if (kEffectDebugOutput) {
-        qDebug() << "LV2EffectProcessor::deleteStatesForInputChannel"
+        qDebug() << "LV2EffectProcessor::releaseStatesForInputChannel"
                  << this << *inputChannel;
     }
 
@@ -235,11 +241,13 @@ void LV2EffectProcessor::deleteStatesForInputChannel(const ChannelHandle* inputC
                 continue;
           }
           if (kEffectDebugOutput) {
-                qDebug() << "LV2EffectProcessor::deleteStatesForInputChannel"
-                         << this << "deleting state" << pState;
+                qDebug() << "LV2EffectProcessor::releaseStatesForInputChannel"
+                         << this << "releasing state" << pState;
           }
-          delete pState;
-          qDebug() << "inputChannel" << inputChannel;
+          // Unlike built-in effects, plugins do not reset their state
+          // when being disabled
+          pState->reset();
+          m_pStatePool->release(pState);
     }
     stateMap.clear();
 }
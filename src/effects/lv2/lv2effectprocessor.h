@@ -21,6 +21,15 @@ class LV2EffectGroupState : public EffectState {
     LilvInstance* lilvIinstance() {
         return m_pInstance;
     }
+
+    // Clears the internal state of the plugin before the instance is reused
+    // for another input channel. Must not be called in the audio thread.
+    void reset() {
+        if (m_pInstance) {
+            lilv_instance_deactivate(m_pInstance);
+            lilv_instance_activate(m_pInstance);
+        }
+    }
   private:
     LilvInstance* m_pInstance;
 };
@@ -37,13 +46,13 @@ class LV2EffectProcessor : public EffectProcessor {
     void initialize(
             const QSet<ChannelHandleAndGroup>& activeInputChannels,
             EffectsManager* pEffectsManager,
-            const mixxx::EngineParameters& bufferParameters) override;
-    EffectState* createState(const mixxx::EngineParameters& bufferParameters) final;
-    bool loadStatesForInputChannel(const ChannelHandle* inputChannel,
-          const EffectStatesMap* pStatesMap) override;
+            const mixxx::EngineParameters& bufferParameters,
+            int pooledInputChannels) override;
+    void reserveStatesForInputChannel() override;
+    bool loadStatesForInputChannel(const ChannelHandle* inputChannel) override;
     // Called from main thread for garbage collection after the last audio thread
     // callback executes process() with EffectEnableState::Disabling
-    void deleteStatesForInputChannel(const ChannelHandle* inputChannel) override;
+    void releaseStatesForInputChannel(const ChannelHandle* inputChannel) override;
 
     void process(const ChannelHandle& inputHandle,
             const ChannelHandle& outputHandle,
@@ -66,4 +75,5 @@ class LV2EffectProcessor : public EffectProcessor {
 
     EffectsManager* m_pEffectsManager;
     ChannelHandleMap<ChannelHandleMap<LV2EffectGroupState*>> m_channelStateMatrix;
+    std::unique_ptr<EffectStatePool> m_pStatePool;
 };
@@ -0,0 +1,451 @@
+#include "engine/bufferscalers/enginebufferscalerubberbandthreaded.h"
+
+#include <rubberband/RubberBandStretcher.h>
+
+#include <QThread>
+#include <QtDebug>
+
+#include "engine/readaheadmanager.h"
+#include "moc_enginebufferscalerubberbandthreaded.cpp"
+#include "util/assert.h"
+#include "util/counter.h"
+#include "util/math.h"
+#include "util/sample.h"
+
+using RubberBand::RubberBandStretcher;
+
+namespace {
+
+// The number of buffers the input is read ahead of the play position, in
+// addition to the latency of RubberBand. Each one gives the worker more
+// time to catch up after it has been interrupted.
+constexpr SINT kLookAheadBuffers = 2;
+
+// The maximum input that is in flight, enough for the largest audio
+// buffers at double speed
+constexpr SINT kMaxFramesInFlight = 16384;
+
+constexpr int kInputBlockCount = 128;
+// Slow tempos produce more output than input
+constexpr int kOutputBlockCount = 256;
+
+constexpr SINT kHistoryFrames = 2 * kMaxFramesInFlight;
+
+constexpr SINT kChannelCount = mixxx::kEngineChannelCount;
+
+// The worker thread is stopped after keylock has not been used for this long
+constexpr int kIdleTimeoutMillis = 10000;
+
+// Constructed once, so that counting in the audio callback does not
+// allocate a new tag each time
+const Counter kUnderflowCounter(QStringLiteral(
+        "EngineBufferScaleRubberBandThreaded::scaleBuffer underflow"));
+
+}  // namespace
+
+class EngineBufferScaleRubberBandThreaded::WorkerThread : public QThread {
+  public:
+    explicit WorkerThread(EngineBufferScaleRubberBandThreaded* pScaler)
+            : m_pScaler(pScaler) {
+    }
+
+  protected:
+    void run() override {
+        m_pScaler->runWorker();
+    }
+
+  private:
+    EngineBufferScaleRubberBandThreaded* const m_pScaler;
+};
+
+EngineBufferScaleRubberBandThreaded::EngineBufferScaleRubberBandThreaded(
+        ReadAheadManager* pReadAheadManager)
+        : m_pReadAheadManager(pReadAheadManager),
+          m_bWorkerRunning(false),
+          m_bWorkerRequested(false),
+          m_bUsed(false),
+          m_bWorkPending(false),
+          m_bQuit(false),
+          m_latencyFrames(0),
+          m_generation(0),
+          m_bBackwards(false),
+          m_historyWritePosition(0),
+          m_historyReadPosition(0.0),
+          m_outputFramesToSkip(0),
+          m_pOutputBlock(nullptr),
+          m_outputBlockOffset(0),
+          m_workerGeneration(-1),
+          m_workerTimeRatio(0.0),
+          m_workerPitchScale(0.0) {
+    // The audio callback requests the worker, which is started from the
+    // main thread
+    connect(this,
+            &EngineBufferScaleRubberBandThreaded::workerRequested,
+            this,
+            &EngineBufferScaleRubberBandThreaded::startWorker,
+            Qt::QueuedConnection);
+    m_idleTimer.setInterval(kIdleTimeoutMillis);
+    connect(&m_idleTimer,
+            &QTimer::timeout,
+            this,
+            &EngineBufferScaleRubberBandThreaded::slotStopIdleWorker);
+}
+
+EngineBufferScaleRubberBandThreaded::~EngineBufferScaleRubberBandThreaded() {
+    stopWorker();
+}
+
+void EngineBufferScaleRubberBandThreaded::startWorker() {
+    m_bWorkerRequested.store(false);
+    if (m_pWorkerThread) {
+        return;
+    }
+    if (!m_pInputBlocks) {
+        m_pInputBlocks = std::make_unique<FIFO<Block>>(kInputBlockCount);
+        m_pOutputBlocks = std::make_unique<FIFO<Block>>(kOutputBlockCount);
+        m_history = mixxx::SampleBuffer(kHistoryFrames * kChannelCount);
+        m_deinterleaved[0] = mixxx::SampleBuffer(kBlockFrames);
+        m_deinterleaved[1] = mixxx::SampleBuffer(kBlockFrames);
+    }
+    m_bQuit.store(false);
+    m_pWorkerThread = std::make_unique<WorkerThread>(this);
+    m_pWorkerThread->setObjectName(QStringLiteral("RubberBand worker"));
+    // Below the priority of the audio callback, which must never wait for
+    // the worker
+    m_pWorkerThread->start(QThread::HighestPriority);
+    // Process the input that has been queued while the worker was stopped
+    m_semaWork.release();
+
+    m_bUsed.store(true);
+    m_bWorkerRunning.store(true);
+    m_idleTimer.start();
+}
+
+void EngineBufferScaleRubberBandThreaded::stopWorker() {
+    if (!m_pWorkerThread) {
+        return;
+    }
+    m_idleTimer.stop();
+    m_bWorkerRunning.store(false);
+    m_bQuit.store(true);
+    m_semaWork.release();
+    m_pWorkerThread->wait();
+    m_pWorkerThread.reset();
+}
+
+void EngineBufferScaleRubberBandThreaded::requestWorker() {
+    if (!m_bWorkerRequested.exchange(true)) {
+        emit workerRequested();
+    }
+}
+
+void EngineBufferScaleRubberBandThreaded::slotStopIdleWorker() {
+    if (!m_bUsed.exchange(false)) {
+        stopWorker();
+    }
+}
+
+void EngineBufferScaleRubberBandThreaded::setScaleParameters(double base_rate,
+                                                             double* pTempoRatio,
+                                                             double* pPitchRatio) {
+    // Negative speed means we are going backwards. pitch does not affect
+    // the playback direction.
+    m_bBackwards = *pTempoRatio < 0;
+
+    // See EngineBufferScaleRubberBand::setScaleParameters()
+    const double kMinSeekSpeed = 1.0 / 128.0;
+    double speed_abs = fabs(*pTempoRatio);
+    if (speed_abs < kMinSeekSpeed) {
+        // Let the caller know we ignored their speed.
+        speed_abs = *pTempoRatio = 0;
+    }
+
+    // The RubberBandStretcher is only accessed by the worker, which picks
+    // up the new parameters with the next input block.
+    m_dBaseRate = base_rate;
+    m_dTempoRatio = speed_abs;
+    m_dPitchRatio = *pPitchRatio;
+}
+
+void EngineBufferScaleRubberBandThreaded::onSampleRateChanged() {
+    // The worker creates a new RubberBandStretcher when it receives the
+    // first input block with the new sample rate
+    clear();
+}
+
+void EngineBufferScaleRubberBandThreaded::clear() {
+    // All blocks that are in flight are discarded
+    ++m_generation;
+    if (m_pOutputBlock) {
+        m_pOutputBlocks->releaseReadRegions(1);
+        m_pOutputBlock = nullptr;
+    }
+    m_historyWritePosition = 0;
+    m_historyReadPosition = 0.0;
+    // RubberBand delays its output by its latency after being reset
+    m_outputFramesToSkip = m_latencyFrames.load(std::memory_order_relaxed);
+}
+
+double EngineBufferScaleRubberBandThreaded::scaleBuffer(
+        CSAMPLE* pOutputBuffer,
+        SINT iOutputBufferSize) {
+    if (m_dBaseRate == 0.0 || m_dTempoRatio == 0.0) {
+        SampleUtil::clear(pOutputBuffer, iOutputBufferSize);
+        // No actual samples/frames have been read from the
+        // unscaled input buffer!
+        return 0.0;
+    }
+    VERIFY_OR_DEBUG_ASSERT(m_pInputBlocks) {
+        SampleUtil::clear(pOutputBuffer, iOutputBufferSize);
+        return 0.0;
+    }
+    m_bUsed.store(true, std::memory_order_relaxed);
+    if (!isWorkerRunning()) {
+        // The worker has been stopped while keylock was idle. The output is
+        // interpolated until it is running again.
+        requestWorker();
+    }
+
+    const SINT frames = getOutputSignal().samples2frames(iOutputBufferSize);
+    const double inputFramesPerOutputFrame = m_dBaseRate * m_dTempoRatio;
+
+    // The input for this buffer is already needed if the output of the
+    // worker is not ready yet
+    const SINT latencyFrames = m_latencyFrames.load(std::memory_order_relaxed);
+    readAhead(static_cast<SINT>(ceil(inputFramesPerOutputFrame *
+            (frames * (1 + kLookAheadBuffers) + latencyFrames))));
+    wakeWorker();
+
+    const SINT receivedFrames = readOutput(pOutputBuffer, frames);
+    m_historyReadPosition += inputFramesPerOutputFrame * receivedFrames;
+
+    if (receivedFrames < frames) {
+        const SINT missingFrames = frames - receivedFrames;
+        interpolateInput(
+                pOutputBuffer + getOutputSignal().frames2samples(receivedFrames),
+                missingFrames,
+                inputFramesPerOutputFrame);
+        m_outputFramesToSkip += missingFrames;
+        kUnderflowCounter.increment();
+    }
+
+    // Like in EngineBufferScaleRubberBand, the frames read are derived from
+    // the output, which excludes the input that is still in flight.
+    return inputFramesPerOutputFrame * frames;
+}
+
+void EngineBufferScaleRubberBandThreaded::readAhead(SINT targetFramesInFlight) {
+    const double rate = (m_bBackwards ? -1.0 : 1.0) * m_dBaseRate * m_dTempoRatio;
+    const SINT target = math_min(targetFramesInFlight, kMaxFramesInFlight);
+    SINT framesInFlight = m_historyWritePosition -
+            static_cast<SINT>(m_historyReadPosition);
+    while (framesInFlight < target) {
+        Block* pBlock1;
+        ring_buffer_size_t size1;
+        Block* pBlock2;
+        ring_buffer_size_t size2;
+        if (m_pInputBlocks->aquireWriteRegions(1, &pBlock1, &size1, &pBlock2, &size2) < 1) {
+            return;
+        }
+        const SINT samplesRead = m_pReadAheadManager->getNextSamples(
+                // The value doesn't matter here. All that matters is we
+                // are going forward or backward.
+                rate,
+                pBlock1->samples,
+                getOutputSignal().frames2samples(
+                        math_min(kBlockFrames, target - framesInFlight)));
+        const SINT framesRead = getOutputSignal().samples2frames(samplesRead);
+        if (framesRead <= 0) {
+            return;
+        }
+        pBlock1->generation = m_generation;
+        pBlock1->frames = framesRead;
+        pBlock1->sampleRate = getOutputSignal().getSampleRate();
+        pBlock1->timeRatio = 1.0 / (m_dBaseRate * m_dTempoRatio);
+        pBlock1->pitchScale = fabs(m_dBaseRate * m_dPitchRatio);
+        for (SINT i = 0; i < framesRead; ++i) {
+            const SINT historyFrame = (m_historyWritePosition + i) % kHistoryFrames;
+            for (SINT channel = 0; channel < kChannelCount; ++channel) {
+                m_history.data()[historyFrame * kChannelCount + channel] =
+                        pBlock1->samples[i * kChannelCount + channel];
+            }
+        }
+        m_pInputBlocks->releaseWriteRegions(1);
+        m_historyWritePosition += framesRead;
+        framesInFlight += framesRead;
+    }
+}
+
+SINT EngineBufferScaleRubberBandThreaded::readOutput(CSAMPLE* pOutput, SINT frames) {
+    SINT receivedFrames = 0;
+    while (receivedFrames < frames) {
+        if (!m_pOutputBlock) {
+            Block* pBlock1;
+            ring_buffer_size_t size1;
+            Block* pBlock2;
+            ring_buffer_size_t size2;
+            if (m_pOutputBlocks->aquireReadRegions(
+                        1, &pBlock1, &size1, &pBlock2, &size2) < 1) {
+                break;
+            }
+            if (pBlock1->generation != m_generation) {
+                m_pOutputBlocks->releaseReadRegions(1);
+                continue;
+            }
+            m_pOutputBlock = pBlock1;
+            m_outputBlockOffset = 0;
+        }
+
+        const SINT skipFrames = math_min(m_outputFramesToSkip,
+                m_pOutputBlock->frames - m_outputBlockOffset);
+        m_outputBlockOffset += skipFrames;
+        m_outputFramesToSkip -= skipFrames;
+
+        const SINT copyFrames = math_min(frames - receivedFrames,
+                m_pOutputBlock->frames - m_outputBlockOffset);
+        SampleUtil::copy(pOutput + receivedFrames * kChannelCount,
+                m_pOutputBlock->samples + m_outputBlockOffset * kChannelCount,
+                copyFrames * kChannelCount);
+        m_outputBlockOffset += copyFrames;
+        receivedFrames += copyFrames;
+
+        if (m_outputBlockOffset >= m_pOutputBlock->frames) {
+            m_pOutputBlocks->releaseReadRegions(1);
+            m_pOutputBlock = nullptr;
+        }
+    }
+    return receivedFrames;
+}
+
+void EngineBufferScaleRubberBandThreaded::interpolateInput(
+        CSAMPLE* pOutput, SINT frames, double inputFramesPerOutputFrame) {
+    const CSAMPLE* pHistory = m_history.data();
+    for (SINT i = 0; i < frames; ++i) {
+        const SINT frame = static_cast<SINT>(floor(m_historyReadPosition));
+        const CSAMPLE fraction = static_cast<CSAMPLE>(m_historyReadPosition - frame);
+        for (SINT channel = 0; channel < kChannelCount; ++channel) {
+            // Frames that could not be read, e.g. at the end of the track,
+            // are silent
+            CSAMPLE sample1 = 0;
+            CSAMPLE sample2 = 0;
+            if (frame >= 0 && frame < m_historyWritePosition) {
+                sample1 = pHistory[(frame % kHistoryFrames) * kChannelCount + channel];
+            }
+            if (frame + 1 >= 0 && frame + 1 < m_historyWritePosition) {
+                sample2 = pHistory[((frame + 1) % kHistoryFrames) * kChannelCount + channel];
+            }
+            pOutput[i * kChannelCount + channel] = sample1 + fraction * (sample2 - sample1);
+        }
+        m_historyReadPosition += inputFramesPerOutputFrame;
+    }
+}
+
+void EngineBufferScaleRubberBandThreaded::wakeWorker() {
+    if (!m_bWorkPending.exchange(true)) {
+        m_semaWork.release();
+    }
+}
+
+void EngineBufferScaleRubberBandThreaded::runWorker() {
+    while (true) {
+        m_semaWork.acquire();
+        if (m_bQuit.load()) {
+            // The RubberBandStretcher is kept, so a restarted worker
+            // continues where this one has stopped
+            return;
+        }
+        // Input that is written after this point is processed after the
+        // next wake up
+        m_bWorkPending.store(false);
+
+        // The output is retrieved first, so that RubberBand never needs to
+        // buffer more than one block
+        while (retrieveOutput() && m_pInputBlocks->readAvailable() > 0) {
+            Block* pBlock1;
+            ring_buffer_size_t size1;
+            Block* pBlock2;
+            ring_buffer_size_t size2;
+            m_pInputBlocks->aquireReadRegions(1, &pBlock1, &size1, &pBlock2, &size2);
+            processInputBlock(*pBlock1);
+            m_pInputBlocks->releaseReadRegions(1);
+        }
+    }
+}
+
+void EngineBufferScaleRubberBandThreaded::processInputBlock(const Block& block) {
+    if (!m_pRubberBand || block.sampleRate != m_workerSampleRate) {
+        // Allocating is fine here, because the audio callback never waits
+        // for the worker
+        m_pRubberBand = std::make_unique<RubberBandStretcher>(
+                block.sampleRate,
+                kChannelCount,
+                RubberBandStretcher::OptionProcessRealTime);
+        m_pRubberBand->setMaxProcessSize(kBlockFrames);
+        m_workerSampleRate = block.sampleRate;
+        m_workerGeneration = block.generation;
+        m_workerTimeRatio = 1.0;
+        m_workerPitchScale = 1.0;
+    } else if (block.generation != m_workerGeneration) {
+        m_pRubberBand->reset();
+        m_workerGeneration = block.generation;
+    }
+
+    // RubberBand handles checking for whether the changes are no-ops
+    if (block.pitchScale > 0 && block.pitchScale != m_workerPitchScale) {
+        m_pRubberBand->setPitchScale(block.pitchScale);
+        m_workerPitchScale = block.pitchScale;
+    }
+    if (block.timeRatio > 0 && block.timeRatio != m_workerTimeRatio) {
+        m_pRubberBand->setTimeRatio(block.timeRatio);
+        m_workerTimeRatio = block.timeRatio;
+        // See EngineBufferScaleRubberBand::setScaleParameters(). The
+        // adjusted tempo can not be reported back to the engine, but it
+        // only differs in the third decimal.
+        double timeRatioInverse = 1.0 / block.timeRatio;
+        while (m_pRubberBand->getInputIncrement() == 0) {
+            timeRatioInverse += 0.001;
+            m_pRubberBand->setTimeRatio(1.0 / timeRatioInverse);
+        }
+    }
+    m_latencyFrames.store(static_cast<SINT>(m_pRubberBand->getLatency()),
+            std::memory_order_relaxed);
+
+    SampleUtil::deinterleaveBuffer(m_deinterleaved[0].data(),
+            m_deinterleaved[1].data(),
+            block.samples,
+            block.frames);
+    const float* const input[] = {
+            m_deinterleaved[0].data(),
+            m_deinterleaved[1].data()};
+    m_pRubberBand->process(input, block.frames, false);
+}
+
+bool EngineBufferScaleRubberBandThreaded::retrieveOutput() {
+    if (!m_pRubberBand) {
+        return true;
+    }
+    while (m_pRubberBand->available() > 0) {
+        Block* pBlock1;
+        ring_buffer_size_t size1;
+        Block* pBlock2;
+        ring_buffer_size_t size2;
+        if (m_pOutputBlocks->aquireWriteRegions(1, &pBlock1, &size1, &pBlock2, &size2) < 1) {
+            return false;
+        }
+        float* const output[] = {
+                m_deinterleaved[0].data(),
+                m_deinterleaved[1].data()};
+        const SINT framesToRetrieve = math_min(
+                static_cast<SINT>(m_pRubberBand->available()), kBlockFrames);
+        const SINT framesRetrieved = static_cast<SINT>(
+                m_pRubberBand->retrieve(output, framesToRetrieve));
+        SampleUtil::interleaveBuffer(pBlock1->samples,
+                m_deinterleaved[0].data(),
+                m_deinterleaved[1].data(),
+                framesRetrieved);
+        pBlock1->generation = m_workerGeneration;
+        pBlock1->frames = framesRetrieved;
+        m_pOutputBlocks->releaseWriteRegions(1);
+    }
+    return true;
+}
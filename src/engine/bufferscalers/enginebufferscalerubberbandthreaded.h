@@ -0,0 +1,152 @@
+#pragma once
+
+#include <QSemaphore>
+#include <QTimer>
+#include <atomic>
+
+#include "engine/bufferscalers/enginebufferscale.h"
+#include "engine/engine.h"
+#include "util/fifo.h"
+#include "util/memory.h"
+#include "util/samplebuffer.h"
+#include "util/types.h"
+
+namespace RubberBand {
+class RubberBandStretcher;
+}  // namespace RubberBand
+
+class ReadAheadManager;
+
+// Uses librubberband to scale audio on a dedicated worker thread.
+//
+// The audio callback reads the input from the ReadAheadManager a few buffers
+// ahead of the play position and passes it to the worker through a lock-free
+// FIFO. The worker stretches it in the background and returns the result
+// through a second FIFO, so the callback only needs to copy the audio that
+// is ready. If the worker has not caught up, e.g. after a seek, the missing
+// frames are interpolated linearly from the read-ahead input like
+// EngineBufferScaleLinear does, i.e. without keylock, and the corresponding
+// output of the worker is skipped later.
+//
+// The frames that are reported as read by scaleBuffer() only cover the
+// audible output. The read-ahead input that is still in flight is not
+// included, so the play position matches what is heard.
+//
+// The worker thread only runs while the deck uses keylock. The audio callback
+// requests it with requestWorker() and it is stopped again after keylock has
+// not been used for a while.
+class EngineBufferScaleRubberBandThreaded : public EngineBufferScale {
+    Q_OBJECT
+  public:
+    explicit EngineBufferScaleRubberBandThreaded(
+            ReadAheadManager* pReadAheadManager);
+    ~EngineBufferScaleRubberBandThreaded() override;
+
+    // Starts the worker thread and allocates the buffers when it is started
+    // for the first time. Must be invoked from the main thread.
+    void startWorker();
+    // Stops the worker thread. The buffers are kept, so the audio callback
+    // may still use the scaler. Must be invoked from the main thread.
+    void stopWorker();
+
+    // Called from the audio callback. The scaler must only be selected
+    // while the worker is running, but it remains usable after the worker
+    // has been stopped.
+    bool isWorkerRunning() const {
+        return m_bWorkerRunning.load();
+    }
+    // Called from the audio callback. Starts the worker thread from the main
+    // thread.
+    void requestWorker();
+
+    void setScaleParameters(double base_rate,
+                            double* pTempoRatio,
+                            double* pPitchRatio) override;
+
+    double scaleBuffer(
+            CSAMPLE* pOutputBuffer,
+            SINT iOutputBufferSize) override;
+
+    // Flush buffer.
+    void clear() override;
+
+  signals:
+    void workerRequested();
+
+  private slots:
+    void slotStopIdleWorker();
+
+  private:
+    // The number of frames that are passed to RubberBand at once
+    static constexpr SINT kBlockFrames = 256;
+
+    // A block of interleaved stereo samples that is passed between the
+    // audio callback and the worker
+    struct Block {
+        // Blocks of a previous generation have been discarded by clear()
+        int generation;
+        SINT frames;
+        // The parameters for processing an input block
+        mixxx::audio::SampleRate sampleRate;
+        double timeRatio;
+        double pitchScale;
+        CSAMPLE samples[kBlockFrames * mixxx::kEngineChannelCount];
+    };
+
+    class WorkerThread;
+
+    void onSampleRateChanged() override;
+
+    // Called from the audio callback
+    void readAhead(SINT targetFramesInFlight);
+    SINT readOutput(CSAMPLE* pOutput, SINT frames);
+    void interpolateInput(CSAMPLE* pOutput, SINT frames, double inputFramesPerOutputFrame);
+    void wakeWorker();
+
+    // Called from the worker thread
+    void runWorker();
+    void processInputBlock(const Block& block);
+    // Returns false if the output FIFO is full
+    bool retrieveOutput();
+
+    // The read-ahead manager that we use to fetch samples
+    ReadAheadManager* m_pReadAheadManager;
+
+    std::unique_ptr<FIFO<Block>> m_pInputBlocks;
+    std::unique_ptr<FIFO<Block>> m_pOutputBlocks;
+    std::unique_ptr<WorkerThread> m_pWorkerThread;
+    std::atomic<bool> m_bWorkerRunning;
+    std::atomic<bool> m_bWorkerRequested;
+    // Set by the audio callback whenever it uses the scaler and reset each
+    // time m_idleTimer checks whether the worker is idle
+    std::atomic<bool> m_bUsed;
+    QTimer m_idleTimer;
+    QSemaphore m_semaWork;
+    std::atomic<bool> m_bWorkPending;
+    std::atomic<bool> m_bQuit;
+    // The latency of the worker's RubberBandStretcher in output frames
+    std::atomic<SINT> m_latencyFrames;
+
+    // State of the audio callback
+    int m_generation;
+    bool m_bBackwards;
+    // A copy of the read-ahead input that is still in flight. The positions
+    // are counted in input frames since the last clear().
+    mixxx::SampleBuffer m_history;
+    SINT m_historyWritePosition;
+    double m_historyReadPosition;
+    // The output of the worker for frames that have already been
+    // interpolated from the history
+    SINT m_outputFramesToSkip;
+    // The partially consumed output block
+    Block* m_pOutputBlock;
+    SINT m_outputBlockOffset;
+
+    // State of the worker
+    std::unique_ptr<RubberBand::RubberBandStretcher> m_pRubberBand;
+    int m_workerGeneration;
+    mixxx::audio::SampleRate m_workerSampleRate;
+    double m_workerTimeRatio;
+    double m_workerPitchScale;
+    mixxx::SampleBuffer m_deinterleaved[2];
+};
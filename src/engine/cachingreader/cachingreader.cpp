@@ -1,5 +1,6 @@
 #include "engine/cachingreader/cachingreader.h"
 
+#include <QDir>
 #include <QFileInfo>
 #include <QtDebug>
 
@@ -22,61 +23,107 @@ mixxx::Logger kLogger("CachingReader");
 // TODO() Do we suffer cache misses if we use an audio buffer of above 23 ms?
 const SINT kDefaultHintFrames = 1024;
 
-// With CachingReaderChunk::kFrames = 8192 each chunk consumes
-// 8192 frames * 2 channels/frame * 4-bytes per sample = 65 kB.
-//
-//     80 chunks ->  5120 KB =  5 MB
-//
-// Each deck (including sample decks) will use their own CachingReader.
-// Consequently the total memory required for all allocated chunks depends
-// on the number of decks. The amount of memory reserved for a single
-// CachingReader must be multiplied by the number of decks to calculate
-// the total amount!
+// The chunks are shared by all readers, see CachingReaderChunkArena.
+// The number of chunks that each reader may hold is adjusted dynamically
+// between kMinChunkQuota and kMaxChunkQuota. With CachingReaderChunk::kFrames
+// = 8192 each chunk consumes 64 KiB, i.e. the quota varies between 5 MiB
+// and 20 MiB per reader. The minimum quota is reserved in the arena while
+// a track is loaded, which matches the number of chunks that each reader
+// used to allocate up front.
 //
 // NOTE(uklotzde, 2019-09-05): Reduce this number to just few chunks
-// (kNumberOfCachedChunksInMemory = 1, 2, 3, ...) for testing purposes
+// (kMinChunkQuota = kMaxChunkQuota = 1, 2, 3, ...) for testing purposes
 // to verify that the MRU/LRU cache works as expected. Even though
 // massive drop outs are expected to occur Mixxx should run reliably!
-const SINT kNumberOfCachedChunksInMemory = 80;
+const int kMinChunkQuota = 80;
+const int kMaxChunkQuota = 320;
+
+// For each hinted chunk the reader may keep additional chunks for
+// the history, e.g. for scratching backwards after a hot cue jump.
+const int kChunkQuotaPerHintedChunk = 4;
+
+// Limit the number of in-flight requests to the worker. This should
+// prevent to overload the worker when it is not able to fetch those
+// requests from the FIFO timely. Otherwise outdated requests pile up
+// in the FIFO and it would take a long time to process them, just to
+// discard the results that most likely have already become obsolete.
+// TODO(XXX): Ideally the request FIFO would be implemented as a ring
+// buffer, where new requests replace old requests when full. Those
+// old requests need to be returned immediately to the CachingReader
+// that must take ownership and free them!!!
+const int kMaxPendingReadRequests = 20;
+
+// Optionally decode whole tracks ahead into a memory-mapped file,
+// see CachingReaderPcmCache
+const ConfigKey kDecodeAheadConfigKey =
+        ConfigKey("[Master]", "caching_reader_decode_ahead");
+
+QString pcmCacheDirPath(const UserSettingsPointer& pConfig) {
+    if (!pConfig || !pConfig->getValue(kDecodeAheadConfigKey, false)) {
+        return QString();
+    }
+    return QDir(pConfig->getSettingsPath()).filePath(QStringLiteral("pcmcache"));
+}
+
+// The counters are constructed once, so that counting in the audio
+// callback does not allocate a new tag each time.
+const Counter kPlayPositionCacheMissCounter(QStringLiteral(
+        "CachingReader::hintAndMaybeWake(): Cache miss for play position"));
+const Counter kLoopCacheMissCounter(QStringLiteral(
+        "CachingReader::hintAndMaybeWake(): Cache miss for loop"));
+const Counter kPrefetchCacheMissCounter(QStringLiteral(
+        "CachingReader::hintAndMaybeWake(): Cache miss for prefetch"));
+const Counter kArenaExhaustedCounter(QStringLiteral(
+        "CachingReader::allocateChunk(): Shared chunk arena exhausted"));
+const Counter kExpireLRUEvictedChunkCounter(QStringLiteral(
+        "CachingReader::allocateChunkExpireLRU(): Evicted chunk"));
+const Counter kReadCacheHitCounter(QStringLiteral(
+        "CachingReader::read(): Read chunk on cache hit"));
+const Counter kReadCacheMissCounter(QStringLiteral(
+        "CachingReader::read(): Failed to read chunk on cache miss"));
+const Counter kQuotaEvictedChunkCounter(QStringLiteral(
+        "CachingReader::updateChunkQuota(): Evicted chunk"));
+
+// Counts the hinted chunks that were not available in the cache,
+// separately for each Hint::PriorityClass.
+void countHintCacheMiss(int priority) {
+    switch (Hint::priorityClassOf(priority)) {
+    case Hint::PriorityClass::PlayPosition:
+        kPlayPositionCacheMissCounter.increment();
+        break;
+    case Hint::PriorityClass::Loop:
+        kLoopCacheMissCounter.increment();
+        break;
+    case Hint::PriorityClass::Prefetch:
+        kPrefetchCacheMissCounter.increment();
+        break;
+    }
+}
 
 } // anonymous namespace
 
 CachingReader::CachingReader(const QString& group,
         UserSettingsPointer config)
         : m_pConfig(config),
-          // Limit the number of in-flight requests to the worker. This should
-          // prevent to overload the worker when it is not able to fetch those
-          // requests from the FIFO timely. Otherwise outdated requests pile up
-          // in the FIFO and it would take a long time to process them, just to
-          // discard the results that most likely have already become obsolete.
-          // TODO(XXX): Ideally the request FIFO would be implemented as a ring
-          // buffer, where new requests replace old requests when full. Those
-          // old requests need to be returned immediately to the CachingReader
-          // that must take ownership and free them!!!
-          m_chunkReadRequestFIFO(kNumberOfCachedChunksInMemory / 4),
-          // The capacity of the back channel must be equal to the number of
-          // allocated chunks, because the worker use writeBlocking(). Otherwise
-          // the worker could get stuck in a hot loop!!!
-          m_readerStatusUpdateFIFO(kNumberOfCachedChunksInMemory),
+          m_chunkReadRequestFIFO(kMaxPendingReadRequests),
+          // The capacity of the back channel must be equal to the maximum
+          // number of allocated chunks, because the worker use
+          // writeBlocking(). Otherwise the worker could get stuck in a
+          // hot loop!!!
+          m_readerStatusUpdateFIFO(kMaxChunkQuota),
           m_state(STATE_IDLE),
+          m_pChunkArena(CachingReaderChunkArena::getOrCreate(config)),
+          m_chunkQuota(kMinChunkQuota),
+          m_acquiredChunkCount(0),
+          m_reservedChunkCount(0),
           m_mruCachingReaderChunk(nullptr),
           m_lruCachingReaderChunk(nullptr),
-          m_sampleBuffer(CachingReaderChunk::kSamples * kNumberOfCachedChunksInMemory),
-          m_worker(group, &m_chunkReadRequestFIFO, &m_readerStatusUpdateFIFO) {
-    m_allocatedCachingReaderChunks.reserve(kNumberOfCachedChunksInMemory);
-    // Divide up the allocated raw memory buffer into total_chunks
-    // chunks. Initialize each chunk to hold nothing and add it to the free
-    // list.
-    for (SINT i = 0; i < kNumberOfCachedChunksInMemory; ++i) {
-        CachingReaderChunkForOwner* c =
-                new CachingReaderChunkForOwner(
-                        mixxx::SampleBuffer::WritableSlice(
-                                m_sampleBuffer,
-                                CachingReaderChunk::kSamples * i,
-                                CachingReaderChunk::kSamples));
-        m_chunks.push_back(c);
-        m_freeChunks.push_back(c);
-    }
+          m_readRequestSequence(0),
+          m_worker(group,
+                  &m_chunkReadRequestFIFO,
+                  &m_readerStatusUpdateFIFO,
+                  pcmCacheDirPath(config)) {
+    m_allocatedCachingReaderChunks.reserve(kMaxChunkQuota);
 
     // Forward signals from worker
     connect(&m_worker, &CachingReaderWorker::trackLoading,
@@ -94,7 +141,9 @@ CachingReader::CachingReader(const QString& group,
 
 CachingReader::~CachingReader() {
     m_worker.quitWait();
-    qDeleteAll(m_chunks);
+    // Return all chunks to the shared arena, including those that
+    // are still referenced by pending read requests.
+    m_pChunkArena->releaseAll(this, m_reservedChunkCount);
 }
 
 void CachingReader::freeChunkFromList(CachingReaderChunkForOwner* pChunk) {
@@ -102,7 +151,33 @@ void CachingReader::freeChunkFromList(CachingReaderChunkForOwner* pChunk) {
             &m_mruCachingReaderChunk,
             &m_lruCachingReaderChunk);
     pChunk->free();
-    m_freeChunks.push_back(pChunk);
+    // The most recently acquired chunk is returned first, i.e. the
+    // reserved chunks are held as long as possible
+    if (m_acquiredChunkCount > m_reservedChunkCount) {
+        m_pChunkArena->release(pChunk);
+    } else {
+        m_pChunkArena->releaseReserved(pChunk);
+    }
+    --m_acquiredChunkCount;
+    DEBUG_ASSERT(m_acquiredChunkCount >= 0);
+}
+
+void CachingReader::setReservedChunkCount(int reservedChunkCount) {
+    // Only the reserved chunks that have not been acquired yet are
+    // accounted for by the arena
+    const int unusedChunkCount =
+            math_max(m_reservedChunkCount - m_acquiredChunkCount, 0);
+    const int targetUnusedChunkCount =
+            math_max(reservedChunkCount - m_acquiredChunkCount, 0);
+    if (targetUnusedChunkCount >= unusedChunkCount) {
+        const int missingChunkCount = targetUnusedChunkCount - unusedChunkCount;
+        const int grantedChunkCount = m_pChunkArena->reserve(missingChunkCount);
+        m_reservedChunkCount = reservedChunkCount -
+                (missingChunkCount - grantedChunkCount);
+    } else {
+        m_pChunkArena->unreserve(unusedChunkCount - targetUnusedChunkCount);
+        m_reservedChunkCount = reservedChunkCount;
+    }
 }
 
 void CachingReader::freeChunk(CachingReaderChunkForOwner* pChunk) {
@@ -119,16 +194,14 @@ void CachingReader::freeChunk(CachingReaderChunkForOwner* pChunk) {
 }
 
 void CachingReader::freeAllChunks() {
-    for (const auto& pChunk: qAsConst(m_chunks)) {
+    for (auto* pChunk : qAsConst(m_allocatedCachingReaderChunks)) {
         // We will receive CHUNK_READ_INVALID for all pending chunk reads
         // which should free the chunks individually.
         if (pChunk->getState() == CachingReaderChunkForOwner::READ_PENDING) {
             continue;
         }
-
-        if (pChunk->getState() != CachingReaderChunkForOwner::FREE) {
-            freeChunkFromList(pChunk);
-        }
+        DEBUG_ASSERT(pChunk->getState() != CachingReaderChunkForOwner::FREE);
+        freeChunkFromList(pChunk);
     }
     DEBUG_ASSERT(!m_mruCachingReaderChunk);
     DEBUG_ASSERT(!m_lruCachingReaderChunk);
@@ -137,11 +210,20 @@ void CachingReader::freeAllChunks() {
 }
 
 CachingReaderChunkForOwner* CachingReader::allocateChunk(SINT chunkIndex) {
-    if (m_freeChunks.empty()) {
+    if (m_allocatedCachingReaderChunks.size() >= m_chunkQuota) {
         return nullptr;
     }
-    CachingReaderChunkForOwner* pChunk = m_freeChunks.front();
-    m_freeChunks.pop_front();
+    CachingReaderChunkForOwner* pChunk;
+    if (m_acquiredChunkCount < m_reservedChunkCount) {
+        pChunk = m_pChunkArena->acquireReserved(this);
+    } else {
+        pChunk = m_pChunkArena->acquire(this);
+    }
+    if (!pChunk) {
+        kArenaExhaustedCounter.increment();
+        return nullptr;
+    }
+    ++m_acquiredChunkCount;
 
     pChunk->init(chunkIndex);
 
@@ -154,6 +236,7 @@ CachingReaderChunkForOwner* CachingReader::allocateChunkExpireLRU(SINT chunkInde
     auto* pChunk = allocateChunk(chunkIndex);
     if (!pChunk) {
         if (m_lruCachingReaderChunk) {
+            kExpireLRUEvictedChunkCounter.increment();
             freeChunk(m_lruCachingReaderChunk);
             pChunk = allocateChunk(chunkIndex);
         } else {
@@ -274,13 +357,18 @@ void CachingReader::process() {
                 }
                 // Reset the readable frame index range
                 m_readableFrameIndexRange = update.readableFrameIndexRange();
+                // Keep the minimum quota available while playing, even
+                // if other readers compete for the shared chunks
+                setReservedChunkCount(kMinChunkQuota);
                 m_state.storeRelease(STATE_TRACK_LOADED);
             } else {
                 DEBUG_ASSERT(update.status == TRACK_UNLOADED);
                 // This message could be processed later when a new
                 // track is already loading! In this case the TRACK_LOADED will
                 // be the very next status update.
-                if (!m_state.testAndSetRelease(STATE_TRACK_UNLOADING, STATE_IDLE)) {
+                if (m_state.testAndSetRelease(STATE_TRACK_UNLOADING, STATE_IDLE)) {
+                    setReservedChunkCount(0);
+                } else {
                     DEBUG_ASSERT(atomicLoadRelaxed(m_state) == STATE_TRACK_LOADING);
                 }
             }
@@ -422,6 +510,7 @@ CachingReader::ReadResult CachingReader::read(SINT startSample, SINT numSamples,
                 mixxx::IndexRange bufferedFrameIndexRange;
                 const CachingReaderChunkForOwner* const pChunk = lookupChunkAndFreshen(chunkIndex);
                 if (pChunk && (pChunk->getState() == CachingReaderChunkForOwner::READY)) {
+                    kReadCacheHitCounter.increment();
                     if (reverse) {
                         bufferedFrameIndexRange =
                                 pChunk->readBufferedSampleFramesReverse(
@@ -439,7 +528,7 @@ CachingReader::ReadResult CachingReader::read(SINT startSample, SINT numSamples,
                     // pending.
                     DEBUG_ASSERT(!pChunk ||
                             (pChunk->getState() == CachingReaderChunkForOwner::READ_PENDING));
-                    Counter("CachingReader::read(): Failed to read chunk on cache miss")++;
+                    kReadCacheMissCounter.increment();
                     if (kLogger.traceEnabled()) {
                         kLogger.trace()
                                 << "Cache miss for chunk with index"
@@ -511,11 +600,29 @@ void CachingReader::hintAndMaybeWake(const HintVector& hintList) {
         return;
     }
 
+    // Submit the read requests in order of their priority. The capacity
+    // of the request FIFO is limited and requests for the play position
+    // must not be rejected after the FIFO has been filled up with less
+    // urgent requests. The hints are sorted into a preallocated member
+    // to avoid memory allocations in the engine callback. Only a few hints
+    // are issued per callback and std::stable_sort() might allocate a
+    // temporary buffer, so a simple insertion sort is used instead.
+    m_sortedHintList.resize(0);
+    for (const auto& hint : hintList) {
+        int insertPos = m_sortedHintList.size();
+        while (insertPos > 0 &&
+                m_sortedHintList[insertPos - 1].priority > hint.priority) {
+            --insertPos;
+        }
+        m_sortedHintList.insert(insertPos, hint);
+    }
+
     // For every chunk that the hints indicated, check if it is in the cache. If
     // any are not, then wake.
     bool shouldWake = false;
+    int hintedChunkCount = 0;
 
-    for (const auto& hint: hintList) {
+    for (const auto& hint : qAsConst(m_sortedHintList)) {
         SINT hintFrame = hint.frame;
         SINT hintFrameCount = hint.frameCount;
 
@@ -545,10 +652,12 @@ void CachingReader::hintAndMaybeWake(const HintVector& hintList) {
 
         const int firstChunkIndex = CachingReaderChunk::indexForFrame(readableFrameIndexRange.start());
         const int lastChunkIndex = CachingReaderChunk::indexForFrame(readableFrameIndexRange.end() - 1);
+        hintedChunkCount += lastChunkIndex - firstChunkIndex + 1;
         for (int chunkIndex = firstChunkIndex; chunkIndex <= lastChunkIndex; ++chunkIndex) {
             CachingReaderChunkForOwner* pChunk = lookupChunk(chunkIndex);
             if (!pChunk) {
                 shouldWake = true;
+                countHintCacheMiss(hint.priority);
                 pChunk = allocateChunkExpireLRU(chunkIndex);
                 if (!pChunk) {
                     kLogger.warning()
@@ -560,6 +669,8 @@ void CachingReader::hintAndMaybeWake(const HintVector& hintList) {
                 // Do not insert the allocated chunk into the MRU/LRU list,
                 // because it will be handed over to the worker immediately
                 CachingReaderChunkReadRequest request;
+                request.priority = hint.priority;
+                request.sequence = m_readRequestSequence++;
                 request.giveToWorker(pChunk);
                 if (kLogger.traceEnabled()) {
                     kLogger.trace()
@@ -582,8 +693,31 @@ void CachingReader::hintAndMaybeWake(const HintVector& hintList) {
         }
     }
 
+    updateChunkQuota(hintedChunkCount);
+
     // If there are chunks to be read, wake up.
     if (shouldWake) {
         m_worker.workReady();
     }
 }
+
+void CachingReader::updateChunkQuota(int hintedChunkCount) {
+    const int targetChunkQuota = math_clamp(
+            kMinChunkQuota + hintedChunkCount * kChunkQuotaPerHintedChunk,
+            kMinChunkQuota,
+            kMaxChunkQuota);
+    if (targetChunkQuota >= m_chunkQuota) {
+        m_chunkQuota = targetChunkQuota;
+        return;
+    }
+    // Shrink gradually, one chunk per callback. Hints for cue points
+    // might only be missing temporarily, e.g. while a track is loading.
+    --m_chunkQuota;
+    // Return the least recently used chunks to the shared arena. Chunks
+    // with pending reads will be freed later if needed.
+    while (m_allocatedCachingReaderChunks.size() > m_chunkQuota &&
+            m_lruCachingReaderChunk) {
+        kQuotaEvictedChunkCounter.increment();
+        freeChunk(m_lruCachingReaderChunk);
+    }
+}
@@ -4,9 +4,9 @@
 #include <QHash>
 #include <QList>
 #include <QVarLengthArray>
-#include <QVector>
-#include <list>
+#include <memory>
 
+#include "engine/cachingreader/cachingreaderchunkarena.h"
 #include "engine/cachingreader/cachingreaderworker.h"
 #include "engine/engineworker.h"
 #include "preferences/usersettings.h"
@@ -23,17 +23,40 @@ typedef struct Hint {
     // If a range of frames should be present, use frameCount to indicate that the
     // range (frame, frame + frameCount) should be present in memory.
     SINT frameCount;
-    // Currently unused -- but in the future could be used to prioritize certain
-    // hints over others. A priority of 1 is the highest priority and should be
-    // used for samples that will be read imminently. Hints for samples that
-    // have the potential to be read (i.e. a cue point) should be issued with
-    // priority >10.
+    // Hints with a lower value are fetched before hints with a higher value.
+    // A priority of 1 is the highest priority and should be used for samples
+    // that will be read imminently. Hints for samples that have the potential
+    // to be read (i.e. a cue point) should be issued with priority >=10.
     int priority;
 
     // for the default frame count in forward direction
     static constexpr SINT kFrameCountForward = 0;
     static constexpr SINT kFrameCountBackward = -1;
 
+    // Samples around the play position that will be read imminently
+    static constexpr int kPriorityPlayPosition = 1;
+    // Samples at the loop in point of an enabled loop
+    static constexpr int kPriorityLoop = 2;
+    // Samples that might be read after a jump, e.g. cue points
+    static constexpr int kPriorityPrefetch = 10;
+
+    // The priorities are grouped into classes for the purpose of
+    // collecting statistics.
+    enum class PriorityClass {
+        PlayPosition,
+        Loop,
+        Prefetch,
+    };
+
+    static PriorityClass priorityClassOf(int priority) {
+        if (priority <= kPriorityPlayPosition) {
+            return PriorityClass::PlayPosition;
+        } else if (priority < kPriorityPrefetch) {
+            return PriorityClass::Loop;
+        } else {
+            return PriorityClass::Prefetch;
+        }
+    }
 } Hint;
 
 // Note that we use a QVarLengthArray here instead of a QVector. Since this list
@@ -67,6 +90,12 @@ typedef QVarLengthArray<Hint, 512> HintVector;
 // least-recently-used list. When a chunk needs to be allocated and there are no
 // free chunks then the least recently used chunk is free'd (see
 // allocateChunkExpireLRU).
+//
+// The chunks are acquired from a CachingReaderChunkArena that is shared by all
+// readers. The number of chunks that a single reader may hold is adjusted
+// continuously according to the number of chunks that are hinted, i.e. decks
+// with many hot cues and loops get more memory than sampler decks that only
+// play a track from the beginning (see updateChunkQuota).
 class CachingReader : public QObject {
     Q_OBJECT
 
@@ -95,7 +124,9 @@ class CachingReader : public QObject {
 
     // Issue a list of hints, but check whether any of the hints request a chunk
     // that is not in the cache. If any hints do request a chunk not in cache,
-    // then wake the reader so that it can process them. Must only be called
+    // then wake the reader so that it can process them. Hints are processed
+    // in order of their priority, i.e. read requests for the play position
+    // are submitted before those for loops or cue points. Must only be called
     // from the engine callback.
     void hintAndMaybeWake(const HintVector& hintList);
 
@@ -138,10 +169,15 @@ class CachingReader : public QObject {
     void freeChunk(CachingReaderChunkForOwner* pChunk);
     void freeChunkFromList(CachingReaderChunkForOwner* pChunk);
 
+    // Adjusts the number of chunks that are reserved for this reader in the
+    // shared arena. Less chunks are reserved if the arena is exhausted.
+    void setReservedChunkCount(int reservedChunkCount);
+
     // Returns all allocated chunks to the free list
     void freeAllChunks();
 
-    // Gets a chunk from the free list. Returns nullptr if none available.
+    // Gets a chunk from the shared arena. Returns nullptr if none available
+    // or if the quota of this reader has been exhausted.
     CachingReaderChunkForOwner* allocateChunk(SINT chunkIndex);
 
     // Gets a chunk from the free list, frees the LRU CachingReaderChunk if none available.
@@ -155,12 +191,27 @@ class CachingReader : public QObject {
     };
     QAtomicInt m_state;
 
-    // Keeps track of all CachingReaderChunks we've allocated.
-    QVector<CachingReaderChunkForOwner*> m_chunks;
+    // Adjusts the maximum number of chunks that this reader may hold
+    // according to the number of hinted chunks. The quota grows immediately
+    // and shrinks gradually to avoid thrashing. Exceeding chunks are
+    // returned to the arena.
+    void updateChunkQuota(int hintedChunkCount);
+
+    // The shared pool of chunks for all readers.
+    const std::shared_ptr<CachingReaderChunkArena> m_pChunkArena;
 
-    // List of free chunks. Linked list so that we have constant time insertions
-    // and deletions. Iteration is not necessary.
-    std::list<CachingReaderChunkForOwner*> m_freeChunks;
+    // The maximum number of chunks that this reader may currently hold.
+    int m_chunkQuota;
+
+    // The number of chunks that have been acquired from the arena, including
+    // those that are no longer referenced by m_allocatedCachingReaderChunks
+    // but still have pending reads.
+    int m_acquiredChunkCount;
+
+    // The number of chunks that are reserved for this reader. The first
+    // m_reservedChunkCount chunks are acquired from the reservation, all
+    // other chunks are shared with all readers.
+    int m_reservedChunkCount;
 
     // Keeps track of what CachingReaderChunks we've allocated and indexes them based on what
     // chunk number they are allocated to.
@@ -170,11 +221,16 @@ class CachingReader : public QObject {
     CachingReaderChunkForOwner* m_mruCachingReaderChunk;
     CachingReaderChunkForOwner* m_lruCachingReaderChunk;
 
-    // The raw memory buffer which is divided up into chunks.
-    mixxx::SampleBuffer m_sampleBuffer;
-
     // The readable frame index range as reported by the worker.
     mixxx::IndexRange m_readableFrameIndexRange;
 
+    // Scratch buffer for sorting the hints by priority. It is a member
+    // to avoid allocating memory in the engine callback.
+    HintVector m_sortedHintList;
+
+    // Incremented for each submitted read request. Used by the worker
+    // for ordering requests with the same priority by their age.
+    quint32 m_readRequestSequence;
+
     CachingReaderWorker m_worker;
 };
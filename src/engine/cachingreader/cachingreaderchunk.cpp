@@ -79,6 +79,24 @@ mixxx::IndexRange CachingReaderChunk::bufferSampleFrames(
     return m_bufferedSampleFrames.frameIndexRange();
 }
 
+mixxx::IndexRange CachingReaderChunk::copySampleFrames(
+        const mixxx::IndexRange& frameIndexRange,
+        mixxx::SampleBuffer::ReadableSlice decodedSamples) {
+    DEBUG_ASSERT(m_index != kInvalidChunkIndex);
+    DEBUG_ASSERT(frameIndexRange.length() <= kFrames);
+    DEBUG_ASSERT(decodedSamples.length() == frames2samples(frameIndexRange.length()));
+    SampleUtil::copy(
+            m_sampleBuffer.data(),
+            decodedSamples.data(),
+            decodedSamples.length());
+    m_bufferedSampleFrames = mixxx::ReadableSampleFrames(
+            frameIndexRange,
+            mixxx::SampleBuffer::ReadableSlice(
+                    m_sampleBuffer.data(),
+                    decodedSamples.length()));
+    return m_bufferedSampleFrames.frameIndexRange();
+}
+
 mixxx::IndexRange CachingReaderChunk::readBufferedSampleFrames(
         CSAMPLE* sampleBuffer,
         const mixxx::IndexRange& frameIndexRange) const {
@@ -149,6 +167,13 @@ void CachingReaderChunkForOwner::free() {
     m_state = FREE;
 }
 
+void CachingReaderChunkForOwner::reset() {
+    m_pPrev = nullptr;
+    m_pNext = nullptr;
+    CachingReaderChunk::init(kInvalidChunkIndex);
+    m_state = FREE;
+}
+
 void CachingReaderChunkForOwner::insertIntoListBefore(
         CachingReaderChunkForOwner** ppHead,
         CachingReaderChunkForOwner** ppTail,
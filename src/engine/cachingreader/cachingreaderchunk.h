@@ -56,6 +56,12 @@ public:
             const mixxx::AudioSourcePointer& pAudioSource,
             mixxx::SampleBuffer::WritableSlice tempOutputBuffer);
 
+    // Copy sample frames that have already been decoded for the given
+    // frame index range. Returns the range of frames that have been copied.
+    mixxx::IndexRange copySampleFrames(
+            const mixxx::IndexRange& frameIndexRange,
+            mixxx::SampleBuffer::ReadableSlice decodedSamples);
+
     mixxx::IndexRange readBufferedSampleFrames(
             CSAMPLE* sampleBuffer,
             const mixxx::IndexRange& frameIndexRange) const;
@@ -95,6 +101,11 @@ public:
     void init(SINT index);
     void free();
 
+    // Unconditionally resets the chunk regardless of its current state
+    // and detaches it from any list. Only used for returning the chunks
+    // of a destroyed owner, when no other thread is able to access them.
+    void reset();
+
     enum State {
         FREE,
         READY,
@@ -0,0 +1,240 @@
+#include "engine/cachingreader/cachingreaderchunkarena.h"
+
+#include <QMutex>
+#include <QMutexLocker>
+
+#include "util/assert.h"
+#include "util/logger.h"
+#include "util/math.h"
+#include "util/stat.h"
+
+namespace {
+
+mixxx::Logger kLogger("CachingReaderChunkArena");
+
+const ConfigKey kMemoryBudgetConfigKey =
+        ConfigKey("[Master]", "caching_reader_memory_budget_mb");
+
+// With CachingReaderChunk::kFrames = 8192 each chunk consumes
+// 8192 frames * 2 channels/frame * 4-bytes per sample = 64 KiB,
+// i.e. 16 chunks per MiB.
+//
+// The default budget of 96 MiB roughly matches the memory that was
+// reserved statically for 4 decks, 4 samplers, and 1 preview deck
+// with 80 chunks (5 MiB) per deck plus some headroom for decks that
+// hint many different regions of a track.
+const int kDefaultMemoryBudgetMiB = 96;
+const int kMinMemoryBudgetMiB = 8;
+const int kMaxMemoryBudgetMiB = 4096;
+
+const QString kAcquiredChunksStatTag =
+        QStringLiteral("CachingReaderChunkArena: acquired chunks");
+
+int chunkCountForMemoryBudget(int memoryBudgetMiB) {
+    const SINT bytesPerChunk = CachingReaderChunk::kSamples * sizeof(CSAMPLE);
+    return static_cast<int>(
+            (static_cast<qint64>(memoryBudgetMiB) * 1024 * 1024) / bytesPerChunk);
+}
+
+QMutex s_sharedArenaMutex;
+std::weak_ptr<CachingReaderChunkArena> s_sharedArena;
+
+} // anonymous namespace
+
+//static
+std::shared_ptr<CachingReaderChunkArena> CachingReaderChunkArena::getOrCreate(
+        const UserSettingsPointer& pConfig) {
+    QMutexLocker locker(&s_sharedArenaMutex);
+    auto pArena = s_sharedArena.lock();
+    if (pArena) {
+        return pArena;
+    }
+    int memoryBudgetMiB = kDefaultMemoryBudgetMiB;
+    if (pConfig) {
+        memoryBudgetMiB = math_clamp(
+                pConfig->getValue(kMemoryBudgetConfigKey, kDefaultMemoryBudgetMiB),
+                kMinMemoryBudgetMiB,
+                kMaxMemoryBudgetMiB);
+    }
+    pArena = std::make_shared<CachingReaderChunkArena>(
+            chunkCountForMemoryBudget(memoryBudgetMiB));
+    kLogger.info()
+            << "Allocated"
+            << pArena->chunkCount()
+            << "chunks with a memory budget of"
+            << memoryBudgetMiB
+            << "MiB";
+    s_sharedArena = pArena;
+    return pArena;
+}
+
+CachingReaderChunkArena::CachingReaderChunkArena(int chunkCount)
+        : m_sampleBuffer(CachingReaderChunk::kSamples * chunkCount),
+          m_freeBitmapWords((chunkCount + kBitsPerWord - 1) / kBitsPerWord),
+          m_acquiredChunkCount(0),
+          m_unreservedChunkCount(chunkCount) {
+    DEBUG_ASSERT(chunkCount > 0);
+    m_chunks.reserve(chunkCount);
+    m_slots.reserve(chunkCount);
+    for (int slot = 0; slot < chunkCount; ++slot) {
+        auto pChunk = std::make_unique<CachingReaderChunkForOwner>(
+                mixxx::SampleBuffer::WritableSlice(
+                        m_sampleBuffer,
+                        CachingReaderChunk::kSamples * slot,
+                        CachingReaderChunk::kSamples));
+        m_slots.insert(pChunk.get(), slot);
+        m_chunks.push_back(std::move(pChunk));
+    }
+    m_freeBitmap = std::make_unique<std::atomic<bitmap_word_t>[]>(m_freeBitmapWords);
+    for (int word = 0; word < m_freeBitmapWords; ++word) {
+        const int bitsInWord = math_min(kBitsPerWord, chunkCount - word * kBitsPerWord);
+        const bitmap_word_t bits = (bitsInWord == kBitsPerWord)
+                ? ~bitmap_word_t(0)
+                : ((bitmap_word_t(1) << bitsInWord) - 1);
+        m_freeBitmap[word].store(bits, std::memory_order_relaxed);
+    }
+    m_owners = std::make_unique<std::atomic<const CachingReader*>[]>(chunkCount);
+    for (int slot = 0; slot < chunkCount; ++slot) {
+        m_owners[slot].store(nullptr, std::memory_order_relaxed);
+    }
+}
+
+CachingReaderChunkArena::~CachingReaderChunkArena() {
+    // All readers must have returned their chunks
+    DEBUG_ASSERT(acquiredChunkCount() == 0);
+}
+
+int CachingReaderChunkArena::reserve(int count) {
+    DEBUG_ASSERT(count >= 0);
+    int unreserved = m_unreservedChunkCount.load(std::memory_order_relaxed);
+    int reserved;
+    do {
+        reserved = math_min(count, math_max(unreserved, 0));
+    } while (!m_unreservedChunkCount.compare_exchange_weak(
+            unreserved,
+            unreserved - reserved,
+            std::memory_order_relaxed));
+    return reserved;
+}
+
+void CachingReaderChunkArena::unreserve(int count) {
+    DEBUG_ASSERT(count >= 0);
+    m_unreservedChunkCount.fetch_add(count, std::memory_order_relaxed);
+}
+
+CachingReaderChunkForOwner* CachingReaderChunkArena::acquire(
+        const CachingReader* pOwner) {
+    // Only take a chunk if it is not needed to fulfill any reservation
+    int unreserved = m_unreservedChunkCount.load(std::memory_order_relaxed);
+    do {
+        if (unreserved <= 0) {
+            return nullptr;
+        }
+    } while (!m_unreservedChunkCount.compare_exchange_weak(
+            unreserved,
+            unreserved - 1,
+            std::memory_order_relaxed));
+    auto* pChunk = acquireSlot(pOwner);
+    VERIFY_OR_DEBUG_ASSERT(pChunk) {
+        unreserve(1);
+    }
+    return pChunk;
+}
+
+CachingReaderChunkForOwner* CachingReaderChunkArena::acquireReserved(
+        const CachingReader* pOwner) {
+    auto* pChunk = acquireSlot(pOwner);
+    // A free chunk is left for each reservation
+    DEBUG_ASSERT(pChunk);
+    return pChunk;
+}
+
+CachingReaderChunkForOwner* CachingReaderChunkArena::acquireSlot(
+        const CachingReader* pOwner) {
+    DEBUG_ASSERT(pOwner);
+    for (int word = 0; word < m_freeBitmapWords; ++word) {
+        bitmap_word_t bits = m_freeBitmap[word].load(std::memory_order_relaxed);
+        while (bits != 0) {
+            // Isolate the lowest set bit and determine its position
+            const bitmap_word_t lowestBit = bits & (~bits + 1);
+            int bit = 0;
+            while ((lowestBit >> bit) != 1) {
+                ++bit;
+            }
+            if (m_freeBitmap[word].compare_exchange_weak(
+                        bits,
+                        bits & ~lowestBit,
+                        std::memory_order_acquire,
+                        std::memory_order_relaxed)) {
+                const int slot = word * kBitsPerWord + bit;
+                m_owners[slot].store(pOwner, std::memory_order_relaxed);
+                const int acquired = m_acquiredChunkCount.fetch_add(
+                                             1, std::memory_order_relaxed) +
+                        1;
+                Stat::track(kAcquiredChunksStatTag,
+                        Stat::UNSPECIFIED,
+                        Stat::experimentFlags(Stat::COUNT | Stat::AVERAGE |
+                                Stat::MIN | Stat::MAX),
+                        acquired);
+                return m_chunks[slot].get();
+            }
+            // bits has been updated by the failed CAS, retry
+        }
+    }
+    return nullptr;
+}
+
+void CachingReaderChunkArena::releaseSlot(int slot) {
+    m_owners[slot].store(nullptr, std::memory_order_relaxed);
+    const int word = slot / kBitsPerWord;
+    const bitmap_word_t bit = bitmap_word_t(1) << (slot % kBitsPerWord);
+    const bitmap_word_t oldBits =
+            m_freeBitmap[word].fetch_or(bit, std::memory_order_release);
+    // Must not be released twice
+    DEBUG_ASSERT(!(oldBits & bit));
+    Q_UNUSED(oldBits); // only used in DEBUG_ASSERT
+    m_acquiredChunkCount.fetch_sub(1, std::memory_order_relaxed);
+}
+
+int CachingReaderChunkArena::slotOf(const CachingReaderChunkForOwner* pChunk) const {
+    DEBUG_ASSERT(pChunk);
+    DEBUG_ASSERT(pChunk->getState() == CachingReaderChunkForOwner::FREE);
+    const int slot = m_slots.value(pChunk, -1);
+    VERIFY_OR_DEBUG_ASSERT(slot >= 0) {
+        kLogger.critical() << "Cannot release foreign chunk" << pChunk;
+    }
+    return slot;
+}
+
+void CachingReaderChunkArena::release(CachingReaderChunkForOwner* pChunk) {
+    const int slot = slotOf(pChunk);
+    if (slot < 0) {
+        return;
+    }
+    releaseSlot(slot);
+    unreserve(1);
+}
+
+void CachingReaderChunkArena::releaseReserved(CachingReaderChunkForOwner* pChunk) {
+    const int slot = slotOf(pChunk);
+    if (slot < 0) {
+        return;
+    }
+    releaseSlot(slot);
+}
+
+void CachingReaderChunkArena::releaseAll(
+        const CachingReader* pOwner, int reservedChunkCount) {
+    DEBUG_ASSERT(pOwner);
+    int releasedChunkCount = 0;
+    for (int slot = 0; slot < chunkCount(); ++slot) {
+        if (m_owners[slot].load(std::memory_order_relaxed) == pOwner) {
+            m_chunks[slot]->reset();
+            releaseSlot(slot);
+            ++releasedChunkCount;
+        }
+    }
+    // Both the acquired chunks and the reserved chunks that have not been
+    // acquired are now available to all owners
+    unreserve(math_max(releasedChunkCount, reservedChunkCount));
+}
@@ -0,0 +1,116 @@
+#pragma once
+
+#include <QHash>
+#include <QtGlobal>
+#include <atomic>
+#include <memory>
+#include <vector>
+
+#include "engine/cachingreader/cachingreaderchunk.h"
+#include "preferences/usersettings.h"
+#include "util/class.h"
+#include "util/samplebuffer.h"
+
+class CachingReader;
+
+// A fixed-size pool of chunks that is shared by all CachingReader instances.
+//
+// The memory of the pool is allocated once according to a configurable budget
+// and divided into chunks of CachingReaderChunk::kSamples. Each CachingReader
+// acquires chunks from the arena on demand and releases them when they are
+// evicted. Decks that only touch a few regions of a track will therefore
+// leave memory for decks that jump around a lot.
+//
+// Readers with a loaded track reserve a minimum number of chunks, which other
+// readers are not able to acquire. Only the remaining chunks are shared on
+// demand, so that many idle readers cannot starve a playing deck.
+//
+// The availability of chunks is tracked by a bitmap of atomic words. Acquiring
+// and releasing chunks is lock-free and wait-free apart from a bounded number
+// of CAS retries, so both operations are safe to be called from the engine
+// callback.
+class CachingReaderChunkArena final {
+  public:
+    // Returns the arena that is shared by all readers. The arena is created
+    // by the first reader according to the configured memory budget and
+    // destroyed after the last reader has been deleted.
+    //
+    // Must not be called from the engine callback!
+    static std::shared_ptr<CachingReaderChunkArena> getOrCreate(
+            const UserSettingsPointer& pConfig);
+
+    explicit CachingReaderChunkArena(int chunkCount);
+    ~CachingReaderChunkArena();
+
+    int chunkCount() const {
+        return static_cast<int>(m_chunks.size());
+    }
+
+    int acquiredChunkCount() const {
+        return m_acquiredChunkCount.load(std::memory_order_relaxed);
+    }
+
+    // The number of free chunks that have not been reserved
+    int unreservedChunkCount() const {
+        return m_unreservedChunkCount.load(std::memory_order_relaxed);
+    }
+
+    // Reserves up to count free chunks for a single owner. Returns the
+    // number of chunks that have actually been reserved.
+    int reserve(int count);
+
+    // Returns reserved chunks that have not been acquired.
+    void unreserve(int count);
+
+    // Takes a free, unreserved chunk from the arena and assigns it to the
+    // given owner. Returns nullptr if all unreserved chunks are in use.
+    CachingReaderChunkForOwner* acquire(const CachingReader* pOwner);
+
+    // Takes a chunk that has been reserved by the given owner.
+    CachingReaderChunkForOwner* acquireReserved(const CachingReader* pOwner);
+
+    // Returns a chunk that has previously been acquired to the arena.
+    // The chunk must already have been freed by its owner.
+    void release(CachingReaderChunkForOwner* pChunk);
+
+    // Returns a chunk that has been acquired with acquireReserved(). The
+    // chunk stays reserved for its owner.
+    void releaseReserved(CachingReaderChunkForOwner* pChunk);
+
+    // Returns all chunks of the given owner to the arena, regardless of
+    // their state, together with its reservation of reservedChunkCount
+    // chunks. Only safe to be invoked after the owner has stopped its
+    // worker thread, i.e. when no other thread is accessing those chunks.
+    void releaseAll(const CachingReader* pOwner, int reservedChunkCount = 0);
+
+  private:
+    typedef quint64 bitmap_word_t;
+    static constexpr int kBitsPerWord = sizeof(bitmap_word_t) * 8;
+
+    CachingReaderChunkForOwner* acquireSlot(const CachingReader* pOwner);
+    void releaseSlot(int slot);
+    int slotOf(const CachingReaderChunkForOwner* pChunk) const;
+
+    mixxx::SampleBuffer m_sampleBuffer;
+
+    std::vector<std::unique_ptr<CachingReaderChunkForOwner>> m_chunks;
+
+    // Reverse lookup of the slot for each chunk. Immutable after
+    // construction and therefore safe to be accessed concurrently.
+    QHash<const CachingReaderChunkForOwner*, int> m_slots;
+
+    // Bit is set if the corresponding chunk is free
+    std::unique_ptr<std::atomic<bitmap_word_t>[]> m_freeBitmap;
+    int m_freeBitmapWords;
+
+    // The current owner of each chunk, nullptr if free
+    std::unique_ptr<std::atomic<const CachingReader*>[]> m_owners;
+
+    std::atomic<int> m_acquiredChunkCount;
+
+    // The free chunks minus the reserved chunks that have not been
+    // acquired yet, i.e. the chunks that are available to any owner
+    std::atomic<int> m_unreservedChunkCount;
+
+    DISALLOW_COPY_AND_ASSIGN(CachingReaderChunkArena);
+};
@@ -0,0 +1,441 @@
+#include "engine/cachingreader/cachingreaderpcmcache.h"
+
+#include <QCryptographicHash>
+#include <QDir>
+#include <QFileInfo>
+#include <QStorageInfo>
+#include <cstring>
+
+#ifdef Q_OS_UNIX
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#elif defined(Q_OS_WIN)
+#include <windows.h>
+#endif
+
+#include "engine/cachingreader/cachingreaderchunk.h"
+#include "sources/audiosourcestereoproxy.h"
+#include "util/logger.h"
+#include "util/math.h"
+
+namespace {
+
+mixxx::Logger kLogger("CachingReaderPcmCache");
+
+// The magic number also detects files that have been written
+// on a platform with a different byte order.
+constexpr quint64 kMagic = 0x4d4958584350434dULL; // "MIXXCPCM"
+constexpr quint32 kVersion = 1;
+
+// The file fingerprint consists of the file size and the leading
+// and trailing bytes of the file. Reading the whole file would take
+// too long for large files on slow disks and is not necessary for
+// detecting modified files.
+constexpr qint64 kFingerprintBlockSize = 64 * 1024;
+
+// Decoded files of all tracks are kept until they exceed this size.
+// The least recently modified files are deleted first.
+constexpr qint64 kMaxCacheDirSize = qint64(8) * 1024 * 1024 * 1024; // 8 GiB
+
+const QString kFileSuffix = QStringLiteral(".pcm");
+// Appended to the file name while decoding has not been completed
+const QString kPartFileSuffix = QStringLiteral(".part");
+// Appended to the file name for the lock file
+const QString kLockFileSuffix = QStringLiteral(".lock");
+
+QString lockFilePath(const QString& filePath) {
+    return filePath + kLockFileSuffix;
+}
+
+// Writing to a mapped page that has no disk space raises SIGBUS instead of
+// returning an error. All blocks of a new file are therefore allocated
+// before mapping it, instead of creating a sparse file.
+bool allocateFile(QFile* pFile, qint64 fileSize) {
+#ifdef __LINUX__
+    return posix_fallocate(pFile->handle(), 0, fileSize) == 0;
+#else
+    // Not all platforms are able to allocate disk space upfront. The
+    // free space is checked instead, which does not account for other
+    // applications that are writing to the same disk in the meantime.
+    const QStorageInfo storageInfo(QFileInfo(*pFile).absolutePath());
+    return storageInfo.bytesAvailable() >= 2 * fileSize &&
+            pFile->resize(fileSize);
+#endif
+}
+
+// Writes the modified pages in the given range back to the file and
+// waits until this has been completed
+bool syncMappedData(uchar* pData, qint64 size) {
+#ifdef Q_OS_UNIX
+    // The start address must be aligned to a page
+    const auto pageSize = static_cast<quintptr>(sysconf(_SC_PAGESIZE));
+    const auto offset = reinterpret_cast<quintptr>(pData) % pageSize;
+    return msync(pData - offset, static_cast<size_t>(size + offset), MS_SYNC) == 0;
+#elif defined(Q_OS_WIN)
+    return FlushViewOfFile(pData, static_cast<SIZE_T>(size)) != 0;
+#else
+    Q_UNUSED(pData);
+    Q_UNUSED(size);
+    return true;
+#endif
+}
+
+QString fingerprintOfFile(
+        const QString& trackLocation,
+        const mixxx::AudioSourcePointer& pAudioSource) {
+    QFile file(trackLocation);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return QString();
+    }
+    QCryptographicHash hash(QCryptographicHash::Sha1);
+    const qint64 fileSize = file.size();
+    hash.addData(reinterpret_cast<const char*>(&fileSize), sizeof(fileSize));
+    hash.addData(file.read(kFingerprintBlockSize));
+    if (fileSize > 2 * kFingerprintBlockSize) {
+        if (!file.seek(fileSize - kFingerprintBlockSize)) {
+            return QString();
+        }
+        hash.addData(file.read(kFingerprintBlockSize));
+    }
+    // Decoders might differ between versions or platforms
+    const quint32 sampleRate = static_cast<quint32>(
+            pAudioSource->getSignalInfo().getSampleRate());
+    hash.addData(reinterpret_cast<const char*>(&sampleRate), sizeof(sampleRate));
+    const qint64 frameIndexMin = pAudioSource->frameIndexMin();
+    hash.addData(reinterpret_cast<const char*>(&frameIndexMin), sizeof(frameIndexMin));
+    const qint64 frameIndexMax = pAudioSource->frameIndexMax();
+    hash.addData(reinterpret_cast<const char*>(&frameIndexMax), sizeof(frameIndexMax));
+    return QString::fromLatin1(hash.result().toHex());
+}
+
+void pruneCacheDir(const QDir& cacheDir, qint64 requiredSize) {
+    const auto fileInfos = cacheDir.entryInfoList(
+            QStringList{
+                    QStringLiteral("*") + kFileSuffix,
+                    QStringLiteral("*") + kFileSuffix + kPartFileSuffix},
+            QDir::Files,
+            QDir::Time); // newest first
+    qint64 totalSize = requiredSize;
+    for (const auto& fileInfo : fileInfos) {
+        totalSize += fileInfo.size();
+        if (totalSize <= kMaxCacheDirSize) {
+            continue;
+        }
+        QString filePath = fileInfo.filePath();
+        if (filePath.endsWith(kPartFileSuffix)) {
+            filePath.chop(kPartFileSuffix.size());
+        }
+        // Files that are mapped into memory by another reader must
+        // not be deleted
+        QLockFile lockFile(lockFilePath(filePath));
+        lockFile.setStaleLockTime(0);
+        if (!lockFile.tryLock(0)) {
+            kLogger.debug() << "Not deleting" << fileInfo.filePath() << "while in use";
+            continue;
+        }
+        kLogger.debug() << "Deleting" << fileInfo.filePath();
+        if (QFile::remove(fileInfo.filePath())) {
+            totalSize -= fileInfo.size();
+        }
+    }
+}
+
+} // anonymous namespace
+
+// The data of the file starts with this header. It is followed by
+// all stereo samples of the track. The size of the header is a multiple
+// of 16 bytes to keep the samples properly aligned for SSE.
+struct CachingReaderPcmCache::Header {
+    quint64 magic;
+    quint32 version;
+    quint32 sampleRate;
+    qint64 frameIndexMin;
+    qint64 frameIndexMax;
+    // Frames in the range [frameIndexMin, decodedFrameIndexEnd) are valid
+    qint64 decodedFrameIndexEnd;
+    qint64 reserved[3];
+};
+
+//static
+uchar* CachingReaderPcmCache::mapFile(QFile* pFile, qint64 fileSize, bool create) {
+    if (!pFile->open(QIODevice::ReadWrite)) {
+        kLogger.warning()
+                << "Failed to open file"
+                << pFile->fileName();
+        return nullptr;
+    }
+    if (create && !allocateFile(pFile, fileSize)) {
+        // The track is read from the audio source without caching it
+        kLogger.warning()
+                << "Not enough disk space for file"
+                << pFile->fileName();
+        pFile->close();
+        pFile->remove();
+        return nullptr;
+    }
+    uchar* pMappedData = pFile->map(0, fileSize);
+    if (!pMappedData) {
+        kLogger.warning()
+                << "Failed to map file"
+                << pFile->fileName()
+                << "into memory";
+    }
+    return pMappedData;
+}
+
+//static
+bool CachingReaderPcmCache::isValidHeader(
+        const Header& header,
+        const mixxx::AudioSourcePointer& pAudioSource) {
+    return header.magic == kMagic &&
+            header.version == kVersion &&
+            header.sampleRate ==
+            static_cast<quint32>(pAudioSource->getSignalInfo().getSampleRate()) &&
+            header.frameIndexMin == pAudioSource->frameIndexMin() &&
+            header.frameIndexMax == pAudioSource->frameIndexMax() &&
+            header.decodedFrameIndexEnd >= header.frameIndexMin &&
+            header.decodedFrameIndexEnd <= header.frameIndexMax;
+}
+
+//static
+std::unique_ptr<CachingReaderPcmCache> CachingReaderPcmCache::open(
+        const QString& cacheDirPath,
+        const QString& trackLocation,
+        const mixxx::AudioSourcePointer& pAudioSource) {
+    DEBUG_ASSERT(pAudioSource);
+    const QString fingerprint = fingerprintOfFile(trackLocation, pAudioSource);
+    if (fingerprint.isEmpty()) {
+        kLogger.warning()
+                << "Failed to read file"
+                << trackLocation;
+        return nullptr;
+    }
+    QDir cacheDir(cacheDirPath);
+    if (!cacheDir.mkpath(cacheDirPath)) {
+        kLogger.warning()
+                << "Failed to create directory"
+                << cacheDirPath;
+        return nullptr;
+    }
+
+    const QString filePath = cacheDir.filePath(fingerprint + kFileSuffix);
+    // The lock is held as long as the file is mapped into memory. Locks
+    // are only considered stale if the owning process does not exist
+    // anymore.
+    auto pLockFile = std::make_unique<QLockFile>(lockFilePath(filePath));
+    pLockFile->setStaleLockTime(0);
+    if (!pLockFile->tryLock(0)) {
+        kLogger.debug()
+                << "File"
+                << filePath
+                << "is already in use";
+        return nullptr;
+    }
+
+    const qint64 fileSize = sizeof(Header) +
+            static_cast<qint64>(CachingReaderChunk::frames2samples(
+                    pAudioSource->frameLength())) *
+                    sizeof(CSAMPLE);
+    // A completed file is never modified again
+    auto pFile = std::make_unique<QFile>(filePath);
+    uchar* pMappedData = nullptr;
+    if (pFile->exists()) {
+        if (pFile->size() == fileSize) {
+            pMappedData = mapFile(pFile.get(), fileSize, false);
+        }
+        if (pMappedData) {
+            const auto& header = *reinterpret_cast<const Header*>(pMappedData);
+            if (!isValidHeader(header, pAudioSource) ||
+                    header.decodedFrameIndexEnd != header.frameIndexMax) {
+                pFile->unmap(pMappedData);
+                pMappedData = nullptr;
+            }
+        }
+        if (!pMappedData) {
+            pFile->close();
+            kLogger.debug() << "Deleting invalid file" << filePath;
+            pFile->remove();
+        }
+    }
+    // Otherwise continue decoding into the temporary file
+    if (!pMappedData) {
+        pFile = std::make_unique<QFile>(filePath + kPartFileSuffix);
+        const bool exists = pFile->exists() && pFile->size() == fileSize;
+        if (!exists) {
+            pFile->remove();
+            pruneCacheDir(cacheDir, fileSize);
+        }
+        pMappedData = mapFile(pFile.get(), fileSize, !exists);
+        if (!pMappedData) {
+            return nullptr;
+        }
+        auto* pHeader = reinterpret_cast<Header*>(pMappedData);
+        if (!exists || !isValidHeader(*pHeader, pAudioSource)) {
+            std::memset(pHeader, 0, sizeof(Header));
+            pHeader->magic = kMagic;
+            pHeader->version = kVersion;
+            pHeader->sampleRate = static_cast<quint32>(
+                    pAudioSource->getSignalInfo().getSampleRate());
+            pHeader->frameIndexMin = pAudioSource->frameIndexMin();
+            pHeader->frameIndexMax = pAudioSource->frameIndexMax();
+            pHeader->decodedFrameIndexEnd = pAudioSource->frameIndexMin();
+        }
+    }
+
+    auto pCache = std::unique_ptr<CachingReaderPcmCache>(
+            new CachingReaderPcmCache(
+                    std::move(pLockFile),
+                    filePath,
+                    std::move(pFile),
+                    pMappedData));
+    if (pCache->isComplete() && pCache->m_pFile->fileName() != filePath) {
+        // Renaming the temporary file failed before
+        pCache->finishFile();
+    }
+    if (kLogger.debugEnabled()) {
+        kLogger.debug()
+                << "Opened"
+                << pCache->m_pFile->fileName()
+                << "for"
+                << trackLocation
+                << "with decoded frames"
+                << pCache->decodedFrameIndexRange();
+    }
+    return pCache;
+}
+
+CachingReaderPcmCache::CachingReaderPcmCache(
+        std::unique_ptr<QLockFile> pLockFile,
+        const QString& filePath,
+        std::unique_ptr<QFile> pFile,
+        uchar* pMappedData)
+        : m_pLockFile(std::move(pLockFile)),
+          m_filePath(filePath),
+          m_pFile(std::move(pFile)),
+          m_pMappedData(pMappedData),
+          m_decodableFrameIndexEnd(static_cast<SINT>(header()->frameIndexMax)) {
+}
+
+CachingReaderPcmCache::~CachingReaderPcmCache() {
+    m_pFile->unmap(m_pMappedData);
+    // Unlocked after the file has been unmapped
+    m_pFile->close();
+}
+
+CachingReaderPcmCache::Header* CachingReaderPcmCache::header() const {
+    static_assert(sizeof(Header) % 16 == 0, "Misaligned sample data");
+    return reinterpret_cast<Header*>(m_pMappedData);
+}
+
+CSAMPLE* CachingReaderPcmCache::sampleData(SINT frameIndex) const {
+    DEBUG_ASSERT(frameIndex >= header()->frameIndexMin);
+    DEBUG_ASSERT(frameIndex <= header()->frameIndexMax);
+    return reinterpret_cast<CSAMPLE*>(m_pMappedData + sizeof(Header)) +
+            CachingReaderChunk::frames2samples(
+                    frameIndex - static_cast<SINT>(header()->frameIndexMin));
+}
+
+mixxx::IndexRange CachingReaderPcmCache::frameIndexRange() const {
+    return mixxx::IndexRange::between(
+            static_cast<SINT>(header()->frameIndexMin),
+            static_cast<SINT>(header()->frameIndexMax));
+}
+
+mixxx::IndexRange CachingReaderPcmCache::decodedFrameIndexRange() const {
+    return mixxx::IndexRange::between(
+            static_cast<SINT>(header()->frameIndexMin),
+            static_cast<SINT>(header()->decodedFrameIndexEnd));
+}
+
+mixxx::IndexRange CachingReaderPcmCache::decodeNextFrames(
+        const mixxx::AudioSourcePointer& pAudioSource,
+        mixxx::SampleBuffer::WritableSlice tempReadBuffer) {
+    const auto decodableFrameIndexRange = intersect(
+            mixxx::IndexRange::between(
+                    static_cast<SINT>(header()->decodedFrameIndexEnd),
+                    static_cast<SINT>(header()->frameIndexMax)),
+            pAudioSource->frameIndexRange());
+    if (decodableFrameIndexRange.empty()) {
+        // The readable range of the audio source has been shrinked
+        // by decoding errors
+        m_decodableFrameIndexEnd = decodedFrameIndexRange().end();
+        return mixxx::IndexRange();
+    }
+    const auto writableFrameIndexRange = mixxx::IndexRange::forward(
+            decodableFrameIndexRange.start(),
+            math_min(decodableFrameIndexRange.length(), CachingReaderChunk::kFrames));
+    mixxx::AudioSourceStereoProxy audioSourceProxy(
+            pAudioSource,
+            tempReadBuffer);
+    const auto readableSampleFrames =
+            audioSourceProxy.readSampleFrames(
+                    mixxx::WritableSampleFrames(
+                            writableFrameIndexRange,
+                            mixxx::SampleBuffer::WritableSlice(
+                                    sampleData(writableFrameIndexRange.start()),
+                                    CachingReaderChunk::frames2samples(
+                                            writableFrameIndexRange.length()))));
+    const auto decodedFrameIndexRange = readableSampleFrames.frameIndexRange();
+    if (decodedFrameIndexRange.empty() ||
+            decodedFrameIndexRange.start() != writableFrameIndexRange.start()) {
+        kLogger.warning()
+                << "Failed to decode frames"
+                << writableFrameIndexRange
+                << "- stopping at frame"
+                << writableFrameIndexRange.start();
+        // The remaining frames will be read from the audio source
+        m_decodableFrameIndexEnd = writableFrameIndexRange.start();
+        return mixxx::IndexRange();
+    }
+    if (decodedFrameIndexRange.end() < writableFrameIndexRange.end()) {
+        // Truncated by decoding errors
+        m_decodableFrameIndexEnd = decodedFrameIndexRange.end();
+    }
+    // Only publish the new frames after their samples have been written
+    // to disk. Otherwise the header might already include them when
+    // reopening the file after a crash or power loss.
+    if (!syncMappedData(
+                reinterpret_cast<uchar*>(sampleData(decodedFrameIndexRange.start())),
+                static_cast<qint64>(CachingReaderChunk::frames2samples(
+                        decodedFrameIndexRange.length())) *
+                        sizeof(CSAMPLE))) {
+        kLogger.warning()
+                << "Failed to write frames"
+                << decodedFrameIndexRange
+                << "to"
+                << m_pFile->fileName();
+        m_decodableFrameIndexEnd = decodedFrameIndexRange.start();
+        return mixxx::IndexRange();
+    }
+    header()->decodedFrameIndexEnd = decodedFrameIndexRange.end();
+    syncMappedData(reinterpret_cast<uchar*>(header()), sizeof(Header));
+    if (header()->decodedFrameIndexEnd == header()->frameIndexMax) {
+        finishFile();
+    }
+    return decodedFrameIndexRange;
+}
+
+void CachingReaderPcmCache::finishFile() {
+    // The file stays mapped into memory while it is renamed. If renaming
+    // fails the temporary file will be completed when reopening it.
+    if (!m_pFile->flush() || !QFile::rename(m_pFile->fileName(), m_filePath)) {
+        kLogger.warning()
+                << "Failed to rename"
+                << m_pFile->fileName()
+                << "to"
+                << m_filePath;
+        return;
+    }
+    kLogger.debug()
+            << "Finished"
+            << m_filePath;
+}
+
+mixxx::SampleBuffer::ReadableSlice CachingReaderPcmCache::readableSlice(
+        const mixxx::IndexRange& frameIndexRange) const {
+    DEBUG_ASSERT(frameIndexRange.isSubrangeOf(decodedFrameIndexRange()));
+    return mixxx::SampleBuffer::ReadableSlice(
+            sampleData(frameIndexRange.start()),
+            CachingReaderChunk::frames2samples(frameIndexRange.length()));
+}
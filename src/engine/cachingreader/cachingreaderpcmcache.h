@@ -0,0 +1,97 @@
+#pragma once
+
+#include <QFile>
+#include <QLockFile>
+#include <QString>
+#include <memory>
+
+#include "sources/audiosource.h"
+#include "util/class.h"
+
+// A memory-mapped file with the decoded stereo PCM samples of a whole track.
+//
+// The file is filled sequentially in the background by CachingReaderWorker
+// whenever it is idle. Chunks that are covered by the already decoded part
+// of the track are then copied from the mapped memory instead of decoding
+// them again from the audio source, which is notably slow after seeking
+// into VBR MP3 files.
+//
+// The file name is derived from a fingerprint of the file contents and the
+// properties of the audio source. Reloading the same track, even if it has
+// been renamed or moved, will find the existing file and continue decoding
+// where it stopped or skip decoding entirely if it has been completed.
+// Incomplete files are decoded into a temporary file that is renamed when
+// decoding has been completed. Each file is locked while it is open, i.e.
+// a track that is loaded by multiple readers at once is only cached by the
+// first reader and the file is not deleted while it is in use.
+//
+// The class is not thread-safe and must only be accessed by the worker.
+class CachingReaderPcmCache final {
+  public:
+    // Opens or creates the cache file for the given track and audio source.
+    // Returns nullptr if the cache file is already in use or could not be
+    // mapped into memory.
+    static std::unique_ptr<CachingReaderPcmCache> open(
+            const QString& cacheDirPath,
+            const QString& trackLocation,
+            const mixxx::AudioSourcePointer& pAudioSource);
+
+    ~CachingReaderPcmCache();
+
+    // The frame index range of the whole track
+    mixxx::IndexRange frameIndexRange() const;
+
+    // The frame index range that has already been decoded into the cache
+    mixxx::IndexRange decodedFrameIndexRange() const;
+
+    // Decoding has either been completed or stopped by decoding errors
+    bool isComplete() const {
+        return decodedFrameIndexRange().end() >= m_decodableFrameIndexEnd;
+    }
+
+    // Decodes the next block of frames from the audio source into the
+    // cache. Returns the decoded frame index range, an empty range if
+    // decoding has been completed or failed. Frames that could not be
+    // decoded are only skipped while the cache is open and decoding
+    // is retried when reopening the cache.
+    mixxx::IndexRange decodeNextFrames(
+            const mixxx::AudioSourcePointer& pAudioSource,
+            mixxx::SampleBuffer::WritableSlice tempReadBuffer);
+
+    // Returns the decoded stereo samples for a frame index range within
+    // decodedFrameIndexRange().
+    mixxx::SampleBuffer::ReadableSlice readableSlice(
+            const mixxx::IndexRange& frameIndexRange) const;
+
+  private:
+    struct Header;
+
+    CachingReaderPcmCache(
+            std::unique_ptr<QLockFile> pLockFile,
+            const QString& filePath,
+            std::unique_ptr<QFile> pFile,
+            uchar* pMappedData);
+
+    static uchar* mapFile(QFile* pFile, qint64 fileSize, bool create);
+    static bool isValidHeader(
+            const Header& header,
+            const mixxx::AudioSourcePointer& pAudioSource);
+
+    Header* header() const;
+    CSAMPLE* sampleData(SINT frameIndex) const;
+
+    // Renames the temporary file after decoding has been completed
+    void finishFile();
+
+    const std::unique_ptr<QLockFile> m_pLockFile;
+    const QString m_filePath;
+    const std::unique_ptr<QFile> m_pFile;
+    uchar* const m_pMappedData;
+
+    // Decoding stops at this frame, which is lower than the end of the
+    // track after decoding errors occurred. It is intentionally not
+    // stored in the file.
+    SINT m_decodableFrameIndexEnd;
+
+    DISALLOW_COPY_AND_ASSIGN(CachingReaderPcmCache);
+};
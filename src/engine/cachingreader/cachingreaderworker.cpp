@@ -3,6 +3,7 @@
 #include <QFileInfo>
 #include <QMutexLocker>
 #include <QtDebug>
+#include <algorithm>
 
 #include "control/controlobject.h"
 #include "moc_cachingreaderworker.cpp"
@@ -21,13 +22,40 @@ mixxx::Logger kLogger("CachingReaderWorker");
 CachingReaderWorker::CachingReaderWorker(
         const QString& group,
         FIFO<CachingReaderChunkReadRequest>* pChunkReadRequestFIFO,
-        FIFO<ReaderStatusUpdate>* pReaderStatusFIFO)
+        FIFO<ReaderStatusUpdate>* pReaderStatusFIFO,
+        const QString& pcmCacheDirPath)
         : m_group(group),
           m_tag(QString("CachingReaderWorker %1").arg(m_group)),
           m_pChunkReadRequestFIFO(pChunkReadRequestFIFO),
           m_pReaderStatusFIFO(pReaderStatusFIFO),
           m_newTrackAvailable(false),
+          m_pcmCacheDirPath(pcmCacheDirPath),
           m_stop(0) {
+    // The worker might fetch all requests from the FIFO at once
+    m_pendingReadRequests.reserve(m_pChunkReadRequestFIFO->writeAvailable());
+}
+
+bool CachingReaderWorker::takeMostUrgentReadRequest(
+        CachingReaderChunkReadRequest* pRequest) {
+    CachingReaderChunkReadRequest request;
+    while (m_pChunkReadRequestFIFO->read(&request, 1) == 1) {
+        m_pendingReadRequests.push_back(request);
+    }
+    if (m_pendingReadRequests.empty()) {
+        return false;
+    }
+    // Only a few requests are pending at any time. A linear search
+    // is sufficient and avoids reordering the remaining requests.
+    const auto mostUrgent = std::min_element(
+            m_pendingReadRequests.begin(),
+            m_pendingReadRequests.end(),
+            [](const CachingReaderChunkReadRequest& lhs,
+                    const CachingReaderChunkReadRequest& rhs) {
+                return lhs.isMoreUrgentThan(rhs);
+            });
+    *pRequest = *mostUrgent;
+    m_pendingReadRequests.erase(mostUrgent);
+    return true;
 }
 
 ReaderStatusUpdate CachingReaderWorker::processReadRequest(
@@ -47,6 +75,17 @@ ReaderStatusUpdate CachingReaderWorker::processReadRequest(
         return result;
     }
 
+    // Copy the samples if they have already been decoded ahead
+    if (m_pPcmCache &&
+            chunkFrameIndexRange.isSubrangeOf(m_pPcmCache->decodedFrameIndexRange())) {
+        pChunk->copySampleFrames(
+                chunkFrameIndexRange,
+                m_pPcmCache->readableSlice(chunkFrameIndexRange));
+        ReaderStatusUpdate result;
+        result.init(CHUNK_READ_SUCCESS, pChunk, m_pAudioSource->frameIndexRange());
+        return result;
+    }
+
     // Try to read the data required for the chunk from the audio source
     const mixxx::IndexRange bufferedFrameIndexRange = pChunk->bufferSampleFrames(
             m_pAudioSource,
@@ -102,13 +141,24 @@ void CachingReaderWorker::run() {
                 m_newTrackAvailable = false;
             } // implicitly unlocks the mutex
             loadTrack(pLoadTrack);
-        } else if (m_pChunkReadRequestFIFO->read(&request, 1) == 1) {
+        } else if (takeMostUrgentReadRequest(&request)) {
             // Read the requested chunk and send the result
             const ReaderStatusUpdate update(processReadRequest(request));
             m_pReaderStatusFIFO->writeBlocking(&update, 1);
+        } else if (m_pPcmCache && !m_pPcmCache->isComplete()) {
+            // Decode ahead while there is nothing else to do. Only a single
+            // chunk is decoded at once to respond to new requests timely.
+            m_pPcmCache->decodeNextFrames(
+                    m_pAudioSource,
+                    mixxx::SampleBuffer::WritableSlice(m_tempReadBuffer));
+            if (m_pPcmCache->isComplete()) {
+                kLogger.debug()
+                        << m_group
+                        << "Finished decoding ahead";
+            }
         } else {
             Event::end(m_tag);
-            m_semaRun.acquire();
+            waitForWork();
             Event::start(m_tag);
         }
     }
@@ -118,11 +168,16 @@ void CachingReaderWorker::loadTrack(const TrackPointer& pTrack) {
     // Discard all pending read requests
     CachingReaderChunkReadRequest request;
     while (m_pChunkReadRequestFIFO->read(&request, 1) == 1) {
-        const auto update = ReaderStatusUpdate::readDiscarded(request.chunk);
+        m_pendingReadRequests.push_back(request);
+    }
+    for (const auto& pendingRequest : m_pendingReadRequests) {
+        const auto update = ReaderStatusUpdate::readDiscarded(pendingRequest.chunk);
         m_pReaderStatusFIFO->writeBlocking(&update, 1);
     }
+    m_pendingReadRequests.clear();
 
     // Unload the track
+    m_pPcmCache.reset();
     m_pAudioSource.reset(); // Close open file handles
 
     if (!pTrack) {
@@ -190,6 +245,14 @@ void CachingReaderWorker::loadTrack(const TrackPointer& pTrack) {
         mixxx::SampleBuffer(tempReadBufferSize).swap(m_tempReadBuffer);
     }
 
+    if (!m_pcmCacheDirPath.isEmpty()) {
+        // Failure is not critical, all chunks will then be decoded on demand
+        m_pPcmCache = CachingReaderPcmCache::open(
+                m_pcmCacheDirPath,
+                trackLocation,
+                m_pAudioSource);
+    }
+
     const auto update =
             ReaderStatusUpdate::trackLoaded(
                     m_pAudioSource->frameIndexRange());
@@ -5,8 +5,10 @@
 #include <QString>
 #include <QThread>
 #include <QtDebug>
+#include <vector>
 
 #include "engine/cachingreader/cachingreaderchunk.h"
+#include "engine/cachingreader/cachingreaderpcmcache.h"
 #include "engine/engineworker.h"
 #include "sources/audiosource.h"
 #include "track/track_decl.h"
@@ -15,12 +17,28 @@
 // POD with trivial ctor/dtor/copy for passing through FIFO
 typedef struct CachingReaderChunkReadRequest {
     CachingReaderChunk* chunk;
+    // The priority of the hint that caused this request, see Hint::priority
+    int priority;
+    // Monotonically increasing (with wrap-around) sequence number that
+    // is assigned when submitting the request.
+    quint32 sequence;
 
     void giveToWorker(CachingReaderChunkForOwner* chunkForOwner) {
         DEBUG_ASSERT(chunkForOwner);
         chunk = chunkForOwner;
         chunkForOwner->giveToWorker();
     }
+
+    // Requests with a higher priority (lower value) are more urgent.
+    // Requests with the same priority are served in the order they have
+    // been submitted, i.e. the oldest request has the earliest deadline.
+    bool isMoreUrgentThan(const CachingReaderChunkReadRequest& other) const {
+        if (priority != other.priority) {
+            return priority < other.priority;
+        }
+        // Signed difference handles the wrap-around of the sequence number
+        return static_cast<qint32>(sequence - other.sequence) < 0;
+    }
 } CachingReaderChunkReadRequest;
 
 enum ReaderStatus {
@@ -95,10 +113,13 @@ class CachingReaderWorker : public EngineWorker {
     Q_OBJECT
 
   public:
-    // Construct a CachingReader with the given group.
+    // Construct a CachingReader with the given group. If a directory
+    // for the PCM cache is provided the worker decodes the whole track
+    // in the background while idle, see CachingReaderPcmCache.
     CachingReaderWorker(const QString& group,
             FIFO<CachingReaderChunkReadRequest>* pChunkReadRequestFIFO,
-            FIFO<ReaderStatusUpdate>* pReaderStatusFIFO);
+            FIFO<ReaderStatusUpdate>* pReaderStatusFIFO,
+            const QString& pcmCacheDirPath = QString());
     ~CachingReaderWorker() override = default;
 
     // Request to load a new track. wake() must be called afterwards.
@@ -137,9 +158,25 @@ class CachingReaderWorker : public EngineWorker {
     ReaderStatusUpdate processReadRequest(
             const CachingReaderChunkReadRequest& request);
 
+    // Moves all read requests from the FIFO into the list of pending
+    // requests and takes the most urgent one. Returns false if no
+    // requests are pending.
+    bool takeMostUrgentReadRequest(CachingReaderChunkReadRequest* pRequest);
+
+    // Read requests that have been received from the FIFO but that
+    // have not been processed yet. Reordered by urgency before
+    // processing, see CachingReaderChunkReadRequest::isMoreUrgentThan().
+    std::vector<CachingReaderChunkReadRequest> m_pendingReadRequests;
+
     // The current audio source of the track loaded
     mixxx::AudioSourcePointer m_pAudioSource;
 
+    // Decoding ahead is disabled if empty
+    const QString m_pcmCacheDirPath;
+
+    // The decoded samples of the track loaded (optional)
+    std::unique_ptr<CachingReaderPcmCache> m_pPcmCache;
+
     // Temporary buffer for reading samples from all channels
     // before conversion to a stereo signal.
     mixxx::SampleBuffer m_tempReadBuffer;
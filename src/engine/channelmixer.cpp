@@ -0,0 +1,144 @@
+#include "engine/channelmixer.h"
+
+#include "engine/channelmixkernel.h"
+#include "util/sample.h"
+#include "util/timer.h"
+
+namespace {
+
+typedef QVarLengthArray<ChannelMixKernel::Input, kPreallocatedChannels> MixInputArray;
+
+// Calculates the new gain of a channel and updates the gain cache
+ChannelMixKernel::Input prepareMixInput(
+        const EngineMaster::GainCalculator& gainCalculator,
+        EngineMaster::ChannelInfo* pChannelInfo,
+        QVarLengthArray<EngineMaster::GainCache, kPreallocatedChannels>* channelGainCache) {
+    EngineMaster::GainCache& gainCache = (*channelGainCache)[pChannelInfo->m_index];
+    ChannelMixKernel::Input input;
+    input.pBuffer = pChannelInfo->m_pBuffer;
+    input.pWriteBack = nullptr;
+    input.oldGain = gainCache.m_gain;
+    if (gainCache.m_fadeout) {
+        input.newGain = 0;
+        gainCache.m_fadeout = false;
+    } else {
+        input.newGain = gainCalculator.getGain(pChannelInfo);
+    }
+    gainCache.m_gain = input.newGain;
+    return input;
+}
+
+} // anonymous namespace
+
+// static
+void ChannelMixer::applyEffectsAndMixChannels(const EngineMaster::GainCalculator& gainCalculator,
+        QVarLengthArray<EngineMaster::ChannelInfo*, kPreallocatedChannels>* activeChannels,
+        QVarLengthArray<EngineMaster::GainCache, kPreallocatedChannels>* channelGainCache,
+        CSAMPLE* pOutput,
+        const ChannelHandle& outputHandle,
+        unsigned int iBufferSize,
+        unsigned int iSampleRate,
+        EngineEffectsManager* pEngineEffectsManager) {
+    // Signal flow overview:
+    // 1. Calculate gains for each channel
+    // 2. Consecutive channels without any active post-fader effects are
+    //    mixed into pOutput in a single pass while applying their gain.
+    // 3. Each other channel's calculated gain and input buffer is passed
+    //    to pEngineEffectsManager, which then:
+    //     A) Copies each channel input buffer to a temporary buffer
+    //     B) Applies gain to the temporary buffer
+    //     C) Processes effects on the temporary buffer
+    //     D) Mixes the temporary buffer into pOutput
+    // The channels are mixed in order and the original channel input buffers
+    // are not modified.
+    //ScopedTimer t("EngineMaster::applyEffectsAndMixChannels");
+    auto outputMode = ChannelMixKernel::OutputMode::Replace;
+    MixInputArray bypassedInputs;
+    for (int i = 0; i < activeChannels->size(); ++i) {
+        EngineMaster::ChannelInfo* pChannelInfo = activeChannels->at(i);
+        const ChannelMixKernel::Input input =
+                prepareMixInput(gainCalculator, pChannelInfo, channelGainCache);
+        if (pEngineEffectsManager->tryBypassPostFader(pChannelInfo->m_handle,
+                    outputHandle,
+                    pChannelInfo->m_features)) {
+            bypassedInputs.append(input);
+            continue;
+        }
+        // Mix all preceding channels before mixing this one
+        ChannelMixKernel::mixWithRampingGain(pOutput,
+                outputMode,
+                bypassedInputs.constData(),
+                bypassedInputs.size(),
+                iBufferSize);
+        outputMode = ChannelMixKernel::OutputMode::Add;
+        bypassedInputs.clear();
+        pEngineEffectsManager->processPostFaderAndMix(pChannelInfo->m_handle,
+                outputHandle,
+                pChannelInfo->m_pBuffer,
+                pOutput,
+                iBufferSize,
+                iSampleRate,
+                pChannelInfo->m_features,
+                input.oldGain,
+                input.newGain);
+    }
+    ChannelMixKernel::mixWithRampingGain(pOutput,
+            outputMode,
+            bypassedInputs.constData(),
+            bypassedInputs.size(),
+            iBufferSize);
+}
+
+// static
+void ChannelMixer::applyEffectsInPlaceAndMixChannels(const EngineMaster::GainCalculator& gainCalculator,
+        QVarLengthArray<EngineMaster::ChannelInfo*, kPreallocatedChannels>* activeChannels,
+        QVarLengthArray<EngineMaster::GainCache, kPreallocatedChannels>* channelGainCache,
+        CSAMPLE* pOutput,
+        const ChannelHandle& outputHandle,
+        unsigned int iBufferSize,
+        unsigned int iSampleRate,
+        EngineEffectsManager* pEngineEffectsManager) {
+    // Signal flow overview:
+    // 1. Calculate gains for each channel
+    // 2. Pass each channel's calculated gain and input buffer to
+    //    pEngineEffectsManager if any post-fader effects are active
+    //    for the channel, which then:
+    //    A) Applies the calculated gain to the channel buffer, modifying the original input buffer
+    //    B) Applies effects to the buffer, modifying the original input buffer
+    // 3. Mix the channel buffers together to make pOutput, overwriting the
+    //    pOutput buffer from the last engine callback. The gain of all
+    //    channels that have not been processed by pEngineEffectsManager is
+    //    applied in the same pass and written back to the channel buffers,
+    //    because they are also used for the individual deck outputs.
+    //ScopedTimer t("EngineMaster::applyEffectsInPlaceAndMixChannels");
+    MixInputArray inputs;
+    for (int i = 0; i < activeChannels->size(); ++i) {
+        EngineMaster::ChannelInfo* pChannelInfo = activeChannels->at(i);
+        ChannelMixKernel::Input input =
+                prepareMixInput(gainCalculator, pChannelInfo, channelGainCache);
+        if (pEngineEffectsManager->tryBypassPostFader(pChannelInfo->m_handle,
+                    outputHandle,
+                    pChannelInfo->m_features)) {
+            if (input.oldGain != CSAMPLE_GAIN_ONE || input.newGain != CSAMPLE_GAIN_ONE) {
+                input.pWriteBack = pChannelInfo->m_pBuffer;
+            }
+        } else {
+            pEngineEffectsManager->processPostFaderInPlace(pChannelInfo->m_handle,
+                    outputHandle,
+                    pChannelInfo->m_pBuffer,
+                    iBufferSize,
+                    iSampleRate,
+                    pChannelInfo->m_features,
+                    input.oldGain,
+                    input.newGain);
+            input.oldGain = CSAMPLE_GAIN_ONE;
+            input.newGain = CSAMPLE_GAIN_ONE;
+        }
+        inputs.append(input);
+    }
+    ChannelMixKernel::mixWithRampingGain(pOutput,
+            ChannelMixKernel::OutputMode::Replace,
+            inputs.constData(),
+            inputs.size(),
+            iBufferSize);
+}
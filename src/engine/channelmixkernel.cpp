@@ -0,0 +1,266 @@
+#include "engine/channelmixkernel.h"
+
+#include "util/assert.h"
+#include "util/cpufeatures.h"
+#include "util/math.h"
+#include "util/sample.h"
+
+#if defined(MIXXX_CPU_X86)
+#include <immintrin.h>
+#endif
+#if defined(MIXXX_CPU_NEON)
+#include <arm_neon.h>
+#endif
+
+namespace {
+
+// A channel with its gain ramp prepared for mixing
+struct Lane {
+    const CSAMPLE* pIn;
+    CSAMPLE* pWriteBack;
+    // The gain of frame f is startGain + gainDelta * f
+    CSAMPLE_GAIN startGain;
+    CSAMPLE_GAIN gainDelta;
+};
+
+// The lanes are prepared on the stack. More inputs are mixed in
+// multiple passes.
+constexpr int kMaxLanesPerPass = 32;
+
+typedef void (*MixLanesFunction)(
+        CSAMPLE* pOutput,
+        bool addToOutput,
+        const Lane* pLanes,
+        int laneCount,
+        SINT numSamples);
+
+// Mixes the samples in the range [firstSample, numSamples)
+inline void mixLanesScalarRange(
+        CSAMPLE* pOutput,
+        bool addToOutput,
+        const Lane* pLanes,
+        int laneCount,
+        SINT firstSample,
+        SINT numSamples) {
+    for (SINT i = firstSample; i < numSamples; ++i) {
+        const int frame = static_cast<int>(i / 2);
+        CSAMPLE acc = addToOutput ? pOutput[i] : CSAMPLE_ZERO;
+        for (int k = 0; k < laneCount; ++k) {
+            const Lane& lane = pLanes[k];
+            const CSAMPLE_GAIN gain = lane.startGain + lane.gainDelta * frame;
+            const CSAMPLE sample = lane.pIn[i] * gain;
+            if (lane.pWriteBack) {
+                lane.pWriteBack[i] = sample;
+            }
+            acc += sample;
+        }
+        pOutput[i] = acc;
+    }
+}
+
+void mixLanesScalar(
+        CSAMPLE* pOutput,
+        bool addToOutput,
+        const Lane* pLanes,
+        int laneCount,
+        SINT numSamples) {
+    mixLanesScalarRange(pOutput, addToOutput, pLanes, laneCount, 0, numSamples);
+}
+
+#if defined(MIXXX_CPU_X86)
+
+// 4 samples = 2 stereo frames per vector
+MIXXX_TARGET_SSE2 void mixLanesSse2(
+        CSAMPLE* pOutput,
+        bool addToOutput,
+        const Lane* pLanes,
+        int laneCount,
+        SINT numSamples) {
+    __m128 frameIndex = _mm_setr_ps(0, 0, 1, 1);
+    const __m128 frameStep = _mm_set1_ps(2);
+    SINT i = 0;
+    for (; i + 4 <= numSamples; i += 4) {
+        __m128 acc = addToOutput ? _mm_loadu_ps(pOutput + i) : _mm_setzero_ps();
+        for (int k = 0; k < laneCount; ++k) {
+            const Lane& lane = pLanes[k];
+            const __m128 gain = _mm_add_ps(
+                    _mm_set1_ps(lane.startGain),
+                    _mm_mul_ps(_mm_set1_ps(lane.gainDelta), frameIndex));
+            const __m128 samples = _mm_mul_ps(_mm_loadu_ps(lane.pIn + i), gain);
+            if (lane.pWriteBack) {
+                _mm_storeu_ps(lane.pWriteBack + i, samples);
+            }
+            acc = _mm_add_ps(acc, samples);
+        }
+        _mm_storeu_ps(pOutput + i, acc);
+        frameIndex = _mm_add_ps(frameIndex, frameStep);
+    }
+    mixLanesScalarRange(pOutput, addToOutput, pLanes, laneCount, i, numSamples);
+}
+
+// 8 samples = 4 stereo frames per vector
+MIXXX_TARGET_AVX2 void mixLanesAvx2(
+        CSAMPLE* pOutput,
+        bool addToOutput,
+        const Lane* pLanes,
+        int laneCount,
+        SINT numSamples) {
+    __m256 frameIndex = _mm256_setr_ps(0, 0, 1, 1, 2, 2, 3, 3);
+    const __m256 frameStep = _mm256_set1_ps(4);
+    SINT i = 0;
+    for (; i + 8 <= numSamples; i += 8) {
+        __m256 acc = addToOutput ? _mm256_loadu_ps(pOutput + i) : _mm256_setzero_ps();
+        for (int k = 0; k < laneCount; ++k) {
+            const Lane& lane = pLanes[k];
+            const __m256 gain = _mm256_add_ps(
+                    _mm256_set1_ps(lane.startGain),
+                    _mm256_mul_ps(_mm256_set1_ps(lane.gainDelta), frameIndex));
+            const __m256 samples = _mm256_mul_ps(_mm256_loadu_ps(lane.pIn + i), gain);
+            if (lane.pWriteBack) {
+                _mm256_storeu_ps(lane.pWriteBack + i, samples);
+            }
+            acc = _mm256_add_ps(acc, samples);
+        }
+        _mm256_storeu_ps(pOutput + i, acc);
+        frameIndex = _mm256_add_ps(frameIndex, frameStep);
+    }
+    mixLanesScalarRange(pOutput, addToOutput, pLanes, laneCount, i, numSamples);
+}
+
+#endif // MIXXX_CPU_X86
+
+#if defined(MIXXX_CPU_NEON)
+
+// 4 samples = 2 stereo frames per vector
+void mixLanesNeon(
+        CSAMPLE* pOutput,
+        bool addToOutput,
+        const Lane* pLanes,
+        int laneCount,
+        SINT numSamples) {
+    const float kInitialFrameIndex[4] = {0, 0, 1, 1};
+    float32x4_t frameIndex = vld1q_f32(kInitialFrameIndex);
+    const float32x4_t frameStep = vdupq_n_f32(2);
+    SINT i = 0;
+    for (; i + 4 <= numSamples; i += 4) {
+        float32x4_t acc = addToOutput ? vld1q_f32(pOutput + i) : vdupq_n_f32(0);
+        for (int k = 0; k < laneCount; ++k) {
+            const Lane& lane = pLanes[k];
+            // No vmlaq_f32(), because it might be fused
+            const float32x4_t gain = vaddq_f32(
+                    vdupq_n_f32(lane.startGain),
+                    vmulq_f32(vdupq_n_f32(lane.gainDelta), frameIndex));
+            const float32x4_t samples = vmulq_f32(vld1q_f32(lane.pIn + i), gain);
+            if (lane.pWriteBack) {
+                vst1q_f32(lane.pWriteBack + i, samples);
+            }
+            acc = vaddq_f32(acc, samples);
+        }
+        vst1q_f32(pOutput + i, acc);
+        frameIndex = vaddq_f32(frameIndex, frameStep);
+    }
+    mixLanesScalarRange(pOutput, addToOutput, pLanes, laneCount, i, numSamples);
+}
+
+#endif // MIXXX_CPU_NEON
+
+MixLanesFunction mixLanesFunction(ChannelMixKernel::Isa isa) {
+    switch (isa) {
+#if defined(MIXXX_CPU_X86)
+    case ChannelMixKernel::Isa::Sse2:
+        return mixLanesSse2;
+    case ChannelMixKernel::Isa::Avx2:
+        return mixLanesAvx2;
+#endif
+#if defined(MIXXX_CPU_NEON)
+    case ChannelMixKernel::Isa::Neon:
+        return mixLanesNeon;
+#endif
+    default:
+        return mixLanesScalar;
+    }
+}
+
+ChannelMixKernel::Isa detectIsa() {
+    if (CpuFeatures::hasAvx2()) {
+        return ChannelMixKernel::Isa::Avx2;
+    }
+    if (CpuFeatures::hasSse2()) {
+        return ChannelMixKernel::Isa::Sse2;
+    }
+    if (CpuFeatures::hasNeon()) {
+        return ChannelMixKernel::Isa::Neon;
+    }
+    return ChannelMixKernel::Isa::Generic;
+}
+
+} // anonymous namespace
+
+// static
+ChannelMixKernel::Isa ChannelMixKernel::isa() {
+    static const Isa s_isa = detectIsa();
+    return s_isa;
+}
+
+// static
+bool ChannelMixKernel::isSupported(Isa isa) {
+    switch (isa) {
+    case Isa::Generic:
+    case Isa::Sse2:
+    case Isa::Avx2:
+    case Isa::Neon:
+        return CpuFeatures::isSupported(isa);
+    case Isa::Avx512:
+        // Not implemented
+        return false;
+    }
+    return false;
+}
+
+// static
+void ChannelMixKernel::mixWithRampingGain(
+        Isa isa,
+        CSAMPLE* pOutput,
+        OutputMode outputMode,
+        const Input* pInputs,
+        int inputCount,
+        SINT numSamples) {
+    DEBUG_ASSERT(isSupported(isa));
+    DEBUG_ASSERT(numSamples % 2 == 0);
+    const MixLanesFunction mixLanes = mixLanesFunction(isa);
+    bool addToOutput = outputMode == OutputMode::Add;
+    Lane lanes[kMaxLanesPerPass];
+    int laneCount = 0;
+    for (int k = 0; k < inputCount; ++k) {
+        const Input& input = pInputs[k];
+        if (input.oldGain == CSAMPLE_GAIN_ZERO && input.newGain == CSAMPLE_GAIN_ZERO) {
+            // Same as SampleUtil::applyRampingGain() and
+            // SampleUtil::addWithRampingGain()
+            if (input.pWriteBack) {
+                SampleUtil::clear(input.pWriteBack, numSamples);
+            }
+            continue;
+        }
+        // Same calculation as in SampleUtil::addWithRampingGain()
+        const CSAMPLE_GAIN gainDelta = (input.newGain - input.oldGain) /
+                CSAMPLE_GAIN(numSamples / 2);
+        Lane& lane = lanes[laneCount++];
+        lane.pIn = input.pBuffer;
+        lane.pWriteBack = input.pWriteBack;
+        if (gainDelta != 0) {
+            lane.startGain = input.oldGain + gainDelta;
+            lane.gainDelta = gainDelta;
+        } else {
+            lane.startGain = input.oldGain;
+            lane.gainDelta = 0;
+        }
+        if (laneCount == kMaxLanesPerPass) {
+            mixLanes(pOutput, addToOutput, lanes, laneCount, numSamples);
+            addToOutput = true;
+            laneCount = 0;
+        }
+    }
+    if (laneCount > 0 || !addToOutput) {
+        mixLanes(pOutput, addToOutput, lanes, laneCount, numSamples);
+    }
+}
@@ -0,0 +1,62 @@
+#pragma once
+
+#include "util/cpufeatures.h"
+#include "util/types.h"
+
+// Mixes any number of stereo channel buffers with individual ramping gains
+// into an output buffer in a single pass over the output.
+//
+// The implementation is selected at runtime according to the instruction
+// sets supported by the CPU. The gain of each channel is ramped linearly
+// from the old to the new gain exactly like in
+// SampleUtil::addWithRampingGain(). All implementations produce the same
+// results as applying SampleUtil::addWithRampingGain() to each channel in
+// order, as long as the compiler does not contract multiplications and
+// additions into fused multiply-add instructions.
+class ChannelMixKernel {
+  public:
+    typedef CpuFeatures::Isa Isa;
+
+    struct Input {
+        const CSAMPLE* pBuffer;
+        // Optional: Receives the samples of pBuffer after applying the
+        // gain. May be equal to pBuffer for applying the gain in place.
+        CSAMPLE* pWriteBack;
+        CSAMPLE_GAIN oldGain;
+        CSAMPLE_GAIN newGain;
+    };
+
+    enum class OutputMode {
+        // Adds the mixed channels to the contents of the output buffer
+        Add,
+        // Replaces the contents of the output buffer
+        Replace,
+    };
+
+    // The best implementation that is supported by the CPU
+    static Isa isa();
+    // Returns true if an implementation for the given instruction set
+    // exists and is supported by the CPU
+    static bool isSupported(Isa isa);
+
+    // numSamples must be even. Channels with an old and new gain of 0 are
+    // skipped, their write back buffer is cleared.
+    static void mixWithRampingGain(
+            CSAMPLE* pOutput,
+            OutputMode outputMode,
+            const Input* pInputs,
+            int inputCount,
+            SINT numSamples) {
+        mixWithRampingGain(isa(), pOutput, outputMode, pInputs, inputCount, numSamples);
+    }
+
+    // Uses the given implementation, which must be supported. Only
+    // intended for testing and benchmarking.
+    static void mixWithRampingGain(
+            Isa isa,
+            CSAMPLE* pOutput,
+            OutputMode outputMode,
+            const Input* pInputs,
+            int inputCount,
+            SINT numSamples);
+};
@@ -0,0 +1,204 @@
+#include "engine/channelprocessorpool.h"
+
+#include "util/counter.h"
+#include "util/cpuaffinity.h"
+#include "util/logger.h"
+#include "util/math.h"
+#include "util/stat.h"
+#include "util/time.h"
+
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+#include <immintrin.h>
+#define MIXXX_SPIN_PAUSE() _mm_pause()
+#else
+#define MIXXX_SPIN_PAUSE()
+#endif
+
+namespace {
+
+mixxx::Logger kLogger("ChannelProcessorPool");
+
+// Enables the parallel processing of decks and samplers
+const ConfigKey kParallelChannelsConfigKey =
+        ConfigKey("[Master]", "parallel_channel_processing");
+
+// More threads than this do not pay off, because most of the time is
+// spent by only a few decks that are playing at the same time.
+constexpr int kMaxPoolThreads = 3;
+
+constexpr quint64 kClaimIndexMask = 0xffffffffULL;
+constexpr int kClaimGenerationShift = 32;
+
+const QString kBarrierWaitStatTag =
+        QStringLiteral("ChannelProcessorPool: barrier wait");
+
+// Waiting longer than this for the last channels indicates that the pool
+// thread that processes them has been preempted
+constexpr mixxx::Duration kMaxSpinDuration = mixxx::Duration::fromMicros(200);
+
+// Constructed once, so that counting in the audio callback does not allocate
+const Counter kBarrierSpinTimeoutCounter(
+        QStringLiteral("ChannelProcessorPool: barrier spin timeout"));
+
+} // anonymous namespace
+
+class ChannelProcessorPool::PoolThread : public QThread {
+  public:
+    explicit PoolThread(ChannelProcessorPool* pPool)
+            : m_pPool(pPool) {
+    }
+
+  protected:
+    void run() override {
+        m_pPool->runPoolThread();
+    }
+
+  private:
+    ChannelProcessorPool* const m_pPool;
+};
+
+// static
+int ChannelProcessorPool::threadCountFromConfig(const UserSettingsPointer& pConfig) {
+    if (!pConfig || !pConfig->getValue(kParallelChannelsConfigKey, false)) {
+        return 0;
+    }
+    // The callback thread itself processes channels, too. One core
+    // is left for the remaining threads of the application.
+    return math_clamp(
+            CpuAffinity::availableCpuCount() - 2, 0, kMaxPoolThreads);
+}
+
+ChannelProcessorPool::ChannelProcessorPool(int threadCount, int reservedCpu)
+        : m_reservedCpu(reservedCpu),
+          m_ppChannelInfos(nullptr),
+          m_iBufferSize(0),
+          m_bCollectFeatures(false),
+          m_channelCount(0),
+          m_claim(0),
+          m_processedCount(0),
+          m_bQuit(false) {
+    DEBUG_ASSERT(threadCount >= 0);
+    for (int i = 0; i < threadCount; ++i) {
+        m_threads.push_back(std::make_unique<PoolThread>(this));
+    }
+    kLogger.info()
+            << "Processing channels in parallel on"
+            << threadCount
+            << "additional threads";
+}
+
+ChannelProcessorPool::~ChannelProcessorPool() {
+    m_bQuit.store(true);
+    m_semaWake.release(threadCount());
+    for (const auto& pThread : m_threads) {
+        pThread->wait();
+    }
+}
+
+void ChannelProcessorPool::start(QThread::Priority priority) {
+    int threadIndex = 0;
+    for (const auto& pThread : m_threads) {
+        pThread->setObjectName(
+                QStringLiteral("ChannelProcessorPool %1").arg(++threadIndex));
+        pThread->start(priority);
+    }
+}
+
+void ChannelProcessorPool::startBatch(
+        EngineMaster::ChannelInfo* const* ppChannelInfos,
+        int channelCount,
+        int iBufferSize,
+        bool collectFeatures) {
+    DEBUG_ASSERT(channelCount >= 0);
+    // All channels of the previous batch have been processed and
+    // no pool thread is able to claim any channels at this point.
+    m_ppChannelInfos = ppChannelInfos;
+    m_iBufferSize = iBufferSize;
+    m_bCollectFeatures = collectFeatures;
+    m_channelCount.store(channelCount, std::memory_order_relaxed);
+    m_processedCount.store(0, std::memory_order_relaxed);
+    const quint64 generation =
+            (m_claim.load(std::memory_order_relaxed) >> kClaimGenerationShift) + 1;
+    // Publish the batch
+    m_claim.store(generation << kClaimGenerationShift, std::memory_order_release);
+    // The calling thread will process at least one channel by itself
+    const int wakeCount = math_min(channelCount - 1, threadCount());
+    if (wakeCount > 0) {
+        m_semaWake.release(wakeCount);
+    }
+}
+
+void ChannelProcessorPool::finishBatch() {
+    while (processNextChannel()) {
+    }
+    // Spin barrier
+    const int channelCount = m_channelCount.load(std::memory_order_relaxed);
+    if (m_processedCount.load(std::memory_order_acquire) < channelCount) {
+        const auto waitStart = mixxx::Time::elapsed();
+        bool spinTimedOut = false;
+        do {
+            if (!spinTimedOut) {
+                MIXXX_SPIN_PAUSE();
+                spinTimedOut = mixxx::Time::elapsed() - waitStart > kMaxSpinDuration;
+                if (spinTimedOut) {
+                    kBarrierSpinTimeoutCounter.increment();
+                }
+                continue;
+            }
+            // Channels that have not been claimed yet are processed on
+            // this thread. A channel that has already been claimed by a
+            // pool thread cannot be taken over, because processing is not
+            // reentrant. Instead the CPU is yielded to the preempted pool
+            // thread, which might be waiting for this very CPU.
+            if (!processNextChannel()) {
+                QThread::yieldCurrentThread();
+            }
+        } while (m_processedCount.load(std::memory_order_acquire) < channelCount);
+        Stat::track(kBarrierWaitStatTag,
+                Stat::DURATION_NANOSEC,
+                Stat::experimentFlags(Stat::COUNT | Stat::AVERAGE |
+                        Stat::MIN | Stat::MAX),
+                (mixxx::Time::elapsed() - waitStart).toIntegerNanos());
+    }
+}
+
+bool ChannelProcessorPool::processNextChannel() {
+    quint64 claim = m_claim.load(std::memory_order_acquire);
+    while (true) {
+        const int index = static_cast<int>(claim & kClaimIndexMask);
+        // The count might already belong to the next batch. Then the
+        // claim below will fail, because the generation has changed.
+        if (index >= m_channelCount.load(std::memory_order_relaxed)) {
+            return false;
+        }
+        if (m_claim.compare_exchange_weak(
+                    claim,
+                    claim + 1,
+                    std::memory_order_acquire,
+                    std::memory_order_acquire)) {
+            break;
+        }
+        // claim has been updated by the failed CAS, retry
+    }
+    EngineMaster::processChannel(
+            m_ppChannelInfos[claim & kClaimIndexMask],
+            m_iBufferSize,
+            m_bCollectFeatures);
+    m_processedCount.fetch_add(1, std::memory_order_release);
+    return true;
+}
+
+void ChannelProcessorPool::runPoolThread() {
+    if (m_reservedCpu >= 0) {
+        CpuAffinity::excludeCpuFromCurrentThread(m_reservedCpu);
+    }
+    while (true) {
+        // Wait for the next batch
+        m_semaWake.acquire();
+        if (m_bQuit.load()) {
+            return;
+        }
+        while (processNextChannel()) {
+        }
+    }
+}
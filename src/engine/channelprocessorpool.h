@@ -0,0 +1,99 @@
+#pragma once
+
+#include <QSemaphore>
+#include <QThread>
+#include <QtGlobal>
+#include <atomic>
+#include <memory>
+#include <vector>
+
+#include "engine/enginemaster.h"
+#include "preferences/usersettings.h"
+#include "util/class.h"
+
+// A pool of pre-spawned threads that process EngineChannels in parallel
+// during the audio callback.
+//
+// The callback thread publishes a batch of channels and then takes part in
+// processing them. Idle pool threads are woken up once per batch and claim
+// the remaining channels one by one. The callback thread returns only after
+// all channels of the batch have been processed. It spins while waiting for
+// the last channels instead of blocking, because the remaining time until
+// they are finished is usually much shorter than the latency of a context
+// switch. The spinning is bounded and the callback thread yields its CPU
+// if a pool thread takes too long, e.g. after it has been preempted.
+//
+// Only channels that do not share any state with other channels while
+// processing may be processed by the pool. See
+// EngineChannel::supportsParallelProcessing().
+class ChannelProcessorPool {
+  public:
+    // Returns the number of pool threads for the parallel engine mode
+    // according to the settings, 0 if parallel processing is disabled.
+    static int threadCountFromConfig(const UserSettingsPointer& pConfig);
+
+    // The reserved CPU (if any) is excluded from the pool threads
+    ChannelProcessorPool(int threadCount, int reservedCpu);
+    ~ChannelProcessorPool();
+
+    int threadCount() const {
+        return static_cast<int>(m_threads.size());
+    }
+
+    // Starts the pool threads
+    void start(QThread::Priority priority = QThread::TimeCriticalPriority);
+
+    // Publishes a batch of channels and wakes up the pool threads. Must
+    // only be called by the audio callback and must be followed by
+    // finishBatch(). The calling thread may process other channels that
+    // are not part of the batch in the meantime.
+    //
+    // If collectFeatures is true the features of each channel are updated
+    // after processing.
+    void startBatch(
+            EngineMaster::ChannelInfo* const* ppChannelInfos,
+            int channelCount,
+            int iBufferSize,
+            bool collectFeatures);
+
+    // Processes the remaining channels of the current batch on the calling
+    // thread and returns after each of them has been processed exactly once.
+    void finishBatch();
+
+  private:
+    class PoolThread;
+
+    void runPoolThread();
+
+    // Claims the next unprocessed channel of the current batch and
+    // processes it. Returns false if no channels are left.
+    bool processNextChannel();
+
+    const int m_reservedCpu;
+
+    std::vector<std::unique_ptr<PoolThread>> m_threads;
+
+    // The current batch. Only modified by the callback thread while no
+    // channels are claimed and read by the pool threads after they have
+    // successfully claimed a channel.
+    EngineMaster::ChannelInfo* const* m_ppChannelInfos;
+    int m_iBufferSize;
+    bool m_bCollectFeatures;
+
+    // The number of channels in the current batch
+    std::atomic<int> m_channelCount;
+
+    // The generation of the current batch (upper 32 bits) and the index
+    // of the next unclaimed channel (lower 32 bits). The generation ensures
+    // that a late pool thread cannot claim a channel of the next batch
+    // based on stale data.
+    std::atomic<quint64> m_claim;
+
+    // The number of channels of the current batch that have been processed
+    std::atomic<int> m_processedCount;
+
+    QSemaphore m_semaWake;
+    std::atomic<bool> m_bQuit;
+
+    DISALLOW_COPY_AND_ASSIGN(ChannelProcessorPool);
+};
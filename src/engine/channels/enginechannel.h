@@ -54,6 +54,15 @@ class EngineChannel : public EngineObject {
     virtual void collectFeatures(GroupFeatureState* pGroupFeatures) const = 0;
     virtual void postProcess(const int iBuffersize) = 0;
 
+    // Channels that do not share any state with other channels during
+    // process() and collectFeatures() may be processed concurrently with
+    // other channels in the parallel engine mode. Invoked once per callback
+    // on the engine thread before processing the channel, because the
+    // answer may change, e.g. when enabling sync.
+    virtual bool supportsParallelProcessing() {
+        return false;
+    }
+
     // TODO(XXX) This hack needs to be removed.
     virtual EngineBuffer* getEngineBuffer() {
         return NULL;
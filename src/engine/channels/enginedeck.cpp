@@ -48,6 +48,10 @@ EngineDeck::~EngineDeck() {
     delete m_pPregain;
 }
 
+bool EngineDeck::supportsParallelProcessing() {
+    return m_pBuffer->prepareParallelProcessing();
+}
+
 void EngineDeck::process(CSAMPLE* pOut, const int iBufferSize) {
     // Feed the incoming audio through if passthrough is active
     const CSAMPLE* sampleBuffer = m_sampleBuffer; // save pointer on stack
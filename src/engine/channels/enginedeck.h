@@ -35,6 +35,11 @@ class EngineDeck : public EngineChannel, public AudioDestination {
     virtual void collectFeatures(GroupFeatureState* pGroupFeatures) const;
     virtual void postProcess(const int iBufferSize);
 
+    // Decks only touch their own EngineBuffer and their pre-fader effect
+    // racks while processing, unless they interact with EngineSync. See
+    // EngineBuffer::prepareParallelProcessing().
+    bool supportsParallelProcessing() override;
+
     // TODO(XXX) This hack needs to be removed.
     virtual EngineBuffer* getEngineBuffer();
 
@@ -1209,7 +1209,7 @@ void CueControl::hintReader(HintVector* pHintList) {
     if (cuePoint >= 0) {
         cue_hint.frame = SampleUtil::floorPlayPosToFrame(m_pCuePoint->get());
         cue_hint.frameCount = Hint::kFrameCountForward;
-        cue_hint.priority = 10;
+        cue_hint.priority = Hint::kPriorityPrefetch;
         pHintList->append(cue_hint);
     }
 
@@ -1221,7 +1221,7 @@ void CueControl::hintReader(HintVector* pHintList) {
         if (position != Cue::kNoPosition) {
             cue_hint.frame = SampleUtil::floorPlayPosToFrame(position);
             cue_hint.frameCount = Hint::kFrameCountForward;
-            cue_hint.priority = 10;
+            cue_hint.priority = Hint::kPriorityPrefetch;
             pHintList->append(cue_hint);
         }
     }
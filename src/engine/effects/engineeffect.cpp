@@ -2,6 +2,7 @@
 
 #include "engine/engine.h"
 #include "util/defs.h"
+#include "util/math.h"
 #include "util/sample.h"
 
 EngineEffect::EngineEffect(EffectManifestPointer pManifest,
@@ -36,7 +37,11 @@ EngineEffect::EngineEffect(EffectManifestPointer pManifest,
     const mixxx::EngineParameters bufferParameters(
           mixxx::audio::SampleRate(96000),
           MAX_BUFFER_LEN / mixxx::kEngineChannelCount);
-    m_pProcessor->initialize(activeInputChannels, pEffectsManager, bufferParameters);
+    m_pProcessor->initialize(activeInputChannels,
+            pEffectsManager,
+            bufferParameters,
+            // Not chosen by the backend if the manifest has not been registered
+            math_max(pManifest->pooledInputChannels(), 0));
     m_effectRampsFromDry = pManifest->effectRampsFromDry();
 }
 
@@ -53,25 +58,23 @@ EngineEffect::~EngineEffect() {
     }
 }
 
-EffectState* EngineEffect::createState(const mixxx::EngineParameters& bufferParameters) {
-    if (!m_pProcessor) {
-        return new EffectState(bufferParameters);
+void EngineEffect::reserveStatesForInputChannel() {
+    if (m_pProcessor) {
+        m_pProcessor->reserveStatesForInputChannel();
     }
-    return m_pProcessor->createState(bufferParameters);
 }
 
-void EngineEffect::loadStatesForInputChannel(const ChannelHandle* inputChannel,
-    EffectStatesMap* pStatesMap) {
+void EngineEffect::loadStatesForInputChannel(const ChannelHandle* inputChannel) {
     if (kEffectDebugOutput) {
         qDebug() << "EngineEffect::loadStatesForInputChannel" << this
                  << "loading states for input" << *inputChannel;
     }
-    m_pProcessor->loadStatesForInputChannel(inputChannel, pStatesMap);
+    m_pProcessor->loadStatesForInputChannel(inputChannel);
 }
 
 // Called from the main thread for garbage collection after an input channel is disabled
-void EngineEffect::deleteStatesForInputChannel(const ChannelHandle* inputChannel) {
-    m_pProcessor->deleteStatesForInputChannel(inputChannel);
+void EngineEffect::releaseStatesForInputChannel(const ChannelHandle* inputChannel) {
+    m_pProcessor->releaseStatesForInputChannel(inputChannel);
 }
 
 bool EngineEffect::processEffectsRequest(EffectsRequest& message,
@@ -136,6 +139,12 @@ bool EngineEffect::processEffectsRequest(EffectsRequest& message,
     return false;
 }
 
+bool EngineEffect::isBypassedForChannel(const ChannelHandle& inputHandle,
+                                        const ChannelHandle& outputHandle) {
+    return m_effectEnableStateForChannelMatrix[inputHandle][outputHandle] ==
+            EffectEnableState::Disabled;
+}
+
 bool EngineEffect::process(const ChannelHandle& inputHandle,
                            const ChannelHandle& outputHandle,
                            const CSAMPLE* pInput, CSAMPLE* pOutput,
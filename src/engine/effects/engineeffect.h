@@ -32,16 +32,20 @@ class EngineEffect : public EffectsRequestHandler {
         return m_parametersById.value(id, NULL);
     }
 
-    EffectState* createState(const mixxx::EngineParameters& bufferParameters);
+    void reserveStatesForInputChannel();
 
-    void loadStatesForInputChannel(const ChannelHandle* inputChannel,
-      EffectStatesMap* pStatesMap);
-    void deleteStatesForInputChannel(const ChannelHandle* inputChannel);
+    void loadStatesForInputChannel(const ChannelHandle* inputChannel);
+    void releaseStatesForInputChannel(const ChannelHandle* inputChannel);
 
     bool processEffectsRequest(
         EffectsRequest& message,
         EffectsResponsePipe* pResponsePipe);
 
+    // Returns true if the effect is fully disabled for the given routing,
+    // so process() would not process it regardless of the chain's state.
+    bool isBypassedForChannel(const ChannelHandle& inputHandle,
+                              const ChannelHandle& outputHandle);
+
     bool process(const ChannelHandle& inputHandle, const ChannelHandle& outputHandle,
                  const CSAMPLE* pInput, CSAMPLE* pOutput,
                  const unsigned int numSamples,
@@ -1,6 +1,7 @@
 #include "engine/effects/engineeffectchain.h"
 
 #include "engine/effects/engineeffect.h"
+#include "engine/engine.h"
 #include "util/defs.h"
 #include "util/sample.h"
 
@@ -11,6 +12,7 @@ EngineEffectChain::EngineEffectChain(const QString& id,
           m_enableState(EffectEnableState::Enabled),
           m_mixMode(EffectChainMixMode::DrySlashWet),
           m_dMix(0),
+          m_maxOutputDelaySeconds(0.0),
           m_buffer1(MAX_BUFFER_LEN),
           m_buffer2(MAX_BUFFER_LEN) {
     // Try to prevent memory allocation.
@@ -49,6 +51,7 @@ bool EngineEffectChain::addEffect(EngineEffect* pEffect, int iIndex) {
         m_effects.append(NULL);
     }
     m_effects.replace(iIndex, pEffect);
+    updateMaxOutputDelay();
     return true;
 }
 
@@ -70,9 +73,27 @@ bool EngineEffectChain::removeEffect(EngineEffect* pEffect, int iIndex) {
     }
 
     m_effects.replace(iIndex, NULL);
+    updateMaxOutputDelay();
     return true;
 }
 
+void EngineEffectChain::updateMaxOutputDelay() {
+    // The delays of effects in series add up
+    m_maxOutputDelaySeconds = 0.0;
+    for (EngineEffect* pEffect : qAsConst(m_effects)) {
+        if (pEffect == nullptr) {
+            continue;
+        }
+        const double maxOutputDelaySeconds =
+                pEffect->getManifest()->maxOutputDelaySeconds();
+        if (maxOutputDelaySeconds < 0) {
+            m_maxOutputDelaySeconds = -1.0;
+            return;
+        }
+        m_maxOutputDelaySeconds += maxOutputDelaySeconds;
+    }
+}
+
 // this is called from the engine thread onCallbackStart()
 bool EngineEffectChain::updateParameters(const EffectsRequest& message) {
     // TODO(rryan): Parameter interpolation.
@@ -125,8 +146,7 @@ bool EngineEffectChain::processEffectsRequest(EffectsRequest& message,
                          << *message.EnableInputChannelForChain.pChannelHandle;
             }
             response.success = enableForInputChannel(
-                  message.EnableInputChannelForChain.pChannelHandle,
-                  message.EnableInputChannelForChain.pEffectStatesMapArray);
+                  message.EnableInputChannelForChain.pChannelHandle);
             break;
         case EffectsRequest::DISABLE_EFFECT_CHAIN_FOR_INPUT_CHANNEL:
             if (kEffectDebugOutput) {
@@ -145,8 +165,7 @@ bool EngineEffectChain::processEffectsRequest(EffectsRequest& message,
     return true;
 }
 
-bool EngineEffectChain::enableForInputChannel(const ChannelHandle* inputHandle,
-        EffectStatesMapArray* statesForEffectsInChain) {
+bool EngineEffectChain::enableForInputChannel(const ChannelHandle* inputHandle) {
     if (kEffectDebugOutput) {
         qDebug() << "EngineEffectChain::enableForInputChannel" << this << inputHandle;
     }
@@ -154,11 +173,7 @@ bool EngineEffectChain::enableForInputChannel(const ChannelHandle* inputHandle,
     for (auto&& outputChannelStatus : outputMap) {
         VERIFY_OR_DEBUG_ASSERT(outputChannelStatus.enableState !=
                 EffectEnableState::Enabled) {
-            for (auto&& pStatesMap : *statesForEffectsInChain) {
-                for (auto&& pState : pStatesMap) {
-                    delete pState;
-                }
-            }
+            // The reserved states remain in the pools of the effects
             return false;
         }
         outputChannelStatus.enableState = EffectEnableState::Enabling;
@@ -169,11 +184,7 @@ bool EngineEffectChain::enableForInputChannel(const ChannelHandle* inputHandle,
                 qDebug() << "EngineEffectChain::enableForInputChannel" << this
                          << "loading states for effect" << i;
             }
-            EffectStatesMap* pStatesMap = &(*statesForEffectsInChain)[i];
-            VERIFY_OR_DEBUG_ASSERT(pStatesMap) {
-                return false;
-            }
-            m_effects[i]->loadStatesForInputChannel(inputHandle, pStatesMap);
+            m_effects[i]->loadStatesForInputChannel(inputHandle);
         }
     }
     return true;
@@ -186,15 +197,15 @@ bool EngineEffectChain::disableForInputChannel(const ChannelHandle* inputHandle)
             outputChannelStatus.enableState = EffectEnableState::Disabling;
         }
     }
-    // Do not call deleteStatesForInputChannel here because the EngineEffects'
-    // process() method needs to run one last time before deleting the states.
-    // deleteStatesForInputChannel needs to be called from the main thread after
+    // Do not call releaseStatesForInputChannel here because the EngineEffects'
+    // process() method needs to run one last time before releasing the states.
+    // releaseStatesForInputChannel needs to be called from the main thread after
     // the successful EffectsResponse is returned by the MessagePipe FIFO.
     return true;
 }
 
 // Called from the main thread for garbage collection after an input channel is disabled
-void EngineEffectChain::deleteStatesForInputChannel(const ChannelHandle* inputChannel) {
+void EngineEffectChain::releaseStatesForInputChannel(const ChannelHandle* inputChannel) {
     // If an output channel is not presently being processed, for example when
     // PFL is not active, then process() cannot be relied upon to set this
     // chain's EffectEnableState from Disabling to Disabled. This must be done
@@ -214,7 +225,7 @@ void EngineEffectChain::deleteStatesForInputChannel(const ChannelHandle* inputCh
     }
     for (EngineEffect* pEffect : qAsConst(m_effects)) {
         if (pEffect != nullptr) {
-            pEffect->deleteStatesForInputChannel(inputChannel);
+            pEffect->releaseStatesForInputChannel(inputChannel);
         }
     }
 }
@@ -241,21 +252,14 @@ bool EngineEffectChain::process(const ChannelHandle& inputHandle,
     // when it gets the intermediate disabling signal.
 
     ChannelStatus& channelStatus = m_chainStatusForChannelMatrix[inputHandle][outputHandle];
-    EffectEnableState effectiveChainEnableState = channelStatus.enableState;
-
-    // If the channel is fully disabled, do not let intermediate
-    // enabling/disabing signals from the chain's enable switch override
-    // the channel's state.
-    if (effectiveChainEnableState != EffectEnableState::Disabled) {
-        if (m_enableState != EffectEnableState::Enabled) {
-            effectiveChainEnableState = m_enableState;
-        }
-    }
+    const EffectEnableState effectiveChainEnableState =
+            effectiveEnableState(channelStatus);
 
     CSAMPLE currentMixKnob = m_dMix;
     CSAMPLE lastCallbackMixKnob = channelStatus.oldMixKnob;
 
     bool processingOccured = false;
+    bool wetOutputIsSilent = true;
     if (effectiveChainEnableState != EffectEnableState::Disabled) {
         // Ramping code inside the effects need to access the original samples
         // after writing to the output buffer. This requires not to use the same buffer
@@ -309,6 +313,10 @@ bool EngineEffectChain::process(const ChannelHandle& inputHandle,
         }
 
         if (processingOccured) {
+            // Only measured while it is needed for bypassing silent input
+            wetOutputIsSilent = groupFeatures.is_silent &&
+                    SampleUtil::isSilent(pIntermediateInput, numSamples);
+
             // pIntermediateInput is the output of the last processed effect. It would be the
             // intermediate input of the next effect if there was one.
             if (m_mixMode == EffectChainMixMode::DrySlashWet) {
@@ -337,13 +345,73 @@ bool EngineEffectChain::process(const ChannelHandle& inputHandle,
         }
     }
 
-    channelStatus.oldMixKnob = currentMixKnob;
+    // Effects with a delayed output need to be processed for a while after
+    // their output has become silent, see isBypassedForChannel()
+    if (groupFeatures.is_silent && wetOutputIsSilent &&
+            effectiveChainEnableState == EffectEnableState::Enabled) {
+        channelStatus.silentSeconds += static_cast<double>(numSamples) /
+                mixxx::kEngineChannelCount / sampleRate;
+    } else {
+        channelStatus.silentSeconds = 0.0;
+    }
+
+    updateChannelStatus(&channelStatus);
+
+    return processingOccured;
+}
+
+EffectEnableState EngineEffectChain::effectiveEnableState(
+        const ChannelStatus& channelStatus) const {
+    // Compute the effective enable state from the channel input routing switch and
+    // the chain's enable state.
+    EffectEnableState effectiveChainEnableState = channelStatus.enableState;
+
+    // If the channel is fully disabled, do not let intermediate
+    // enabling/disabing signals from the chain's enable switch override
+    // the channel's state.
+    if (effectiveChainEnableState != EffectEnableState::Disabled) {
+        if (m_enableState != EffectEnableState::Enabled) {
+            effectiveChainEnableState = m_enableState;
+        }
+    }
+
+    // Like for the chain's enable switch, the disabling signal takes
+    // precedence over the enabling signal.
+    if (effectiveChainEnableState != EffectEnableState::Disabled) {
+        const EffectEnableState mixState = mixEnableState(channelStatus);
+        if (mixState == EffectEnableState::Disabled ||
+                mixState == EffectEnableState::Disabling) {
+            effectiveChainEnableState = mixState;
+        } else if (mixState == EffectEnableState::Enabling &&
+                effectiveChainEnableState != EffectEnableState::Disabling) {
+            effectiveChainEnableState = EffectEnableState::Enabling;
+        }
+    }
+    return effectiveChainEnableState;
+}
+
+EffectEnableState EngineEffectChain::mixEnableState(
+        const ChannelStatus& channelStatus) const {
+    // While the mix knob is ramping from or to fully dry, the wet signal
+    // is still audible. After it has been fully dry for a whole callback,
+    // the effects get a last disabling signal, which lets them clear their
+    // buffers, and are not processed until it is turned up again.
+    const bool wetIsAudible = m_dMix != 0 || channelStatus.oldMixKnob != 0;
+    if (channelStatus.mixMuted) {
+        return wetIsAudible ? EffectEnableState::Enabling : EffectEnableState::Disabled;
+    }
+    return wetIsAudible ? EffectEnableState::Enabled : EffectEnableState::Disabling;
+}
+
+void EngineEffectChain::updateChannelStatus(ChannelStatus* pChannelStatus) {
+    pChannelStatus->mixMuted = m_dMix == 0 && pChannelStatus->oldMixKnob == 0;
+    pChannelStatus->oldMixKnob = m_dMix;
 
     // If the EffectProcessors have been sent a signal for the intermediate
     // enabling/disabling state, set the channel state or chain state
     // to the fully enabled/disabled state for the next engine callback.
 
-    EffectEnableState& chainOnChannelEnableState = channelStatus.enableState;
+    EffectEnableState& chainOnChannelEnableState = pChannelStatus->enableState;
     if (chainOnChannelEnableState == EffectEnableState::Disabling) {
         chainOnChannelEnableState = EffectEnableState::Disabled;
     } else if (chainOnChannelEnableState == EffectEnableState::Enabling) {
@@ -355,6 +423,45 @@ bool EngineEffectChain::process(const ChannelHandle& inputHandle,
     } else if (m_enableState == EffectEnableState::Enabling) {
         m_enableState = EffectEnableState::Enabled;
     }
+}
 
-    return processingOccured;
+bool EngineEffectChain::areEffectsBypassedForChannel(const ChannelHandle& inputHandle,
+                                                     const ChannelHandle& outputHandle) {
+    for (EngineEffect* pEffect : qAsConst(m_effects)) {
+        if (pEffect != nullptr &&
+                !pEffect->isBypassedForChannel(inputHandle, outputHandle)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool EngineEffectChain::isBypassedForChannel(const ChannelHandle& inputHandle,
+                                             const ChannelHandle& outputHandle,
+                                             const GroupFeatureState& groupFeatures) {
+    const ChannelStatus& channelStatus =
+            m_chainStatusForChannelMatrix[inputHandle][outputHandle];
+    const EffectEnableState enableState = effectiveEnableState(channelStatus);
+    if (enableState == EffectEnableState::Disabled) {
+        return true;
+    }
+    if (areEffectsBypassedForChannel(inputHandle, outputHandle)) {
+        // process() would pass the input through, whatever the ramps are
+        return true;
+    }
+    if (enableState != EffectEnableState::Enabled) {
+        // The effects need to get the intermediate enabling/disabling signal
+        return false;
+    }
+    // The output of the effects has been silent for longer than they may
+    // delay their input, so their tails have ended.
+    return groupFeatures.is_silent &&
+            m_maxOutputDelaySeconds >= 0 &&
+            channelStatus.silentSeconds > m_maxOutputDelaySeconds;
+}
+
+void EngineEffectChain::bypass(const ChannelHandle& inputHandle,
+                               const ChannelHandle& outputHandle) {
+    ChannelStatus& channelStatus = m_chainStatusForChannelMatrix[inputHandle][outputHandle];
+    updateChannelStatus(&channelStatus);
 }
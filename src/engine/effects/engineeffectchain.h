@@ -32,22 +32,42 @@ class EngineEffectChain : public EffectsRequestHandler {
                  const unsigned int sampleRate,
                  const GroupFeatureState& groupFeatures);
 
+    // Returns true if process() would not process any effects for the
+    // given routing or if processing them would not make an audible
+    // difference. Then only bypass() needs to be invoked instead of
+    // process() and the input can be passed through unmodified.
+    bool isBypassedForChannel(const ChannelHandle& inputHandle,
+                              const ChannelHandle& outputHandle,
+                              const GroupFeatureState& groupFeatures);
+
+    // Updates the state of a bypassed chain like process() would do.
+    void bypass(const ChannelHandle& inputHandle,
+                const ChannelHandle& outputHandle);
+
     const QString& id() const {
         return m_id;
     }
 
     bool enabledForChannel(const ChannelHandle& handle) const;
 
-    void deleteStatesForInputChannel(const ChannelHandle* channel);
+    void releaseStatesForInputChannel(const ChannelHandle* channel);
 
   private:
     struct ChannelStatus {
         ChannelStatus()
                 : oldMixKnob(0),
-                  enableState(EffectEnableState::Disabled) {
+                  enableState(EffectEnableState::Disabled),
+                  mixMuted(true),
+                  silentSeconds(0.0) {
         }
         CSAMPLE oldMixKnob;
         EffectEnableState enableState;
+        // The mix knob has been fully dry during the last callback, so the
+        // effects have been disabled.
+        bool mixMuted;
+        // How long both the input and the wet output of the chain have been
+        // silent without interruption.
+        double silentSeconds;
     };
 
     QString debugString() const {
@@ -57,8 +77,7 @@ class EngineEffectChain : public EffectsRequestHandler {
     bool updateParameters(const EffectsRequest& message);
     bool addEffect(EngineEffect* pEffect, int iIndex);
     bool removeEffect(EngineEffect* pEffect, int iIndex);
-    bool enableForInputChannel(const ChannelHandle* inputHandle,
-            EffectStatesMapArray* statesForEffectsInChain);
+    bool enableForInputChannel(const ChannelHandle* inputHandle);
     bool disableForInputChannel(const ChannelHandle* inputHandle);
 
     // Gets or creates a ChannelStatus entry in m_channelStatus for the provided
@@ -66,11 +85,30 @@ class EngineEffectChain : public EffectsRequestHandler {
     ChannelStatus& getChannelStatus(const ChannelHandle& inputHandle,
                                     const ChannelHandle& outputHandle);
 
+    EffectEnableState effectiveEnableState(const ChannelStatus& channelStatus) const;
+
+    // The effects are disabled for a channel while the mix knob is fully
+    // dry, and enabled again when it is turned up.
+    EffectEnableState mixEnableState(const ChannelStatus& channelStatus) const;
+
+    // Returns true if all effects are fully disabled for the given routing
+    bool areEffectsBypassedForChannel(const ChannelHandle& inputHandle,
+                                      const ChannelHandle& outputHandle);
+
+    // Sums up the maxOutputDelaySeconds() of all loaded effects
+    void updateMaxOutputDelay();
+
+    // Finishes the processing of a callback for the channel
+    void updateChannelStatus(ChannelStatus* pChannelStatus);
+
     QString m_id;
     EffectEnableState m_enableState;
     EffectChainMixMode m_mixMode;
     CSAMPLE m_dMix;
     QList<EngineEffect*> m_effects;
+    // Negative if the effects may produce output at any time after their
+    // input has become silent
+    double m_maxOutputDelaySeconds;
     mixxx::SampleBuffer m_buffer1;
     mixxx::SampleBuffer m_buffer2;
     ChannelHandleMap<ChannelHandleMap<ChannelStatus>> m_chainStatusForChannelMatrix;
@@ -94,6 +94,28 @@ bool EngineEffectRack::process(const ChannelHandle& inputHandle,
     return processingOccured;
 }
 
+bool EngineEffectRack::isBypassedForChannel(const ChannelHandle& inputHandle,
+                                            const ChannelHandle& outputHandle,
+                                            const GroupFeatureState& groupFeatures) {
+    for (EngineEffectChain* pChain : qAsConst(m_chains)) {
+        if (pChain != nullptr &&
+                !pChain->isBypassedForChannel(
+                        inputHandle, outputHandle, groupFeatures)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void EngineEffectRack::bypass(const ChannelHandle& inputHandle,
+                              const ChannelHandle& outputHandle) {
+    for (EngineEffectChain* pChain : qAsConst(m_chains)) {
+        if (pChain != nullptr) {
+            pChain->bypass(inputHandle, outputHandle);
+        }
+    }
+}
+
 bool EngineEffectRack::addEffectChain(EngineEffectChain* pChain, int iIndex) {
     if (iIndex < 0) {
         if (kEffectDebugOutput) {
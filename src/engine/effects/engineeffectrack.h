@@ -26,6 +26,17 @@ class EngineEffectRack : public EffectsRequestHandler {
                  const unsigned int sampleRate,
                  const GroupFeatureState& groupFeatures);
 
+    // Returns true if none of the chains would process any effects
+    // or make an audible difference
+    bool isBypassedForChannel(const ChannelHandle& inputHandle,
+                              const ChannelHandle& outputHandle,
+                              const GroupFeatureState& groupFeatures);
+
+    // Updates the state of all chains after isBypassedForChannel()
+    // returned true.
+    void bypass(const ChannelHandle& inputHandle,
+                const ChannelHandle& outputHandle);
+
     int number() const {
         return m_iRackNumber;
     }
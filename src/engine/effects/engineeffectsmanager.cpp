@@ -168,6 +168,26 @@ void EngineEffectsManager::processPostFaderAndMix(
                  oldGain, newGain);
 }
 
+bool EngineEffectsManager::tryBypassPostFader(
+    const ChannelHandle& inputHandle,
+    const ChannelHandle& outputHandle,
+    const GroupFeatureState& groupFeatures) {
+    const QList<EngineEffectRack*>& racks =
+            m_racksByStage.value(SignalProcessingStage::Postfader);
+    for (EngineEffectRack* pRack : racks) {
+        if (pRack != nullptr &&
+                !pRack->isBypassedForChannel(inputHandle, outputHandle, groupFeatures)) {
+            return false;
+        }
+    }
+    for (EngineEffectRack* pRack : racks) {
+        if (pRack != nullptr) {
+            pRack->bypass(inputHandle, outputHandle);
+        }
+    }
+    return true;
+}
+
 void EngineEffectsManager::processInner(
     const SignalProcessingStage stage,
     const ChannelHandle& inputHandle,
@@ -54,6 +54,17 @@ class EngineEffectsManager : public EffectsRequestHandler {
         const CSAMPLE_GAIN oldGain = CSAMPLE_GAIN_ONE,
         const CSAMPLE_GAIN newGain = CSAMPLE_GAIN_ONE);
 
+    // Returns true if no post-fader effects would be processed for the
+    // given routing. Then the state of all post-fader effect chains is
+    // updated and the caller is responsible to apply the gain and to mix
+    // the channel instead of invoking processPostFaderInPlace() or
+    // processPostFaderAndMix(). Otherwise nothing is modified and false
+    // is returned.
+    bool tryBypassPostFader(
+        const ChannelHandle& inputHandle,
+        const ChannelHandle& outputHandle,
+        const GroupFeatureState& groupFeatures);
+
     bool processEffectsRequest(
         EffectsRequest& message,
         EffectsResponsePipe* pResponsePipe);
@@ -9,7 +9,8 @@ struct GroupFeatureState {
               has_beat_fraction(false),
               beat_fraction(0.0),
               has_gain(false),
-              gain(1.0) {
+              gain(1.0),
+              is_silent(false) {
     }
 
     // The beat length in seconds.
@@ -23,4 +24,8 @@ struct GroupFeatureState {
 
     bool has_gain;
     double gain;
+
+    // True if the buffer of the group contains only silence. Effects that
+    // have no audible tail do not need to be processed then.
+    bool is_silent;
 };
@@ -65,20 +65,6 @@ struct EffectsRequest {
 #undef CLEAR_STRUCT
     }
 
-    // This is called from the main thread by EffectsManager after receiving a
-    // response from EngineEffectsManager in the audio engine thread.
-    ~EffectsRequest() {
-        if (type == ENABLE_EFFECT_CHAIN_FOR_INPUT_CHANNEL) {
-            VERIFY_OR_DEBUG_ASSERT(EnableInputChannelForChain.pEffectStatesMapArray != nullptr) {
-                return;
-            }
-            // This only deletes the container used to passed the EffectStates
-            // to EffectProcessorImpl. The EffectStates are managed by
-            // EffectProcessorImpl.
-            delete EnableInputChannelForChain.pEffectStatesMapArray;
-        }
-    }
-
     MessageType type;
     qint64 request_id;
 
@@ -119,7 +105,7 @@ struct EffectsRequest {
             int iIndex;
         } RemoveChainFromRack;
         struct {
-            EffectStatesMapArray* pEffectStatesMapArray;
+            // The EffectStates are acquired from the pools of the effects
             const ChannelHandle* pChannelHandle;
         } EnableInputChannelForChain;
         struct {
@@ -10,6 +10,7 @@
 #include "control/controlpushbutton.h"
 #include "engine/bufferscalers/enginebufferscalelinear.h"
 #include "engine/bufferscalers/enginebufferscalerubberband.h"
+#include "engine/bufferscalers/enginebufferscalerubberbandthreaded.h"
 #include "engine/bufferscalers/enginebufferscalest.h"
 #include "engine/cachingreader/cachingreader.h"
 #include "engine/channels/enginechannel.h"
@@ -89,6 +90,7 @@ EngineBuffer::EngineBuffer(const QString& group,
           m_iSeekPhaseQueued(0),
           m_iEnableSyncQueued(SYNC_REQUEST_NONE),
           m_iSyncModeQueued(SYNC_INVALID),
+          m_bDeferSyncRequests(false),
           m_iTrackLoading(0),
           m_bPlayAfterLoading(false),
           m_iSampleRate(0),
@@ -257,11 +259,8 @@ EngineBuffer::EngineBuffer(const QString& group,
     m_pScaleLinear = new EngineBufferScaleLinear(m_pReadAheadManager);
     m_pScaleST = new EngineBufferScaleST(m_pReadAheadManager);
     m_pScaleRB = new EngineBufferScaleRubberBand(m_pReadAheadManager);
-    if (m_pKeylockEngine->get() == SOUNDTOUCH) {
-        m_pScaleKeylock = m_pScaleST;
-    } else {
-        m_pScaleKeylock = m_pScaleRB;
-    }
+    m_pScaleRBThreaded = new EngineBufferScaleRubberBandThreaded(m_pReadAheadManager);
+    selectKeylockEngine(m_pKeylockEngine->get());
     m_pScaleVinyl = m_pScaleLinear;
     m_pScale = m_pScaleVinyl;
     m_pScale->clear();
@@ -312,6 +311,7 @@ EngineBuffer::~EngineBuffer() {
     delete m_pScaleLinear;
     delete m_pScaleST;
     delete m_pScaleRB;
+    delete m_pScaleRBThreaded;
 
     delete m_pKeylock;
     delete m_pEject;
@@ -338,6 +338,14 @@ void EngineBuffer::enableIndependentPitchTempoScaling(bool bEnable,
     EngineBufferScale* keylock_scale = m_pScaleKeylock;
     EngineBufferScale* vinyl_scale = m_pScaleVinyl;
 
+    if (bEnable && keylock_scale == m_pScaleRBThreaded &&
+            !m_pScaleRBThreaded->isWorkerRunning()) {
+        // The worker thread is only started for the decks that use keylock.
+        // Until it is running RubberBand processes in the callback.
+        m_pScaleRBThreaded->requestWorker();
+        keylock_scale = m_pScaleRB;
+    }
+
     if (bEnable && m_pScale != keylock_scale) {
         if (m_speed_old != 0.0) {
             // Crossfade if we are not paused.
@@ -763,11 +771,17 @@ void EngineBuffer::slotKeylockEngineChanged(double dIndex) {
     if (m_bScalerOverride) {
         return;
     }
+    selectKeylockEngine(dIndex);
+}
+
+void EngineBuffer::selectKeylockEngine(double dIndex) {
     // static_cast<KeylockEngine>(dIndex); direct cast produces a "not used" warning with gcc
     int iEngine = static_cast<int>(dIndex);
     KeylockEngine engine = static_cast<KeylockEngine>(iEngine);
     if (engine == SOUNDTOUCH) {
         m_pScaleKeylock = m_pScaleST;
+    } else if (engine == RUBBERBAND_THREADED) {
+        m_pScaleKeylock = m_pScaleRBThreaded;
     } else {
         m_pScaleKeylock = m_pScaleRB;
     }
@@ -786,7 +800,9 @@ void EngineBuffer::processTrackLocked(
     }
 
     // Sync requests can affect rate, so process those first.
-    processSyncRequests();
+    if (!m_bDeferSyncRequests) {
+        processSyncRequests();
+    }
 
     // Note: play is also active during cue preview
     bool paused = !m_playButton->toBool();
@@ -1106,6 +1122,7 @@ void EngineBuffer::process(CSAMPLE* pOutput, const int iBufferSize) {
     m_pScaleLinear->setSampleRate(sampleRate);
     m_pScaleST->setSampleRate(sampleRate);
     m_pScaleRB->setSampleRate(sampleRate);
+    m_pScaleRBThreaded->setSampleRate(sampleRate);
 
     bool bTrackLoading = atomicLoadRelaxed(m_iTrackLoading) != 0;
     if (!bTrackLoading && m_pause.tryLock()) {
@@ -1150,6 +1167,8 @@ void EngineBuffer::process(CSAMPLE* pOutput, const int iBufferSize) {
 
     m_iLastBufferSize = iBufferSize;
     m_bCrossfadeReady = false;
+    // Only valid for a single callback
+    m_bDeferSyncRequests = false;
 }
 
 void EngineBuffer::processSlip(int iBufferSize) {
@@ -1175,6 +1194,14 @@ void EngineBuffer::processSlip(int iBufferSize) {
     }
 }
 
+bool EngineBuffer::prepareParallelProcessing() {
+    m_bDeferSyncRequests =
+            !m_pSyncControl->isSynchronized() &&
+            atomicLoadRelaxed(m_iEnableSyncQueued) == SYNC_REQUEST_NONE &&
+            atomicLoadRelaxed(m_iSyncModeQueued) == SYNC_INVALID;
+    return m_bDeferSyncRequests;
+}
+
 void EngineBuffer::processSyncRequests() {
     SyncRequestQueued enable_request =
             static_cast<SyncRequestQueued>(
@@ -1356,7 +1383,7 @@ void EngineBuffer::hintReader(const double dRate) {
     if (m_bSlipEnabledProcessing) {
         Hint hint;
         hint.frame = SampleUtil::floorPlayPosToFrame(m_dSlipPosition);
-        hint.priority = 1;
+        hint.priority = Hint::kPriorityPlayPosition;
         if (m_dSlipRate >= 0) {
             hint.frameCount = Hint::kFrameCountForward;
         } else {
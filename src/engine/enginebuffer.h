@@ -42,6 +42,7 @@ class EngineBufferScale;
 class EngineBufferScaleLinear;
 class EngineBufferScaleST;
 class EngineBufferScaleRubberBand;
+class EngineBufferScaleRubberBandThreaded;
 class EngineSync;
 class EngineWorkerScheduler;
 class VisualPlayPosition;
@@ -86,6 +87,7 @@ class EngineBuffer : public EngineObject {
     enum KeylockEngine {
         SOUNDTOUCH,
         RUBBERBAND,
+        RUBBERBAND_THREADED,
         KEYLOCK_ENGINE_COUNT,
     };
 
@@ -123,6 +125,12 @@ class EngineBuffer : public EngineObject {
     void processSlip(int iBufferSize);
     void postProcess(const int iBufferSize);
 
+    // Returns true if the next call of process() does not interact with
+    // EngineSync and may run concurrently with other decks. Sync requests
+    // that are queued afterwards are deferred until the next callback, in
+    // which the deck is processed on the engine thread again.
+    bool prepareParallelProcessing();
+
     /// Return true iff a seek is currently queued but not yet processed
     /// If no seek was queued, the seek position is set to -1
     bool getQueuedSeekPosition(double* pSeekPosition) const;
@@ -152,6 +160,8 @@ class EngineBuffer : public EngineObject {
             return tr("Soundtouch (faster)");
         case RUBBERBAND:
             return tr("Rubberband (better)");
+        case RUBBERBAND_THREADED:
+            return tr("Rubberband (better, on a separate thread)");
         default:
             return tr("Unknown (bad value)");
         }
@@ -195,6 +205,9 @@ class EngineBuffer : public EngineObject {
     // must not be called outside the Constructor
     void addControl(EngineControl* pControl);
 
+    // Selects the keylock scaler for the value of [Master],keylock_engine
+    void selectKeylockEngine(double dIndex);
+
     void enableIndependentPitchTempoScaling(bool bEnable,
                                             const int iBufferSize);
 
@@ -368,6 +381,7 @@ class EngineBuffer : public EngineObject {
     // Objects used for pitch-indep time stretch (key lock) scaling of the audio
     EngineBufferScaleST* m_pScaleST;
     EngineBufferScaleRubberBand* m_pScaleRB;
+    EngineBufferScaleRubberBandThreaded* m_pScaleRBThreaded;
 
     // Indicates whether the scaler has changed since the last process()
     bool m_bScalerChanged;
@@ -378,6 +392,8 @@ class EngineBuffer : public EngineObject {
     QAtomicInt m_iSeekPhaseQueued;
     QAtomicInt m_iEnableSyncQueued;
     QAtomicInt m_iSyncModeQueued;
+    // Set while the deck is processed concurrently with other decks
+    bool m_bDeferSyncRequests;
     ControlValueAtomic<double> m_queuedSeekPosition;
     QAtomicPointer<EngineChannel> m_pChannelToCloneFrom;
 
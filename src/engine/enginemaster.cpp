@@ -9,6 +9,7 @@
 #include "control/controlpushbutton.h"
 #include "effects/effectsmanager.h"
 #include "engine/channelmixer.h"
+#include "engine/channelprocessorpool.h"
 #include "engine/channels/enginechannel.h"
 #include "engine/channels/enginedeck.h"
 #include "engine/effects/engineeffectsmanager.h"
@@ -63,9 +64,16 @@ EngineMaster::EngineMaster(
     m_bBusOutputConnected[EngineChannel::CENTER] = false;
     m_bBusOutputConnected[EngineChannel::RIGHT] = false;
     m_bExternalRecordBroadcastInputConnected = false;
-    m_pWorkerScheduler = new EngineWorkerScheduler(this);
+    m_pWorkerScheduler = new EngineWorkerScheduler(this, pConfig);
     m_pWorkerScheduler->start(QThread::HighPriority);
 
+    m_pChannelProcessorPool = nullptr;
+    const int channelProcessorThreadCount =
+            ChannelProcessorPool::threadCountFromConfig(pConfig);
+    if (channelProcessorThreadCount > 0) {
+        startChannelProcessorPool(channelProcessorThreadCount);
+    }
+
     // Master sample rate
     m_pMasterSampleRate = new ControlObject(ConfigKey(group, "samplerate"), true, true);
     m_pMasterSampleRate->set(44100.);
@@ -195,6 +203,7 @@ EngineMaster::EngineMaster(
 
 EngineMaster::~EngineMaster() {
     //qDebug() << "in ~EngineMaster()";
+    delete m_pChannelProcessorPool;
     delete m_pKeylockEngine;
     delete m_pCrossfader;
     delete m_pBalance;
@@ -353,17 +362,14 @@ void EngineMaster::processChannels(int iBufferSize) {
     }
 
     // Now that the list is built and ordered, do the processing.
-    for (int i = activeChannelsStartIndex;
-             i < m_activeChannels.size(); ++i) {
-        ChannelInfo* pChannelInfo = m_activeChannels[i];
-        EngineChannel* pChannel = pChannelInfo->m_pChannel;
-        pChannel->process(pChannelInfo->m_pBuffer, iBufferSize);
-
-        // Collect metadata for effects
-        if (m_pEngineEffectsManager) {
-            GroupFeatureState features;
-            pChannel->collectFeatures(&features);
-            pChannelInfo->m_features = features;
+    if (m_pChannelProcessorPool) {
+        processActiveChannelsInParallel(activeChannelsStartIndex, iBufferSize);
+    } else {
+        for (int i = activeChannelsStartIndex;
+                 i < m_activeChannels.size(); ++i) {
+            processChannel(m_activeChannels[i],
+                    iBufferSize,
+                    m_pEngineEffectsManager != nullptr);
         }
     }
 
@@ -381,6 +387,68 @@ void EngineMaster::processChannels(int iBufferSize) {
     }
 }
 
+// static
+void EngineMaster::processChannel(
+        ChannelInfo* pChannelInfo, int iBufferSize, bool collectFeatures) {
+    EngineChannel* pChannel = pChannelInfo->m_pChannel;
+    pChannel->process(pChannelInfo->m_pBuffer, iBufferSize);
+
+    // Collect metadata for effects
+    if (collectFeatures) {
+        GroupFeatureState features;
+        pChannel->collectFeatures(&features);
+        features.is_silent = SampleUtil::isSilent(pChannelInfo->m_pBuffer, iBufferSize);
+        pChannelInfo->m_features = features;
+    }
+}
+
+void EngineMaster::startChannelProcessorPool(int threadCount) {
+    VERIFY_OR_DEBUG_ASSERT(!m_pChannelProcessorPool) {
+        return;
+    }
+    m_pChannelProcessorPool = new ChannelProcessorPool(
+            threadCount,
+            m_pWorkerScheduler->reservedCpu());
+    m_pChannelProcessorPool->start();
+}
+
+void EngineMaster::processActiveChannelsInParallel(
+        int activeChannelsStartIndex, int iBufferSize) {
+    int i = activeChannelsStartIndex;
+    if (i == 0) {
+        // The sync master must be processed before all other channels
+        processChannel(m_activeChannels[0],
+                iBufferSize,
+                m_pEngineEffectsManager != nullptr);
+        i = 1;
+    }
+    // Each channel is asked only once, because the answer might change
+    // concurrently
+    m_parallelChannels.clear();
+    m_serialChannels.clear();
+    for (; i < m_activeChannels.size(); ++i) {
+        ChannelInfo* pChannelInfo = m_activeChannels[i];
+        if (pChannelInfo->m_pChannel->supportsParallelProcessing()) {
+            m_parallelChannels.append(pChannelInfo);
+        } else {
+            m_serialChannels.append(pChannelInfo);
+        }
+    }
+    m_pChannelProcessorPool->startBatch(
+            m_parallelChannels.constData(),
+            m_parallelChannels.size(),
+            iBufferSize,
+            m_pEngineEffectsManager != nullptr);
+    // Process all remaining channels in this thread while the
+    // pool is busy with the batch.
+    for (ChannelInfo* pChannelInfo : qAsConst(m_serialChannels)) {
+        processChannel(pChannelInfo,
+                iBufferSize,
+                m_pEngineEffectsManager != nullptr);
+    }
+    m_pChannelProcessorPool->finishBatch();
+}
+
 void EngineMaster::process(const int iBufferSize) {
     static bool haveSetName = false;
     if (!haveSetName) {
@@ -819,6 +887,8 @@ void EngineMaster::addChannel(EngineChannel* pChannel) {
     m_activeBusChannels[EngineChannel::RIGHT].reserve(m_channels.size());
     m_activeHeadphoneChannels.reserve(m_channels.size());
     m_activeTalkoverChannels.reserve(m_channels.size());
+    m_parallelChannels.reserve(m_channels.size());
+    m_serialChannels.reserve(m_channels.size());
 
     EngineBuffer* pBuffer = pChannelInfo->m_pChannel->getEngineBuffer();
     if (pBuffer != nullptr) {
@@ -857,6 +927,16 @@ const CSAMPLE* EngineMaster::getChannelBuffer(const QString& group) const {
     return nullptr;
 }
 
+const GroupFeatureState* EngineMaster::getChannelFeatures(const QString& group) const {
+    for (int i = 0; i < m_channels.size(); ++i) {
+        const ChannelInfo* pChannelInfo = m_channels[i];
+        if (pChannelInfo->m_pChannel->getGroup() == group) {
+            return &pChannelInfo->m_features;
+        }
+    }
+    return nullptr;
+}
+
 const CSAMPLE* EngineMaster::buffer(const AudioOutput& output) const {
     switch (output.getType()) {
     case AudioOutput::MASTER:
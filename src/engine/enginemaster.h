@@ -13,6 +13,7 @@
 #include "soundio/soundmanagerutil.h"
 #include "recording/recordingmanager.h"
 
+class ChannelProcessorPool;
 class EngineWorkerScheduler;
 class EngineBuffer;
 class EngineChannel;
@@ -99,6 +100,7 @@ class EngineMaster : public QObject, public AudioSource {
     const CSAMPLE* getOutputBusBuffer(unsigned int i) const;
     const CSAMPLE* getDeckBuffer(unsigned int i) const;
     const CSAMPLE* getChannelBuffer(const QString& name) const;
+    const GroupFeatureState* getChannelFeatures(const QString& name) const;
     const CSAMPLE* getSidechainBuffer() const;
 
     EngineSideChain* getSideChain() const {
@@ -122,6 +124,15 @@ class EngineMaster : public QObject, public AudioSource {
         int m_index;
     };
 
+    // Processes a single channel into its buffer. If collectFeatures is
+    // true the features of the channel that are needed by effects are
+    // updated afterwards. Shared by the engine thread and the threads of
+    // ChannelProcessorPool.
+    static void processChannel(
+            ChannelInfo* pChannelInfo,
+            int iBufferSize,
+            bool collectFeatures);
+
     struct GainCache {
         CSAMPLE m_gain;
         bool m_fadeout;
@@ -250,6 +261,10 @@ class EngineMaster : public QObject, public AudioSource {
     ControlObject* m_pHeadphoneEnabled;
     ControlObject* m_pBoothEnabled;
 
+    // Enables the parallel engine mode. Only invoked from the constructor
+    // and by tests, before processing any channels.
+    void startChannelProcessorPool(int threadCount);
+
   private:
     // Processes active channels. The master sync channel (if any) is processed
     // first and all others are processed after. Populates m_activeChannels,
@@ -257,6 +272,10 @@ class EngineMaster : public QObject, public AudioSource {
     // m_activeTalkoverChannels with each channel that is active for the
     // respective output.
     void processChannels(int iBufferSize);
+    // Processes the active channels with the help of m_pChannelProcessorPool.
+    // The sync master (if any) is processed first, then all channels that
+    // support parallel processing are processed concurrently.
+    void processActiveChannelsInParallel(int activeChannelsStartIndex, int iBufferSize);
 
     ChannelHandleFactoryPointer m_pChannelHandleFactory;
     void applyMasterEffects();
@@ -279,6 +298,12 @@ class EngineMaster : public QObject, public AudioSource {
     QVarLengthArray<ChannelInfo*, kPreallocatedChannels> m_activeBusChannels[3];
     QVarLengthArray<ChannelInfo*, kPreallocatedChannels> m_activeHeadphoneChannels;
     QVarLengthArray<ChannelInfo*, kPreallocatedChannels> m_activeTalkoverChannels;
+    // The active channels without the sync master that are processed
+    // by m_pChannelProcessorPool in the parallel engine mode.
+    QVarLengthArray<ChannelInfo*, kPreallocatedChannels> m_parallelChannels;
+    // The remaining active channels that are processed by the engine thread
+    // while the pool is busy, e.g. decks that interact with EngineSync.
+    QVarLengthArray<ChannelInfo*, kPreallocatedChannels> m_serialChannels;
 
     unsigned int m_iSampleRate;
     unsigned int m_iBufferSize;
@@ -292,6 +317,8 @@ class EngineMaster : public QObject, public AudioSource {
     CSAMPLE* m_pSidechainMix;
 
     EngineWorkerScheduler* m_pWorkerScheduler;
+    // nullptr unless the parallel engine mode is enabled
+    ChannelProcessorPool* m_pChannelProcessorPool;
     EngineSync* m_pMasterSync;
 
     ControlObject* m_pMasterGain;
@@ -2,10 +2,15 @@
 
 #include "engine/engineworkerscheduler.h"
 #include "moc_engineworker.cpp"
+#include "util/cpuaffinity.h"
+#include "util/stat.h"
+#include "util/time.h"
 
 EngineWorker::EngineWorker()
-    : m_pScheduler(nullptr) {
-    m_notReady.test_and_set();
+        : m_pScheduler(nullptr),
+          m_ready(false),
+          m_readySinceNanos(0),
+          m_workerThreadInitialized(false) {
 }
 
 EngineWorker::~EngineWorker() {
@@ -21,15 +26,50 @@ void EngineWorker::setScheduler(EngineWorkerScheduler* pScheduler) {
 }
 
 void EngineWorker::workReady() {
-    m_notReady.clear();
     VERIFY_OR_DEBUG_ASSERT(m_pScheduler) {
-        return;     
+        return;
+    }
+    // Only queue the worker if it has not been ready before
+    if (!m_ready.exchange(true)) {
+        m_readySinceNanos.store(
+                mixxx::Time::elapsed().toIntegerNanos(),
+                std::memory_order_relaxed);
+        if (!m_pScheduler->workerReady(this)) {
+            // Allow the next call to queue the worker again
+            m_readySinceNanos.store(0, std::memory_order_relaxed);
+            m_ready.store(false);
+        }
     }
-    m_pScheduler->workerReady();
 }
 
 void EngineWorker::wakeIfReady() {
-    if (!m_notReady.test_and_set()) {
+    if (m_ready.exchange(false)) {
         m_semaRun.release();
     }
 }
+
+void EngineWorker::initWorkerThread() {
+    m_workerThreadInitialized = true;
+    m_wakeLatencyStatTag = QStringLiteral("EngineWorker wake latency ") +
+            QThread::currentThread()->objectName();
+    if (m_pScheduler && m_pScheduler->reservedCpu() >= 0) {
+        CpuAffinity::excludeCpuFromCurrentThread(m_pScheduler->reservedCpu());
+    }
+}
+
+void EngineWorker::waitForWork() {
+    DEBUG_ASSERT(QThread::currentThread() == this);
+    m_semaRun.acquire();
+    if (!m_workerThreadInitialized) {
+        initWorkerThread();
+    }
+    const qint64 readySinceNanos =
+            m_readySinceNanos.exchange(0, std::memory_order_relaxed);
+    if (readySinceNanos > 0) {
+        Stat::track(m_wakeLatencyStatTag,
+                Stat::DURATION_NANOSEC,
+                Stat::experimentFlags(Stat::COUNT | Stat::AVERAGE |
+                        Stat::SAMPLE_VARIANCE | Stat::MIN | Stat::MAX),
+                mixxx::Time::elapsed().toIntegerNanos() - readySinceNanos);
+    }
+}
@@ -3,6 +3,7 @@
 #include <atomic>
 #include <QObject>
 #include <QSemaphore>
+#include <QString>
 #include <QThread>
 
 // EngineWorker is an interface for running background processing work when the
@@ -25,9 +26,24 @@ class EngineWorker : public QThread {
     void wakeIfReady();
 
   protected:
+    // Blocks the worker thread until it is woken up by the scheduler or
+    // by releasing m_semaRun directly. Must only be called from run().
+    // Reports the latency between workReady() and the actual wake up
+    // of the worker thread.
+    void waitForWork();
+
     QSemaphore m_semaRun;
 
   private:
+    // Applies the CPU affinity of the scheduler to the worker thread
+    void initWorkerThread();
+
     EngineWorkerScheduler* m_pScheduler;
-    std::atomic_flag m_notReady;
+    std::atomic<bool> m_ready;
+
+    // Time when the worker became ready, 0 if not ready
+    std::atomic<qint64> m_readySinceNanos;
+
+    bool m_workerThreadInitialized;
+    QString m_wakeLatencyStatTag;
 };
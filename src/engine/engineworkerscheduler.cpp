@@ -4,57 +4,152 @@
 
 #include "engine/engineworker.h"
 #include "moc_engineworkerscheduler.cpp"
+#include "util/cpuaffinity.h"
 #include "util/event.h"
+#include "util/logger.h"
+#include "util/math.h"
 
-EngineWorkerScheduler::EngineWorkerScheduler(QObject* pParent)
-        : m_bWakeScheduler(false),
+namespace {
+
+mixxx::Logger kLogger("EngineWorkerScheduler");
+
+// Reserves a CPU core for the audio callback, -1 = disabled.
+const ConfigKey kReservedCpuConfigKey =
+        ConfigKey("[Master]", "engine_worker_reserved_cpu");
+
+// Waking up a worker is cheap. A few scheduler threads are sufficient
+// to wake up all workers at once without delay.
+constexpr int kMaxSchedulerThreads = 4;
+
+} // anonymous namespace
+
+class EngineWorkerScheduler::SchedulerThread : public QThread {
+  public:
+    explicit SchedulerThread(EngineWorkerScheduler* pScheduler)
+            : m_pScheduler(pScheduler) {
+    }
+
+  protected:
+    void run() override {
+        m_pScheduler->runSchedulerThread();
+    }
+
+  private:
+    EngineWorkerScheduler* const m_pScheduler;
+};
+
+// static
+int EngineWorkerScheduler::reservedCpuFromConfig(const UserSettingsPointer& pConfig) {
+    if (!pConfig) {
+        return -1;
+    }
+    const int reservedCpu = pConfig->getValue(kReservedCpuConfigKey, -1);
+    if (reservedCpu >= CpuAffinity::availableCpuCount()) {
+        kLogger.warning()
+                << "Ignoring invalid reserved CPU"
+                << reservedCpu;
+        return -1;
+    }
+    return math_max(reservedCpu, -1);
+}
+
+EngineWorkerScheduler::EngineWorkerScheduler(
+        QObject* pParent,
+        UserSettingsPointer pConfig)
+        : QObject(pParent),
+          m_reservedCpu(reservedCpuFromConfig(pConfig)),
+          m_bWakeScheduler(false),
+          m_readyWorkerQueueCount(1),
+          m_workerCount(0),
           m_bQuit(false) {
-    Q_UNUSED(pParent);
+    m_readyWorkerQueues[0] =
+            std::make_unique<mixxx::MpmcQueue<EngineWorker*>>(MAX_ENGINE_WORKERS);
+    const int threadCount = math_clamp(
+            CpuAffinity::availableCpuCount() - 1, 1, kMaxSchedulerThreads);
+    for (int i = 0; i < threadCount; ++i) {
+        m_schedulerThreads.push_back(std::make_unique<SchedulerThread>(this));
+    }
+    if (m_reservedCpu >= 0) {
+        kLogger.info()
+                << "Reserving CPU"
+                << m_reservedCpu
+                << "for the audio callback";
+    }
 }
 
 EngineWorkerScheduler::~EngineWorkerScheduler() {
-    m_bQuit = true;
-    m_waitCondition.wakeAll();
-    wait();
+    m_bQuit.store(true);
+    m_semaWake.release(static_cast<int>(m_schedulerThreads.size()));
+    for (const auto& pThread : m_schedulerThreads) {
+        pThread->wait();
+    }
 }
 
-void EngineWorkerScheduler::workerReady() {
-    m_bWakeScheduler = true;
+void EngineWorkerScheduler::start(QThread::Priority priority) {
+    int threadIndex = 0;
+    for (const auto& pThread : m_schedulerThreads) {
+        pThread->setObjectName(
+                QStringLiteral("EngineWorkerScheduler %1").arg(++threadIndex));
+        pThread->start(priority);
+    }
+}
+
+bool EngineWorkerScheduler::workerReady(EngineWorker* pWorker) {
+    DEBUG_ASSERT(pWorker);
+    const int queueCount = m_readyWorkerQueueCount.load(std::memory_order_acquire);
+    // Should not fail, because each worker is queued at most once and
+    // the queue is large enough for all workers. Workers that are still
+    // queued in a previous queue might occupy it temporarily after the
+    // queue has grown.
+    if (!m_readyWorkerQueues[queueCount - 1]->tryPush(pWorker)) {
+        return false;
+    }
+    m_bWakeScheduler.store(true, std::memory_order_release);
+    return true;
 }
 
 void EngineWorkerScheduler::addWorker(EngineWorker* pWorker) {
     DEBUG_ASSERT(pWorker);
-    QMutexLocker locker(&m_mutex);
-    m_workers.push_back(pWorker);
+    QMutexLocker locker(&m_addWorkerMutex);
+    ++m_workerCount;
+    const int queueCount = m_readyWorkerQueueCount.load(std::memory_order_relaxed);
+    if (m_workerCount <= m_readyWorkerQueues[queueCount - 1]->capacity()) {
+        return;
+    }
+    VERIFY_OR_DEBUG_ASSERT(queueCount < kMaxReadyWorkerQueues) {
+        kLogger.critical()
+                << "Too many engine workers:"
+                << m_workerCount;
+        return;
+    }
+    // The capacity is doubled to grow the queue only a few times
+    m_readyWorkerQueues[queueCount] =
+            std::make_unique<mixxx::MpmcQueue<EngineWorker*>>(2 * m_workerCount);
+    m_readyWorkerQueueCount.store(queueCount + 1, std::memory_order_release);
 }
 
 void EngineWorkerScheduler::runWorkers() {
-    // Wake the scheduler if we have written a worker-ready message to the
-    // scheduler. There is no race condition in accessing this boolean because
-    // both workerReady and runWorkers are called from the callback thread.
-    if (m_bWakeScheduler) {
-        m_bWakeScheduler = false;
-        m_waitCondition.wakeAll();
+    // Wake the scheduler if a worker has been queued since the last call.
+    // The scheduler threads are woken up all at once and start to dequeue
+    // ready workers in parallel.
+    if (m_bWakeScheduler.exchange(false, std::memory_order_acquire)) {
+        m_semaWake.release(static_cast<int>(m_schedulerThreads.size()));
     }
 }
 
-void EngineWorkerScheduler::run() {
+void EngineWorkerScheduler::runSchedulerThread() {
     static const QString tag("EngineWorkerScheduler");
-    while (!m_bQuit) {
+    while (!m_bQuit.load()) {
         Event::start(tag);
-        {
-            QMutexLocker lock(&m_mutex);
-            for(const auto& pWorker: m_workers) {
+        const int queueCount = m_readyWorkerQueueCount.load(std::memory_order_acquire);
+        for (int i = 0; i < queueCount; ++i) {
+            EngineWorker* pWorker;
+            while (m_readyWorkerQueues[i]->tryPop(&pWorker)) {
                 pWorker->wakeIfReady();
             }
         }
         Event::end(tag);
-        {
-            QMutexLocker lock(&m_mutex);
-            if (!m_bQuit) {
-                // Wait for next runWorkers() call
-                m_waitCondition.wait(&m_mutex); // unlock mutex and wait
-            }
-        }
+        // Wait for next runWorkers() call
+        m_semaWake.acquire();
     }
 }
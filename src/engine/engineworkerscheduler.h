@@ -1,38 +1,91 @@
 #pragma once
 
 #include <QMutex>
-#include <QThreadPool>
-#include <QWaitCondition>
+#include <QObject>
+#include <QSemaphore>
+#include <QThread>
+#include <array>
+#include <atomic>
+#include <memory>
+#include <vector>
 
-#include "util/fifo.h"
+#include "preferences/usersettings.h"
+#include "util/mpmcqueue.h"
 
-// The max engine workers that can be expected to run within a callback
-// (e.g. the max that we will schedule). Must be a power of 2.
+// The initial capacity of the ready queue. The queue grows when more
+// workers are added. Must be a power of 2.
 #define MAX_ENGINE_WORKERS 32
 
 class EngineWorker;
 
-class EngineWorkerScheduler : public QThread {
+// Wakes up EngineWorkers after they have signaled that work is ready.
+//
+// Ready workers are queued in a bounded lock-free queue in the order they
+// became ready. A small pool of scheduler threads takes workers from this
+// queue and wakes them up, so that the wake up of many workers (e.g. when
+// loading a whole sampler bank) is not serialized behind a single thread.
+// The queue is replaced by a larger queue when adding more workers than
+// it could hold.
+//
+// Optionally one CPU core can be reserved for the audio callback. All
+// worker threads will then be restricted to the remaining cores.
+class EngineWorkerScheduler : public QObject {
     Q_OBJECT
   public:
-    EngineWorkerScheduler(QObject* pParent=NULL);
-    virtual ~EngineWorkerScheduler();
+    explicit EngineWorkerScheduler(
+            QObject* pParent = nullptr,
+            UserSettingsPointer pConfig = UserSettingsPointer());
+    ~EngineWorkerScheduler() override;
+
+    // Starts the pool of scheduler threads
+    void start(QThread::Priority priority = QThread::InheritPriority);
 
     void addWorker(EngineWorker* pWorker);
     void runWorkers();
-    void workerReady();
 
-  protected:
-    void run();
+    // Queues a ready worker. Returns false if the worker could not be
+    // queued and needs to signal workReady() again.
+    bool workerReady(EngineWorker* pWorker);
+
+    // Reads the CPU core that is reserved for the audio callback from
+    // the settings. Returns -1 if disabled or invalid.
+    static int reservedCpuFromConfig(const UserSettingsPointer& pConfig);
+
+    // The CPU core that is reserved for the audio callback or -1 if
+    // worker threads may run on any core.
+    int reservedCpu() const {
+        return m_reservedCpu;
+    }
 
   private:
+    class SchedulerThread;
+
+    void runSchedulerThread();
+
+    const int m_reservedCpu;
+
     // Indicates whether workerReady has been called since the last time
-    // runWorkers was run. This should only be touched from the engine callback.
-    bool m_bWakeScheduler;
+    // runWorkers was run.
+    std::atomic<bool> m_bWakeScheduler;
+
+    // Workers that have signaled to be ready, but that have not been
+    // woken up yet. Each worker is queued at most once. Only the last
+    // queue is used for new workers. The previous queues are still drained
+    // and never deleted before the scheduler, because workerReady() might
+    // still be accessing them concurrently.
+    static constexpr int kMaxReadyWorkerQueues = 16;
+    std::array<std::unique_ptr<mixxx::MpmcQueue<EngineWorker*>>, kMaxReadyWorkerQueues>
+            m_readyWorkerQueues;
+    std::atomic<int> m_readyWorkerQueueCount;
+
+    // Serializes adding workers
+    QMutex m_addWorkerMutex;
+    int m_workerCount;
 
-    std::vector<EngineWorker*> m_workers;
+    std::vector<std::unique_ptr<SchedulerThread>> m_schedulerThreads;
 
-    QWaitCondition m_waitCondition;
-    QMutex m_mutex;
-    volatile bool m_bQuit;
+    // Released once per scheduler thread for each runWorkers() call
+    // that follows a workerReady() call.
+    QSemaphore m_semaWake;
+    std::atomic<bool> m_bQuit;
 };
@@ -17,8 +17,6 @@
 
 #include "broadcast/defs_broadcast.h"
 #include "control/controlpushbutton.h"
-#include "encoder/encoder.h"
-#include "encoder/encoderbroadcastsettings.h"
 #ifdef __OPUS__
 #include "encoder/encoderopus.h"
 #endif
@@ -53,7 +51,6 @@ ShoutConnection::ShoutConnection(BroadcastProfilePtr profile,
           m_iShoutFailures(0),
           m_pConfig(pConfig),
           m_pProfile(profile),
-          m_encoder(nullptr),
           m_pMasterSamplerate(new ControlProxy("[Master]", "samplerate", this)),
           m_pBroadcastEnabled(new ControlProxy(BROADCAST_PREF_KEY, "enabled", this)),
           m_custom_metadata(false),
@@ -184,10 +181,12 @@ void ShoutConnection::updateFromPreferences() {
 
     setState(NETWORKSTREAMWORKER_STATE_BUSY);
 
-    // Delete m_encoder if it has been initialized (with maybe) different bitrate.
-    // delete m_encoder calls write() check if it will be exit early
+    // The reader of an MP3 stream is kept below if the encoder settings
+    // have not changed, e.g. when reconnecting. Otherwise it is detached
+    // from its group.
     DEBUG_ASSERT(m_iShoutStatus != SHOUTERR_CONNECTED);
-    m_encoder.reset();
+    std::unique_ptr<BroadcastEncoderGroup::Reader> pPreviousEncoderReader =
+            std::move(m_pEncoderReader);
 
     m_format_is_mp3 = false;
     m_format_is_ov = false;
@@ -440,24 +439,30 @@ void ShoutConnection::updateFromPreferences() {
         return;
     }
 
-    // Initialize m_encoder
-    EncoderSettingsPointer pBroadcastSettings =
-            std::make_shared<EncoderBroadcastSettings>(m_pProfile);
-    m_encoder = EncoderFactory::getFactory().createEncoder(
-                    pBroadcastSettings, this);
+    // Join the encoder group for the settings of the profile. The Vorbis
+    // and Opus encoders only write the Ogg headers once after having been
+    // initialized, which every new connection needs to receive first.
+    // Ogg streams therefore get a new group with a new encoder, the
+    // previous group has no other readers.
+    if (m_format_is_mp3 &&
+            pPreviousEncoderReader &&
+            pPreviousEncoderReader->group()->key() ==
+                    BroadcastEncoderGroup::groupKey(m_pProfile, masterSamplerate)) {
+        m_pEncoderReader = std::move(pPreviousEncoderReader);
+        setState(NETWORKSTREAMWORKER_STATE_READY);
+        return;
+    }
+    pPreviousEncoderReader.reset();
 
     QString errorMsg;
-    // TODO(XXX): Use mixxx::audio::SampleRate instead of int in initEncoder
-    if (m_encoder->initEncoder(static_cast<int>(masterSamplerate), errorMsg) < 0) {
+    m_pEncoderReader = BroadcastEncoderGroup::attach(
+            m_pProfile, masterSamplerate, &errorMsg);
+    if (!m_pEncoderReader) {
         // e.g., if lame is not found
-        // init m_encoder itself will display a message box
+        // initEncoder() itself will display a message box
         kLogger.warning() << "**** Encoder init failed";
         kLogger.warning() << errorMsg;
 
-        // delete m_encoder calls write() make sure it will be exit early
-        DEBUG_ASSERT(m_iShoutStatus != SHOUTERR_CONNECTED);
-        m_encoder.reset();
-
         setState(NETWORKSTREAMWORKER_STATE_ERROR);
         m_lastErrorStr = "Encoder error";
 
@@ -482,7 +487,7 @@ bool ShoutConnection::processConnect() {
     // Make sure that we call updateFromPreferences always
     updateFromPreferences();
 
-    if (!m_encoder) {
+    if (!m_pEncoderReader) {
         // updateFromPreferences failed
         setStatus(BroadcastProfile::STATUS_FAILURE);
         kLogger.warning() << "ShoutOutput::processConnect() returning false";
@@ -600,9 +605,9 @@ bool ShoutConnection::processConnect() {
 
     // no connection, clean up
     shout_close(m_pShout);
-    // delete m_encoder calls write() check if it will be exit early
     DEBUG_ASSERT(m_iShoutStatus != SHOUTERR_CONNECTED);
-    m_encoder.reset();
+    // Keep the read position for reconnecting
+    m_pEncoderReader->suspend();
     if (m_pProfile->getEnabled()) {
         setStatus(BroadcastProfile::STATUS_FAILURE);
     } else {
@@ -625,29 +630,37 @@ bool ShoutConnection::processDisconnect() {
         emit broadcastDisconnected();
         disconnected = true;
     }
-    // delete m_encoder calls write() check if it will be exit early
     DEBUG_ASSERT(m_iShoutStatus != SHOUTERR_CONNECTED);
-    m_encoder.reset();
+    // Keep the read position for reconnecting
+    if (m_pEncoderReader) {
+        m_pEncoderReader->suspend();
+    }
     return disconnected;
 }
 
-void ShoutConnection::write(const unsigned char* header, const unsigned char* body,
-                            int headerLen, int bodyLen) {
+void ShoutConnection::sendEncodedPackets() {
     setFunctionCode(7);
-	if (!m_pShout || m_iShoutStatus != SHOUTERR_CONNECTED) {
-        // This happens when the decoder calls flush() and the connection is
-        // already down
-        return;
+    const int skippedPackets = m_pEncoderReader->read(&m_encodedPackets);
+    if (skippedPackets > 0) {
+        kLogger.warning()
+                << m_pProfile->getProfileName()
+                << "skipped" << skippedPackets
+                << "encoded packets that have not been sent in time";
     }
 
-    // Send header if there is one
-    if (headerLen > 0) {
-        if(!writeSingle(header, headerLen)) {
-            return;
+    for (const QByteArray& packet : qAsConst(m_encodedPackets)) {
+        // The connection might have been lost while sending the previous
+        // packet
+        if (!m_pShout || m_iShoutStatus != SHOUTERR_CONNECTED) {
+            break;
+        }
+        if (!writeSingle(reinterpret_cast<const unsigned char*>(packet.constData()),
+                    packet.size())) {
+            break;
         }
     }
-
-    if(!writeSingle(body, bodyLen)) {
+    m_encodedPackets.clear();
+    if (!m_pShout || m_iShoutStatus != SHOUTERR_CONNECTED) {
         return;
     }
 
@@ -660,22 +673,6 @@ void ShoutConnection::write(const unsigned char* header, const unsigned char* bo
         }
     }
 }
-// These are not used for streaming, but the interface requires them
-int ShoutConnection::tell() {
-    if (!m_pShout) {
-        return -1;
-    }
-    return -1;
-}
-// These are not used for streaming, but the interface requires them
-void ShoutConnection::seek(int pos) {
-    Q_UNUSED(pos)
-    return;
-}
-// These are not used for streaming, but the interface requires them
-int ShoutConnection::filelen() {
-    return 0;
-}
 
 bool ShoutConnection::writeSingle(const unsigned char* data, size_t len) {
     setFunctionCode(8);
@@ -715,11 +712,12 @@ void ShoutConnection::process(const CSAMPLE* pBuffer, const int iBufferSize) {
         return;
     }
 
-    // If we are connected, encode the samples.
-    if (iBufferSize > 0 && m_encoder) {
+    // If we are connected, encode the samples. Only one connection of the
+    // encoder group actually encodes them, all connections send the packets.
+    if (iBufferSize > 0 && m_pEncoderReader) {
         setFunctionCode(6);
-        m_encoder->encodeBuffer(pBuffer, iBufferSize);
-        // the encoded frames are received by the write() callback.
+        m_pEncoderReader->process(pBuffer, iBufferSize);
+        sendEncodedPackets();
     }
 
     // Check if track metadata has changed and if so, update.
@@ -984,6 +982,7 @@ void ShoutConnection::run() {
         errorDialog(tr("Can't connect to streaming server"),
                 m_lastErrorStr + "\n" +
                 tr("Please check your connection to the Internet and verify that your username and password are correct."));
+        m_pEncoderReader.reset();
         return;
     }
 
@@ -1032,6 +1031,8 @@ void ShoutConnection::run() {
         }
     }
 
+    // Leave the encoder group, which is deleted with its last connection
+    m_pEncoderReader.reset();
     kLogger.debug() << "run: Thread stopped";
 }
 
@@ -12,10 +12,11 @@
 #include <QVector>
 #include <QWaitCondition>
 
+#include <memory>
+
+#include "broadcast/broadcastencodergroup.h"
 #include "control/controlobject.h"
 #include "control/controlproxy.h"
-#include "encoder/encoder.h"
-#include "encoder/encodercallback.h"
 #include "errordialoghandler.h"
 #include "preferences/broadcastprofile.h"
 #include "preferences/usersettings.h"
@@ -30,7 +31,7 @@ struct _util_dict;
 typedef struct _util_dict shout_metadata_t;
 
 class ShoutConnection
-        : public QThread, public EncoderCallback, public NetworkOutputStreamWorker {
+        : public QThread, public NetworkOutputStreamWorker {
     Q_OBJECT
   public:
     ShoutConnection(BroadcastProfilePtr profile, UserSettingsPointer pConfig);
@@ -43,17 +44,6 @@ class ShoutConnection
     void shutdown() override {
     }
 
-    // Called by the encoder in method 'encodebuffer()' to flush the stream to
-    // the server.
-    void write(const unsigned char* header, const unsigned char* body,
-               int headerLen, int bodyLen) override;
-    // gets stream position
-    int tell() override;
-    // sets stream position
-    void seek(int pos) override;
-    // gets stream length
-    int filelen() override;
-
     /** connects to server **/
     bool serverConnect();
     bool isConnected();
@@ -99,8 +89,9 @@ class ShoutConnection
     void errorDialog(const QString& text, const QString& detailedError);
     void infoDialog(const QString& text, const QString& detailedError);
 
-    void serverWrite(unsigned char *header, unsigned char *body,
-               int headerLen, int bodyLen);
+    // Sends the packets that have been encoded by the encoder group to the
+    // server.
+    void sendEncodedPackets();
 
 #ifndef __WINDOWS__
     void ignoreSigpipe();
@@ -124,7 +115,9 @@ class ShoutConnection
     long m_iShoutFailures;
     UserSettingsPointer m_pConfig;
     BroadcastProfilePtr m_pProfile;
-    EncoderPointer m_encoder;
+    // Connections with the same encoder settings share an encoder
+    std::unique_ptr<BroadcastEncoderGroup::Reader> m_pEncoderReader;
+    QVector<QByteArray> m_encodedPackets;
     ControlProxy* m_pMasterSamplerate;
     ControlProxy* m_pBroadcastEnabled;
     // static metadata according to prefereneces
@@ -1,5 +1,9 @@
 #include "library/analysisfeature.h"
 
+#include <QDir>
+#include <QFile>
+#include <QSaveFile>
+#include <QSet>
 #include <QtDebug>
 
 #include "controllers/keyboard/keyboardeventfilter.h"
@@ -20,6 +24,10 @@ const mixxx::Logger kLogger("AnalysisFeature");
 
 const QString kViewName = QStringLiteral("Analysis");
 
+// Contains the ids of all tracks that have not been analyzed
+// before exiting, one per line
+const QString kPersistedQueueFileName = QStringLiteral("analysis_queue.txt");
+
 // Utilize all available cores for batch analysis of tracks
 const int kNumberOfAnalyzerThreads = math_max(1, QThread::idealThreadCount());
 
@@ -108,9 +116,28 @@ void AnalysisFeature::bindLibraryWidget(WLibrary* libraryWidget,
     // Let the DlgAnalysis know whether or not analysis is active.
     emit analysisActive(static_cast<bool>(m_pTrackAnalysisScheduler));
 
+    if (m_pTrackAnalysisScheduler) {
+        // The analysis might already have been started before
+        // the view is created, e.g. when resuming it
+        connectTrackAnalysisSchedulerToView();
+    }
+
     libraryWidget->registerView(kViewName, m_pAnalysisView);
 }
 
+void AnalysisFeature::connectTrackAnalysisSchedulerToView() {
+    DEBUG_ASSERT(m_pTrackAnalysisScheduler);
+    DEBUG_ASSERT(m_pAnalysisView);
+    connect(m_pTrackAnalysisScheduler.get(),
+            &TrackAnalysisScheduler::progress,
+            m_pAnalysisView,
+            &DlgAnalysis::onTrackAnalysisSchedulerProgress);
+    connect(m_pTrackAnalysisScheduler.get(),
+            &TrackAnalysisScheduler::finished,
+            m_pAnalysisView,
+            &DlgAnalysis::onTrackAnalysisSchedulerFinished);
+}
+
 TreeItemModel* AnalysisFeature::getChildModel() {
     return &m_childModel;
 }
@@ -143,14 +170,9 @@ void AnalysisFeature::analyzeTracks(const QList<TrackId>& trackIds) {
                 m_pConfig,
                 getAnalyzerModeFlags(m_pConfig));
 
-        connect(m_pTrackAnalysisScheduler.get(),
-                &TrackAnalysisScheduler::progress,
-                m_pAnalysisView,
-                &DlgAnalysis::onTrackAnalysisSchedulerProgress);
-        connect(m_pTrackAnalysisScheduler.get(),
-                &TrackAnalysisScheduler::finished,
-                m_pAnalysisView,
-                &DlgAnalysis::onTrackAnalysisSchedulerFinished);
+        if (m_pAnalysisView) {
+            connectTrackAnalysisSchedulerToView();
+        }
         connect(m_pTrackAnalysisScheduler.get(),
                 &TrackAnalysisScheduler::progress,
                 this,
@@ -192,6 +214,69 @@ void AnalysisFeature::stopAnalysis() {
     m_pTrackAnalysisScheduler->stop();
 }
 
+void AnalysisFeature::stopAnalysisAndPersistQueue() {
+    if (!m_pTrackAnalysisScheduler) {
+        return; // inactive
+    }
+    const QList<TrackId> trackIds =
+            m_pTrackAnalysisScheduler->stopAndCollectScheduledTrackIds();
+    kLogger.info()
+            << "Stopping analysis and persisting"
+            << trackIds.size()
+            << "scheduled tracks";
+    QSaveFile file(persistedQueueFilePath());
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Text)) {
+        kLogger.warning()
+                << "Failed to open file"
+                << file.fileName();
+        return;
+    }
+    QSet<TrackId> writtenTrackIds;
+    for (const auto& trackId : trackIds) {
+        if (!writtenTrackIds.contains(trackId)) {
+            writtenTrackIds.insert(trackId);
+            file.write(trackId.toString().toLatin1());
+            file.write("\n");
+        }
+    }
+    if (!file.commit()) {
+        kLogger.warning()
+                << "Failed to write file"
+                << file.fileName();
+    }
+}
+
+QString AnalysisFeature::persistedQueueFilePath() const {
+    return QDir(m_pConfig->getSettingsPath()).filePath(kPersistedQueueFileName);
+}
+
+void AnalysisFeature::resumePersistedQueue() {
+    QFile file(persistedQueueFilePath());
+    if (!file.exists()) {
+        return;
+    }
+    QList<TrackId> trackIds;
+    if (file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+        while (!file.atEnd()) {
+            const TrackId trackId(QVariant(QString::fromLatin1(file.readLine()).trimmed()));
+            if (trackId.isValid()) {
+                trackIds.append(trackId);
+            }
+        }
+        file.close();
+    }
+    // Only resume once, even if the analysis is stopped again
+    file.remove();
+    if (trackIds.isEmpty()) {
+        return;
+    }
+    kLogger.info()
+            << "Resuming analysis of"
+            << trackIds.size()
+            << "tracks";
+    analyzeTracks(trackIds);
+}
+
 void AnalysisFeature::onTrackAnalysisSchedulerProgress(
         AnalyzerProgress /*currentTrackProgress*/,
         int currentTrackNumber,
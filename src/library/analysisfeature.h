@@ -48,6 +48,14 @@ class AnalysisFeature : public LibraryFeature {
     void suspendAnalysis();
     void resumeAnalysis();
     void stopAnalysis();
+    // Stops the analysis and stores all tracks that have not been
+    // analyzed yet. The analysis of these tracks is resumed after
+    // restarting.
+    void stopAnalysisAndPersistQueue();
+    // Resumes the analysis of the tracks that have been stored by
+    // stopAnalysisAndPersistQueue() before exiting. Only invoked
+    // once after the library has been initialized.
+    void resumePersistedQueue();
 
   private slots:
     void onTrackAnalysisSchedulerProgress(AnalyzerProgress currentTrackProgress, int currentTrackNumber, int totalTracksCount);
@@ -63,6 +71,9 @@ class AnalysisFeature : public LibraryFeature {
     // tracks in the job
     void setTitleProgress(int currentTrackNumber, int totalTracksCount);
 
+    QString persistedQueueFilePath() const;
+    void connectTrackAnalysisSchedulerToView();
+
     const QString m_baseTitle;
     const QIcon m_icon;
 
@@ -1,5 +1,10 @@
 #include "library/basetrackcache.h"
 
+#include <QThread>
+#include <QtConcurrentMap>
+#include <algorithm>
+#include <vector>
+
 #include "library/queryutil.h"
 #include "library/searchqueryparser.h"
 #include "library/trackcollection.h"
@@ -8,12 +13,67 @@
 #include "track/keyutils.h"
 #include "track/track.h"
 #include "util/compatibility.h"
+#include "util/math.h"
 #include "util/performancetimer.h"
 
 namespace {
 
 constexpr bool sDebug = false;
 
+// Smaller numbers of tracks are sorted on the calling thread
+constexpr int kMinTracksPerSortChunk = 10000;
+
+// Sorts chunks of the rows in parallel and merges them afterwards.
+// The order of equal rows is preserved.
+template<typename LessThan>
+void parallelStableSort(QVector<int>* pRows, LessThan lessThan) {
+    const int size = pRows->size();
+    const int chunkCount = math_min(
+            QThread::idealThreadCount(), size / kMinTracksPerSortChunk);
+    int* const pBegin = pRows->data();
+    if (chunkCount <= 1) {
+        std::stable_sort(pBegin, pBegin + size, lessThan);
+        return;
+    }
+    QVector<int> bounds;
+    for (int i = 0; i <= chunkCount; ++i) {
+        bounds.append(static_cast<int>(static_cast<qint64>(size) * i / chunkCount));
+    }
+    QVector<int> chunks;
+    for (int i = 0; i < chunkCount; ++i) {
+        chunks.append(i);
+    }
+    QtConcurrent::blockingMap(chunks, [&](int chunk) {
+        std::stable_sort(pBegin + bounds[chunk], pBegin + bounds[chunk + 1], lessThan);
+    });
+    // Merge neighboring chunks pairwise until a single chunk remains
+    for (int width = 1; width < chunkCount; width *= 2) {
+        QVector<int> firstChunks;
+        for (int chunk = 0; chunk + width < chunkCount; chunk += 2 * width) {
+            firstChunks.append(chunk);
+        }
+        QtConcurrent::blockingMap(firstChunks, [&](int chunk) {
+            std::inplace_merge(pBegin + bounds[chunk],
+                    pBegin + bounds[chunk + width],
+                    pBegin + bounds[math_min(chunk + 2 * width, chunkCount)],
+                    lessThan);
+        });
+    }
+}
+
+// Same as "cast(%1 as integer)" in SQL
+int leadingInteger(const QString& text) {
+    const QString trimmed = text.trimmed();
+    int end = 0;
+    if (end < trimmed.size() && (trimmed[end] == '-' || trimmed[end] == '+')) {
+        ++end;
+    }
+    while (end < trimmed.size() && trimmed[end].isDigit()) {
+        ++end;
+    }
+    return trimmed.left(end).toInt();
+}
+
 }  // namespace
 
 BaseTrackCache::BaseTrackCache(TrackCollection* pTrackCollection,
@@ -29,6 +89,7 @@ BaseTrackCache::BaseTrackCache(TrackCollection* pTrackCollection,
           m_pQueryParser(new SearchQueryParser(pTrackCollection)),
           m_bIndexBuilt(false),
           m_bIsCaching(isCaching),
+          m_trackInfo(columns.size()),
           m_database(pTrackCollection->database()) {
     m_searchColumns << "artist"
                     << "album"
@@ -46,6 +107,21 @@ BaseTrackCache::BaseTrackCache(TrackCollection* pTrackCollection,
     for (int i = 0; i < m_searchColumns.size(); ++i) {
         m_searchColumnIndices[i] = m_columnCache.fieldIndex(m_searchColumns[i]);
     }
+
+    // Mirror the special sort orders of ColumnCache::columnSortForFieldIndex()
+    const int trackNumberColumn =
+            fieldIndex(ColumnCache::COLUMN_LIBRARYTABLE_TRACKNUMBER);
+    if (trackNumberColumn >= 0) {
+        m_trackInfo.setStringSortKeyFunction(trackNumberColumn, leadingInteger);
+    }
+    const int keyColumn = fieldIndex(ColumnCache::COLUMN_LIBRARYTABLE_KEY);
+    if (keyColumn >= 0) {
+        m_trackInfo.setStringSortKeyFunction(keyColumn, [this](const QString& key) {
+            return KeyUtils::keyToCircleOfFifthsOrder(
+                    KeyUtils::guessKeyFromText(key),
+                    m_columnCache.keyNotation());
+        });
+    }
 }
 
 BaseTrackCache::~BaseTrackCache() {
@@ -219,13 +295,12 @@ bool BaseTrackCache::updateTrackInIndex(
 
     TrackId trackId = pTrack->getId();
     if (trackId.isValid()) {
-        // m_trackInfo[id] will insert a QVector<QVariant> into the
-        // m_trackInfo HashTable with the key "id"
-        QVector<QVariant>& record = m_trackInfo[trackId];
-        // preallocate memory for all columns at once
-        record.resize(numColumns);
+        const int row = m_trackInfo.insert(trackId);
         for (int i = 0; i < numColumns; ++i) {
-            getTrackValueForColumn(pTrack, i, record[i]);
+            // Columns that are not provided by the track keep their value
+            QVariant value = m_trackInfo.value(row, i);
+            getTrackValueForColumn(pTrack, i, value);
+            m_trackInfo.setValue(row, i, value);
         }
         if (m_bIsCaching) {
             replaceRecentTrack(std::move(trackId), std::move(pTrack));
@@ -267,20 +342,16 @@ bool BaseTrackCache::updateIndexWithQuery(const QString& queryString) {
     while (query.next()) {
         TrackId trackId(query.value(idColumn));
 
-        //m_trackInfo[id] will insert a QVector<QVariant> into the
-        //m_trackInfo HashTable with the key "id"
-        QVector<QVariant>& record = m_trackInfo[trackId];
-        record.resize(numColumns);
-
+        const int row = m_trackInfo.insert(trackId);
         for (int i = 0; i < numColumns; ++i) {
             if (fieldIndex(ColumnCache::COLUMN_LIBRARYTABLE_NATIVELOCATION) == i) {
                 // Database stores all locations with Qt separators: "/"
                 // Here we want to cache the display string with native separators.
                 QString location = query.value(i).toString();
-                record[i] = QDir::toNativeSeparators(location);
+                m_trackInfo.setValue(row, i, QDir::toNativeSeparators(location));
             }
             else {
-                record[i] = query.value(i);
+                m_trackInfo.setValue(row, i, query.value(i));
             }
         }
     }
@@ -309,6 +380,8 @@ void BaseTrackCache::buildIndex() {
     if (!updateIndexWithQuery(queryString)) {
         qDebug() << "buildIndex failed!";
     }
+    qDebug() << this << "cached" << m_trackInfo.size() << "tracks occupying"
+             << m_trackInfo.memoryUsage() / 1024 << "KiB";
 
     m_bIndexBuilt = true;
 }
@@ -446,10 +519,9 @@ QVariant BaseTrackCache::data(TrackId trackId, int column) const {
     // metadata. Currently the upper-levels will not delegate row-specific
     // columns to this method, but there should still be a check here I think.
     if (!result.isValid()) {
-        auto it = m_trackInfo.constFind(trackId);
-        if (it != m_trackInfo.constEnd()) {
-            const QVector<QVariant>& fields = it.value();
-            result = fields.value(column, result);
+        const int row = m_trackInfo.row(trackId);
+        if (row >= 0) {
+            result = m_trackInfo.value(row, column);
         }
     }
     return result;
@@ -502,41 +574,22 @@ void BaseTrackCache::filterAndSort(const QSet<TrackId>& trackIds,
         filter.prepend("WHERE ");
     }
 
-    QString queryString = QString("SELECT %1 FROM %2 %3 %4")
-            .arg(m_idColumn, m_tableName, filter, orderByClause);
-
-    if (sDebug) {
-        qDebug() << this << "select() executing:" << queryString;
-    }
-
-    QSqlQuery query(m_database);
-    // This causes a memory savings since QSqlCachedResult (what QtSQLite uses)
-    // won't allocate a giant in-memory table that we won't use at all.
-    query.setForwardOnly(true);
-    query.prepare(queryString);
-
-    if (!query.exec()) {
-        LOG_FAILED_QUERY(query);
-    }
-
-    int idColumn = query.record().indexOf(m_idColumn);
-    int rows = query.size();
+    // Sorting the typed columns in memory is much faster than sorting in
+    // SQL, which compares strings with a custom collation function.
+    const bool sortTracksInMemory = !orderByClause.isEmpty() &&
+            canSortInMemory(trackIds, sortColumns, columnOffset);
 
-    if (sDebug) {
-        qDebug() << "Rows returned:" << rows;
+    queryTrackOrder(filter, sortTracksInMemory ? QString() : orderByClause);
+    if (sortTracksInMemory &&
+            !sortInMemory(&m_trackOrder, sortColumns, columnOffset)) {
+        // Some tracks are not cached, sort all of them in SQL instead
+        queryTrackOrder(filter, orderByClause);
     }
 
-    m_trackOrder.resize(0); // keeps allocated memory
     trackToIndex->clear();
-    if (rows > 0) {
-        trackToIndex->reserve(rows);
-        m_trackOrder.reserve(rows);
-    }
-
-    while (query.next()) {
-        TrackId trackId(query.value(idColumn));
-        (*trackToIndex)[trackId] = m_trackOrder.size();
-        m_trackOrder.append(trackId);
+    trackToIndex->reserve(m_trackOrder.size());
+    for (int i = 0; i < m_trackOrder.size(); ++i) {
+        (*trackToIndex)[m_trackOrder[i]] = i;
     }
 
     // At this point, the original set of tracks have been divided into two
@@ -614,6 +667,124 @@ void BaseTrackCache::filterAndSort(const QSet<TrackId>& trackIds,
     }
 }
 
+void BaseTrackCache::queryTrackOrder(
+        const QString& filter, const QString& orderByClause) {
+    QString queryString = QString("SELECT %1 FROM %2 %3 %4")
+            .arg(m_idColumn,
+                    m_tableName,
+                    filter,
+                    orderByClause);
+
+    if (sDebug) {
+        qDebug() << this << "select() executing:" << queryString;
+    }
+
+    QSqlQuery query(m_database);
+    // This causes a memory savings since QSqlCachedResult (what QtSQLite uses)
+    // won't allocate a giant in-memory table that we won't use at all.
+    query.setForwardOnly(true);
+    query.prepare(queryString);
+
+    if (!query.exec()) {
+        LOG_FAILED_QUERY(query);
+    }
+
+    int idColumn = query.record().indexOf(m_idColumn);
+    int rows = query.size();
+
+    if (sDebug) {
+        qDebug() << "Rows returned:" << rows;
+    }
+
+    m_trackOrder.resize(0); // keeps allocated memory
+    if (rows > 0) {
+        m_trackOrder.reserve(rows);
+    }
+
+    while (query.next()) {
+        m_trackOrder.append(TrackId(query.value(idColumn)));
+    }
+}
+
+bool BaseTrackCache::canSortInMemory(const QSet<TrackId>& trackIds,
+        const QList<SortColumn>& sortColumns,
+        const int columnOffset) const {
+    if (sortColumns.isEmpty()) {
+        return false;
+    }
+    for (const auto& sortColumn : sortColumns) {
+        // Columns of the table model that are not provided by this
+        // track source, e.g. the random order of the preview column,
+        // are only sorted in SQL
+        const int column = sortColumn.m_column - columnOffset;
+        if (column < 1 || !m_trackInfo.isSortable(column)) {
+            return false;
+        }
+    }
+    for (const auto& trackId : trackIds) {
+        if (!m_trackInfo.contains(trackId)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool BaseTrackCache::sortInMemory(QVector<TrackId>* pTrackIds,
+        const QList<SortColumn>& sortColumns,
+        const int columnOffset) {
+    PerformanceTimer timer;
+    timer.start();
+
+    // The query might return tracks that have been added to the database
+    // after the tracks have been cached
+    QVector<int> rows;
+    rows.reserve(pTrackIds->size());
+    for (const auto& trackId : qAsConst(*pTrackIds)) {
+        const int row = m_trackInfo.row(trackId);
+        if (row < 0) {
+            if (sDebug) {
+                qDebug() << this << "cannot sort uncached track" << trackId
+                         << "in memory";
+            }
+            return false;
+        }
+        rows.append(row);
+    }
+
+    std::vector<SortColumn> columns;
+    columns.reserve(sortColumns.size());
+    for (const auto& sortColumn : sortColumns) {
+        const int column = sortColumn.m_column - columnOffset;
+        if (column == fieldIndex(ColumnCache::COLUMN_LIBRARYTABLE_KEY)) {
+            // The key notation might have changed
+            m_trackInfo.invalidateSortRanks(column);
+        }
+        m_trackInfo.updateSortRanks(column);
+        columns.push_back(SortColumn(column, sortColumn.m_order));
+    }
+
+    const ColumnarTrackInfo& trackInfo = m_trackInfo;
+    parallelStableSort(&rows, [&columns, &trackInfo](int row1, int row2) {
+        for (const auto& sortColumn : columns) {
+            const int result = trackInfo.compare(sortColumn.m_column, row1, row2);
+            if (result != 0) {
+                return sortColumn.m_order == Qt::AscendingOrder ? result < 0 : result > 0;
+            }
+        }
+        return false;
+    });
+
+    for (int i = 0; i < rows.size(); ++i) {
+        (*pTrackIds)[i] = m_trackInfo.trackId(rows[i]);
+    }
+
+    if (sDebug) {
+        qDebug() << this << "sorting" << rows.size() << "tracks in memory took"
+                 << timer.elapsed().debugMillisWithUnit();
+    }
+    return true;
+}
+
 int BaseTrackCache::findSortInsertionPoint(TrackPointer pTrack,
         const QList<SortColumn>& sortColumns,
         const int columnOffset,
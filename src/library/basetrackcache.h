@@ -10,6 +10,7 @@
 #include <QVector>
 #include <memory>
 
+#include "library/columnartrackinfo.h"
 #include "library/columncache.h"
 #include "track/track_decl.h"
 #include "track/trackid.h"
@@ -99,6 +100,18 @@ class BaseTrackCache : public QObject {
     void getTrackValueForColumn(TrackPointer pTrack, int column,
                                 QVariant& trackValue) const;
 
+    bool canSortInMemory(const QSet<TrackId>& trackIds,
+            const QList<SortColumn>& sortColumns,
+            const int columnOffset) const;
+    // Returns false and leaves the track ids unmodified if not all tracks
+    // are cached, e.g. if they have been added after building the index.
+    bool sortInMemory(QVector<TrackId>* pTrackIds,
+            const QList<SortColumn>& sortColumns,
+            const int columnOffset);
+    // Replaces m_trackOrder with the ids of all tracks that match
+    // the filter in the given order.
+    void queryTrackOrder(const QString& filter, const QString& orderByClause);
+
     int findSortInsertionPoint(TrackPointer pTrack,
                                const QList<SortColumn>& sortColumns,
                                const int columnOffset,
@@ -147,7 +160,7 @@ class BaseTrackCache : public QObject {
 
     bool m_bIndexBuilt;
     bool m_bIsCaching;
-    QHash<TrackId, QVector<QVariant> > m_trackInfo;
+    ColumnarTrackInfo m_trackInfo;
     QSqlDatabase m_database;
     ControlProxy* m_pKeyNotationCP;
 
@@ -0,0 +1,411 @@
+#include "library/columnartrackinfo.h"
+
+#include <QDateTime>
+#include <algorithm>
+
+#include "util/assert.h"
+
+namespace {
+
+template<typename T>
+inline int compareValues(T value1, T value2) {
+    if (value1 < value2) {
+        return -1;
+    }
+    if (value2 < value1) {
+        return 1;
+    }
+    return 0;
+}
+
+// Values of other types are stored as text like in the database. Qt
+// writes date time values as ISO 8601 text with milliseconds.
+QString textOfValue(const QVariant& value) {
+    if (value.userType() == QMetaType::QDateTime) {
+        return value.toDateTime().toString(Qt::ISODateWithMs);
+    }
+    return value.toString();
+}
+
+} // anonymous namespace
+
+ColumnarTrackInfo::Column::Column()
+        : kind(Kind::Empty),
+          type(QMetaType::UnknownType),
+          stringRanksValid(true) {
+}
+
+ColumnarTrackInfo::ColumnarTrackInfo(int columnCount)
+        : m_columns(columnCount) {
+}
+
+// static
+ColumnarTrackInfo::Kind ColumnarTrackInfo::kindOfType(int type) {
+    switch (type) {
+    case QMetaType::Bool:
+    case QMetaType::Int:
+    case QMetaType::UInt:
+    case QMetaType::LongLong:
+        return Kind::Integer;
+    case QMetaType::Float:
+    case QMetaType::Double:
+        return Kind::Double;
+    case QMetaType::QString:
+    case QMetaType::QDateTime:
+        return Kind::String;
+    default:
+        return Kind::Variant;
+    }
+}
+
+int ColumnarTrackInfo::insert(TrackId trackId) {
+    const auto it = m_rowsByTrackId.constFind(trackId);
+    if (it != m_rowsByTrackId.constEnd()) {
+        return it.value();
+    }
+    const int row = m_trackIds.size();
+    m_trackIds.append(trackId);
+    m_rowsByTrackId.insert(trackId, row);
+    for (auto& column : m_columns) {
+        resizeColumn(&column, row, row + 1);
+    }
+    return row;
+}
+
+void ColumnarTrackInfo::remove(TrackId trackId) {
+    const auto it = m_rowsByTrackId.find(trackId);
+    if (it == m_rowsByTrackId.end()) {
+        return;
+    }
+    const int row = it.value();
+    m_rowsByTrackId.erase(it);
+    // Keep the rows contiguous by moving the last row into the gap.
+    // Interned strings are kept until the next clear().
+    const int lastRow = m_trackIds.size() - 1;
+    if (row != lastRow) {
+        moveRow(lastRow, row);
+        m_trackIds[row] = m_trackIds[lastRow];
+        m_rowsByTrackId[m_trackIds[row]] = row;
+    }
+    m_trackIds.removeLast();
+    for (auto& column : m_columns) {
+        resizeColumn(&column, lastRow + 1, lastRow);
+    }
+}
+
+void ColumnarTrackInfo::clear() {
+    for (auto& column : m_columns) {
+        Column emptyColumn;
+        emptyColumn.stringSortKeyFunction = std::move(column.stringSortKeyFunction);
+        column = std::move(emptyColumn);
+    }
+    m_trackIds.clear();
+    m_rowsByTrackId.clear();
+}
+
+// static
+void ColumnarTrackInfo::resizeColumn(Column* pColumn, int oldRowCount, int rowCount) {
+    // New rows are null
+    switch (pColumn->kind) {
+    case Kind::Empty:
+        break;
+    case Kind::Integer:
+        pColumn->integers.resize(rowCount);
+        pColumn->nulls.resize(rowCount);
+        for (int row = oldRowCount; row < rowCount; ++row) {
+            pColumn->nulls.setBit(row);
+        }
+        break;
+    case Kind::Double:
+        pColumn->doubles.resize(rowCount);
+        pColumn->nulls.resize(rowCount);
+        for (int row = oldRowCount; row < rowCount; ++row) {
+            pColumn->nulls.setBit(row);
+        }
+        break;
+    case Kind::String:
+        pColumn->stringIds.resize(rowCount);
+        for (int row = oldRowCount; row < rowCount; ++row) {
+            pColumn->stringIds[row] = -1;
+        }
+        break;
+    case Kind::Variant:
+        pColumn->variants.resize(rowCount);
+        for (int row = oldRowCount; row < rowCount; ++row) {
+            pColumn->variants[row] = QVariant(QVariant::Type(pColumn->type));
+        }
+        break;
+    }
+}
+
+void ColumnarTrackInfo::moveRow(int fromRow, int toRow) {
+    for (auto& column : m_columns) {
+        switch (column.kind) {
+        case Kind::Empty:
+            break;
+        case Kind::Integer:
+            column.integers[toRow] = column.integers[fromRow];
+            column.nulls.setBit(toRow, column.nulls.testBit(fromRow));
+            break;
+        case Kind::Double:
+            column.doubles[toRow] = column.doubles[fromRow];
+            column.nulls.setBit(toRow, column.nulls.testBit(fromRow));
+            break;
+        case Kind::String:
+            column.stringIds[toRow] = column.stringIds[fromRow];
+            break;
+        case Kind::Variant:
+            column.variants[toRow] = column.variants[fromRow];
+            break;
+        }
+    }
+}
+
+void ColumnarTrackInfo::convertColumn(Column* pColumn, Kind kind, int type) {
+    DEBUG_ASSERT(pColumn->kind != kind);
+    const int rowCount = m_trackIds.size();
+    if (pColumn->kind == Kind::Empty) {
+        // All rows are null
+        pColumn->kind = kind;
+        pColumn->type = type;
+        resizeColumn(pColumn, 0, rowCount);
+        return;
+    }
+    // Mixed types are stored as QVariant
+    DEBUG_ASSERT(kind == Kind::Variant);
+    QVector<QVariant> variants;
+    variants.reserve(rowCount);
+    for (int row = 0; row < rowCount; ++row) {
+        variants.append(value(row, static_cast<int>(pColumn - m_columns.data())));
+    }
+    Column column;
+    column.kind = Kind::Variant;
+    column.type = pColumn->type;
+    column.variants = std::move(variants);
+    column.stringSortKeyFunction = std::move(pColumn->stringSortKeyFunction);
+    *pColumn = std::move(column);
+}
+
+int ColumnarTrackInfo::internString(Column* pColumn, const QString& value) {
+    const auto it = pColumn->stringIdsByValue.constFind(value);
+    if (it != pColumn->stringIdsByValue.constEnd()) {
+        return it.value();
+    }
+    const int stringId = pColumn->strings.size();
+    pColumn->strings.append(value);
+    pColumn->stringIdsByValue.insert(value, stringId);
+    pColumn->stringRanksValid = false;
+    return stringId;
+}
+
+void ColumnarTrackInfo::setValue(int row, int column, const QVariant& value) {
+    VERIFY_OR_DEBUG_ASSERT(column >= 0 && column < columnCount()) {
+        return;
+    }
+    DEBUG_ASSERT(row >= 0 && row < m_trackIds.size());
+    Column* pColumn = &m_columns[column];
+    const bool isNull = !value.isValid() || value.isNull();
+    if (!isNull) {
+        const Kind kind = kindOfType(value.userType());
+        if (pColumn->kind == Kind::Empty) {
+            convertColumn(pColumn, kind, value.userType());
+        } else if (pColumn->kind != kind && pColumn->kind != Kind::Variant) {
+            // Values that are stored as text in the database might be
+            // provided with a different type by Track, e.g. QDateTime
+            const bool storeAsString = pColumn->kind == Kind::String &&
+                    value.canConvert(QMetaType::QString);
+            if (!storeAsString) {
+                convertColumn(pColumn, Kind::Variant, pColumn->type);
+            }
+        }
+    } else if (pColumn->kind == Kind::Empty) {
+        if (pColumn->type == QMetaType::UnknownType) {
+            pColumn->type = value.userType();
+        }
+        return;
+    }
+
+    switch (pColumn->kind) {
+    case Kind::Empty:
+        DEBUG_ASSERT(!"unreachable");
+        break;
+    case Kind::Integer:
+        pColumn->integers[row] = isNull ? 0 : value.toLongLong();
+        pColumn->nulls.setBit(row, isNull);
+        break;
+    case Kind::Double:
+        pColumn->doubles[row] = isNull ? 0.0 : value.toDouble();
+        pColumn->nulls.setBit(row, isNull);
+        break;
+    case Kind::String:
+        pColumn->stringIds[row] = isNull ? -1 : internString(pColumn, textOfValue(value));
+        break;
+    case Kind::Variant:
+        pColumn->variants[row] = value;
+        break;
+    }
+}
+
+QVariant ColumnarTrackInfo::value(int row, int column) const {
+    if (column < 0 || column >= columnCount()) {
+        return QVariant();
+    }
+    DEBUG_ASSERT(row >= 0 && row < m_trackIds.size());
+    const Column& col = m_columns[column];
+    QVariant result;
+    switch (col.kind) {
+    case Kind::Empty:
+        return QVariant(QVariant::Type(col.type));
+    case Kind::Integer:
+        if (col.nulls.testBit(row)) {
+            return QVariant(QVariant::Type(col.type));
+        }
+        result = QVariant(col.integers[row]);
+        break;
+    case Kind::Double:
+        if (col.nulls.testBit(row)) {
+            return QVariant(QVariant::Type(col.type));
+        }
+        result = QVariant(col.doubles[row]);
+        break;
+    case Kind::String: {
+        const int stringId = col.stringIds[row];
+        if (stringId < 0) {
+            return QVariant(QVariant::Type(col.type));
+        }
+        return QVariant(col.strings[stringId]);
+    }
+    case Kind::Variant:
+        return col.variants[row];
+    }
+    // Restore the original type, e.g. bool or int
+    if (result.userType() != col.type) {
+        result.convert(col.type);
+    }
+    return result;
+}
+
+void ColumnarTrackInfo::setStringSortKeyFunction(
+        int column,
+        StringSortKeyFunction sortKeyFunction) {
+    VERIFY_OR_DEBUG_ASSERT(column >= 0 && column < columnCount()) {
+        return;
+    }
+    m_columns[column].stringSortKeyFunction = std::move(sortKeyFunction);
+    invalidateSortRanks(column);
+}
+
+bool ColumnarTrackInfo::isSortable(int column) const {
+    if (column < 0 || column >= columnCount()) {
+        return false;
+    }
+    return m_columns[column].kind != Kind::Variant;
+}
+
+void ColumnarTrackInfo::invalidateSortRanks(int column) {
+    VERIFY_OR_DEBUG_ASSERT(column >= 0 && column < columnCount()) {
+        return;
+    }
+    m_columns[column].stringRanksValid = false;
+}
+
+void ColumnarTrackInfo::updateSortRanks(int column) {
+    VERIFY_OR_DEBUG_ASSERT(column >= 0 && column < columnCount()) {
+        return;
+    }
+    Column* pColumn = &m_columns[column];
+    if (pColumn->kind != Kind::String || pColumn->stringRanksValid) {
+        return;
+    }
+    const int stringCount = pColumn->strings.size();
+    // The collation keys are computed only once for each string
+    pColumn->stringCollationKeys.reserve(stringCount);
+    for (int i = static_cast<int>(pColumn->stringCollationKeys.size());
+            i < stringCount;
+            ++i) {
+        pColumn->stringCollationKeys.push_back(
+                m_collator.sortKey(pColumn->strings[i]));
+    }
+    QVector<int> sortKeys(stringCount);
+    if (pColumn->stringSortKeyFunction) {
+        for (int i = 0; i < stringCount; ++i) {
+            sortKeys[i] = pColumn->stringSortKeyFunction(pColumn->strings[i]);
+        }
+    }
+    QVector<int> stringIds(stringCount);
+    for (int i = 0; i < stringCount; ++i) {
+        stringIds[i] = i;
+    }
+    std::sort(stringIds.begin(), stringIds.end(), [&](int id1, int id2) {
+        if (sortKeys[id1] != sortKeys[id2]) {
+            return sortKeys[id1] < sortKeys[id2];
+        }
+        return pColumn->stringCollationKeys[id1].compare(
+                       pColumn->stringCollationKeys[id2]) < 0;
+    });
+    // Equal strings get the same rank
+    pColumn->stringRanks.resize(stringCount);
+    int rank = 0;
+    for (int i = 0; i < stringCount; ++i) {
+        if (i > 0) {
+            const int previousId = stringIds[i - 1];
+            const int id = stringIds[i];
+            if (sortKeys[previousId] != sortKeys[id] ||
+                    pColumn->stringCollationKeys[previousId].compare(
+                            pColumn->stringCollationKeys[id]) != 0) {
+                ++rank;
+            }
+        }
+        pColumn->stringRanks[stringIds[i]] = rank;
+    }
+    pColumn->stringRanksValid = true;
+}
+
+int ColumnarTrackInfo::compare(int column, int row1, int row2) const {
+    DEBUG_ASSERT(isSortable(column));
+    const Column& col = m_columns[column];
+    switch (col.kind) {
+    case Kind::Empty:
+        return 0;
+    case Kind::Integer:
+    case Kind::Double: {
+        const bool isNull1 = col.nulls.testBit(row1);
+        const bool isNull2 = col.nulls.testBit(row2);
+        if (isNull1 || isNull2) {
+            return compareValues(!isNull1, !isNull2);
+        }
+        if (col.kind == Kind::Integer) {
+            return compareValues(col.integers[row1], col.integers[row2]);
+        }
+        return compareValues(col.doubles[row1], col.doubles[row2]);
+    }
+    case Kind::String: {
+        DEBUG_ASSERT(col.stringRanksValid);
+        const int stringId1 = col.stringIds[row1];
+        const int stringId2 = col.stringIds[row2];
+        if (stringId1 < 0 || stringId2 < 0) {
+            return compareValues(stringId1 >= 0, stringId2 >= 0);
+        }
+        return compareValues(col.stringRanks[stringId1], col.stringRanks[stringId2]);
+    }
+    case Kind::Variant:
+        break;
+    }
+    return 0;
+}
+
+size_t ColumnarTrackInfo::memoryUsage() const {
+    size_t bytes = m_trackIds.size() * (sizeof(TrackId) + sizeof(int));
+    for (const auto& column : m_columns) {
+        bytes += column.integers.size() * sizeof(qint64);
+        bytes += column.doubles.size() * sizeof(double);
+        bytes += column.variants.size() * sizeof(QVariant);
+        bytes += column.nulls.size() / 8;
+        bytes += column.stringIds.size() * sizeof(int);
+        bytes += column.stringRanks.size() * sizeof(int);
+        for (const auto& string : column.strings) {
+            bytes += sizeof(QString) + string.size() * sizeof(QChar);
+        }
+    }
+    return bytes;
+}
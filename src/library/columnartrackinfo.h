@@ -0,0 +1,141 @@
+#pragma once
+
+#include <QBitArray>
+#include <QCollatorSortKey>
+#include <QHash>
+#include <QString>
+#include <QVariant>
+#include <QVector>
+#include <functional>
+#include <vector>
+
+#include "track/trackid.h"
+#include "util/string.h"
+
+/// Column-oriented storage of the values that are cached by BaseTrackCache.
+///
+/// Each column stores its values in a contiguous, typed array that is
+/// chosen by the type of the values: integers, floating point numbers,
+/// or strings that are interned per column. Columns with values of
+/// mixed or other types fall back to storing QVariant.
+///
+/// Interned strings are ranked by their collation keys, which are
+/// computed only once per string. Comparing rows by these ranks is
+/// as cheap as comparing numbers and needed for sorting in memory.
+class ColumnarTrackInfo {
+  public:
+    /// Maps a string to a number that takes precedence over the
+    /// collation order when ranking the strings of a column.
+    typedef std::function<int(const QString&)> StringSortKeyFunction;
+
+    explicit ColumnarTrackInfo(int columnCount);
+
+    int columnCount() const {
+        return static_cast<int>(m_columns.size());
+    }
+
+    /// The number of tracks
+    int size() const {
+        return m_trackIds.size();
+    }
+
+    bool contains(TrackId trackId) const {
+        return m_rowsByTrackId.contains(trackId);
+    }
+
+    /// Returns -1 if the track is missing
+    int row(TrackId trackId) const {
+        return m_rowsByTrackId.value(trackId, -1);
+    }
+
+    TrackId trackId(int row) const {
+        return m_trackIds[row];
+    }
+
+    /// Returns the row of the track. A new row with all values set to
+    /// null is added if the track is missing.
+    int insert(TrackId trackId);
+
+    void remove(TrackId trackId);
+
+    void clear();
+
+    /// Invalid values are stored as null values.
+    void setValue(int row, int column, const QVariant& value);
+
+    /// Returns an invalid QVariant if the column does not exist.
+    QVariant value(int row, int column) const;
+
+    /// Sets the function for ranking the strings of the column in
+    /// addition to their collation order.
+    void setStringSortKeyFunction(
+            int column,
+            StringSortKeyFunction sortKeyFunction);
+
+    /// Whether compare() is supported for the column.
+    bool isSortable(int column) const;
+
+    /// Ranks the strings of the column if they have changed since the
+    /// last update. Must be invoked before compare().
+    void updateSortRanks(int column);
+
+    /// Needs to be invoked if the results of the string sort key function
+    /// have changed, e.g. after changing the key notation.
+    void invalidateSortRanks(int column);
+
+    /// Compares the values of 2 rows in ascending order. Null values are
+    /// ordered first. Only const members are accessed, i.e. rows might be
+    /// compared on multiple threads concurrently.
+    int compare(int column, int row1, int row2) const;
+
+    /// The approximate number of bytes that is occupied by all columns
+    size_t memoryUsage() const;
+
+  private:
+    enum class Kind {
+        // No values except null values have been stored yet
+        Empty,
+        Integer,
+        Double,
+        String,
+        Variant,
+    };
+
+    struct Column {
+        Column();
+
+        Kind kind;
+        // The type of the values that are returned for this column
+        int type;
+
+        // Only the array for the kind of column is populated
+        QVector<qint64> integers;
+        QVector<double> doubles;
+        QVector<QVariant> variants;
+        // Null values of Integer and Double columns
+        QBitArray nulls;
+
+        // Interned strings, -1 for null values
+        QVector<int> stringIds;
+        QVector<QString> strings;
+        QHash<QString, int> stringIdsByValue;
+        std::vector<QCollatorSortKey> stringCollationKeys;
+        // The rank of each string id in ascending order
+        QVector<int> stringRanks;
+        bool stringRanksValid;
+        StringSortKeyFunction stringSortKeyFunction;
+    };
+
+    static Kind kindOfType(int type);
+
+    static void resizeColumn(Column* pColumn, int oldRowCount, int rowCount);
+    void convertColumn(Column* pColumn, Kind kind, int type);
+    int internString(Column* pColumn, const QString& value);
+    void moveRow(int fromRow, int toRow);
+
+    const mixxx::StringCollator m_collator;
+
+    std::vector<Column> m_columns;
+    QVector<TrackId> m_trackIds;
+    QHash<TrackId, int> m_rowsByTrackId;
+};
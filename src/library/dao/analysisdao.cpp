@@ -1,3 +1,4 @@
+#include <QFileInfo>
 #include <QSqlQuery>
 #include <QSqlResult>
 #include <QSqlError>
@@ -32,7 +33,7 @@ QList<AnalysisDao::AnalysisInfo> AnalysisDao::getAnalysesForTrack(TrackId trackI
 
     QSqlQuery query(m_database);
     query.prepare(QString(
-        "SELECT id, type, description, version, data_checksum FROM %1 "
+        "SELECT id, type, description, version, data_format, data_checksum FROM %1 "
         "WHERE track_id=:trackId").arg(s_analysisTableName));
     query.bindValue(":trackId", trackId.toVariant());
 
@@ -47,7 +48,7 @@ QList<AnalysisDao::AnalysisInfo> AnalysisDao::getAnalysesForTrackByType(
 
     QSqlQuery query(m_database);
     query.prepare(QString(
-        "SELECT id, type, description, version, data_checksum FROM %1 "
+        "SELECT id, type, description, version, data_format, data_checksum FROM %1 "
         "WHERE track_id=:trackId AND type=:type").arg(s_analysisTableName));
     query.bindValue(":trackId", trackId.toVariant());
     query.bindValue(":type", type);
@@ -71,6 +72,7 @@ QList<AnalysisDao::AnalysisInfo> AnalysisDao::loadAnalysesFromQuery(TrackId trac
     const int typeColumn = queryRecord.indexOf("type");
     const int descriptionColumn = queryRecord.indexOf("description");
     const int versionColumn = queryRecord.indexOf("version");
+    const int dataFormatColumn = queryRecord.indexOf("data_format");
     const int dataChecksumColumn = queryRecord.indexOf("data_checksum");
 
     QDir analysisPath(getAnalysisStoragePath());
@@ -81,9 +83,24 @@ QList<AnalysisDao::AnalysisInfo> AnalysisDao::loadAnalysesFromQuery(TrackId trac
         info.type = static_cast<AnalysisType>(query->value(typeColumn).toInt());
         info.description = query->value(descriptionColumn).toString();
         info.version = query->value(versionColumn).toString();
+        info.dataFormat = static_cast<DataFormat>(query->value(dataFormatColumn).toInt());
         int checksum = query->value(dataChecksumColumn).toInt();
         QString dataPath = analysisPath.absoluteFilePath(
             QString::number(info.analysisId));
+        info.dataPath = dataPath;
+        if (info.dataFormat == DataFormat::Uncompressed) {
+            // The data is loaded by the consumer and only the size is
+            // checked here instead of reading the whole file.
+            const qint64 fileSize = QFileInfo(dataPath).size();
+            if (checksum != fileSize) {
+                qDebug() << "WARNING: Corrupt analysis found at" << dataPath
+                         << "length" << fileSize;
+                continue;
+            }
+            bytes += fileSize;
+            analyses.append(info);
+            continue;
+        }
         QByteArray compressedData = loadDataFromFile(dataPath);
         int file_checksum = qChecksum(compressedData.constData(),
                                       compressedData.length());
@@ -114,21 +131,29 @@ bool AnalysisDao::saveAnalysis(AnalysisDao::AnalysisInfo* info) {
     PerformanceTimer time;
     time.start();
 
-    QByteArray compressedData = qCompress(info->data, kCompressionLevel);
-    int checksum = qChecksum(compressedData.constData(),
+    QByteArray compressedData;
+    int checksum;
+    if (info->dataFormat == DataFormat::Uncompressed) {
+        compressedData = info->data;
+        checksum = compressedData.length();
+    } else {
+        compressedData = qCompress(info->data, kCompressionLevel);
+        checksum = qChecksum(compressedData.constData(),
                              compressedData.length());
+    }
 
     QSqlQuery query(m_database);
     if (info->analysisId == -1) {
         query.prepare(QString(
-            "INSERT INTO %1 (track_id, type, description, version, data_checksum) "
-            "VALUES (:trackId,:type,:description,:version,:data_checksum)")
+            "INSERT INTO %1 (track_id, type, description, version, data_format, data_checksum) "
+            "VALUES (:trackId,:type,:description,:version,:data_format,:data_checksum)")
                       .arg(s_analysisTableName));
 
         query.bindValue(":trackId", info->trackId.toVariant());
         query.bindValue(":type", info->type);
         query.bindValue(":description", info->description);
         query.bindValue(":version", info->version);
+        query.bindValue(":data_format", static_cast<int>(info->dataFormat));
         query.bindValue(":data_checksum", checksum);
 
         if (!query.exec()) {
@@ -143,6 +168,7 @@ bool AnalysisDao::saveAnalysis(AnalysisDao::AnalysisInfo* info) {
             "type = :type,"
             "description = :description,"
             "version = :version,"
+            "data_format = :data_format,"
             "data_checksum = :data_checksum "
             "WHERE id = :analysisId").arg(s_analysisTableName));
 
@@ -151,6 +177,7 @@ bool AnalysisDao::saveAnalysis(AnalysisDao::AnalysisInfo* info) {
         query.bindValue(":type", info->type);
         query.bindValue(":description", info->description);
         query.bindValue(":version", info->version);
+        query.bindValue(":data_format", static_cast<int>(info->dataFormat));
         query.bindValue(":data_checksum", checksum);
 
         if (!query.exec()) {
@@ -161,6 +188,7 @@ bool AnalysisDao::saveAnalysis(AnalysisDao::AnalysisInfo* info) {
 
     QString dataPath = getAnalysisStoragePath().absoluteFilePath(
         QString::number(info->analysisId));
+    info->dataPath = dataPath;
     if (!saveDataToFile(dataPath, compressedData)) {
         qDebug() << "WARNING: Couldn't save analysis data to file" << dataPath;
         return false;
@@ -327,6 +355,7 @@ void AnalysisDao::saveTrackAnalyses(
         analysis.analysisId = pWaveform->getId();
     }
     analysis.type = AnalysisDao::TYPE_WAVEFORM;
+    analysis.dataFormat = DataFormat::Uncompressed;
     analysis.description = pWaveform->getDescription();
     analysis.version = pWaveform->getVersion();
     analysis.data = pWaveform->toByteArray();
@@ -341,6 +370,9 @@ void AnalysisDao::saveTrackAnalyses(
 
     // Clear analysisId since we are re-using the AnalysisInfo
     analysis.analysisId = -1;
+    if (pWaveSummary->getId() != -1) {
+        analysis.analysisId = pWaveSummary->getId();
+    }
     analysis.type = AnalysisDao::TYPE_WAVESUMMARY;
     analysis.description = pWaveSummary->getDescription();
     analysis.version = pWaveSummary->getVersion();
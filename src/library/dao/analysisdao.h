@@ -19,17 +19,29 @@ class AnalysisDao : public DAO {
         TYPE_WAVESUMMARY
     };
 
+    // How the data is stored in the analysis file
+    enum class DataFormat {
+        // qCompress'd, loaded into AnalysisInfo::data
+        Compressed = 0,
+        // Stored as is and not loaded into AnalysisInfo::data. The file
+        // at AnalysisInfo::dataPath can be memory-mapped instead.
+        Uncompressed = 1,
+    };
+
     struct AnalysisInfo {
         AnalysisInfo()
                 : analysisId(-1),
-                  type(TYPE_UNKNOWN) {
+                  type(TYPE_UNKNOWN),
+                  dataFormat(DataFormat::Compressed) {
         }
         int analysisId;
         TrackId trackId;
         AnalysisType type;
         QString description;
         QString version;
+        DataFormat dataFormat;
         QByteArray data;
+        QString dataPath;
     };
 
     explicit AnalysisDao(UserSettingsPointer pConfig);
@@ -3,9 +3,16 @@
 #include <QtDebug>
 #include <QVariant>
 #include <QThread>
+#include <QFile>
+#include <QFileInfo>
+
+#ifdef Q_OS_UNIX
+#include <sys/stat.h>
+#endif
 
 #include "libraryhashdao.h"
 #include "library/queryutil.h"
+#include "track/trackfile.h"
 
 namespace {
 
@@ -16,8 +23,31 @@ inline constexpr mixxx::cache_key_signed_t dbHash(mixxx::cache_key_t hash) {
     return mixxx::signedCacheKey(hash);
 }
 
+// Subdirectories are selected by their path prefix. All paths that
+// start with "<dirPath>/" are ordered before "<dirPath>0", because
+// '0' directly follows '/' in the character set.
+const QString kSubdirectoriesCondition = QStringLiteral(
+        "(directory_path>=:prefix AND directory_path<:prefix_end)");
+
 } // anonymous namespace
 
+// static
+LibraryFileStatus LibraryFileStatus::fromFileInfo(const QFileInfo& fileInfo) {
+    LibraryFileStatus fileStatus;
+    fileStatus.location = TrackFile(fileInfo).location();
+    fileStatus.size = fileInfo.size();
+    fileStatus.modifiedAt = fileInfo.lastModified().toMSecsSinceEpoch();
+#ifdef Q_OS_UNIX
+    // The inode changes if a file has been replaced, even if the
+    // size and modification time have been preserved.
+    struct stat fileStat;
+    if (::stat(QFile::encodeName(fileInfo.filePath()).constData(), &fileStat) == 0) {
+        fileStatus.inode = static_cast<quint64>(fileStat.st_ino);
+    }
+#endif
+    return fileStatus;
+}
+
 QHash<QString, mixxx::cache_key_t> LibraryHashDAO::getDirectoryHashes() {
     QSqlQuery query(m_database);
     query.prepare("SELECT hash, directory_path FROM LibraryHashes");
@@ -144,6 +174,32 @@ void LibraryHashDAO::invalidateAllDirectories() {
     }
 }
 
+void LibraryHashDAO::invalidateDirectories(const QStringList& dirPaths,
+                                           bool includeSubdirectories) {
+    QSqlQuery query(m_database);
+    if (includeSubdirectories) {
+        query.prepare(QStringLiteral("UPDATE LibraryHashes "
+                                     "SET needs_verification=1 "
+                                     "WHERE directory_path=:directory_path OR ") +
+                kSubdirectoriesCondition);
+    } else {
+        query.prepare("UPDATE LibraryHashes "
+                      "SET needs_verification=1 "
+                      "WHERE directory_path=:directory_path");
+    }
+    for (const auto& dirPath : dirPaths) {
+        query.bindValue(":directory_path", dirPath);
+        if (includeSubdirectories) {
+            query.bindValue(":prefix", dirPath + QChar('/'));
+            query.bindValue(":prefix_end", dirPath + QChar('0'));
+        }
+        if (!query.exec()) {
+            LOG_FAILED_QUERY(query)
+                    << "Couldn't mark directory as needing verification.";
+        }
+    }
+}
+
 void LibraryHashDAO::markUnverifiedDirectoriesAsDeleted() {
     //qDebug() << "LibraryHashDAO::markUnverifiedDirectoriesAsDeleted"
     //<< QThread::currentThread() << m_database.connectionName();
@@ -159,6 +215,14 @@ void LibraryHashDAO::markUnverifiedDirectoriesAsDeleted() {
 
 void LibraryHashDAO::removeDeletedDirectoryHashes() {
     QSqlQuery query(m_database);
+    query.prepare("DELETE FROM LibraryFiles WHERE directory_path IN "
+                  "(SELECT directory_path FROM LibraryHashes WHERE "
+                  "directory_deleted=:directory_deleted)");
+    query.bindValue(":directory_deleted", 1);
+    if (!query.exec()) {
+        LOG_FAILED_QUERY(query);
+    }
+
     query.prepare("DELETE FROM LibraryHashes WHERE "
                "directory_deleted=:directory_deleted");
     query.bindValue(":directory_deleted", 1);
@@ -182,3 +246,78 @@ QStringList LibraryHashDAO::getDeletedDirectories() {
     }
     return result;
 }
+
+QHash<QString, LibraryFileStatus> LibraryHashDAO::getFileStatuses() {
+    QSqlQuery query(m_database);
+    query.setForwardOnly(true);
+    query.prepare("SELECT location, filesize, modified_at, inode FROM LibraryFiles");
+    QHash<QString, LibraryFileStatus> fileStatuses;
+    if (!query.exec()) {
+        LOG_FAILED_QUERY(query);
+        return fileStatuses;
+    }
+    readFileStatuses(&query, &fileStatuses);
+    return fileStatuses;
+}
+
+QHash<QString, LibraryFileStatus> LibraryHashDAO::getFileStatuses(
+        const QStringList& dirPaths) {
+    QSqlQuery query(m_database);
+    query.setForwardOnly(true);
+    query.prepare("SELECT location, filesize, modified_at, inode FROM LibraryFiles "
+                  "WHERE directory_path=:directory_path");
+    QHash<QString, LibraryFileStatus> fileStatuses;
+    for (const auto& dirPath : dirPaths) {
+        query.bindValue(":directory_path", dirPath);
+        if (!query.exec()) {
+            LOG_FAILED_QUERY(query);
+            continue;
+        }
+        readFileStatuses(&query, &fileStatuses);
+    }
+    return fileStatuses;
+}
+
+// static
+void LibraryHashDAO::readFileStatuses(QSqlQuery* pQuery,
+        QHash<QString, LibraryFileStatus>* pFileStatuses) {
+    QSqlQuery& query = *pQuery;
+    const int locationColumn = query.record().indexOf("location");
+    const int sizeColumn = query.record().indexOf("filesize");
+    const int modifiedAtColumn = query.record().indexOf("modified_at");
+    const int inodeColumn = query.record().indexOf("inode");
+    while (query.next()) {
+        LibraryFileStatus fileStatus;
+        fileStatus.location = query.value(locationColumn).toString();
+        fileStatus.size = query.value(sizeColumn).toLongLong();
+        fileStatus.modifiedAt = query.value(modifiedAtColumn).toLongLong();
+        fileStatus.inode = query.value(inodeColumn).toULongLong();
+        pFileStatuses->insert(fileStatus.location, fileStatus);
+    }
+}
+
+void LibraryHashDAO::saveFileStatuses(const QString& dirPath,
+                                      const QList<LibraryFileStatus>& fileStatuses) {
+    QSqlQuery query(m_database);
+    query.prepare("DELETE FROM LibraryFiles WHERE directory_path=:directory_path");
+    query.bindValue(":directory_path", dirPath);
+    if (!query.exec()) {
+        LOG_FAILED_QUERY(query) << "Deleting file statuses failed.";
+        return;
+    }
+
+    query.prepare("INSERT INTO LibraryFiles "
+                  "(location, directory_path, filesize, modified_at, inode) "
+                  "VALUES (:location, :directory_path, :filesize, :modified_at, :inode)");
+    for (const auto& fileStatus : fileStatuses) {
+        query.bindValue(":location", fileStatus.location);
+        query.bindValue(":directory_path", dirPath);
+        query.bindValue(":filesize", fileStatus.size);
+        query.bindValue(":modified_at", fileStatus.modifiedAt);
+        // Stored as a signed 64-bit integer like the directory hashes
+        query.bindValue(":inode", static_cast<qint64>(fileStatus.inode));
+        if (!query.exec()) {
+            LOG_FAILED_QUERY(query) << "Saving file status failed.";
+        }
+    }
+}
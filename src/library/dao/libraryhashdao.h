@@ -2,12 +2,46 @@
 
 #include <QObject>
 #include <QHash>
+#include <QList>
+#include <QMetaType>
 #include <QString>
 #include <QSqlDatabase>
+#include <QStringList>
 
 #include "library/dao/dao.h"
 #include "util/cache.h"
 
+class QFileInfo;
+class QSqlQuery;
+
+// The file system properties of a file in one of the library
+// directories. A file is considered as modified if any of these
+// properties has changed since the last scan.
+struct LibraryFileStatus {
+    // Reads the properties from the file system
+    static LibraryFileStatus fromFileInfo(const QFileInfo& fileInfo);
+
+    QString location;
+    qint64 size = -1;
+    // Milliseconds since epoch
+    qint64 modifiedAt = -1;
+    // Only available on Unix, otherwise 0
+    quint64 inode = 0;
+};
+
+inline bool operator==(const LibraryFileStatus& lhs, const LibraryFileStatus& rhs) {
+    return lhs.location == rhs.location &&
+            lhs.size == rhs.size &&
+            lhs.modifiedAt == rhs.modifiedAt &&
+            lhs.inode == rhs.inode;
+}
+
+inline bool operator!=(const LibraryFileStatus& lhs, const LibraryFileStatus& rhs) {
+    return !(lhs == rhs);
+}
+
+Q_DECLARE_METATYPE(LibraryFileStatus);
+
 class LibraryHashDAO : public DAO {
   public:
     ~LibraryHashDAO() override = default;
@@ -19,9 +53,28 @@ class LibraryHashDAO : public DAO {
                              int dir_deleted);
     void markAsExisting(const QString& dirPath);
     void invalidateAllDirectories();
+    // Only invalidates the given directories and optionally all
+    // of their subdirectories.
+    void invalidateDirectories(const QStringList& dirPaths,
+                               bool includeSubdirectories);
     void markUnverifiedDirectoriesAsDeleted();
+    // Also removes the file statuses of these directories
     void removeDeletedDirectoryHashes();
     void updateDirectoryStatuses(const QStringList& dirPaths,
                                  const bool deleted, const bool verified);
     QStringList getDeletedDirectories();
+
+    // The file statuses of all files in the library directories
+    // by location.
+    QHash<QString, LibraryFileStatus> getFileStatuses();
+    // Only the file statuses of files that are directly contained in
+    // the given directories
+    QHash<QString, LibraryFileStatus> getFileStatuses(const QStringList& dirPaths);
+    // Replaces the file statuses of all files in the directory
+    void saveFileStatuses(const QString& dirPath,
+                          const QList<LibraryFileStatus>& fileStatuses);
+
+  private:
+    static void readFileStatuses(QSqlQuery* pQuery,
+            QHash<QString, LibraryFileStatus>* pFileStatuses);
 };
@@ -434,17 +434,15 @@ PlaylistDAO::HiddenType PlaylistDAO::getHiddenType(const int playlistId) const {
     // qDebug() << "PlaylistDAO::getHiddenType"
     //          << QThread::currentThread() << m_database.connectionName();
 
-    QSqlQuery query(m_database);
-    query.prepare(QStringLiteral(
-            "SELECT hidden FROM Playlists WHERE id = :id"));
-    query.bindValue(":id", playlistId);
+    FwdSqlQuery query(m_database,
+            QStringLiteral(
+                    "SELECT hidden FROM Playlists WHERE id = :id"));
+    query.bindValue(QStringLiteral(":id"), playlistId);
 
-    if (query.exec()) {
+    if (query.execPrepared()) {
         if (query.next()) {
-            return static_cast<HiddenType>(query.value(0).toInt());
+            return static_cast<HiddenType>(query.fieldValue(0).toInt());
         }
-    } else {
-        LOG_FAILED_QUERY(query);
     }
     qDebug() << "PlaylistDAO::getHiddenType returns PLHT_UNKNOWN for playlistId "
              << playlistId;
@@ -544,46 +542,48 @@ void PlaylistDAO::removeTracksFromPlaylist(int playlistId, const QList<int>& pos
 }
 
 void PlaylistDAO::removeTracksFromPlaylistInner(int playlistId, int position) {
-    QSqlQuery query(m_database);
-    query.prepare(QStringLiteral(
-            "SELECT track_id FROM PlaylistTracks "
-            "WHERE playlist_id=:id AND position=:position"));
-    query.bindValue(":id", playlistId);
-    query.bindValue(":position", position);
-
-    if (!query.exec()) {
-        LOG_FAILED_QUERY(query);
-        return;
-    }
+    // This function is invoked repeatedly when removing many tracks.
+    // The statements are prepared only once and reused by FwdSqlQuery.
+    TrackId trackId;
+    {
+        FwdSqlQuery query(m_database,
+                QStringLiteral(
+                        "SELECT track_id FROM PlaylistTracks "
+                        "WHERE playlist_id=:id AND position=:position"));
+        query.bindValue(QStringLiteral(":id"), playlistId);
+        query.bindValue(QStringLiteral(":position"), position);
+
+        if (!query.execPrepared()) {
+            return;
+        }
 
-    if (!query.next()) {
-        qDebug() << "removeTrackFromPlaylist no track exists at position:"
-                 << position << "in playlist:" << playlistId;
-        return;
+        if (!query.next()) {
+            qDebug() << "removeTrackFromPlaylist no track exists at position:"
+                     << position << "in playlist:" << playlistId;
+            return;
+        }
+        trackId = TrackId(query.fieldValue(0));
     }
-    TrackId trackId(query.value(query.record().indexOf("track_id")));
 
     // Delete the track from the playlist.
-    query.prepare(QStringLiteral(
-            "DELETE FROM PlaylistTracks "
-            "WHERE playlist_id=:id AND position=:position"));
-    query.bindValue(":id", playlistId);
-    query.bindValue(":position", position);
+    FwdSqlQuery deleteQuery(m_database,
+            QStringLiteral(
+                    "DELETE FROM PlaylistTracks "
+                    "WHERE playlist_id=:id AND position=:position"));
+    deleteQuery.bindValue(QStringLiteral(":id"), playlistId);
+    deleteQuery.bindValue(QStringLiteral(":position"), position);
 
-    if (!query.exec()) {
-        LOG_FAILED_QUERY(query);
+    if (!deleteQuery.execPrepared()) {
         return;
     }
 
-    query.prepare(QStringLiteral(
-            "UPDATE PlaylistTracks SET position=position-1 "
-            "WHERE position>=:position AND playlist_id=:id"));
-    query.bindValue(":id", playlistId);
-    query.bindValue(":position", position);
-
-    if (!query.exec()) {
-        LOG_FAILED_QUERY(query);
-    }
+    FwdSqlQuery updateQuery(m_database,
+            QStringLiteral(
+                    "UPDATE PlaylistTracks SET position=position-1 "
+                    "WHERE position>=:position AND playlist_id=:id"));
+    updateQuery.bindValue(QStringLiteral(":id"), playlistId);
+    updateQuery.bindValue(QStringLiteral(":position"), position);
+    updateQuery.execPrepared();
 
     m_playlistsTrackIsIn.remove(trackId, playlistId);
 
@@ -817,19 +817,16 @@ bool PlaylistDAO::copyPlaylistTracks(const int sourcePlaylistID, const int targe
 int PlaylistDAO::getMaxPosition(const int playlistId) const {
     // Find out the highest position existing in the playlist so we know what
     // position this track should have.
-    QSqlQuery query(m_database);
-    query.prepare(QStringLiteral(
-            "SELECT max(position) as position FROM PlaylistTracks "
-            "WHERE playlist_id = :id"));
-    query.bindValue(":id", playlistId);
-    if (!query.exec()) {
-        LOG_FAILED_QUERY(query);
-    }
+    FwdSqlQuery query(m_database,
+            QStringLiteral(
+                    "SELECT max(position) as position FROM PlaylistTracks "
+                    "WHERE playlist_id = :id"));
+    query.bindValue(QStringLiteral(":id"), playlistId);
 
     // Get the position of the highest track in the playlist.
     int position = 0;
-    if (query.next()) {
-        position = query.value(query.record().indexOf("position")).toInt();
+    if (query.execPrepared() && query.next()) {
+        position = query.fieldValue(0).toInt();
     }
     return position;
 }
@@ -780,7 +780,10 @@ TrackId TrackDAO::addTracksAddTrack(const TrackPointer& pTrack, bool unremove) {
     return trackId;
 }
 
-TrackPointer TrackDAO::addTracksAddFile(const TrackFile& trackFile, bool unremove) {
+TrackPointer TrackDAO::addTracksAddFile(
+        const TrackFile& trackFile,
+        bool unremove,
+        const PreparedTrackImport* pPreparedImport) {
     // Check that track is a supported extension.
     // TODO(uklotzde): The following check can be skipped if
     // the track is already in the library. A refactoring is
@@ -827,8 +830,11 @@ TrackPointer TrackDAO::addTracksAddFile(const TrackFile& trackFile, bool unremov
     // object is known and has been updated in the cache.
 
     // Initially (re-)import the metadata for the newly created track
-    // from the file.
-    SoundSourceProxy(pTrack).updateTrackFromSource();
+    // from the file unless it has already been imported in advance.
+    SoundSourceProxy proxy(pTrack);
+    if (!pPreparedImport || !proxy.updateTrackFromPreparedImport(*pPreparedImport)) {
+        proxy.updateTrackFromSource();
+    }
     if (!pTrack->isMetadataSynchronized()) {
         qWarning() << "TrackDAO::addTracksAddFile:"
                 << "Failed to parse track metadata from file"
@@ -1657,6 +1663,33 @@ void TrackDAO::invalidateTrackLocationsInLibrary() const {
     }
 }
 
+void TrackDAO::invalidateTrackLocationsInDirectories(
+        const QStringList& directories,
+        bool includeSubdirectories) const {
+    QSqlQuery query(m_database);
+    if (includeSubdirectories) {
+        // All paths that start with "<directory>/" are ordered
+        // before "<directory>0"
+        query.prepare("UPDATE track_locations SET needs_verification=1 "
+                      "WHERE directory=:directory OR "
+                      "(directory>=:prefix AND directory<:prefix_end)");
+    } else {
+        query.prepare("UPDATE track_locations SET needs_verification=1 "
+                      "WHERE directory=:directory");
+    }
+    for (const auto& directory : directories) {
+        query.bindValue(":directory", directory);
+        if (includeSubdirectories) {
+            query.bindValue(":prefix", directory + QChar('/'));
+            query.bindValue(":prefix_end", directory + QChar('0'));
+        }
+        VERIFY_OR_DEBUG_ASSERT(query.exec()) {
+            LOG_FAILED_QUERY(query)
+                    << "Couldn't mark tracks in" << directory << "as needing verification.";
+        }
+    }
+}
+
 void TrackDAO::markTrackLocationsAsVerified(const QStringList& locations) const {
     //qDebug() << "TrackDAO::markTrackLocationsAsVerified" << QThread::currentThread() << m_database.connectionName();
 
@@ -20,6 +20,7 @@ class PlaylistDAO;
 class AnalysisDao;
 class CueDAO;
 class LibraryHashDAO;
+struct PreparedTrackImport;
 
 class TrackDAO : public QObject, public virtual DAO, public virtual GlobalTrackCacheRelocator {
     Q_OBJECT
@@ -118,9 +119,12 @@ class TrackDAO : public QObject, public virtual DAO, public virtual GlobalTrackC
     TrackId addTracksAddTrack(
             const TrackPointer& pTrack,
             bool unremove);
+    // The file is only parsed if the track is not known yet and the
+    // optional prepared import is either missing or cannot be used.
     TrackPointer addTracksAddFile(
             const TrackFile& trackFile,
-            bool unremove);
+            bool unremove,
+            const PreparedTrackImport* pPreparedImport = nullptr);
     void addTracksFinish(bool rollback = false);
 
     bool updateTrack(Track* pTrack) const;
@@ -146,6 +150,9 @@ class TrackDAO : public QObject, public virtual DAO, public virtual GlobalTrackC
     void markTrackLocationsAsVerified(const QStringList& locations) const;
     void markTracksInDirectoriesAsVerified(const QStringList& directories) const;
     void invalidateTrackLocationsInLibrary() const;
+    void invalidateTrackLocationsInDirectories(
+            const QStringList& directories,
+            bool includeSubdirectories) const;
     void markUnverifiedTracksAsDeleted();
 
     bool verifyRemainingTracks(
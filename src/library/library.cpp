@@ -137,6 +137,7 @@ Library::Library(
             &PlayerManager::trackAnalyzerIdle,
             this,
             &Library::onPlayerManagerTrackAnalyzerIdle);
+    m_pAnalysisFeature->resumePersistedQueue();
 
     // iTunes and Rhythmbox should be last until we no longer have an obnoxious
     // messagebox popup when you select them. (This forces you to reach for your
@@ -228,7 +229,7 @@ TrackCollectionManager* Library::trackCollections() const {
 
 void Library::stopPendingTasks() {
     if (m_pAnalysisFeature) {
-        m_pAnalysisFeature->stopAnalysis();
+        m_pAnalysisFeature->stopAnalysisAndPersistQueue();
         m_pAnalysisFeature = nullptr;
     }
 }
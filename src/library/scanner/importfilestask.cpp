@@ -1,16 +1,29 @@
 #include "library/scanner/importfilestask.h"
 
+#include "library/coverartutils.h"
 #include "library/scanner/libraryscanner.h"
 #include "moc_importfilestask.cpp"
+#include "sources/soundsourceproxy.h"
 #include "track/trackfile.h"
 #include "util/timer.h"
 
+namespace {
+
+// The number of parsed files that are passed to the library scanner
+// thread at once for adding them to the database. Bigger batches
+// reduce the signaling overhead, but the database writer should
+// not wait too long for the first batch of a large directory.
+constexpr int kMaxTracksPerBatch = 32;
+
+} // anonymous namespace
+
 ImportFilesTask::ImportFilesTask(LibraryScanner* pScanner,
         const ScannerGlobalPointer scannerGlobal,
         const QString& dirPath,
         const bool prevHashExists,
         const mixxx::cache_key_t newHash,
         const std::list<QFileInfo>& filesToImport,
+        const QList<LibraryFileStatus>& fileStatuses,
         const std::list<QFileInfo>& possibleCovers,
         SecurityTokenPointer pToken)
         : ScannerTask(pScanner, scannerGlobal),
@@ -18,20 +31,29 @@ ImportFilesTask::ImportFilesTask(LibraryScanner* pScanner,
           m_prevHashExists(prevHashExists),
           m_newHash(newHash),
           m_filesToImport(filesToImport),
+          m_fileStatuses(fileStatuses),
           m_possibleCovers(possibleCovers),
           m_pToken(pToken) {
 }
 
 void ImportFilesTask::run() {
     ScopedTimer timer("ImportFilesTask::run");
+    // All files are located in the same directory and the possible
+    // cover art files in this directory are only searched once.
+    CoverInfoGuesser coverInfoGuesser;
+    QList<PreparedTrackImport> preparedImports;
+    DEBUG_ASSERT(m_fileStatuses.size() == static_cast<int>(m_filesToImport.size()));
+    auto fileStatusIter = m_fileStatuses.constBegin();
     for (const QFileInfo& fileInfo: m_filesToImport) {
+        const LibraryFileStatus& fileStatus = *fileStatusIter++;
         // If a flag was raised telling us to cancel the library scan then stop.
         if (m_scannerGlobal->shouldCancel()) {
             setSuccess(false);
             return;
         }
 
-        const QString trackLocation(TrackFile(fileInfo).location());
+        const TrackFile trackFile(fileInfo);
+        const QString trackLocation(trackFile.location());
         //qDebug() << "ImportFilesTask::run" << trackLocation;
 
         // If the file does not exist in the database then add it. If it
@@ -42,7 +64,11 @@ void ImportFilesTask::run() {
             // If the track is in the database, mark it as existing. This code gets
             // executed when other files in the same directory have changed (the
             // directory hash has changed).
-            emit trackExists(trackLocation);
+            if (m_scannerGlobal->fileModified(fileStatus)) {
+                emit trackModified(trackLocation);
+            } else {
+                emit trackExists(trackLocation);
+            }
         } else {
             if (!fileInfo.exists()) {
                 qWarning() << "ImportFilesTask: Skipping inaccessible file"
@@ -51,10 +77,21 @@ void ImportFilesTask::run() {
             }
             qDebug() << "Importing track" << trackLocation;
 
-            emit addNewTrack(trackLocation);
+            // Parse the file on this worker thread. Adding the track
+            // to the database is done by the library scanner thread.
+            preparedImports.append(SoundSourceProxy::prepareTrackImport(
+                    trackFile, &coverInfoGuesser));
+            if (preparedImports.size() >= kMaxTracksPerBatch) {
+                emit addNewTracks(preparedImports);
+                preparedImports.clear();
+            }
         }
     }
-    // Insert or update the hash in the database.
+    if (!preparedImports.isEmpty()) {
+        emit addNewTracks(preparedImports);
+    }
+    // Insert or update the file statuses and the hash in the database.
+    emit fileStatusesScanned(m_dirPath, m_fileStatuses);
     emit directoryHashedAndScanned(m_dirPath, !m_prevHashExists, m_newHash);
     setSuccess(true);
 }
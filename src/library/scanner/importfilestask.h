@@ -16,6 +16,7 @@ class ImportFilesTask : public ScannerTask {
             const bool prevHashExists,
             const mixxx::cache_key_t newHash,
             const std::list<QFileInfo>& filesToImport,
+            const QList<LibraryFileStatus>& fileStatuses,
             const std::list<QFileInfo>& possibleCovers,
             SecurityTokenPointer pToken);
     virtual ~ImportFilesTask() {}
@@ -27,6 +28,8 @@ class ImportFilesTask : public ScannerTask {
     const bool m_prevHashExists;
     const mixxx::cache_key_t m_newHash;
     const std::list<QFileInfo> m_filesToImport;
+    // The file statuses in the same order as the files
+    const QList<LibraryFileStatus> m_fileStatuses;
     const std::list<QFileInfo> m_possibleCovers;
     SecurityTokenPointer m_pToken;
 };
@@ -1,30 +1,60 @@
 #include "library/scanner/libraryscanner.h"
 
+#include <QDir>
+#include <memory>
+
 #include "library/coverartutils.h"
 #include "library/queryutil.h"
 #include "library/scanner/libraryscannerdlg.h"
+#include "library/scanner/librarywatcher.h"
 #include "library/scanner/recursivescandirectorytask.h"
 #include "library/scanner/scannertask.h"
 #include "library/scanner/scannerutil.h"
 #include "moc_libraryscanner.cpp"
 #include "sources/soundsourceproxy.h"
 #include "track/track.h"
+#include "track/trackref.h"
 #include "util/db/dbconnectionpooled.h"
 #include "util/db/dbconnectionpooler.h"
 #include "util/db/fwdsqlquery.h"
 #include "util/file.h"
 #include "util/logger.h"
+#include "util/math.h"
 #include "util/performancetimer.h"
 #include "util/timer.h"
 #include "util/trace.h"
 
 namespace {
 
-// TODO(rryan) make configurable
-const int kScannerThreadPoolSize = 1;
+const ConfigKey kScannerThreadPoolSizeConfigKey =
+        ConfigKey(QStringLiteral("[Library]"), QStringLiteral("ScannerThreadPoolSize"));
+
+// Scanning directories and parsing files is often limited by the
+// latency of the file system rather than by the CPU, e.g. for network
+// shares. The number of threads could be increased in the settings.
+int scannerThreadPoolSize(const UserSettingsPointer& pConfig) {
+    const int defaultSize = math_max(QThread::idealThreadCount(), 1);
+    if (!pConfig) {
+        return defaultSize;
+    }
+    const int size = pConfig->getValue(kScannerThreadPoolSizeConfigKey, defaultSize);
+    return math_max(size, 1);
+}
+
+const ConfigKey kWatchDirectoriesConfigKey =
+        ConfigKey(QStringLiteral("[Library]"), QStringLiteral("WatchDirectories"));
+
+const ConfigKey kSyncTrackMetadataExportConfigKey =
+        ConfigKey(QStringLiteral("[Library]"), QStringLiteral("SyncTrackMetadataExport"));
 
 mixxx::Logger kLogger("LibraryScanner");
 
+bool isDirectoryOrSubdirectory(const QString& dirPath, const QString& rootDirPath) {
+    return dirPath == rootDirPath ||
+            (dirPath.startsWith(rootDirPath) &&
+                    dirPath.at(rootDirPath.size()) == QChar('/'));
+}
+
 QAtomicInt s_instanceCounter(0);
 
 // Returns the number of affected rows or -1 on error
@@ -44,12 +74,15 @@ LibraryScanner::LibraryScanner(
         mixxx::DbConnectionPoolPtr pDbConnectionPool,
         const UserSettingsPointer& pConfig)
         : m_pDbConnectionPool(std::move(pDbConnectionPool)),
+          m_pConfig(pConfig),
           m_analysisDao(pConfig),
           m_trackDao(m_cueDao, m_playlistDao,
                   m_analysisDao, m_libraryHashDao,
                   pConfig),
           m_stateSema(1), // only one transaction is possible at a time
-          m_state(IDLE) {
+          m_state(IDLE),
+          m_pWatcher(nullptr),
+          m_scanIncrementally(false) {
     // Move LibraryScanner to its own thread so that our signals/slots will
     // queue to our event loop.
     moveToThread(this);
@@ -58,7 +91,16 @@ LibraryScanner::LibraryScanner(
     const int instanceId = s_instanceCounter.fetchAndAddAcquire(1) + 1;
     setObjectName(QString("LibraryScanner %1").arg(instanceId));
 
-    m_pool.setMaxThreadCount(kScannerThreadPoolSize);
+    m_pool.setMaxThreadCount(scannerThreadPoolSize(pConfig));
+    kLogger.debug()
+            << "Using"
+            << m_pool.maxThreadCount()
+            << "threads for scanning";
+
+    qRegisterMetaType<PreparedTrackImport>();
+    qRegisterMetaType<QList<PreparedTrackImport>>();
+    qRegisterMetaType<LibraryFileStatus>();
+    qRegisterMetaType<QList<LibraryFileStatus>>();
 
     // Listen to signals from our public methods (invoked by other threads) and
     // connect them to our slots to run the command on the scanner thread.
@@ -74,7 +116,7 @@ LibraryScanner::LibraryScanner(
             m_pProgressDlg.data(),
             &LibraryScannerDlg::slotUpdate);
     connect(this,
-            &LibraryScanner::scanStarted,
+            &LibraryScanner::progressStarted,
             m_pProgressDlg.data(),
             &LibraryScannerDlg::slotScanStarted);
     connect(this,
@@ -148,10 +190,25 @@ void LibraryScanner::run() {
         m_analysisDao.initialize(dbConnection);
         m_directoryDao.initialize(dbConnection);
 
+        // The watcher must live in the scanner thread to receive
+        // its signals in the scanner thread's event loop.
+        std::unique_ptr<LibraryWatcher> pWatcher;
+        if (m_pConfig && m_pConfig->getValue(kWatchDirectoriesConfigKey, false)) {
+            pWatcher = std::make_unique<LibraryWatcher>();
+            connect(pWatcher.get(),
+                    &LibraryWatcher::directoriesChanged,
+                    this,
+                    &LibraryScanner::slotWatchedDirectoriesChanged);
+            m_pWatcher = pWatcher.get();
+            updateWatchedDirectories();
+        }
+
         // Start the event loop.
         kLogger.debug() << "Event loop starting";
         exec();
         kLogger.debug() << "Event loop stopped";
+
+        m_pWatcher = nullptr;
     }
     kLogger.debug() << "Exiting thread";
 }
@@ -160,6 +217,9 @@ void LibraryScanner::slotStartScan() {
     kLogger.debug() << "slotStartScan()";
     DEBUG_ASSERT(m_state == STARTING);
 
+    const bool incremental = m_scanIncrementally;
+    m_scanIncrementally = false;
+
     // Recursively scan each directory in the directories table.
     m_libraryRootDirs = m_directoryDao.getDirs();
     // If there are no directories then we have nothing to do. Cleanup and
@@ -168,10 +228,27 @@ void LibraryScanner::slotStartScan() {
         changeScannerState(IDLE);
         return;
     }
+
+    QStringList dirtyDirPaths;
+    if (incremental) {
+        dirtyDirPaths = takeDirtyLibraryDirectories();
+        if (dirtyDirPaths.isEmpty()) {
+            changeScannerState(IDLE);
+            return;
+        }
+    } else if (m_pWatcher) {
+        // All directories are rescanned anyway
+        m_pWatcher->takeDirtyDirectories();
+    }
     changeScannerState(SCANNING);
 
     QSet<QString> trackLocations = m_trackDao.getAllTrackLocations();
     QHash<QString, mixxx::cache_key_t> directoryHashes = m_libraryHashDao.getDirectoryHashes();
+    // Incremental scans only need to compare the files of the
+    // changed directories
+    QHash<QString, LibraryFileStatus> fileStatuses = incremental
+            ? m_libraryHashDao.getFileStatuses(dirtyDirPaths)
+            : m_libraryHashDao.getFileStatuses();
     QRegExp extensionFilter(SoundSourceProxy::getSupportedFileNamesRegex());
     QRegExp coverExtensionFilter =
             QRegExp(CoverArtUtils::supportedCoverArtExtensionsRegex(),
@@ -179,13 +256,22 @@ void LibraryScanner::slotStartScan() {
     QStringList directoryBlacklist = ScannerUtil::getDirectoryBlacklist();
 
     m_scannerGlobal = ScannerGlobalPointer(
-            new ScannerGlobal(trackLocations, directoryHashes, extensionFilter,
-                              coverExtensionFilter, directoryBlacklist));
+            new ScannerGlobal(trackLocations, directoryHashes, fileStatuses,
+                              extensionFilter, coverExtensionFilter,
+                              directoryBlacklist, incremental));
 
     m_scannerGlobal->startTimer();
 
     emit scanStarted();
 
+    if (incremental) {
+        // Scans of watched directories run in the background without
+        // showing the progress dialog
+        queueIncrementalScanTasks(dirtyDirPaths);
+        return;
+    }
+    emit progressStarted();
+
     // First, we're going to mark all the directories that we've previously
     // hashed as needing verification. As we search through the directory tree
     // when we rescan, we'll mark any directory that does still exist as
@@ -273,6 +359,147 @@ void LibraryScanner::slotFinishHashedScan() {
     pWatcher->taskDone();
 }
 
+QStringList LibraryScanner::takeDirtyLibraryDirectories() {
+    VERIFY_OR_DEBUG_ASSERT(m_pWatcher) {
+        return QStringList();
+    }
+    QStringList dirtyDirPaths;
+    const QStringList dirPaths = m_pWatcher->takeDirtyDirectories();
+    for (const auto& dirPath : dirPaths) {
+        for (const auto& rootDirPath : qAsConst(m_libraryRootDirs)) {
+            if (isDirectoryOrSubdirectory(dirPath, rootDirPath)) {
+                dirtyDirPaths.append(dirPath);
+                break;
+            }
+        }
+    }
+    return dirtyDirPaths;
+}
+
+void LibraryScanner::queueIncrementalScanTasks(const QStringList& dirtyDirPaths) {
+    kLogger.debug()
+            << "Incrementally scanning"
+            << dirtyDirPaths.size()
+            << "changed directories";
+
+    // Directories that have been removed are reported by the watcher,
+    // but their subdirectories are not. The same applies to
+    // subdirectories of changed directories that have been removed.
+    QStringList existingDirPaths;
+    QStringList removedDirPaths;
+    for (const auto& dirPath : dirtyDirPaths) {
+        if (QDir(dirPath).exists()) {
+            existingDirPaths.append(dirPath);
+        } else {
+            removedDirPaths.append(dirPath);
+        }
+    }
+    const auto knownDirPaths = m_libraryHashDao.getDirectoryHashes().keys();
+    for (const auto& knownDirPath : knownDirPaths) {
+        if (removedDirPaths.contains(knownDirPath)) {
+            continue;
+        }
+        for (const auto& dirPath : qAsConst(existingDirPaths)) {
+            if (knownDirPath != dirPath &&
+                    isDirectoryOrSubdirectory(knownDirPath, dirPath) &&
+                    !QDir(knownDirPath).exists()) {
+                removedDirPaths.append(knownDirPath);
+                break;
+            }
+        }
+    }
+
+    // Only the changed directories and the tracks that they contain
+    // need to be verified again. All other directories and tracks
+    // remain verified from the last scan.
+    m_libraryHashDao.invalidateDirectories(existingDirPaths, false);
+    m_trackDao.invalidateTrackLocationsInDirectories(existingDirPaths, false);
+    m_libraryHashDao.invalidateDirectories(removedDirPaths, true);
+    m_trackDao.invalidateTrackLocationsInDirectories(removedDirPaths, true);
+
+    m_trackDao.addTracksPrepare();
+
+    // Changed and new directories are scanned in a single stage,
+    // because unchanged subdirectories are skipped anyway.
+    TaskWatcher* pWatcher = &m_scannerGlobal->getTaskWatcher();
+    pWatcher->watchTask();
+    connect(pWatcher,
+            &TaskWatcher::allTasksDone,
+            this,
+            &LibraryScanner::slotFinishUnhashedScan);
+
+    for (const auto& dirPath : qAsConst(existingDirPaths)) {
+        for (const auto& rootDirPath : qAsConst(m_libraryRootDirs)) {
+            if (!isDirectoryOrSubdirectory(dirPath, rootDirPath)) {
+                continue;
+            }
+            // The security bookmark of the library root directory
+            // also grants access to all of its subdirectories.
+            const MDir rootDir(rootDirPath);
+            const QDir dir(dirPath);
+            if (!m_scannerGlobal->testAndMarkDirectoryScanned(dir)) {
+                queueTask(new RecursiveScanDirectoryTask(this, m_scannerGlobal,
+                                                         dir,
+                                                         rootDir.token(),
+                                                         true));
+            }
+            break;
+        }
+    }
+    pWatcher->taskDone();
+}
+
+void LibraryScanner::reimportModifiedTracks() {
+    const QStringList& trackLocations = m_scannerGlobal->modifiedTracks();
+    if (trackLocations.isEmpty()) {
+        return;
+    }
+    // Metadata in the library might have been edited since the last scan.
+    // It is only overwritten if file tags are considered as the primary
+    // source of track metadata, i.e. if metadata is exported into files.
+    if (!m_pConfig ||
+            m_pConfig->getValueString(kSyncTrackMetadataExportConfigKey).toInt() != 1) {
+        kLogger.info()
+                << "Found"
+                << trackLocations.size()
+                << "modified file(s) without reimporting their metadata";
+        return;
+    }
+    kLogger.info()
+            << "Reimporting metadata of"
+            << trackLocations.size()
+            << "modified file(s)";
+    for (const auto& trackLocation : trackLocations) {
+        if (m_scannerGlobal->shouldCancel()) {
+            return;
+        }
+        const auto pTrack = m_trackDao.getTrackByRef(
+                TrackRef::fromFileInfo(TrackFile(trackLocation)));
+        if (!pTrack) {
+            continue;
+        }
+        // Saving the modified track is deferred until the last
+        // reference has been dropped.
+        SoundSourceProxy(pTrack).updateTrackFromSource(
+                SoundSourceProxy::ImportTrackMetadataMode::Again);
+    }
+}
+
+void LibraryScanner::updateWatchedDirectories() {
+    if (!m_pWatcher) {
+        return;
+    }
+    QStringList dirPaths = m_libraryHashDao.getDirectoryHashes().keys();
+    // New or empty library directories have not been hashed yet
+    const QStringList rootDirPaths = m_directoryDao.getDirs();
+    for (const auto& rootDirPath : rootDirPaths) {
+        if (!dirPaths.contains(rootDirPath)) {
+            dirPaths.append(rootDirPath);
+        }
+    }
+    m_pWatcher->setDirectories(dirPaths);
+}
+
 void LibraryScanner::cleanUpScan() {
     // At the end of a scan, mark all tracks and directories that weren't
     // "verified" as "deleted" (as long as the scan wasn't canceled half way
@@ -346,6 +573,12 @@ void LibraryScanner::cleanUpScan() {
 
     transaction.commit();
 
+    if (m_scannerGlobal->isIncremental()) {
+        // Detecting cover art needs to check all tracks without
+        // cover art and is only done for full scans.
+        return;
+    }
+
     kLogger.debug() << "Detecting cover art for unscanned files";
     QSet<TrackId> coverArtTracksChanged;
     m_trackDao.detectCoverArtForTracksWithoutCover(
@@ -381,6 +614,8 @@ void LibraryScanner::slotFinishUnhashedScan() {
 
     if (!m_scannerGlobal->shouldCancel() && bScanFinishedCleanly) {
         cleanUpScan();
+        reimportModifiedTracks();
+        updateWatchedDirectories();
     }
 
     if (!m_scannerGlobal->shouldCancel() && bScanFinishedCleanly) {
@@ -390,22 +625,44 @@ void LibraryScanner::slotFinishUnhashedScan() {
     }
 
     // TODO(XXX) doesn't take into account verifyRemainingTracks.
+    const mixxx::Duration elapsed = m_scannerGlobal->timerElapsed();
+    const int numFiles = m_scannerGlobal->verifiedTracks().size() +
+            m_scannerGlobal->addedTracks().size();
+    const double filesPerSecond = elapsed.toDoubleSeconds() > 0
+            ? numFiles / elapsed.toDoubleSeconds()
+            : 0.0;
     qDebug("Scan took: %s. "
            "%d unchanged directories. "
            "%d changed/added directories. "
            "%d tracks verified from changed/added directories. "
-           "%d new tracks.",
-           m_scannerGlobal->timerElapsed().formatNanosWithUnit().toLocal8Bit().constData(),
+           "%d new tracks. "
+           "%.1f files/s on %d threads.",
+           elapsed.formatNanosWithUnit().toLocal8Bit().constData(),
            m_scannerGlobal->verifiedDirectories().size(),
            m_scannerGlobal->numScannedDirectories(),
            m_scannerGlobal->verifiedTracks().size(),
-           m_scannerGlobal->addedTracks().size());
+           m_scannerGlobal->addedTracks().size(),
+           filesPerSecond,
+           m_pool.maxThreadCount());
 
     m_scannerGlobal.clear();
     changeScannerState(FINISHED);
     // now we may accept new scan commands
 
     emit scanFinished();
+
+    if (m_pWatcher && m_pWatcher->hasDirtyDirectories()) {
+        // Directories have been changed while scanning
+        slotWatchedDirectoriesChanged();
+    }
+}
+
+void LibraryScanner::slotWatchedDirectoriesChanged() {
+    // The scan is started directly in the scanner thread
+    if (changeScannerState(STARTING)) {
+        m_scanIncrementally = true;
+        slotStartScan();
+    }
 }
 
 void LibraryScanner::scan() {
@@ -478,9 +735,17 @@ void LibraryScanner::queueTask(ScannerTask* pTask) {
             this,
             &LibraryScanner::slotTrackExists);
     connect(pTask,
-            &ScannerTask::addNewTrack,
+            &ScannerTask::trackModified,
+            this,
+            &LibraryScanner::slotTrackModified);
+    connect(pTask,
+            &ScannerTask::fileStatusesScanned,
+            this,
+            &LibraryScanner::slotFileStatusesScanned);
+    connect(pTask,
+            &ScannerTask::addNewTracks,
             this,
-            &LibraryScanner::slotAddNewTrack);
+            &LibraryScanner::slotAddNewTracks);
 
     // Progress signals.
     // Pass directly to the main thread
@@ -533,11 +798,38 @@ void LibraryScanner::slotTrackExists(const QString& trackPath) {
     }
 }
 
-void LibraryScanner::slotAddNewTrack(const QString& trackPath) {
-    //kLogger.debug() << "slotAddNewTrack" << trackPath;
-    ScopedTimer timer("LibraryScanner::addNewTrack");
+void LibraryScanner::slotTrackModified(const QString& trackPath) {
+    ScopedTimer timer("LibraryScanner::slotTrackModified");
+    if (m_scannerGlobal) {
+        m_scannerGlobal->addVerifiedTrack(trackPath);
+        m_scannerGlobal->addModifiedTrack(trackPath);
+    }
+}
+
+void LibraryScanner::slotFileStatusesScanned(const QString& directoryPath,
+        const QList<LibraryFileStatus>& fileStatuses) {
+    ScopedTimer timer("LibraryScanner::slotFileStatusesScanned");
+    m_libraryHashDao.saveFileStatuses(directoryPath, fileStatuses);
+}
+
+void LibraryScanner::slotAddNewTracks(
+        const QList<PreparedTrackImport>& preparedImports) {
+    ScopedTimer timer("LibraryScanner::slotAddNewTracks");
+    // All tracks are added within the transaction that has been
+    // started by slotStartScan(). The batch must not be interrupted
+    // when canceling the scan, because the hash of the directory that
+    // contains these tracks will be stored afterwards.
+    for (const auto& preparedImport : preparedImports) {
+        addNewTrack(preparedImport);
+    }
+}
+
+void LibraryScanner::addNewTrack(const PreparedTrackImport& preparedImport) {
+    const QString trackPath = preparedImport.trackFile.location();
+    //kLogger.debug() << "addNewTrack" << trackPath;
     // For statistics tracking and to detect moved tracks
-    TrackPointer pTrack(m_trackDao.addTracksAddFile(trackPath, false));
+    TrackPointer pTrack(m_trackDao.addTracksAddFile(
+            preparedImport.trackFile, false, &preparedImport));
     if (pTrack) {
         DEBUG_ASSERT(!pTrack->isDirty());
         // The track's actual location might differ from the
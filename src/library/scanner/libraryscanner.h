@@ -16,12 +16,14 @@
 #include "library/dao/playlistdao.h"
 #include "library/dao/trackdao.h"
 #include "library/scanner/scannerglobal.h"
+#include "sources/soundsourceproxy.h"
 #include "track/track_decl.h"
 #include "track/trackid.h"
 #include "util/db/dbconnectionpool.h"
 
 class ScannerTask;
 class LibraryScannerDlg;
+class LibraryWatcher;
 
 class LibraryScanner : public QThread {
     FRIEND_TEST(LibraryScannerTest, ScannerRoundtrip);
@@ -42,6 +44,8 @@ class LibraryScanner : public QThread {
 
   signals:
     void scanStarted();
+    // Only emitted for full scans that report their progress
+    void progressStarted();
     void scanFinished();
     void progressHashing(const QString&);
     void progressLoading(const QString& path);
@@ -64,13 +68,17 @@ class LibraryScanner : public QThread {
     void slotStartScan();
     void slotFinishHashedScan();
     void slotFinishUnhashedScan();
+    void slotWatchedDirectoriesChanged();
 
     // ScannerTask signal handlers.
     void slotDirectoryHashedAndScanned(const QString& directoryPath,
                                    bool newDirectory, mixxx::cache_key_t hash);
     void slotDirectoryUnchanged(const QString& directoryPath);
     void slotTrackExists(const QString& trackPath);
-    void slotAddNewTrack(const QString& trackPath);
+    void slotTrackModified(const QString& trackPath);
+    void slotFileStatusesScanned(const QString& directoryPath,
+            const QList<LibraryFileStatus>& fileStatuses);
+    void slotAddNewTracks(const QList<PreparedTrackImport>& preparedImports);
 
   private:
     enum ScannerState {
@@ -96,9 +104,21 @@ class LibraryScanner : public QThread {
 
     void cleanUpScan();
 
+    // Returns the dirty directories of the watcher that are located
+    // in one of the library root directories.
+    QStringList takeDirtyLibraryDirectories();
+    void queueIncrementalScanTasks(const QStringList& dirtyDirPaths);
+    void reimportModifiedTracks();
+    void updateWatchedDirectories();
+
+    void addNewTrack(const PreparedTrackImport& preparedImport);
+
     mixxx::DbConnectionPoolPtr m_pDbConnectionPool;
+    const UserSettingsPointer m_pConfig;
 
-    // The pool of threads used for worker tasks.
+    // The pool of threads used for worker tasks, i.e. for scanning
+    // directories and parsing files concurrently. Only the library
+    // scanner thread itself writes into the database.
     QThreadPool m_pool;
 
     // The library scanner thread's DAOs.
@@ -120,5 +140,12 @@ class LibraryScanner : public QThread {
     volatile ScannerState m_state;
 
     QStringList m_libraryRootDirs;
+
+    // Only exists while the event loop of the scanner thread is running
+    // and if watching the library directories has been enabled.
+    LibraryWatcher* m_pWatcher;
+    // Only rescan the directories that have been reported by the watcher
+    bool m_scanIncrementally;
+
     QScopedPointer<LibraryScannerDlg> m_pProgressDlg;
 };
@@ -9,7 +9,9 @@
 
 LibraryScannerDlg::LibraryScannerDlg(QWidget* parent, Qt::WindowFlags f)
         : QWidget(parent, f),
-          m_bCancelled(false) {
+          // No progress is shown until a full scan has been started, e.g.
+          // for scans of watched directories in the background
+          m_bCancelled(true) {
     setWindowIcon(QIcon(":/images/mixxx_icon.svg"));
 
     QVBoxLayout* pLayout = new QVBoxLayout(this);
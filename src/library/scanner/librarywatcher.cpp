@@ -0,0 +1,132 @@
+#include "library/scanner/librarywatcher.h"
+
+#include <QFileInfo>
+
+#include "moc_librarywatcher.cpp"
+#include "util/logger.h"
+
+namespace {
+
+const mixxx::Logger kLogger("LibraryWatcher");
+
+// Polling is only a fallback and needs to access every polled
+// directory in the file system.
+constexpr int kPollIntervalMillis = 60 * 1000;
+
+// Wait until all files have been copied or moved before
+// starting a rescan.
+constexpr int kSettleDelayMillis = 3 * 1000;
+
+QDateTime directoryLastModified(const QString& dirPath) {
+    const QFileInfo fileInfo(dirPath);
+    if (!fileInfo.exists()) {
+        return QDateTime();
+    }
+    return fileInfo.lastModified();
+}
+
+} // anonymous namespace
+
+LibraryWatcher::LibraryWatcher(QObject* pParent)
+        : QObject(pParent) {
+    m_pollTimer.setInterval(kPollIntervalMillis);
+    m_settleTimer.setInterval(kSettleDelayMillis);
+    m_settleTimer.setSingleShot(true);
+    connect(&m_fileSystemWatcher,
+            &QFileSystemWatcher::directoryChanged,
+            this,
+            &LibraryWatcher::slotDirectoryChanged);
+    connect(&m_pollTimer,
+            &QTimer::timeout,
+            this,
+            &LibraryWatcher::slotPollDirectories);
+    connect(&m_settleTimer,
+            &QTimer::timeout,
+            this,
+            &LibraryWatcher::directoriesChanged);
+}
+
+void LibraryWatcher::setDirectories(const QStringList& dirPaths) {
+    const QSet<QString> newDirPaths(dirPaths.begin(), dirPaths.end());
+
+    const QStringList watchedDirPaths = m_fileSystemWatcher.directories();
+    QStringList removedDirPaths;
+    QSet<QString> oldDirPaths;
+    for (const auto& dirPath : watchedDirPaths) {
+        if (newDirPaths.contains(dirPath)) {
+            oldDirPaths.insert(dirPath);
+        } else {
+            removedDirPaths.append(dirPath);
+        }
+    }
+    if (!removedDirPaths.isEmpty()) {
+        m_fileSystemWatcher.removePaths(removedDirPaths);
+    }
+    auto i = m_polledDirectories.begin();
+    while (i != m_polledDirectories.end()) {
+        if (newDirPaths.contains(i.key())) {
+            oldDirPaths.insert(i.key());
+            ++i;
+        } else {
+            i = m_polledDirectories.erase(i);
+        }
+    }
+
+    QStringList addedDirPaths;
+    for (const auto& dirPath : newDirPaths) {
+        if (!oldDirPaths.contains(dirPath)) {
+            addedDirPaths.append(dirPath);
+        }
+    }
+    if (!addedDirPaths.isEmpty()) {
+        const QStringList failedDirPaths =
+                m_fileSystemWatcher.addPaths(addedDirPaths);
+        for (const auto& dirPath : failedDirPaths) {
+            m_polledDirectories.insert(dirPath, directoryLastModified(dirPath));
+        }
+    }
+
+    if (m_polledDirectories.isEmpty()) {
+        m_pollTimer.stop();
+    } else if (!m_pollTimer.isActive()) {
+        m_pollTimer.start();
+    }
+    kLogger.info()
+            << "Watching"
+            << watchedDirectoryCount()
+            << "and polling"
+            << polledDirectoryCount()
+            << "directories";
+}
+
+QStringList LibraryWatcher::takeDirtyDirectories() {
+    const QStringList dirPaths(m_dirtyDirectories.begin(), m_dirtyDirectories.end());
+    m_dirtyDirectories.clear();
+    m_settleTimer.stop();
+    return dirPaths;
+}
+
+void LibraryWatcher::slotDirectoryChanged(const QString& dirPath) {
+    markDirty(dirPath);
+}
+
+void LibraryWatcher::slotPollDirectories() {
+    for (auto i = m_polledDirectories.begin(); i != m_polledDirectories.end(); ++i) {
+        const QDateTime lastModified = directoryLastModified(i.key());
+        if (lastModified != i.value()) {
+            i.value() = lastModified;
+            markDirty(i.key());
+        }
+    }
+}
+
+void LibraryWatcher::markDirty(const QString& dirPath) {
+    if (kLogger.debugEnabled()) {
+        kLogger.debug()
+                << "Directory has been changed:"
+                << dirPath;
+    }
+    m_dirtyDirectories.insert(dirPath);
+    // Restart the timer on every change
+    m_settleTimer.start();
+}
@@ -0,0 +1,67 @@
+#pragma once
+
+#include <QDateTime>
+#include <QFileSystemWatcher>
+#include <QHash>
+#include <QObject>
+#include <QSet>
+#include <QStringList>
+#include <QTimer>
+
+/// Watches the directories of the library for changes and collects
+/// the directories that need to be rescanned.
+///
+/// Directories are watched with QFileSystemWatcher, i.e. with inotify on
+/// Linux. Directories that cannot be watched, e.g. after the maximum
+/// number of inotify watches has been exceeded, are polled periodically
+/// by comparing their modification times instead.
+///
+/// Only changes of directory entries are detected reliably, i.e. added,
+/// removed, or renamed files and subdirectories. Files that are modified
+/// in place and changes on network shares that have been made by other
+/// hosts might go unnoticed until the next full scan.
+class LibraryWatcher : public QObject {
+    Q_OBJECT
+  public:
+    explicit LibraryWatcher(QObject* pParent = nullptr);
+    ~LibraryWatcher() override = default;
+
+    /// Replaces the watched directories. Dirty directories are kept
+    /// until they are taken.
+    void setDirectories(const QStringList& dirPaths);
+
+    int watchedDirectoryCount() const {
+        return m_fileSystemWatcher.directories().size();
+    }
+    int polledDirectoryCount() const {
+        return m_polledDirectories.size();
+    }
+
+    bool hasDirtyDirectories() const {
+        return !m_dirtyDirectories.isEmpty();
+    }
+    /// Returns and clears the directories that have been changed.
+    QStringList takeDirtyDirectories();
+
+  signals:
+    /// Emitted after directories have been changed and no further
+    /// changes have been detected for a while, e.g. after copying
+    /// many files.
+    void directoriesChanged();
+
+  private slots:
+    void slotDirectoryChanged(const QString& dirPath);
+    void slotPollDirectories();
+
+  private:
+    void markDirty(const QString& dirPath);
+
+    QFileSystemWatcher m_fileSystemWatcher;
+
+    // The last modification time of directories that are polled
+    QHash<QString, QDateTime> m_polledDirectories;
+    QTimer m_pollTimer;
+
+    QSet<QString> m_dirtyDirectories;
+    QTimer m_settleTimer;
+};
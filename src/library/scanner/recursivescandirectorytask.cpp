@@ -38,6 +38,7 @@ void RecursiveScanDirectoryTask::run() {
     QString currentFile;
     QFileInfo currentFileInfo;
     std::list<QFileInfo> filesToImport;
+    QList<LibraryFileStatus> fileStatuses;
     std::list<QFileInfo> possibleCovers;
     std::list<QDir> dirsToScan;
 
@@ -57,8 +58,18 @@ void RecursiveScanDirectoryTask::run() {
         if (currentFileInfo.isFile()) {
             const QString& fileName = currentFileInfo.fileName();
             if (supportedExtensionsRegex.indexIn(fileName) != -1) {
+                // Modified files need to be detected in addition to
+                // added, removed, or renamed files.
+                const auto fileStatus = LibraryFileStatus::fromFileInfo(currentFileInfo);
                 hasher.addData(currentFile.toUtf8());
+                hasher.addData(reinterpret_cast<const char*>(&fileStatus.size),
+                        sizeof(fileStatus.size));
+                hasher.addData(reinterpret_cast<const char*>(&fileStatus.modifiedAt),
+                        sizeof(fileStatus.modifiedAt));
+                hasher.addData(reinterpret_cast<const char*>(&fileStatus.inode),
+                        sizeof(fileStatus.inode));
                 filesToImport.push_back(currentFileInfo);
+                fileStatuses.append(fileStatus);
             } else if (supportedCoverExtensionsRegex.indexIn(fileName) != -1) {
                 possibleCovers.push_back(currentFileInfo);
             }
@@ -94,8 +105,9 @@ void RecursiveScanDirectoryTask::run() {
                 m_pScanner->queueTask(
                         new ImportFilesTask(m_pScanner, m_scannerGlobal, dirPath,
                                             prevHashExists, newHash, filesToImport,
-                                            possibleCovers, m_pToken));
+                                            fileStatuses, possibleCovers, m_pToken));
             } else {
+                emit fileStatusesScanned(dirPath, fileStatuses);
                 emit directoryHashedAndScanned(dirPath, !prevHashExists, newHash);
             }
         } else {
@@ -107,6 +119,13 @@ void RecursiveScanDirectoryTask::run() {
 
     // Process all of the sub-directories.
     foreach (const QDir& nextDir, dirsToScan) {
+        if (m_scannerGlobal->isIncremental() &&
+                mixxx::isValidCacheKey(
+                        m_scannerGlobal->directoryHashInDatabase(nextDir.path()))) {
+            // Known subdirectories are only rescanned if they
+            // have been modified themselves.
+            continue;
+        }
         // Atomically test and mark the directory as scanned to avoid
         // that the same directory is scanned multiple times by different
         // tasks.
@@ -7,7 +7,8 @@
 
 /// Recursively scan a music library. Doesn't import tracks for any directories
 /// that have already been scanned and have not changed. Changes are tracked by
-/// performing a hash of the directory's file list, and those hashes are stored
+/// performing a hash of the directory's file list including the size,
+/// modification time, and inode of each file, and those hashes are stored
 /// in the database. Successful if the scan completed without being
 /// cancelled. False if the scan was cancelled part-way through.
 class RecursiveScanDirectoryTask : public ScannerTask {
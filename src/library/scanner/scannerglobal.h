@@ -9,6 +9,7 @@
 #include <QSharedPointer>
 #include <QStringList>
 
+#include "library/dao/libraryhashdao.h"
 #include "util/cache.h"
 #include "util/performancetimer.h"
 #include "util/sandbox.h"
@@ -40,14 +41,18 @@ class ScannerGlobal {
   public:
     ScannerGlobal(const QSet<QString>& trackLocations,
                   const QHash<QString, mixxx::cache_key_t>& directoryHashes,
+                  const QHash<QString, LibraryFileStatus>& fileStatuses,
                   const QRegExp& supportedExtensionsMatcher,
                   const QRegExp& supportedCoverExtensionsMatcher,
-                  const QStringList& directoriesBlacklist)
+                  const QStringList& directoriesBlacklist,
+                  bool incremental = false)
             : m_trackLocations(trackLocations),
               m_directoryHashes(directoryHashes),
+              m_fileStatuses(fileStatuses),
               m_supportedExtensionsMatcher(supportedExtensionsMatcher),
               m_supportedCoverExtensionsMatcher(supportedCoverExtensionsMatcher),
               m_directoriesBlacklist(directoriesBlacklist),
+              m_incremental(incremental),
               // Unless marked un-clean, we assume it will finish cleanly.
               m_scanFinishedCleanly(true),
               m_shouldCancel(false),
@@ -63,9 +68,23 @@ class ScannerGlobal {
         return m_trackLocations.contains(trackLocation);
     }
 
-    // Returns the directory hash if it exists or -1 if it doesn't.
+    // Returns the directory hash if it exists or an invalid cache key
+    // if it doesn't.
     inline mixxx::cache_key_t directoryHashInDatabase(const QString& directoryPath) const {
-        return m_directoryHashes.value(directoryPath, -1);
+        return m_directoryHashes.value(directoryPath, mixxx::invalidCacheKey());
+    }
+
+    // Returns whether the file has been modified since the last scan.
+    // Files that have not been scanned before are not modified.
+    inline bool fileModified(const LibraryFileStatus& fileStatus) const {
+        const auto i = m_fileStatuses.constFind(fileStatus.location);
+        return i != m_fileStatuses.constEnd() && i.value() != fileStatus;
+    }
+
+    // Incremental scans only rescan the directories that have been
+    // modified and new subdirectories, but no other subdirectories.
+    bool isIncremental() const {
+        return m_incremental;
     }
 
     inline bool directoryBlacklisted(const QString& directoryPath) const {
@@ -151,6 +170,14 @@ class ScannerGlobal {
         return m_verifiedTracks;
     }
 
+    void addModifiedTrack(const QString& trackLocation) {
+        m_modifiedTracks << trackLocation;
+    }
+
+    const QStringList& modifiedTracks() const {
+        return m_modifiedTracks;
+    }
+
     void startTimer() {
         m_timer.start();
     }
@@ -180,6 +207,7 @@ class ScannerGlobal {
 
     QSet<QString> m_trackLocations;
     QHash<QString, mixxx::cache_key_t> m_directoryHashes;
+    QHash<QString, LibraryFileStatus> m_fileStatuses;
 
     mutable QMutex m_supportedExtensionsMatcherMutex;
     QRegExp m_supportedExtensionsMatcher;
@@ -204,12 +232,17 @@ class ScannerGlobal {
     // this has never been investigated.
     QStringList m_directoriesBlacklist;
 
+    const bool m_incremental;
+
     // The list of directories verified by the scan.
     QStringList m_verifiedDirectories;
 
     // The list of tracks verified by the scan.
     QStringList m_verifiedTracks;
 
+    // The list of verified tracks with modified files.
+    QStringList m_modifiedTracks;
+
     // The list of tracks added by the scan.
     QStringList m_addedTracks;
 
@@ -4,6 +4,7 @@
 #include <QRunnable>
 
 #include "library/scanner/scannerglobal.h"
+#include "sources/soundsourceproxy.h"
 
 class LibraryScanner;
 
@@ -23,7 +24,13 @@ class ScannerTask : public QObject, public QRunnable {
                                    bool newDirectory, mixxx::cache_key_t hash);
     void directoryUnchanged(const QString& directoryPath);
     void trackExists(const QString& filePath);
-    void addNewTrack(const QString& filePath);
+    // The track exists, but the file has been modified since the last scan
+    void trackModified(const QString& filePath);
+    void fileStatusesScanned(const QString& directoryPath,
+                             const QList<LibraryFileStatus>& fileStatuses);
+    // The files have already been parsed and only need to be added
+    // to the database by the library scanner thread.
+    void addNewTracks(const QList<PreparedTrackImport>& preparedImports);
 
     // Feedback to GUI
     void progressLoading(const QString& fileName);
@@ -4,6 +4,7 @@
 
 #include "library/basetrackcache.h"
 #include "moc_trackcollection.cpp"
+#include "sources/seekindexcache.h"
 #include "track/globaltrackcache.h"
 #include "util/assert.h"
 #include "util/db/sqltransaction.h"
@@ -338,6 +339,16 @@ bool TrackCollection::purgeTracks(
         const QList<TrackId>& trackIds) {
     DEBUG_ASSERT_QOBJECT_THREAD_AFFINITY(this);
 
+    // The cached seek indexes are deleted together with the other
+    // analysis data, but they are stored by location
+    QStringList trackLocations;
+    if (mixxx::SeekIndexCache::isEnabled()) {
+        trackLocations.reserve(trackIds.size());
+        for (const auto& trackId : trackIds) {
+            trackLocations.append(m_trackDao.getTrackLocation(trackId));
+        }
+    }
+
     // Transactional
     SqlTransaction transaction(m_database);
     VERIFY_OR_DEBUG_ASSERT(transaction) {
@@ -361,6 +372,9 @@ bool TrackCollection::purgeTracks(
     m_cueDao.deleteCuesForTracks(trackIds);
     m_playlistDao.removeTracksFromPlaylists(trackIds);
     m_analysisDao.deleteAnalyses(trackIds);
+    for (const auto& trackLocation : qAsConst(trackLocations)) {
+        mixxx::SeekIndexCache::remove(trackLocation);
+    }
 
     // Post-processing
     // TODO(XXX): Move signals from TrackDAO to TrackCollection
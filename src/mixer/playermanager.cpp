@@ -126,7 +126,9 @@ void PlayerManager::bindToLibrary(Library* pLibrary) {
             pLibrary,
             kNumberOfAnalyzerThreads,
             m_pConfig,
-            AnalyzerModeFlags::WithWaveform);
+            static_cast<AnalyzerModeFlags>(
+                    AnalyzerModeFlags::WithWaveform |
+                    AnalyzerModeFlags::ParallelAnalyzers));
 
     connect(m_pTrackAnalysisScheduler.get(), &TrackAnalysisScheduler::trackProgress,
             this, &PlayerManager::onTrackAnalysisProgress);
@@ -23,8 +23,10 @@
 #include "recording/recordingmanager.h"
 #include "skin/colorschemeparser.h"
 #include "skin/launchimage.h"
+#include "skin/skincompiler.h"
 #include "skin/skincontext.h"
 #include "util/cmdlineargs.h"
+#include "util/performancetimer.h"
 #include "util/timer.h"
 #include "util/valuetransformer.h"
 #include "util/xml.h"
@@ -318,13 +320,35 @@ QWidget* LegacySkinParser::parseSkin(const QString& skinPath, QWidget* pParent)
     ScopedTimer timer("SkinLoader::parseSkin");
     qDebug() << "LegacySkinParser loading skin:" << skinPath;
 
+    // Each phase of loading the skin is timed separately
+    PerformanceTimer phaseTimer;
+    phaseTimer.start();
+    QStringList phaseDurations;
+    const auto finishPhase = [&phaseTimer, &phaseDurations](const QString& phase) {
+        const mixxx::Duration elapsed = phaseTimer.restart();
+        Stat::track(QStringLiteral("LegacySkinParser::parseSkin ") + phase,
+                Stat::DURATION_NANOSEC,
+                kDefaultComputeFlags,
+                elapsed.toIntegerNanos());
+        phaseDurations.append(phase + QChar(' ') + elapsed.formatMillisWithUnit());
+    };
+
     m_pContext = std::make_unique<SkinContext>(m_pConfig, skinPath + "/skin.xml");
     m_pContext->setSkinBasePath(skinPath);
 
     if (m_pParent) {
         qDebug() << "ERROR: Somehow a parent already exists -- you are probably re-using a LegacySkinParser which is not advisable!";
     }
-    QDomElement skinDocument = openSkin(skinPath);
+
+    // The compiled skin does not contain any templates or variables
+    SkinCompiler compiler(m_pConfig, skinPath);
+    QDomElement skinDocument = compiler.loadCached();
+    const bool cached = !skinDocument.isNull();
+    finishPhase(QStringLiteral("cache lookup"));
+    if (!cached) {
+        skinDocument = openSkin(skinPath);
+        finishPhase(QStringLiteral("XML parsing"));
+    }
 
     if (skinDocument.isNull()) {
         qDebug() << "LegacySkinParser::parseSkin - failed for skin:" << skinPath;
@@ -386,8 +410,21 @@ QWidget* LegacySkinParser::parseSkin(const QString& skinPath, QWidget* pParent)
             }
         }
     }
+    finishPhase(QStringLiteral("skin attributes"));
 
     ColorSchemeParser::setupLegacyColorSchemes(skinDocument, m_pConfig, &m_style, m_pContext.get());
+    finishPhase(QStringLiteral("color scheme"));
+
+    if (cached) {
+        if (!compiler.templatePath().isEmpty()) {
+            m_pContext->setSkinTemplatePath(compiler.templatePath());
+        }
+    } else {
+        compiler.compile(skinDocument, m_pContext.get());
+        finishPhase(QStringLiteral("template expansion"));
+        compiler.saveCached(skinDocument);
+        finishPhase(QStringLiteral("cache write"));
+    }
 
     // don't parent till here so the first opengl waveform doesn't screw
     // up --bkgood
@@ -396,6 +433,9 @@ QWidget* LegacySkinParser::parseSkin(const QString& skinPath, QWidget* pParent)
     // (fullscreen mostly) --bkgood
     m_pParent = pParent;
     QList<QWidget*> widgets = parseNode(skinDocument);
+    finishPhase(QStringLiteral("widget creation"));
+    qDebug() << "LegacySkinParser loaded" << (cached ? "cached" : "newly compiled")
+             << "skin" << skinPath << "phases:" << phaseDurations.join(", ");
 
     if (widgets.empty()) {
         SKIN_WARNING(skinDocument, *m_pContext) << "Skin produced no widgets!";
@@ -591,10 +631,6 @@ QList<QWidget*> LegacySkinParser::parseNode(const QDomElement& node) {
         result = wrapWidget(parseEngineKey(node));
     } else if (nodeName == "Battery") {
         result = wrapWidget(parseBattery(node));
-    } else if (nodeName == "SetVariable") {
-        m_pContext->updateVariable(node);
-    } else if (nodeName == "Template") {
-        result = parseTemplate(node);
     } else if (nodeName == "SingletonDefinition") {
         parseSingletonDefinition(node);
     } else if (nodeName == "SingletonContainer") {
@@ -1489,89 +1525,6 @@ QString LegacySkinParser::getLibraryStyle(const QDomNode& node) {
     return style;
 }
 
-QDomElement LegacySkinParser::loadTemplate(const QString& path) {
-    QFileInfo templateFileInfo(path);
-
-    QString absolutePath = templateFileInfo.absoluteFilePath();
-
-    auto it = m_templateCache.constFind(absolutePath);
-    if (it != m_templateCache.constEnd()) {
-        return it.value();
-    }
-
-    QFile templateFile(absolutePath);
-
-    if (!templateFile.open(QIODevice::ReadOnly)) {
-        qWarning() << "Could not open template file:" << absolutePath;
-    }
-
-    QDomDocument tmpl("template");
-    QString errorMessage;
-    int errorLine;
-    int errorColumn;
-
-    if (!tmpl.setContent(&templateFile, &errorMessage,
-                         &errorLine, &errorColumn)) {
-        qWarning() << "LegacySkinParser::loadTemplate - setContent failed see"
-                   << absolutePath << "line:" << errorLine << "column:" << errorColumn;
-        qWarning() << "LegacySkinParser::loadTemplate - message:" << errorMessage;
-        return QDomElement();
-    }
-
-    m_templateCache[absolutePath] = tmpl.documentElement();
-    m_pContext->setSkinTemplatePath(templateFileInfo.absoluteDir().absolutePath());
-    return tmpl.documentElement();
-}
-
-QList<QWidget*> LegacySkinParser::parseTemplate(const QDomElement& node) {
-    if (!node.hasAttribute("src")) {
-        SKIN_WARNING(node, *m_pContext)
-                << "Template instantiation without src attribute:"
-                << node.text();
-        return QList<QWidget*>();
-    }
-
-    QString path = node.attribute("src");
-
-    std::unique_ptr<SkinContext> pOldContext = std::move(m_pContext);
-    m_pContext = std::make_unique<SkinContext>(pOldContext.get());
-
-    QDomElement templateNode = loadTemplate(path);
-
-    if (templateNode.isNull()) {
-        SKIN_WARNING(node, *m_pContext) << "Template instantiation for template failed:" << path;
-        m_pContext = std::move(pOldContext);
-        return QList<QWidget*>();
-    }
-
-    if (sDebug) {
-        qDebug() << "BEGIN TEMPLATE" << path;
-    }
-
-    // Take any <SetVariable> elements from this node and update the context
-    // with them.
-    m_pContext->updateVariables(node);
-    m_pContext->setXmlPath(path);
-
-    QList<QWidget*> widgets;
-
-    QDomNode child = templateNode.firstChild();
-    while (!child.isNull()) {
-        if (child.isElement()) {
-            QList<QWidget*> childWidgets = parseNode(child.toElement());
-            widgets.append(childWidgets);
-        }
-        child = child.nextSibling();
-    }
-
-    m_pContext = std::move(pOldContext);
-
-    if (sDebug) {
-        qDebug() << "END TEMPLATE" << path;
-    }
-    return widgets;
-}
-
 QString LegacySkinParser::lookupNodeGroup(const QDomElement& node) {
     QString group = m_pContext->selectString(node, "Group");
 
@@ -63,9 +63,6 @@ class LegacySkinParser : public QObject, public SkinParser {
 
     QList<QWidget*> parseNode(const QDomElement& node);
 
-    // Load the given template from file and return its document element.
-    QDomElement loadTemplate(const QString& path);
-
     // Parsers for each node
 
     // Most widgets can use parseStandardWidget.
@@ -119,9 +116,6 @@ class LegacySkinParser : public QObject, public SkinParser {
     QWidget* parseRecordingDuration(const QDomElement& node);
     QWidget* parseCoverArt(const QDomElement& node);
 
-    // Renders a template.
-    QList<QWidget*> parseTemplate(const QDomElement& node);
-
     void commonWidgetSetup(const QDomNode& node, WBaseWidget* pBaseWidget,
                            bool allowConnections=true);
     void setupPosition(const QDomNode& node, QWidget* pWidget);
@@ -158,6 +152,5 @@ class LegacySkinParser : public QObject, public SkinParser {
     std::unique_ptr<SkinContext> m_pContext;
     QString m_style;
     Tooltips m_tooltips;
-    QHash<QString, QDomElement> m_templateCache;
     static QSet<QString> s_sharedGroupStrings;
 };
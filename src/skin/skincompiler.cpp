@@ -0,0 +1,448 @@
+#include "skin/skincompiler.h"
+
+#include <QCryptographicHash>
+#include <QDataStream>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QVector>
+#include <QtDebug>
+
+#include "skin/skincontext.h"
+#include "util/version.h"
+
+namespace {
+
+const QString kCacheDirName = QStringLiteral("skincache");
+
+constexpr quint32 kCacheMagic = 0x4d58534b; // "MXSK"
+// Increment when changing the file format or the compilation rules
+constexpr quint32 kCacheFormatVersion = 1;
+constexpr QDataStream::Version kDataStreamVersion = QDataStream::Qt_5_0;
+
+constexpr quint8 kElementNode = 0;
+constexpr quint8 kTextNode = 1;
+
+QByteArray hashContents(const QByteArray& contents) {
+    return QCryptographicHash::hash(contents, QCryptographicHash::Sha1);
+}
+
+QByteArray hashFile(const QString& path) {
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return QByteArray();
+    }
+    return hashContents(file.readAll());
+}
+
+// Writes the tree with each distinct string stored only once
+class TreeWriter {
+  public:
+    void writeElement(QDataStream* pStream, const QDomElement& element) {
+        *pStream << kElementNode << intern(element.tagName());
+
+        const QDomNamedNodeMap attributes = element.attributes();
+        *pStream << static_cast<quint32>(attributes.count());
+        for (int i = 0; i < attributes.count(); ++i) {
+            const QDomAttr attribute = attributes.item(i).toAttr();
+            *pStream << intern(attribute.name()) << intern(attribute.value());
+        }
+
+        // Comments and processing instructions are dropped
+        QVector<QDomNode> children;
+        for (QDomNode child = element.firstChild();
+                !child.isNull();
+                child = child.nextSibling()) {
+            if (child.isElement() || child.isText()) {
+                children.append(child);
+            }
+        }
+        *pStream << static_cast<quint32>(children.size());
+        for (const auto& child : children) {
+            if (child.isElement()) {
+                writeElement(pStream, child.toElement());
+            } else {
+                // Also covers CDATA sections
+                *pStream << kTextNode << intern(child.nodeValue());
+            }
+        }
+    }
+
+    const QVector<QString>& strings() const {
+        return m_strings;
+    }
+
+  private:
+    quint32 intern(const QString& string) {
+        auto it = m_indices.constFind(string);
+        if (it != m_indices.constEnd()) {
+            return it.value();
+        }
+        const quint32 index = static_cast<quint32>(m_strings.size());
+        m_strings.append(string);
+        m_indices.insert(string, index);
+        return index;
+    }
+
+    QHash<QString, quint32> m_indices;
+    QVector<QString> m_strings;
+};
+
+class TreeReader {
+  public:
+    TreeReader(QDataStream* pStream, QDomDocument* pDocument)
+            : m_pStream(pStream),
+              m_pDocument(pDocument) {
+        *m_pStream >> m_strings;
+    }
+
+    // Returns a null node if the data is corrupt
+    QDomNode readNode() {
+        quint8 type;
+        quint32 index;
+        *m_pStream >> type >> index;
+        if (m_pStream->status() != QDataStream::Ok ||
+                index >= static_cast<quint32>(m_strings.size())) {
+            return QDomNode();
+        }
+        if (type == kTextNode) {
+            return m_pDocument->createTextNode(m_strings[index]);
+        }
+        if (type != kElementNode) {
+            return QDomNode();
+        }
+
+        QDomElement element = m_pDocument->createElement(m_strings[index]);
+        quint32 attributeCount;
+        *m_pStream >> attributeCount;
+        for (quint32 i = 0; i < attributeCount; ++i) {
+            quint32 nameIndex;
+            quint32 valueIndex;
+            *m_pStream >> nameIndex >> valueIndex;
+            if (m_pStream->status() != QDataStream::Ok ||
+                    nameIndex >= static_cast<quint32>(m_strings.size()) ||
+                    valueIndex >= static_cast<quint32>(m_strings.size())) {
+                return QDomNode();
+            }
+            element.setAttribute(m_strings[nameIndex], m_strings[valueIndex]);
+        }
+
+        quint32 childCount;
+        *m_pStream >> childCount;
+        for (quint32 i = 0; i < childCount; ++i) {
+            QDomNode child = readNode();
+            if (child.isNull()) {
+                return QDomNode();
+            }
+            element.appendChild(child);
+        }
+        return element;
+    }
+
+  private:
+    QDataStream* const m_pStream;
+    QDomDocument* const m_pDocument;
+    QVector<QString> m_strings;
+};
+
+} // anonymous namespace
+
+SkinCompiler::SkinCompiler(UserSettingsPointer pConfig, const QString& skinPath)
+        : m_pConfig(pConfig),
+          m_skinPath(QDir(skinPath).absolutePath()) {
+}
+
+QString SkinCompiler::cacheFilePath() const {
+    // The selected color scheme is part of the key, because the compiled
+    // tree contains the values of its variables
+    const QString key = m_skinPath + QChar('\n') +
+            m_pConfig->getValueString(ConfigKey("[Config]", "Scheme")) +
+            QChar('\n') + Version::version();
+    const QString fileName = QString::fromLatin1(
+            QCryptographicHash::hash(key.toUtf8(), QCryptographicHash::Sha1)
+                    .toHex());
+    return QDir(m_pConfig->getSettingsPath())
+            .filePath(kCacheDirName + QChar('/') + fileName);
+}
+
+QDomElement SkinCompiler::loadCached() {
+    QFile file(cacheFilePath());
+    if (!file.open(QIODevice::ReadOnly)) {
+        return QDomElement();
+    }
+    QDataStream stream(&file);
+    stream.setVersion(kDataStreamVersion);
+
+    quint32 magic;
+    quint32 formatVersion;
+    QString version;
+    QString skinPath;
+    stream >> magic >> formatVersion >> version >> skinPath;
+    if (stream.status() != QDataStream::Ok ||
+            magic != kCacheMagic ||
+            formatVersion != kCacheFormatVersion ||
+            version != Version::version() ||
+            skinPath != m_skinPath) {
+        return QDomElement();
+    }
+
+    quint32 dependencyCount;
+    stream >> dependencyCount;
+    for (quint32 i = 0; i < dependencyCount; ++i) {
+        QString path;
+        QByteArray hash;
+        stream >> path >> hash;
+        if (stream.status() != QDataStream::Ok) {
+            return QDomElement();
+        }
+        if (hashFile(path) != hash) {
+            qDebug() << "SkinCompiler: cached skin is outdated, changed file:" << path;
+            return QDomElement();
+        }
+    }
+
+    QString templatePath;
+    QByteArray tree;
+    stream >> templatePath >> tree;
+    if (stream.status() != QDataStream::Ok) {
+        return QDomElement();
+    }
+
+    QDomDocument document("skin");
+    QDomElement skinDocument = deserializeTree(&document, tree);
+    if (skinDocument.isNull()) {
+        qWarning() << "SkinCompiler: failed to read cached skin" << file.fileName();
+        return QDomElement();
+    }
+    m_templatePath = templatePath;
+    return skinDocument;
+}
+
+bool SkinCompiler::saveCached(const QDomElement& skinDocument) const {
+    const QString filePath = cacheFilePath();
+    if (!QDir().mkpath(QFileInfo(filePath).absolutePath())) {
+        qWarning() << "SkinCompiler: failed to create cache directory for" << filePath;
+        return false;
+    }
+
+    QSaveFile file(filePath);
+    if (!file.open(QIODevice::WriteOnly)) {
+        qWarning() << "SkinCompiler: failed to open" << filePath;
+        return false;
+    }
+    QDataStream stream(&file);
+    stream.setVersion(kDataStreamVersion);
+    stream << kCacheMagic << kCacheFormatVersion << Version::version() << m_skinPath;
+    stream << static_cast<quint32>(m_dependencies.size());
+    for (auto it = m_dependencies.constBegin(); it != m_dependencies.constEnd(); ++it) {
+        stream << it.key() << it.value();
+    }
+    stream << m_templatePath << serializeTree(skinDocument);
+    if (stream.status() != QDataStream::Ok || !file.commit()) {
+        qWarning() << "SkinCompiler: failed to write" << filePath;
+        return false;
+    }
+    return true;
+}
+
+// static
+QByteArray SkinCompiler::serializeTree(const QDomElement& element) {
+    TreeWriter writer;
+    QByteArray nodes;
+    {
+        QDataStream stream(&nodes, QIODevice::WriteOnly);
+        stream.setVersion(kDataStreamVersion);
+        writer.writeElement(&stream, element);
+    }
+
+    // The string table is needed before the nodes when reading
+    QByteArray data;
+    QDataStream stream(&data, QIODevice::WriteOnly);
+    stream.setVersion(kDataStreamVersion);
+    stream << writer.strings();
+    stream.writeRawData(nodes.constData(), nodes.size());
+    return data;
+}
+
+// static
+QDomElement SkinCompiler::deserializeTree(QDomDocument* pDocument, const QByteArray& data) {
+    QDataStream stream(data);
+    stream.setVersion(kDataStreamVersion);
+    TreeReader reader(&stream, pDocument);
+    const QDomElement element = reader.readNode().toElement();
+    if (element.isNull()) {
+        return QDomElement();
+    }
+    pDocument->appendChild(element);
+    return element;
+}
+
+void SkinCompiler::compile(const QDomElement& skinDocument, SkinContext* pContext) {
+    m_dependencies.clear();
+    m_templatePath.clear();
+
+    QFile skinXmlFile(QDir(m_skinPath).filePath("skin.xml"));
+    if (skinXmlFile.open(QIODevice::ReadOnly)) {
+        addDependency(skinXmlFile.fileName(), skinXmlFile.readAll());
+    }
+
+    // Same distinction as in LegacySkinParser::parseNode()
+    const bool newStyle = !pContext->selectString(skinDocument, "Layout").isEmpty();
+    if (newStyle) {
+        expandElement(skinDocument, pContext);
+    } else {
+        // Legacy skins do not use a <Children> block.
+        expandWidgetList(skinDocument, pContext);
+    }
+}
+
+void SkinCompiler::expandElement(QDomElement element, SkinContext* pContext) {
+    // Only the first <Children> node is parsed. Splitters evaluate their
+    // own nodes after their children, so they may refer to variables that
+    // have been set by them.
+    QDomElement children = SkinContext::selectElement(element, "Children");
+    const bool childrenFirst = element.tagName() == "Splitter";
+    if (childrenFirst && !children.isNull()) {
+        expandWidgetList(children, pContext);
+    }
+    for (QDomNode child = element.firstChild();
+            !child.isNull();
+            child = child.nextSibling()) {
+        if (child.isElement() && child != children) {
+            resolveVariables(child.toElement(), pContext);
+        }
+    }
+    if (!childrenFirst && !children.isNull()) {
+        expandWidgetList(children, pContext);
+    }
+}
+
+void SkinCompiler::expandWidgetList(QDomElement list, SkinContext* pContext) {
+    QDomNode child = list.firstChild();
+    while (!child.isNull()) {
+        const QDomNode next = child.nextSibling();
+        if (child.isElement()) {
+            QDomElement element = child.toElement();
+            const QString nodeName = element.tagName();
+            if (nodeName == "SetVariable") {
+                // Applies to all following nodes until the end of the
+                // enclosing template, like in LegacySkinParser::parseNode()
+                pContext->updateVariable(element);
+                list.removeChild(element);
+            } else if (nodeName == "Template") {
+                expandTemplate(list, element, pContext);
+            } else {
+                expandElement(element, pContext);
+            }
+        }
+        child = next;
+    }
+}
+
+void SkinCompiler::expandTemplate(QDomElement list, QDomElement node, SkinContext* pContext) {
+    if (!node.hasAttribute("src")) {
+        SKIN_WARNING(node, *pContext)
+                << "Template instantiation without src attribute:"
+                << node.text();
+        list.removeChild(node);
+        return;
+    }
+
+    const QString path = node.attribute("src");
+    QDomElement templateNode = loadTemplate(path, pContext);
+    if (templateNode.isNull()) {
+        SKIN_WARNING(node, *pContext) << "Template instantiation for template failed:" << path;
+        list.removeChild(node);
+        return;
+    }
+
+    SkinContext templateContext(pContext);
+    // Take any <SetVariable> elements from this node and update the context
+    // with them.
+    templateContext.updateVariables(node);
+    templateContext.setXmlPath(path);
+
+    // Templates are instantiated many times, so expand a copy
+    QDomElement expanded = list.ownerDocument().importNode(templateNode, true).toElement();
+    expandWidgetList(expanded, &templateContext);
+    while (!expanded.firstChild().isNull()) {
+        list.insertBefore(expanded.firstChild(), node);
+    }
+    list.removeChild(node);
+}
+
+void SkinCompiler::resolveVariables(QDomElement element, const SkinContext* pContext) {
+    QDomNode child = element.firstChild();
+    while (!child.isNull()) {
+        const QDomNode next = child.nextSibling();
+        if (child.isElement()) {
+            QDomElement childElement = child.toElement();
+            const QString nodeName = childElement.tagName();
+            if (nodeName == "Variable") {
+                element.replaceChild(
+                        element.ownerDocument().createTextNode(
+                                pContext->variableNodeToText(childElement)),
+                        childElement);
+            } else if (nodeName == "State" && pContext->hasVariableUpdates(childElement)) {
+                // Variables that are set in a <State> only apply to that
+                // state, see WPushButton::setup().
+                SkinContext stateContext(pContext);
+                stateContext.updateVariables(childElement);
+                QDomElement setVariable = SkinContext::selectElement(childElement, "SetVariable");
+                while (!setVariable.isNull()) {
+                    childElement.removeChild(setVariable);
+                    setVariable = SkinContext::selectElement(childElement, "SetVariable");
+                }
+                resolveVariables(childElement, &stateContext);
+            } else if (nodeName != "SetVariable") {
+                // <SetVariable> nodes outside of widget lists are not
+                // evaluated by the parser, so they are left untouched.
+                resolveVariables(childElement, pContext);
+            }
+        }
+        child = next;
+    }
+}
+
+QDomElement SkinCompiler::loadTemplate(const QString& path, SkinContext* pContext) {
+    QFileInfo templateFileInfo(path);
+
+    QString absolutePath = templateFileInfo.absoluteFilePath();
+
+    auto it = m_templateCache.constFind(absolutePath);
+    if (it != m_templateCache.constEnd()) {
+        return it.value();
+    }
+
+    QFile templateFile(absolutePath);
+
+    if (!templateFile.open(QIODevice::ReadOnly)) {
+        qWarning() << "Could not open template file:" << absolutePath;
+    }
+    const QByteArray contents = templateFile.readAll();
+    // Also broken templates invalidate the cache when they are fixed
+    addDependency(absolutePath, contents);
+
+    QDomDocument tmpl("template");
+    QString errorMessage;
+    int errorLine;
+    int errorColumn;
+
+    if (!tmpl.setContent(contents, &errorMessage,
+                         &errorLine, &errorColumn)) {
+        qWarning() << "SkinCompiler::loadTemplate - setContent failed see"
+                   << absolutePath << "line:" << errorLine << "column:" << errorColumn;
+        qWarning() << "SkinCompiler::loadTemplate - message:" << errorMessage;
+        return QDomElement();
+    }
+
+    m_templateCache[absolutePath] = tmpl.documentElement();
+    m_templatePath = templateFileInfo.absoluteDir().absolutePath();
+    pContext->setSkinTemplatePath(m_templatePath);
+    return tmpl.documentElement();
+}
+
+void SkinCompiler::addDependency(const QString& path, const QByteArray& contents) {
+    m_dependencies.insert(QFileInfo(path).absoluteFilePath(), hashContents(contents));
+}
@@ -0,0 +1,63 @@
+#pragma once
+
+#include <QByteArray>
+#include <QDomDocument>
+#include <QDomElement>
+#include <QHash>
+#include <QString>
+
+#include "preferences/usersettings.h"
+
+class SkinContext;
+
+// Compiles a skin document into a self-contained form and caches it on disk.
+//
+// Compiling inlines all <Template> instantiations and replaces all <Variable>
+// references with their values, so that no <SetVariable>, <Template> or
+// <Variable> nodes are left in the tree that LegacySkinParser instantiates
+// the widgets from. The compiled tree is stored in a compact binary format
+// with interned strings and keyed by the skin path, the selected color scheme
+// and the Mixxx version. It is only reused as long as the contents of
+// skin.xml and all templates it was compiled from are unchanged.
+class SkinCompiler {
+  public:
+    SkinCompiler(UserSettingsPointer pConfig, const QString& skinPath);
+
+    // Returns the document element of the cached compiled skin or a null
+    // element if there is no valid cache entry.
+    QDomElement loadCached();
+
+    // Expands all templates and variables of the skin document in place.
+    // The context must already contain the variables of the color scheme.
+    void compile(const QDomElement& skinDocument, SkinContext* pContext);
+
+    // Writes the compiled skin document to the cache.
+    bool saveCached(const QDomElement& skinDocument) const;
+
+    // The directory of the last template that has been compiled, which
+    // LegacySkinParser adds to the skin search paths.
+    const QString& templatePath() const {
+        return m_templatePath;
+    }
+
+    QString cacheFilePath() const;
+
+    static QByteArray serializeTree(const QDomElement& element);
+    static QDomElement deserializeTree(QDomDocument* pDocument, const QByteArray& data);
+
+  private:
+    void expandElement(QDomElement element, SkinContext* pContext);
+    void expandWidgetList(QDomElement list, SkinContext* pContext);
+    void expandTemplate(QDomElement list, QDomElement node, SkinContext* pContext);
+    void resolveVariables(QDomElement element, const SkinContext* pContext);
+    QDomElement loadTemplate(const QString& path, SkinContext* pContext);
+    void addDependency(const QString& path, const QByteArray& contents);
+
+    UserSettingsPointer m_pConfig;
+    const QString m_skinPath;
+    QString m_templatePath;
+    QHash<QString, QDomElement> m_templateCache;
+    // The absolute paths and content hashes of all files that the
+    // compiled skin depends on
+    QHash<QString, QByteArray> m_dependencies;
+};
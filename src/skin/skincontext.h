@@ -77,6 +77,8 @@ class SkinContext {
     void updateVariables(const QDomNode& node);
     // Updates the SkinContext with 'element', a <SetVariable> node.
     void updateVariable(const QDomElement& element);
+    // Evaluates a <Variable> or <SetVariable> node.
+    QString variableNodeToText(const QDomElement& element) const;
 
     static inline QDomNode selectNode(const QDomNode& node, const QString& nodeName) {
         QDomNode child = node.firstChild();
@@ -255,8 +257,6 @@ class SkinContext {
 
     QDomElement loadSvg(const QString& filename) const;
 
-    QString variableNodeToText(const QDomElement& element) const;
-
     UserSettingsPointer m_pConfig;
 
     QString m_xmlPath;
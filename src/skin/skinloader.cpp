@@ -7,6 +7,7 @@
 
 #include "vinylcontrol/vinylcontrolmanager.h"
 #include "skin/legacyskinparser.h"
+#include "control/control.h"
 #include "controllers/controllermanager.h"
 #include "library/library.h"
 #include "effects/effectsmanager.h"
@@ -128,7 +129,12 @@ QWidget* SkinLoader::loadConfiguredSkin(QWidget* pParent,
             pVCMan,
             pEffectsManager,
             pRecordingManager);
-    return legacy.parseSkin(skinPath, pParent);
+    ControlDoublePrivate::ScopedLookupStats lookupStats;
+    QWidget* pSkin = legacy.parseSkin(skinPath, pParent);
+    qDebug() << "Resolved" << lookupStats.count() << "controls in"
+             << lookupStats.duration().formatMillisWithUnit()
+             << "while loading skin" << skinPath;
+    return pSkin;
 }
 
 LaunchImage* SkinLoader::loadLaunchImage(QWidget* pParent) {
@@ -8,9 +8,11 @@
 
 #include "control/controlobject.h"
 #include "control/controlproxy.h"
+#include "engine/engineworkerscheduler.h"
 #include "soundio/sounddevice.h"
 #include "soundio/soundmanager.h"
 #include "soundio/soundmanagerutil.h"
+#include "util/cpuaffinity.h"
 #include "util/denormalsarezero.h"
 #include "util/fifo.h"
 #include "util/math.h"
@@ -880,6 +882,14 @@ int SoundDevicePortAudio::callbackProcessClkRef(
         QThread::currentThread()->setPriority(QThread::TimeCriticalPriority);
         m_bSetThreadPriority = true;
 
+        // Keep the callback on the core that is kept free from the
+        // EngineWorker threads (if configured).
+        const int reservedCpu =
+                EngineWorkerScheduler::reservedCpuFromConfig(m_pConfig);
+        if (reservedCpu >= 0) {
+            CpuAffinity::pinCurrentThreadToCpu(reservedCpu);
+        }
+
 
 #ifdef __SSE__
         // This disables the denormals calculations, to avoid a
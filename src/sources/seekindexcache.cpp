@@ -0,0 +1,327 @@
+#include "sources/seekindexcache.h"
+
+#include <QCryptographicHash>
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QtEndian>
+#include <algorithm>
+#include <cstring>
+
+#include "util/assert.h"
+#include "util/logger.h"
+
+namespace mixxx {
+
+namespace {
+
+const Logger kLogger("SeekIndexCache");
+
+// Layout of the cache file, all numbers in little endian:
+//  0: magic
+//  4: format version (quint32)
+//  8: size of the audio file (qint64)
+// 16: modification time of the audio file in ms since epoch (qint64)
+// 24: content hash of the audio file (SHA-1, 20 bytes)
+// 44: channel count (qint32)
+// 48: sample rate (qint32)
+// 52: bitrate (qint32)
+// 56: frame length (qint64)
+// 64: number of entries (qint64)
+// 72: entries until the end of the file, each with the frame index
+//     and the byte offset (see appendEntry())
+const char kMagic[4] = {'M', 'X', 'S', 'I'};
+constexpr quint32 kFormatVersion = 2;
+constexpr int kContentHashSize = 20;
+constexpr qint64 kHeaderSize = 72;
+// An encoded entry consists of 2 varints with at least 1 byte each
+constexpr qint64 kMinEntrySize = 2;
+// The expected size of an encoded entry for reserving memory
+constexpr qint64 kTypicalEntrySize = 4;
+
+const QString kFileSuffix = QStringLiteral(".idx");
+
+// The number of bytes at the beginning and at the end of the audio
+// file that are hashed. Reading the whole file would defeat the
+// purpose of the cache.
+constexpr qint64 kHashedBlockSize = 64 * 1024;
+
+QString s_dirPath;
+qint64 s_maxTotalSize = SeekIndexCache::kDefaultMaxTotalSize;
+
+// Entries are coded as the difference to the difference between the
+// previous two entries, which is 0 for most frames of CBR files and
+// small for VBR files. The result is zig-zag encoded, i.e. the sign is
+// moved into the lowest bit, and stored with 7 bits per byte.
+// All calculations wrap around to tolerate corrupt files.
+struct EntryCoder {
+    quint64 prevFrameIndex = 0;
+    quint64 prevByteOffset = 0;
+    quint64 prevFrameIndexDelta = 0;
+    quint64 prevByteOffsetDelta = 0;
+};
+
+void appendVarint(QByteArray* pData, quint64 value) {
+    while (value >= 0x80) {
+        pData->append(static_cast<char>((value & 0x7f) | 0x80));
+        value >>= 7;
+    }
+    pData->append(static_cast<char>(value));
+}
+
+bool readVarint(const uchar** ppData, const uchar* pEnd, quint64* pValue) {
+    quint64 value = 0;
+    for (int shift = 0; shift < 64; shift += 7) {
+        if (*ppData >= pEnd) {
+            return false;
+        }
+        const uchar byte = *(*ppData)++;
+        value |= static_cast<quint64>(byte & 0x7f) << shift;
+        if ((byte & 0x80) == 0) {
+            *pValue = value;
+            return true;
+        }
+    }
+    return false;
+}
+
+inline quint64 encodeZigZag(quint64 value) {
+    return (value << 1) ^ (0 - (value >> 63));
+}
+
+inline quint64 decodeZigZag(quint64 value) {
+    return (value >> 1) ^ (0 - (value & 1));
+}
+
+void appendEntry(QByteArray* pData, EntryCoder* pCoder, const SeekIndex::Entry& entry) {
+    const quint64 frameIndexDelta =
+            static_cast<quint64>(entry.frameIndex) - pCoder->prevFrameIndex;
+    const quint64 byteOffsetDelta =
+            static_cast<quint64>(entry.byteOffset) - pCoder->prevByteOffset;
+    appendVarint(pData, encodeZigZag(frameIndexDelta - pCoder->prevFrameIndexDelta));
+    appendVarint(pData, encodeZigZag(byteOffsetDelta - pCoder->prevByteOffsetDelta));
+    pCoder->prevFrameIndex = static_cast<quint64>(entry.frameIndex);
+    pCoder->prevByteOffset = static_cast<quint64>(entry.byteOffset);
+    pCoder->prevFrameIndexDelta = frameIndexDelta;
+    pCoder->prevByteOffsetDelta = byteOffsetDelta;
+}
+
+bool readEntry(const uchar** ppData,
+        const uchar* pEnd,
+        EntryCoder* pCoder,
+        SeekIndex::Entry* pEntry) {
+    quint64 frameIndexDeltaDelta;
+    quint64 byteOffsetDeltaDelta;
+    if (!readVarint(ppData, pEnd, &frameIndexDeltaDelta) ||
+            !readVarint(ppData, pEnd, &byteOffsetDeltaDelta)) {
+        return false;
+    }
+    pCoder->prevFrameIndexDelta += decodeZigZag(frameIndexDeltaDelta);
+    pCoder->prevByteOffsetDelta += decodeZigZag(byteOffsetDeltaDelta);
+    pCoder->prevFrameIndex += pCoder->prevFrameIndexDelta;
+    pCoder->prevByteOffset += pCoder->prevByteOffsetDelta;
+    pEntry->frameIndex = static_cast<qint64>(pCoder->prevFrameIndex);
+    pEntry->byteOffset = static_cast<qint64>(pCoder->prevByteOffset);
+    return true;
+}
+
+QString pathHashOf(const QString& audioFilePath) {
+    return QString::fromLatin1(QCryptographicHash::hash(
+            QFileInfo(audioFilePath).absoluteFilePath().toUtf8(),
+            QCryptographicHash::Sha1)
+                                       .toHex());
+}
+
+// Deletes the least recently used files until the total size of
+// the directory does not exceed the limit
+void pruneDirectory() {
+    const auto fileInfos = QDir(s_dirPath).entryInfoList(
+            QStringList{QStringLiteral("*") + kFileSuffix},
+            QDir::Files,
+            QDir::Time); // most recently used first
+    qint64 totalSize = 0;
+    for (const auto& fileInfo : fileInfos) {
+        totalSize += fileInfo.size();
+        if (totalSize <= s_maxTotalSize) {
+            continue;
+        }
+        kLogger.debug() << "Deleting" << fileInfo.filePath();
+        if (QFile::remove(fileInfo.filePath())) {
+            totalSize -= fileInfo.size();
+        }
+    }
+}
+
+QByteArray hashFileContent(QFile* pFile, qint64 fileSize) {
+    QCryptographicHash hash(QCryptographicHash::Sha1);
+    hash.addData(pFile->read(kHashedBlockSize));
+    if (fileSize > kHashedBlockSize) {
+        if (!pFile->seek(std::max(kHashedBlockSize, fileSize - kHashedBlockSize))) {
+            return QByteArray();
+        }
+        hash.addData(pFile->read(kHashedBlockSize));
+    }
+    const QByteArray result = hash.result();
+    DEBUG_ASSERT(result.size() == kContentHashSize);
+    return result;
+}
+
+} // anonymous namespace
+
+//static
+void SeekIndexCache::setDirectory(const QString& dirPath, qint64 maxTotalSize) {
+    if (!dirPath.isEmpty() && !QDir().mkpath(dirPath)) {
+        kLogger.warning()
+                << "Failed to create directory"
+                << dirPath;
+        s_dirPath = QString();
+        return;
+    }
+    s_dirPath = dirPath;
+    s_maxTotalSize = maxTotalSize;
+}
+
+//static
+bool SeekIndexCache::isEnabled() {
+    return !s_dirPath.isEmpty();
+}
+
+//static
+void SeekIndexCache::remove(const QString& audioFilePath) {
+    if (!isEnabled() || audioFilePath.isEmpty()) {
+        return;
+    }
+    const QDir dir(s_dirPath);
+    const auto fileNames = dir.entryList(
+            QStringList{QStringLiteral("*-") + pathHashOf(audioFilePath) + kFileSuffix},
+            QDir::Files);
+    for (const auto& fileName : fileNames) {
+        kLogger.debug() << "Deleting" << dir.filePath(fileName);
+        QFile::remove(dir.filePath(fileName));
+    }
+}
+
+SeekIndexCache::SeekIndexCache(
+        const QString& audioFilePath,
+        const QString& type)
+        : m_fileSize(0),
+          m_lastModifiedMillis(0) {
+    if (!isEnabled()) {
+        return;
+    }
+    const QFileInfo fileInfo(audioFilePath);
+    QFile file(fileInfo.absoluteFilePath());
+    if (!file.open(QIODevice::ReadOnly)) {
+        return;
+    }
+    m_fileSize = file.size();
+    m_lastModifiedMillis = fileInfo.lastModified().toMSecsSinceEpoch();
+    m_contentHash = hashFileContent(&file, m_fileSize);
+    if (m_contentHash.isEmpty()) {
+        return;
+    }
+    // Each location has a single cache file that is replaced when
+    // the audio file is modified
+    m_cacheFilePath = QDir(s_dirPath).filePath(
+            type + QChar('-') + pathHashOf(audioFilePath) + kFileSuffix);
+}
+
+bool SeekIndexCache::load(SeekIndex* pIndex) const {
+    DEBUG_ASSERT(pIndex);
+    if (m_cacheFilePath.isEmpty()) {
+        return false;
+    }
+    QFile file(m_cacheFilePath);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+    const qint64 size = file.size();
+    if (size < kHeaderSize) {
+        return false;
+    }
+    const uchar* pData = file.map(0, size);
+    if (!pData) {
+        return false;
+    }
+    bool valid = std::memcmp(pData, kMagic, sizeof(kMagic)) == 0 &&
+            qFromLittleEndian<quint32>(pData + 4) == kFormatVersion &&
+            qFromLittleEndian<qint64>(pData + 8) == m_fileSize &&
+            qFromLittleEndian<qint64>(pData + 16) == m_lastModifiedMillis &&
+            std::memcmp(pData + 24, m_contentHash.constData(), kContentHashSize) == 0;
+    const qint64 entryCount = valid ? qFromLittleEndian<qint64>(pData + 64) : 0;
+    valid = valid && entryCount > 0 &&
+            entryCount <= (size - kHeaderSize) / kMinEntrySize;
+    if (valid) {
+        pIndex->channelCount = qFromLittleEndian<qint32>(pData + 44);
+        pIndex->sampleRate = qFromLittleEndian<qint32>(pData + 48);
+        pIndex->bitrate = qFromLittleEndian<qint32>(pData + 52);
+        pIndex->frameLength = qFromLittleEndian<qint64>(pData + 56);
+        pIndex->entries.resize(static_cast<size_t>(entryCount));
+        const uchar* pEntry = pData + kHeaderSize;
+        const uchar* const pEnd = pData + size;
+        EntryCoder coder;
+        for (auto& entry : pIndex->entries) {
+            if (!readEntry(&pEntry, pEnd, &coder, &entry)) {
+                valid = false;
+                break;
+            }
+        }
+        valid = valid && pEntry == pEnd;
+    }
+    file.unmap(const_cast<uchar*>(pData));
+    if (valid) {
+        // The modification time of the cache file is used
+        // for evicting the least recently used files
+        QFile touchedFile(m_cacheFilePath);
+        if (touchedFile.open(QIODevice::Append)) {
+            touchedFile.setFileTime(QDateTime::currentDateTimeUtc(),
+                    QFileDevice::FileModificationTime);
+        }
+    } else {
+        kLogger.debug()
+                << "Ignoring outdated or invalid cache file"
+                << m_cacheFilePath;
+    }
+    return valid;
+}
+
+bool SeekIndexCache::save(const SeekIndex& index) const {
+    if (m_cacheFilePath.isEmpty() || index.entries.empty()) {
+        return false;
+    }
+    const qint64 entryCount = static_cast<qint64>(index.entries.size());
+    QByteArray data(static_cast<int>(kHeaderSize), '\0');
+    data.reserve(static_cast<int>(kHeaderSize + entryCount * kTypicalEntrySize));
+    auto* pData = reinterpret_cast<uchar*>(data.data());
+    std::memcpy(pData, kMagic, sizeof(kMagic));
+    qToLittleEndian(kFormatVersion, pData + 4);
+    qToLittleEndian(m_fileSize, pData + 8);
+    qToLittleEndian(m_lastModifiedMillis, pData + 16);
+    std::memcpy(pData + 24, m_contentHash.constData(), kContentHashSize);
+    qToLittleEndian(static_cast<qint32>(index.channelCount), pData + 44);
+    qToLittleEndian(static_cast<qint32>(index.sampleRate), pData + 48);
+    qToLittleEndian(static_cast<qint32>(index.bitrate), pData + 52);
+    qToLittleEndian(index.frameLength, pData + 56);
+    qToLittleEndian(entryCount, pData + 64);
+    EntryCoder coder;
+    for (const auto& entry : index.entries) {
+        appendEntry(&data, &coder, entry);
+    }
+
+    // Files might be opened and indexed concurrently
+    QSaveFile file(m_cacheFilePath);
+    if (!file.open(QIODevice::WriteOnly) ||
+            file.write(data) != data.size() ||
+            !file.commit()) {
+        kLogger.warning()
+                << "Failed to write cache file"
+                << m_cacheFilePath;
+        return false;
+    }
+    pruneDirectory();
+    return true;
+}
+
+} // namespace mixxx
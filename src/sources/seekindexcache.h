@@ -0,0 +1,85 @@
+#pragma once
+
+#include <QByteArray>
+#include <QString>
+#include <QtGlobal>
+#include <vector>
+
+namespace mixxx {
+
+/// The positions of (compressed) frames within an audio file that are
+/// needed for seeking, together with the audio properties that have been
+/// determined while scanning the file.
+struct SeekIndex {
+    struct Entry {
+        qint64 frameIndex;
+        qint64 byteOffset;
+    };
+
+    SeekIndex()
+            : channelCount(0),
+              sampleRate(0),
+              bitrate(0),
+              frameLength(0) {
+    }
+
+    int channelCount;
+    int sampleRate;
+    // kbps, 0 if unknown
+    int bitrate;
+    qint64 frameLength;
+    // Ordered by frame index
+    std::vector<Entry> entries;
+};
+
+/// Persists the seek index of an audio file to avoid scanning the whole
+/// file again when opening it the next time.
+///
+/// The cache file of an audio file is only valid as long as the size,
+/// the modification time and the hash of the head and tail of the audio
+/// file remain unchanged. Stored indexes are memory-mapped for loading.
+///
+/// Entries are delta-coded, which needs 2 to 3 bytes per MP3 frame. The
+/// least recently used cache files are deleted when the total size of
+/// the directory exceeds its limit.
+class SeekIndexCache {
+  public:
+    static constexpr qint64 kDefaultMaxTotalSize = 64 * 1024 * 1024;
+
+    /// Sets the directory for all cache files. The cache is disabled
+    /// while no directory has been set. Must be invoked before any
+    /// audio files are opened.
+    static void setDirectory(
+            const QString& dirPath,
+            qint64 maxTotalSize = kDefaultMaxTotalSize);
+
+    static bool isEnabled();
+
+    /// Deletes the indexes of all types for the file, e.g. when the
+    /// track is removed from the library.
+    static void remove(const QString& audioFilePath);
+
+    /// The type distinguishes the indexes of different decoders for
+    /// the same file.
+    SeekIndexCache(
+            const QString& audioFilePath,
+            const QString& type);
+
+    /// Returns false if no valid index is available for the file.
+    bool load(SeekIndex* pIndex) const;
+
+    bool save(const SeekIndex& index) const;
+
+    /// The path of the cache file, empty if disabled.
+    const QString& cacheFilePath() const {
+        return m_cacheFilePath;
+    }
+
+  private:
+    QString m_cacheFilePath;
+    qint64 m_fileSize;
+    qint64 m_lastModifiedMillis;
+    QByteArray m_contentHash;
+};
+
+} // namespace mixxx
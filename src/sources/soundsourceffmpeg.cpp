@@ -1,5 +1,6 @@
 #include "sources/soundsourceffmpeg.h"
 
+#include <algorithm>
 #include <mutex>
 
 #include "util/logger.h"
@@ -162,7 +163,11 @@ IndexRange getStreamFrameIndexRange(const AVStream& avStream) {
 
 SINT getStreamSeekPrerollFrameCount(const AVStream& avStream) {
     // Stream might not provide an appropriate value that is
-    // sufficient for sample accurate decoding
+    // sufficient for sample accurate decoding.
+    //
+    // With a seek index the preroll starts at the packet boundary
+    // before the target position. Without the demuxer has to guess
+    // the position and the preroll is rounded to codec frames.
     const SINT defaultSeekPrerollFrameCount =
             avStream.codecpar->seek_preroll;
     DEBUG_ASSERT(defaultSeekPrerollFrameCount >= 0);
@@ -466,7 +471,11 @@ SoundSourceFFmpeg::SoundSourceFFmpeg(const QUrl& url)
           m_pavStream(nullptr),
           m_pavDecodedFrame(nullptr),
           m_pavResampledFrame(nullptr),
-          m_seekPrerollFrameCount(0) {
+          m_seekPrerollFrameCount(0),
+          m_seekIndexByteSeeking(false),
+          m_seekIndexCursor(-1),
+          m_indexedSeekCount(0),
+          m_recordingSeekIndex(false) {
 }
 
 SoundSourceFFmpeg::~SoundSourceFFmpeg() {
@@ -680,6 +689,25 @@ SoundSource::OpenResult SoundSourceFFmpeg::tryOpen(
     kLogger.debug() << "Seek preroll frame count:" << m_seekPrerollFrameCount;
 #endif
 
+    // The packet index is recorded while decoding the whole stream,
+    // e.g. during analysis, and reused when opening the file again.
+    DEBUG_ASSERT(m_seekIndexEntries.empty());
+    {
+        SeekIndex seekIndex;
+        if (SeekIndexCache(getLocalFileName(), QStringLiteral("ffmpeg"))
+                        .load(&seekIndex)) {
+            if (isValidSeekIndex(seekIndex)) {
+                m_seekIndexEntries = std::move(seekIndex.entries);
+            } else {
+                kLogger.warning()
+                        << "Ignoring invalid seek index:"
+                        << getLocalFileName();
+            }
+        }
+    }
+    m_seekIndexByteSeeking =
+            !(m_pavInputFormatContext->iformat->flags & AVFMT_NO_BYTE_SEEK);
+
     m_frameBuffer = ReadAheadFrameBuffer(
             getSignalInfo(),
             frameBufferCapacityForStream(*m_pavStream));
@@ -776,6 +804,10 @@ void SoundSourceFFmpeg::close() {
     m_pavCodecContext.close();
     m_pavInputFormatContext.close();
     m_pavStream = nullptr;
+    m_seekIndexEntries.clear();
+    m_seekIndexCursor = -1;
+    m_recordingSeekIndex = false;
+    m_recordedSeekIndexEntries.clear();
 }
 
 namespace {
@@ -834,6 +866,10 @@ bool SoundSourceFFmpeg::adjustCurrentPosition(SINT startIndex) {
         return true;
     }
 
+    if (!m_seekIndexEntries.empty()) {
+        return seekToIndexedPacket(startIndex);
+    }
+
     // Need to seek to a new position before continue reading. For
     // sample accurate decoding the actual seek position must be
     // placed BEFORE the position where reading continues.
@@ -864,6 +900,12 @@ bool SoundSourceFFmpeg::adjustCurrentPosition(SINT startIndex) {
             m_pavStream->index,
             seekTimestamp,
             AVSEEK_FLAG_BACKWARD);
+    // Only packets that are decoded from the very beginning of the
+    // stream are recorded
+    m_recordingSeekIndex = seekIndex == kMinFrameIndex &&
+            av_seek_frame_result >= 0 &&
+            SeekIndexCache::isEnabled();
+    m_recordedSeekIndexEntries.clear();
     if (av_seek_frame_result < 0) {
         // Unrecoverable seek error: Invalidate the current position and abort
         kLogger.warning().noquote()
@@ -879,6 +921,174 @@ bool SoundSourceFFmpeg::adjustCurrentPosition(SINT startIndex) {
     return true;
 }
 
+bool SoundSourceFFmpeg::seekToIndexedPacket(SINT startIndex) {
+    DEBUG_ASSERT(!m_seekIndexEntries.empty());
+    ++m_indexedSeekCount;
+    // The packet that contains the start index
+    auto entry = std::upper_bound(
+            m_seekIndexEntries.begin(),
+            m_seekIndexEntries.end(),
+            startIndex,
+            [](SINT frameIndex, const SeekIndex::Entry& entry) {
+                return frameIndex < entry.frameIndex;
+            });
+    if (entry != m_seekIndexEntries.begin()) {
+        --entry;
+    }
+    // Only decode the preceding packets that the codec needs for
+    // restoring its internal state
+    while (entry != m_seekIndexEntries.begin() &&
+            startIndex - entry->frameIndex < m_seekPrerollFrameCount) {
+        --entry;
+    }
+    const auto seekIndex = static_cast<SINT>(entry->frameIndex);
+    DEBUG_ASSERT(seekIndex <= startIndex);
+
+    if (m_frameBuffer.tryContinueReadingFrom(seekIndex)) {
+        return true;
+    }
+
+    avcodec_flush_buffers(m_pavCodecContext);
+
+    int av_seek_frame_result;
+    if (m_seekIndexByteSeeking) {
+        // The demuxer does not need to search for the position. The
+        // timestamps of the following packets are taken from the index.
+        av_seek_frame_result = av_seek_frame(
+                m_pavInputFormatContext,
+                m_pavStream->index,
+                entry->byteOffset,
+                AVSEEK_FLAG_BYTE);
+        m_seekIndexCursor =
+                static_cast<int>(std::distance(m_seekIndexEntries.begin(), entry));
+    } else {
+        // The timestamp matches the packet exactly
+        av_seek_frame_result = av_seek_frame(
+                m_pavInputFormatContext,
+                m_pavStream->index,
+                convertFrameIndexToStreamTime(*m_pavStream, seekIndex),
+                AVSEEK_FLAG_BACKWARD);
+        m_seekIndexCursor = -1;
+    }
+    m_recordingSeekIndex = false;
+    if (av_seek_frame_result < 0) {
+        kLogger.warning().noquote()
+                << "av_seek_frame() failed:"
+                << formatErrorString(av_seek_frame_result);
+        m_seekIndexCursor = -1;
+        m_frameBuffer.invalidate();
+        return false;
+    }
+    m_frameBuffer.reset();
+
+    return true;
+}
+
+bool SoundSourceFFmpeg::isValidSeekIndex(const SeekIndex& seekIndex) const {
+    if (seekIndex.channelCount != m_pavStream->codecpar->channels ||
+            seekIndex.sampleRate != m_pavStream->codecpar->sample_rate ||
+            seekIndex.frameLength != frameIndexRange().length() ||
+            seekIndex.entries.empty() ||
+            seekIndex.entries.front().frameIndex != kMinFrameIndex) {
+        return false;
+    }
+    for (std::size_t i = 1; i < seekIndex.entries.size(); ++i) {
+        const auto& previous = seekIndex.entries[i - 1];
+        const auto& entry = seekIndex.entries[i];
+        if (entry.frameIndex <= previous.frameIndex ||
+                entry.byteOffset <= previous.byteOffset) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void SoundSourceFFmpeg::updateSeekIndex(
+        AVPacket* pavPacket, SINT packetFrameIndex) {
+    if (!pavPacket->data) {
+        // End of stream
+        m_seekIndexCursor = -1;
+        if (m_recordingSeekIndex && !m_recordedSeekIndexEntries.empty()) {
+            SeekIndex seekIndex;
+            seekIndex.channelCount = m_pavStream->codecpar->channels;
+            seekIndex.sampleRate = m_pavStream->codecpar->sample_rate;
+            seekIndex.bitrate = getBitrate();
+            seekIndex.frameLength = frameIndexRange().length();
+            seekIndex.entries = std::move(m_recordedSeekIndexEntries);
+            if (isValidSeekIndex(seekIndex)) {
+                SeekIndexCache(getLocalFileName(), QStringLiteral("ffmpeg"))
+                        .save(seekIndex);
+                m_seekIndexEntries = std::move(seekIndex.entries);
+            }
+        }
+        m_recordingSeekIndex = false;
+        m_recordedSeekIndexEntries.clear();
+        return;
+    }
+
+    if (m_seekIndexCursor >= 0) {
+        // After seeking to a byte offset the demuxer might only be able
+        // to estimate the timestamps of the following packets
+        if (m_seekIndexCursor < static_cast<int>(m_seekIndexEntries.size()) &&
+                m_seekIndexEntries[m_seekIndexCursor].byteOffset == pavPacket->pos) {
+            pavPacket->pts = convertFrameIndexToStreamTime(*m_pavStream,
+                    static_cast<SINT>(m_seekIndexEntries[m_seekIndexCursor].frameIndex));
+            pavPacket->dts = pavPacket->pts;
+            ++m_seekIndexCursor;
+        } else {
+            kLogger.warning()
+                    << "Packet at byte offset"
+                    << pavPacket->pos
+                    << "is missing in the seek index";
+            m_seekIndexCursor = -1;
+        }
+    }
+
+    if (m_recordingSeekIndex) {
+        if (packetFrameIndex >= kMinFrameIndex &&
+                pavPacket->pos >= 0 &&
+                (m_recordedSeekIndexEntries.empty() ||
+                        (m_recordedSeekIndexEntries.back().frameIndex < packetFrameIndex &&
+                                m_recordedSeekIndexEntries.back().byteOffset <
+                                        pavPacket->pos))) {
+            m_recordedSeekIndexEntries.push_back(SeekIndex::Entry{
+                    packetFrameIndex,
+                    pavPacket->pos});
+        } else {
+            // Packets without a position or with unordered timestamps
+            // cannot be indexed
+            m_recordingSeekIndex = false;
+            m_recordedSeekIndexEntries.clear();
+        }
+    }
+}
+
+void SoundSourceFFmpeg::finishSeekIndex() {
+    DEBUG_ASSERT(m_recordingSeekIndex);
+    // Index the remaining packets without decoding them
+    AVPacket avPacket;
+    av_init_packet(&avPacket);
+    avPacket.data = nullptr;
+    avPacket.size = 0;
+    while (m_recordingSeekIndex) {
+        const SINT packetFrameIndex = readNextPacket(
+                m_pavInputFormatContext,
+                m_pavStream,
+                &avPacket,
+                frameIndexRange().end());
+        if (packetFrameIndex == ReadAheadFrameBuffer::kInvalidFrameIndex) {
+            m_recordingSeekIndex = false;
+            m_recordedSeekIndexEntries.clear();
+            break;
+        }
+        // Stops recording at the end of the stream
+        updateSeekIndex(&avPacket, packetFrameIndex);
+        av_packet_unref(&avPacket);
+    }
+    // The decoder has not received the skipped packets
+    m_frameBuffer.reset();
+}
+
 bool SoundSourceFFmpeg::consumeNextAVPacket(
         AVPacket* pavPacket, AVPacket** ppavNextPacket) {
     DEBUG_ASSERT(pavPacket);
@@ -895,6 +1105,7 @@ bool SoundSourceFFmpeg::consumeNextAVPacket(
             m_frameBuffer.invalidate();
             return false;
         }
+        updateSeekIndex(pavPacket, packetFrameIndex);
         *ppavNextPacket = pavPacket;
     }
     auto pavNextPacket = *ppavNextPacket;
@@ -1205,6 +1416,11 @@ ReadableSampleFrames SoundSourceFFmpeg::readSampleFramesClamped(
     }
     DEBUG_ASSERT(!pavNextPacket);
 
+    if (m_recordingSeekIndex &&
+            writableFrameRange.start() >= frameIndexRange().end()) {
+        finishSeekIndex();
+    }
+
     auto readableRange =
             IndexRange::between(
                     readableStartIndex,
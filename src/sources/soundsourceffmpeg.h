@@ -8,7 +8,10 @@ extern "C" {
 
 } // extern "C"
 
+#include <vector>
+
 #include "sources/readaheadframebuffer.h"
+#include "sources/seekindexcache.h"
 #include "sources/soundsourceprovider.h"
 
 namespace mixxx {
@@ -20,6 +23,12 @@ class SoundSourceFFmpeg : public SoundSource {
 
     void close() override;
 
+    // The number of seeks that have used the seek index, e.g. for
+    // verifying that a cached seek index is reused
+    int indexedSeekCount() const {
+        return m_indexedSeekCount;
+    }
+
   protected:
     ReadableSampleFrames readSampleFramesClamped(
             const WritableSampleFrames& sampleFrames) override;
@@ -38,6 +47,19 @@ class SoundSourceFFmpeg : public SoundSource {
     // upon seek errors.
     bool adjustCurrentPosition(
             SINT startIndex);
+    // Seek to the packet that is needed for decoding the requested start
+    // index sample-accurately by using the seek index.
+    bool seekToIndexedPacket(
+            SINT startIndex);
+
+    bool isValidSeekIndex(const SeekIndex& seekIndex) const;
+    // Corrects the timestamps of packets after seeking to a byte offset
+    // and records a new seek index while decoding from the beginning.
+    void updateSeekIndex(
+            AVPacket* pavPacket,
+            SINT packetFrameIndex);
+    // Reads the remaining packets for completing the recorded seek index
+    void finishSeekIndex();
 
     bool consumeNextAVPacket(
             AVPacket* pavPacket,
@@ -183,6 +205,16 @@ class SoundSourceFFmpeg : public SoundSource {
 
     FrameCount m_seekPrerollFrameCount;
 
+    // The start positions of all packets, empty if unknown
+    std::vector<SeekIndex::Entry> m_seekIndexEntries;
+    bool m_seekIndexByteSeeking;
+    // The entry of the next packet after seeking to a byte offset
+    int m_seekIndexCursor;
+    int m_indexedSeekCount;
+    // Recorded while decoding the whole stream from the beginning
+    bool m_recordingSeekIndex;
+    std::vector<SeekIndex::Entry> m_recordedSeekIndexEntries;
+
     ReadAheadFrameBuffer m_frameBuffer;
 };
 
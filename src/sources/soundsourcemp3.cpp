@@ -225,6 +225,22 @@ SoundSource::OpenResult SoundSourceMp3::tryOpen(
     DEBUG_ASSERT(m_seekFrameList.empty());
     m_avgSeekFrameCount = 0;
     m_curFrameIndex = 0;
+
+    // Scanning all frame headers of a file is expensive. The results
+    // are reused if the file has not been modified since.
+    const SeekIndexCache seekIndexCache(m_file.fileName(), QStringLiteral("mp3"));
+    {
+        SeekIndex seekIndex;
+        if (seekIndexCache.load(&seekIndex)) {
+            if (isValidSeekIndex(seekIndex)) {
+                return openFromSeekIndex(seekIndex);
+            }
+            kLogger.warning()
+                    << "Rescanning file with invalid seek index:"
+                    << m_file.fileName();
+        }
+    }
+
     int headerPerSampleRate[kSampleRateCount];
     for (int i = 0; i < kSampleRateCount; ++i) {
         headerPerSampleRate[i] = 0;
@@ -410,6 +426,81 @@ SoundSource::OpenResult SoundSourceMp3::tryOpen(
         return OpenResult::Failed;
     }
 
+    seekIndexCache.save(createSeekIndex());
+
+    return OpenResult::Succeeded;
+}
+
+SeekIndex SoundSourceMp3::createSeekIndex() const {
+    SeekIndex seekIndex;
+    seekIndex.channelCount = getSignalInfo().getChannelCount();
+    seekIndex.sampleRate = getSignalInfo().getSampleRate();
+    seekIndex.bitrate = getBitrate();
+    seekIndex.frameLength = frameLength();
+    DEBUG_ASSERT(!m_seekFrameList.empty());
+    // The terminating seek frame is not stored
+    seekIndex.entries.reserve(m_seekFrameList.size() - 1);
+    for (size_t i = 0; i + 1 < m_seekFrameList.size(); ++i) {
+        const SeekFrameType& seekFrame = m_seekFrameList[i];
+        seekIndex.entries.push_back(SeekIndex::Entry{
+                seekFrame.frameIndex,
+                seekFrame.pInputData - m_pFileData});
+    }
+    return seekIndex;
+}
+
+bool SoundSourceMp3::isValidSeekIndex(const SeekIndex& seekIndex) const {
+    const audio::ChannelCount channelCount(seekIndex.channelCount);
+    if (!channelCount.isValid() || channelCount > kChannelCountMax ||
+            getIndexBySampleRate(audio::SampleRate(seekIndex.sampleRate)) >=
+                    kSampleRateCount ||
+            seekIndex.entries.empty() ||
+            seekIndex.entries.front().frameIndex != 0) {
+        return false;
+    }
+    qint64 prevFrameIndex = -1;
+    qint64 prevByteOffset = -1;
+    for (const auto& entry : seekIndex.entries) {
+        if (entry.frameIndex <= prevFrameIndex ||
+                entry.frameIndex >= seekIndex.frameLength ||
+                entry.byteOffset <= prevByteOffset ||
+                static_cast<quint64>(entry.byteOffset) >= m_fileSize) {
+            return false;
+        }
+        prevFrameIndex = entry.frameIndex;
+        prevByteOffset = entry.byteOffset;
+    }
+    return true;
+}
+
+SoundSource::OpenResult SoundSourceMp3::openFromSeekIndex(const SeekIndex& seekIndex) {
+    DEBUG_ASSERT(isValidSeekIndex(seekIndex));
+    for (const auto& entry : seekIndex.entries) {
+        addSeekFrame(static_cast<SINT>(entry.frameIndex),
+                m_pFileData + entry.byteOffset);
+    }
+    m_curFrameIndex = static_cast<SINT>(seekIndex.frameLength);
+
+    initChannelCountOnce(audio::ChannelCount(seekIndex.channelCount));
+    initSampleRateOnce(audio::SampleRate(seekIndex.sampleRate));
+    initFrameIndexRangeOnce(IndexRange::forward(0, m_curFrameIndex));
+    m_avgSeekFrameCount = frameLength() / m_seekFrameList.size();
+    if (audio::Bitrate(seekIndex.bitrate).isValid()) {
+        initBitrateOnce(seekIndex.bitrate);
+    }
+
+    // Terminate m_seekFrameList
+    addSeekFrame(m_curFrameIndex, nullptr);
+
+    // Restart decoding at the beginning of the audio stream
+    restartDecoding(m_seekFrameList.front());
+
+    if (m_curFrameIndex != frameIndexMin()) {
+        kLogger.warning() << "Failed to start decoding:" << m_file.fileName();
+        // Abort
+        return OpenResult::Failed;
+    }
+
     return OpenResult::Succeeded;
 }
 
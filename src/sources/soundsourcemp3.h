@@ -1,5 +1,6 @@
 #pragma once
 
+#include "sources/seekindexcache.h"
 #include "sources/soundsourceprovider.h"
 
 #ifdef _MSC_VER
@@ -53,6 +54,12 @@ class SoundSourceMp3 final : public SoundSource {
 
     void addSeekFrame(SINT frameIndex, const unsigned char* pInputData);
 
+    /// Restores the seek frames and audio properties from a
+    /// persisted index instead of scanning the whole file.
+    bool isValidSeekIndex(const SeekIndex& seekIndex) const;
+    OpenResult openFromSeekIndex(const SeekIndex& seekIndex);
+    SeekIndex createSeekIndex() const;
+
     /** Returns the position in m_seekFrameList of the requested frame index. */
     SINT findSeekFrameIndex(SINT frameIndex) const;
 
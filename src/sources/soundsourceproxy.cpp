@@ -68,6 +68,41 @@ bool registerSoundSourceProvider(
     return true;
 }
 
+// Only parses artist and title if the title is empty to avoid
+// inconsistencies. Otherwise the file name (without extension)
+// is used as the title and the artist is unmodified.
+void parseMissingArtistTitleFromFileName(
+        const TrackFile& trackFile,
+        mixxx::TrackMetadata* pTrackMetadata,
+        QDateTime* pMetadataSynchronized) {
+    if (!pTrackMetadata->getTrackInfo().getTitle().trimmed().isEmpty()) {
+        return;
+    }
+    // TODO(XXX): Disable splitting of artist/title in settings, i.e.
+    // optionally don't split even if both title and artist are empty?
+    // Some users might want to import the whole file name of untagged
+    // files as the title without splitting the artist:
+    //     https://www.mixxx.org/forums/viewtopic.php?f=3&t=12838
+    // NOTE(uklotzde, 2019-09-26): Whoever needs this should simply set
+    // splitArtistTitle = false here and compile their custom version!
+    // It is not worth extending the settings and injecting them into
+    // SoundSourceProxy for just a few people.
+    const bool splitArtistTitle =
+            pTrackMetadata->getTrackInfo().getArtist().trimmed().isEmpty();
+    kLogger.info()
+            << "Parsing missing"
+            << (splitArtistTitle ? "artist/title" : "title")
+            << "from file name:"
+            << trackFile;
+    if (pTrackMetadata->refTrackInfo().parseArtistTitleFromFileName(
+                trackFile.fileName(), splitArtistTitle) &&
+            pMetadataSynchronized->isNull()) {
+        // Since this is also some kind of metadata import, we mark the
+        // track's metadata as synchronized with the time stamp of the file.
+        *pMetadataSynchronized = trackFile.fileLastModified();
+    }
+}
+
 void registerReferenceSoundSourceProvider(
         mixxx::SoundSourceProviderRegistry* pProviderRegistry,
         const mixxx::SoundSourceProviderPointer& pProvider) {
@@ -575,34 +610,11 @@ void SoundSourceProxy::updateTrackFromSource(
         if (mergeImportedMetadata) {
             // Nothing to do if no metadata imported
             return;
-        } else if (trackMetadata.getTrackInfo().getTitle().trimmed().isEmpty()) {
-            // Only parse artist and title if both fields are empty to avoid
-            // inconsistencies. Otherwise the file name (without extension)
-            // is used as the title and the artist is unmodified.
-            //
-            // TODO(XXX): Disable splitting of artist/title in settings, i.e.
-            // optionally don't split even if both title and artist are empty?
-            // Some users might want to import the whole file name of untagged
-            // files as the title without splitting the artist:
-            //     https://www.mixxx.org/forums/viewtopic.php?f=3&t=12838
-            // NOTE(uklotzde, 2019-09-26): Whoever needs this should simply set
-            // splitArtistTitle = false here and compile their custom version!
-            // It is not worth extending the settings and injecting them into
-            // SoundSourceProxy for just a few people.
-            const bool splitArtistTitle =
-                    trackMetadata.getTrackInfo().getArtist().trimmed().isEmpty();
-            const auto trackFile = m_pTrack->getFileInfo();
-            kLogger.info()
-                    << "Parsing missing"
-                    << (splitArtistTitle ? "artist/title" : "title")
-                    << "from file name:"
-                    << trackFile;
-            if (trackMetadata.refTrackInfo().parseArtistTitleFromFileName(trackFile.fileName(), splitArtistTitle) &&
-                    metadataImported.second.isNull()) {
-                // Since this is also some kind of metadata import, we mark the
-                // track's metadata as synchronized with the time stamp of the file.
-                metadataImported.second = trackFile.fileLastModified();
-            }
+        } else {
+            parseMissingArtistTitleFromFileName(
+                    m_pTrack->getFileInfo(),
+                    &trackMetadata,
+                    &metadataImported.second);
         }
     }
 
@@ -635,23 +647,7 @@ void SoundSourceProxy::updateTrackFromSource(
                         << getUrl().toString();
             }
         }
-        m_pTrack->importMetadata(trackMetadata, metadataImported.second);
-        bool pendingBeatsImport = m_pTrack->getBeatsImportStatus() == Track::ImportStatus::Pending;
-        bool pendingCueImport = m_pTrack->getCueImportStatus() == Track::ImportStatus::Pending;
-        if (pendingBeatsImport || pendingCueImport) {
-            // Try to open the audio source once to determine the actual
-            // stream properties for finishing the pending import.
-            kLogger.debug()
-                    << "Opening audio source to finish import of beats/cues";
-            const auto pAudioSource = openAudioSource();
-            Q_UNUSED(pAudioSource); // only used in debug assertion
-            DEBUG_ASSERT(!pAudioSource ||
-                    m_pTrack->getBeatsImportStatus() ==
-                            Track::ImportStatus::Complete);
-            DEBUG_ASSERT(!pAudioSource ||
-                    m_pTrack->getCueImportStatus() ==
-                            Track::ImportStatus::Complete);
-        }
+        initTrackMetadata(trackMetadata, metadataImported.second);
     }
 
     if (pCoverImg) {
@@ -666,6 +662,109 @@ void SoundSourceProxy::updateTrackFromSource(
     }
 }
 
+void SoundSourceProxy::initTrackMetadata(
+        const mixxx::TrackMetadata& trackMetadata,
+        const QDateTime& metadataSynchronized) {
+    DEBUG_ASSERT(m_pTrack);
+    m_pTrack->importMetadata(trackMetadata, metadataSynchronized);
+    bool pendingBeatsImport = m_pTrack->getBeatsImportStatus() == Track::ImportStatus::Pending;
+    bool pendingCueImport = m_pTrack->getCueImportStatus() == Track::ImportStatus::Pending;
+    if (pendingBeatsImport || pendingCueImport) {
+        // Try to open the audio source once to determine the actual
+        // stream properties for finishing the pending import.
+        kLogger.debug()
+                << "Opening audio source to finish import of beats/cues";
+        const auto pAudioSource = openAudioSource();
+        Q_UNUSED(pAudioSource); // only used in debug assertion
+        DEBUG_ASSERT(!pAudioSource ||
+                m_pTrack->getBeatsImportStatus() ==
+                        Track::ImportStatus::Complete);
+        DEBUG_ASSERT(!pAudioSource ||
+                m_pTrack->getCueImportStatus() ==
+                        Track::ImportStatus::Complete);
+    }
+}
+
+//static
+PreparedTrackImport SoundSourceProxy::prepareTrackImport(
+        const TrackFile& trackFile,
+        CoverInfoGuesser* pCoverInfoGuesser) {
+    PreparedTrackImport preparedImport;
+    preparedImport.trackFile = trackFile;
+    {
+        // Files of cached tracks might be modified concurrently when
+        // exporting metadata. These tracks must be imported while the
+        // cache is locked by updateTrackFromSource(). The canonical
+        // location is resolved before locking the cache, because it
+        // requires file system access.
+        const auto trackRef = TrackRef::fromFileInfo(trackFile);
+        GlobalTrackCacheLocker locker;
+        if (locker.lookupTrackByRef(trackRef)) {
+            return preparedImport;
+        }
+    }
+    SoundSourceProxy proxy(trackFile.toUrl());
+    if (!proxy.m_pSoundSource) {
+        return preparedImport;
+    }
+    preparedImport.fileType = proxy.m_pSoundSource->getType();
+
+    QImage coverImg;
+    auto metadataImported =
+            proxy.m_pSoundSource->importTrackMetadataAndCoverImage(
+                    &preparedImport.trackMetadata, &coverImg);
+    if (metadataImported.first == mixxx::MetadataSource::ImportResult::Failed) {
+        kLogger.warning()
+                << "Failed to import track metadata and embedded cover art"
+                << "from file"
+                << proxy.getUrl().toString();
+    }
+    if (metadataImported.first != mixxx::MetadataSource::ImportResult::Succeeded) {
+        parseMissingArtistTitleFromFileName(
+                trackFile,
+                &preparedImport.trackMetadata,
+                &metadataImported.second);
+    }
+    preparedImport.metadataSynchronized = metadataImported.second;
+
+    const QString albumName =
+            preparedImport.trackMetadata.getAlbumInfo().getTitle();
+    if (pCoverInfoGuesser) {
+        preparedImport.coverInfo = pCoverInfoGuesser->guessCoverInfo(
+                trackFile, albumName, coverImg);
+    } else {
+        preparedImport.coverInfo = CoverInfoGuesser().guessCoverInfo(
+                trackFile, albumName, coverImg);
+    }
+    DEBUG_ASSERT(preparedImport.coverInfo.source == CoverInfo::GUESSED);
+    return preparedImport;
+}
+
+bool SoundSourceProxy::updateTrackFromPreparedImport(
+        const PreparedTrackImport& preparedImport) {
+    DEBUG_ASSERT(m_pTrack);
+    if (!preparedImport.isValid() || !m_pSoundSource) {
+        return false;
+    }
+    if (m_pTrack->getId().isValid() ||
+            m_pTrack->isMetadataSynchronized() ||
+            m_pTrack->getLocation() != preparedImport.trackFile.location()) {
+        // Only new tracks are initialized from the prepared import
+        return false;
+    }
+    if (kLogger.debugEnabled()) {
+        kLogger.debug()
+                << "Initializing track metadata and embedded cover art from prepared import"
+                << getUrl().toString();
+    }
+    m_pTrack->setType(preparedImport.fileType);
+    initTrackMetadata(
+            preparedImport.trackMetadata,
+            preparedImport.metadataSynchronized);
+    m_pTrack->setCoverInfo(preparedImport.coverInfo);
+    return true;
+}
+
 mixxx::MetadataSource::ImportResult SoundSourceProxy::importTrackMetadata(mixxx::TrackMetadata* pTrackMetadata) const {
     if (m_pSoundSource) {
         return m_pSoundSource->importTrackMetadataAndCoverImage(pTrackMetadata, nullptr).first;
@@ -1,10 +1,36 @@
 #pragma once
 
+#include <QDateTime>
+#include <QMetaType>
+
+#include "library/coverart.h"
 #include "sources/soundsourceproviderregistry.h"
 #include "track/track_decl.h"
 #include "track/trackfile.h"
+#include "track/trackmetadata.h"
 #include "util/sandbox.h"
 
+class CoverInfoGuesser;
+
+/// The file type, metadata, and cover art of a file that have been
+/// imported in advance, i.e. before the corresponding track object
+/// is created.
+///
+/// See also: SoundSourceProxy::prepareTrackImport()
+struct PreparedTrackImport {
+    bool isValid() const {
+        return !fileType.isEmpty();
+    }
+
+    TrackFile trackFile;
+    QString fileType;
+    mixxx::TrackMetadata trackMetadata;
+    QDateTime metadataSynchronized;
+    CoverInfoRelative coverInfo;
+};
+
+Q_DECLARE_METATYPE(PreparedTrackImport);
+
 /// Creates sound sources for tracks. Only intended to be used
 /// in a narrow scope and not shareable between multiple threads!
 class SoundSourceProxy {
@@ -51,6 +77,22 @@ class SoundSourceProxy {
             TrackFile trackFile,
             SecurityTokenPointer pSecurityToken = SecurityTokenPointer());
 
+    /// Imports the file type, metadata, and cover art of a new track
+    /// without creating a track object. This is the expensive part of
+    /// updateTrackFromSource() that involves parsing the file and
+    /// searching for cover art. It could be done on any thread and
+    /// concurrently for different files.
+    ///
+    /// The cover info guesser is optional and could be reused for
+    /// multiple files in the same directory.
+    ///
+    /// The result is invalid if the file type is not supported or if
+    /// a track object for this file already exists. Only the track
+    /// file is set in this case.
+    static PreparedTrackImport prepareTrackImport(
+            const TrackFile& trackFile,
+            CoverInfoGuesser* pCoverInfoGuesser = nullptr);
+
     explicit SoundSourceProxy(
             TrackPointer pTrack,
             const mixxx::SoundSourceProviderPointer& pProvider = nullptr);
@@ -116,6 +158,17 @@ class SoundSourceProxy {
     void updateTrackFromSource(
             ImportTrackMetadataMode importTrackMetadataMode = ImportTrackMetadataMode::Default);
 
+    /// Updates a new track object that has not been added to the library
+    /// yet from the results of prepareTrackImport() instead of parsing
+    /// the file again. The result is the same as invoking
+    /// updateTrackFromSource() with the default mode.
+    ///
+    /// Returns false if the prepared import is invalid or does not match
+    /// the track. The caller should fall back to updateTrackFromSource()
+    /// in this case.
+    bool updateTrackFromPreparedImport(
+            const PreparedTrackImport& preparedImport);
+
     /// Parse only the metadata from the file without modifying
     /// the referenced track.
     mixxx::MetadataSource::ImportResult importTrackMetadata(
@@ -157,6 +210,12 @@ class SoundSourceProxy {
     // the referenced track.
     QImage importCoverImage() const;
 
+    // Import the metadata into the track object and try to finish
+    // the import of beats and cues that depend on the audio properties.
+    void initTrackMetadata(
+            const mixxx::TrackMetadata& trackMetadata,
+            const QDateTime& metadataSynchronized);
+
     const TrackPointer m_pTrack;
 
     const QUrl m_url;
@@ -0,0 +1,167 @@
+#include <gtest/gtest.h>
+
+#include <QtDebug>
+#include <algorithm>
+#include <chrono>
+#include <thread>
+
+#include "analyzer/analyzerfanout.h"
+#include "track/track.h"
+
+namespace {
+
+constexpr SINT kBlockSize = 16;
+constexpr int kBlockCount = 100;
+
+// Records the order of the processed blocks by their first sample
+class RecordingAnalyzer : public Analyzer {
+  public:
+    RecordingAnalyzer(std::vector<CSAMPLE>* pFirstSamples, int delayMicros, int failAfter = -1)
+            : m_pFirstSamples(pFirstSamples),
+              m_delayMicros(delayMicros),
+              m_failAfter(failAfter) {
+    }
+
+    bool initialize(TrackPointer, int, int) override {
+        return true;
+    }
+
+    bool processSamples(const CSAMPLE* pIn, const int iLen) override {
+        EXPECT_EQ(kBlockSize, iLen);
+        for (int i = 1; i < iLen; ++i) {
+            EXPECT_EQ(pIn[0], pIn[i]);
+        }
+        m_pFirstSamples->push_back(pIn[0]);
+        if (m_delayMicros > 0) {
+            std::this_thread::sleep_for(std::chrono::microseconds(m_delayMicros));
+        }
+        return m_failAfter < 0 ||
+                static_cast<int>(m_pFirstSamples->size()) < m_failAfter;
+    }
+
+    void storeResults(TrackPointer) override {
+    }
+
+    void cleanup() override {
+    }
+
+  private:
+    std::vector<CSAMPLE>* const m_pFirstSamples;
+    const int m_delayMicros;
+    const int m_failAfter;
+};
+
+class AnalyzerFanOutTest : public testing::Test {
+  protected:
+    void addAnalyzer(int delayMicros, int failAfter = -1) {
+        m_firstSamples.emplace_back();
+        m_analyzers.emplace_back(std::make_unique<RecordingAnalyzer>(
+                &m_firstSamples.back(), delayMicros, failAfter));
+    }
+
+    void initializeAnalyzers() {
+        for (auto& analyzer : m_analyzers) {
+            EXPECT_TRUE(analyzer.initialize(TrackPointer(), 44100, kBlockSize * kBlockCount));
+        }
+    }
+
+    void finishAnalyzers() {
+        for (auto& analyzer : m_analyzers) {
+            analyzer.finish(TrackPointer());
+        }
+    }
+
+    // Blocks are filled with their index
+    void submitBlocks(AnalyzerFanOut* pFanOut, bool copy) {
+        std::vector<CSAMPLE> samples(kBlockSize);
+        for (int i = 0; i < kBlockCount; ++i) {
+            auto block = pFanOut->nextBlock();
+            ASSERT_LE(kBlockSize, block.length());
+            CSAMPLE* pSamples = copy ? samples.data() : block.data();
+            std::fill(pSamples, pSamples + kBlockSize, static_cast<CSAMPLE>(i));
+            pFanOut->submitBlock(pSamples, kBlockSize);
+        }
+    }
+
+    // Blocks are filled with their index at an offset within the buffer,
+    // so that they overlap with the start of the buffer
+    void submitBlocksAtOffset(AnalyzerFanOut* pFanOut, SINT offset) {
+        for (int i = 0; i < kBlockCount; ++i) {
+            auto block = pFanOut->nextBlock();
+            ASSERT_LE(offset + kBlockSize, block.length());
+            std::fill(block.data(), block.data() + offset, -1.0f);
+            CSAMPLE* pSamples = block.data() + offset;
+            std::fill(pSamples, pSamples + kBlockSize, static_cast<CSAMPLE>(i));
+            pFanOut->submitBlock(pSamples, kBlockSize);
+        }
+    }
+
+    // Reserved by each test to keep the addresses stable
+    std::vector<std::vector<CSAMPLE>> m_firstSamples;
+    std::vector<AnalyzerWithState> m_analyzers;
+};
+
+TEST_F(AnalyzerFanOutTest, AllBlocksInOrder) {
+    m_firstSamples.reserve(3);
+    addAnalyzer(0);
+    addAnalyzer(50);
+    addAnalyzer(200);
+    initializeAnalyzers();
+
+    AnalyzerFanOut fanOut(kBlockSize, 4);
+    fanOut.start(&m_analyzers);
+    submitBlocks(&fanOut, false);
+    submitBlocks(&fanOut, true);
+    fanOut.waitUntilProcessed();
+    finishAnalyzers();
+    fanOut.stop();
+
+    for (const auto& firstSamples : m_firstSamples) {
+        ASSERT_EQ(2u * kBlockCount, firstSamples.size());
+        for (int i = 0; i < 2 * kBlockCount; ++i) {
+            EXPECT_EQ(static_cast<CSAMPLE>(i % kBlockCount), firstSamples[i]);
+        }
+    }
+}
+
+TEST_F(AnalyzerFanOutTest, SamplesWithinBlock) {
+    m_firstSamples.reserve(2);
+    addAnalyzer(0);
+    addAnalyzer(50);
+    initializeAnalyzers();
+
+    AnalyzerFanOut fanOut(2 * kBlockSize, 4);
+    fanOut.start(&m_analyzers);
+    submitBlocksAtOffset(&fanOut, kBlockSize / 2);
+    fanOut.waitUntilProcessed();
+    finishAnalyzers();
+    fanOut.stop();
+
+    for (const auto& firstSamples : m_firstSamples) {
+        ASSERT_EQ(static_cast<size_t>(kBlockCount), firstSamples.size());
+        for (int i = 0; i < kBlockCount; ++i) {
+            EXPECT_EQ(static_cast<CSAMPLE>(i), firstSamples[i]);
+        }
+    }
+}
+
+TEST_F(AnalyzerFanOutTest, FailingAnalyzerBecomesInactive) {
+    m_firstSamples.reserve(2);
+    addAnalyzer(0);
+    addAnalyzer(0, 10);
+    initializeAnalyzers();
+
+    AnalyzerFanOut fanOut(kBlockSize, 2);
+    fanOut.start(&m_analyzers);
+    submitBlocks(&fanOut, false);
+    fanOut.waitUntilProcessed();
+    EXPECT_TRUE(m_analyzers[0].isActive());
+    EXPECT_FALSE(m_analyzers[1].isActive());
+    finishAnalyzers();
+    fanOut.stop();
+
+    EXPECT_EQ(static_cast<size_t>(kBlockCount), m_firstSamples[0].size());
+    EXPECT_EQ(10u, m_firstSamples[1].size());
+}
+
+} // namespace
@@ -33,13 +33,13 @@ class MockEffectProcessor : public EffectProcessor {
   public:
     MockEffectProcessor() {}
 
-    MOCK_METHOD3(initialize, void(const QSet<ChannelHandleAndGroup>& activeInputChannels,
+    MOCK_METHOD4(initialize, void(const QSet<ChannelHandleAndGroup>& activeInputChannels,
                                   EffectsManager* pEffectsManager,
-                                  const mixxx::EngineParameters& bufferParameters));
-    MOCK_METHOD1(createState, EffectState*(const mixxx::EngineParameters& bufferParameters));
-    MOCK_METHOD2(loadStatesForInputChannel, bool(const ChannelHandle* inputChannel,
-          const EffectStatesMap* pStatesMap));
-    MOCK_METHOD1(deleteStatesForInputChannel, void(const ChannelHandle* inputChannel));
+                                  const mixxx::EngineParameters& bufferParameters,
+                                  int pooledInputChannels));
+    MOCK_METHOD0(reserveStatesForInputChannel, void());
+    MOCK_METHOD1(loadStatesForInputChannel, bool(const ChannelHandle* inputChannel));
+    MOCK_METHOD1(releaseStatesForInputChannel, void(const ChannelHandle* inputChannel));
     MOCK_METHOD7(process, void(const ChannelHandle& inputHandle,
                                const ChannelHandle& outputHandle,
                                const CSAMPLE* pInput,
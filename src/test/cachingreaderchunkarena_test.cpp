@@ -0,0 +1,114 @@
+#include "engine/cachingreader/cachingreaderchunkarena.h"
+
+#include <gtest/gtest.h>
+
+#include <QList>
+#include <QSet>
+
+namespace {
+
+// The arena only compares the owner pointers, the readers are never accessed
+const CachingReader* const kOwnerA = reinterpret_cast<const CachingReader*>(0x1);
+const CachingReader* const kOwnerB = reinterpret_cast<const CachingReader*>(0x2);
+
+class CachingReaderChunkArenaTest : public testing::Test {
+};
+
+TEST_F(CachingReaderChunkArenaTest, AcquireAllAndRelease) {
+    // Spans more than a single bitmap word
+    const int kChunkCount = 70;
+    CachingReaderChunkArena arena(kChunkCount);
+    EXPECT_EQ(kChunkCount, arena.chunkCount());
+
+    QSet<CachingReaderChunkForOwner*> chunks;
+    for (int i = 0; i < kChunkCount; ++i) {
+        auto* pChunk = arena.acquire(kOwnerA);
+        ASSERT_NE(nullptr, pChunk);
+        chunks.insert(pChunk);
+    }
+    EXPECT_EQ(kChunkCount, chunks.size());
+    EXPECT_EQ(kChunkCount, arena.acquiredChunkCount());
+    EXPECT_EQ(nullptr, arena.acquire(kOwnerA));
+
+    auto* pChunk = *chunks.begin();
+    arena.release(pChunk);
+    EXPECT_EQ(kChunkCount - 1, arena.acquiredChunkCount());
+    EXPECT_EQ(pChunk, arena.acquire(kOwnerB));
+
+    for (auto* pChunk : chunks) {
+        arena.release(pChunk);
+    }
+    EXPECT_EQ(0, arena.acquiredChunkCount());
+}
+
+TEST_F(CachingReaderChunkArenaTest, ReleaseAllOfOwner) {
+    CachingReaderChunkArena arena(8);
+    for (int i = 0; i < 3; ++i) {
+        ASSERT_NE(nullptr, arena.acquire(kOwnerA));
+    }
+    auto* pChunkB = arena.acquire(kOwnerB);
+    ASSERT_NE(nullptr, pChunkB);
+    EXPECT_EQ(4, arena.acquiredChunkCount());
+
+    arena.releaseAll(kOwnerA);
+    EXPECT_EQ(1, arena.acquiredChunkCount());
+
+    arena.release(pChunkB);
+    EXPECT_EQ(0, arena.acquiredChunkCount());
+    EXPECT_EQ(8, arena.unreservedChunkCount());
+}
+
+TEST_F(CachingReaderChunkArenaTest, ReservedChunksAreNotShared) {
+    CachingReaderChunkArena arena(8);
+    EXPECT_EQ(5, arena.reserve(5));
+    EXPECT_EQ(3, arena.unreservedChunkCount());
+
+    // Another owner is only able to acquire the unreserved chunks
+    QList<CachingReaderChunkForOwner*> sharedChunks;
+    for (int i = 0; i < 3; ++i) {
+        auto* pChunk = arena.acquire(kOwnerB);
+        ASSERT_NE(nullptr, pChunk);
+        sharedChunks.append(pChunk);
+    }
+    EXPECT_EQ(nullptr, arena.acquire(kOwnerB));
+    // Nothing is left for further reservations
+    EXPECT_EQ(0, arena.reserve(1));
+
+    // The reserved chunks are still available to their owner
+    QList<CachingReaderChunkForOwner*> reservedChunks;
+    for (int i = 0; i < 5; ++i) {
+        auto* pChunk = arena.acquireReserved(kOwnerA);
+        ASSERT_NE(nullptr, pChunk);
+        reservedChunks.append(pChunk);
+    }
+    EXPECT_EQ(8, arena.acquiredChunkCount());
+
+    // A reserved chunk that is released stays reserved
+    arena.releaseReserved(reservedChunks.takeLast());
+    EXPECT_EQ(0, arena.unreservedChunkCount());
+    EXPECT_EQ(nullptr, arena.acquire(kOwnerB));
+
+    // A shared chunk that is released is available to all owners
+    arena.release(sharedChunks.takeLast());
+    EXPECT_EQ(1, arena.unreservedChunkCount());
+
+    // Releasing all chunks of the owner also returns its reservation
+    arena.releaseAll(kOwnerA, 5);
+    EXPECT_EQ(6, arena.unreservedChunkCount());
+    arena.releaseAll(kOwnerB);
+    EXPECT_EQ(8, arena.unreservedChunkCount());
+    EXPECT_EQ(0, arena.acquiredChunkCount());
+}
+
+TEST_F(CachingReaderChunkArenaTest, PartialReservation) {
+    CachingReaderChunkArena arena(4);
+    EXPECT_EQ(3, arena.reserve(3));
+    EXPECT_EQ(1, arena.reserve(3));
+    EXPECT_EQ(0, arena.unreservedChunkCount());
+    arena.unreserve(2);
+    EXPECT_EQ(2, arena.unreservedChunkCount());
+    EXPECT_NE(nullptr, arena.acquire(kOwnerA));
+    EXPECT_EQ(1, arena.unreservedChunkCount());
+}
+
+} // namespace
@@ -0,0 +1,119 @@
+#include "engine/cachingreader/cachingreaderpcmcache.h"
+
+#include <gtest/gtest.h>
+
+#include <QDir>
+
+#include "engine/cachingreader/cachingreaderchunk.h"
+#include "sources/soundsourceproxy.h"
+#include "test/mixxxtest.h"
+#include "track/track.h"
+#include "util/math.h"
+#include "util/samplebuffer.h"
+
+namespace {
+
+const QDir kTestDir(QDir::current().absoluteFilePath("src/test/id3-test-data"));
+
+class CachingReaderPcmCacheTest : public MixxxTest {
+  protected:
+    void SetUp() override {
+        m_trackLocation = kTestDir.absoluteFilePath("cover-test.wav");
+        m_pAudioSource = openAudioSource();
+        ASSERT_TRUE(m_pAudioSource);
+        m_cacheDirPath = getTestDataDir().filePath("pcmcache");
+        mixxx::SampleBuffer(
+                m_pAudioSource->getSignalInfo().frames2samples(
+                        CachingReaderChunk::kFrames))
+                .swap(m_tempReadBuffer);
+    }
+
+    mixxx::AudioSourcePointer openAudioSource() const {
+        mixxx::AudioSource::OpenParams openParams;
+        openParams.setChannelCount(CachingReaderChunk::kChannels);
+        return SoundSourceProxy(Track::newTemporary(m_trackLocation))
+                .openAudioSource(openParams);
+    }
+
+    void decodeAll(CachingReaderPcmCache* pCache) {
+        while (!pCache->isComplete()) {
+            ASSERT_FALSE(pCache->decodeNextFrames(
+                                       m_pAudioSource,
+                                       mixxx::SampleBuffer::WritableSlice(m_tempReadBuffer))
+                                 .empty());
+        }
+    }
+
+    QString m_trackLocation;
+    QString m_cacheDirPath;
+    mixxx::AudioSourcePointer m_pAudioSource;
+    mixxx::SampleBuffer m_tempReadBuffer;
+};
+
+TEST_F(CachingReaderPcmCacheTest, DecodeAndReopen) {
+    {
+        auto pCache = CachingReaderPcmCache::open(
+                m_cacheDirPath, m_trackLocation, m_pAudioSource);
+        ASSERT_TRUE(pCache);
+        EXPECT_EQ(m_pAudioSource->frameIndexRange(), pCache->frameIndexRange());
+        EXPECT_TRUE(pCache->decodedFrameIndexRange().empty());
+        EXPECT_FALSE(pCache->isComplete());
+        decodeAll(pCache.get());
+    }
+
+    // Reopening must not require decoding again
+    auto pCache = CachingReaderPcmCache::open(
+            m_cacheDirPath, m_trackLocation, m_pAudioSource);
+    ASSERT_TRUE(pCache);
+    EXPECT_TRUE(pCache->isComplete());
+
+    // Compare the cached samples with samples decoded from a fresh source
+    const auto pAudioSource = openAudioSource();
+    ASSERT_TRUE(pAudioSource);
+    const auto frameIndexRange = mixxx::IndexRange::forward(
+            pCache->frameIndexRange().start(),
+            math_min(pCache->frameIndexRange().length(), CachingReaderChunk::kFrames));
+    mixxx::SampleBuffer expectedSamples(
+            CachingReaderChunk::frames2samples(frameIndexRange.length()));
+    const auto readableSampleFrames = pAudioSource->readSampleFrames(
+            mixxx::WritableSampleFrames(
+                    frameIndexRange,
+                    mixxx::SampleBuffer::WritableSlice(expectedSamples)));
+    ASSERT_EQ(frameIndexRange, readableSampleFrames.frameIndexRange());
+    const auto cachedSamples = pCache->readableSlice(frameIndexRange);
+    ASSERT_EQ(expectedSamples.size(), cachedSamples.length());
+    for (SINT i = 0; i < cachedSamples.length(); ++i) {
+        EXPECT_EQ(readableSampleFrames.readableData()[i], cachedSamples[i]);
+    }
+}
+
+TEST_F(CachingReaderPcmCacheTest, RenameWhenComplete) {
+    auto pCache = CachingReaderPcmCache::open(
+            m_cacheDirPath, m_trackLocation, m_pAudioSource);
+    ASSERT_TRUE(pCache);
+    const QDir cacheDir(m_cacheDirPath);
+    const QStringList completeFiles{QStringLiteral("*.pcm")};
+    const QStringList partFiles{QStringLiteral("*.pcm.part")};
+    EXPECT_TRUE(cacheDir.entryList(completeFiles, QDir::Files).isEmpty());
+    EXPECT_EQ(1, cacheDir.entryList(partFiles, QDir::Files).size());
+
+    decodeAll(pCache.get());
+    EXPECT_EQ(1, cacheDir.entryList(completeFiles, QDir::Files).size());
+    EXPECT_TRUE(cacheDir.entryList(partFiles, QDir::Files).isEmpty());
+}
+
+TEST_F(CachingReaderPcmCacheTest, SingleOwner) {
+    auto pCache = CachingReaderPcmCache::open(
+            m_cacheDirPath, m_trackLocation, m_pAudioSource);
+    ASSERT_TRUE(pCache);
+
+    // Another reader of the same track must not write the same file
+    EXPECT_FALSE(CachingReaderPcmCache::open(
+            m_cacheDirPath, m_trackLocation, m_pAudioSource));
+
+    pCache.reset();
+    EXPECT_TRUE(CachingReaderPcmCache::open(
+            m_cacheDirPath, m_trackLocation, m_pAudioSource));
+}
+
+} // namespace
@@ -0,0 +1,215 @@
+#include <benchmark/benchmark.h>
+#include <gtest/gtest.h>
+
+#include <QVector>
+#include <QtDebug>
+
+#include "engine/channelmixkernel.h"
+#include "util/sample.h"
+
+namespace {
+
+const ChannelMixKernel::Isa kAllIsas[] = {
+        ChannelMixKernel::Isa::Generic,
+        ChannelMixKernel::Isa::Sse2,
+        ChannelMixKernel::Isa::Avx2,
+        ChannelMixKernel::Isa::Neon,
+};
+
+class ChannelMixKernelTest : public testing::Test {
+  protected:
+    void SetUp() override {
+        // Covers unity, zero, constant, and ramping gains
+        const CSAMPLE_GAIN kGains[][2] = {
+                {1.0f, 1.0f},
+                {0.0f, 0.0f},
+                {0.5f, 0.5f},
+                {0.0f, 1.0f},
+                {0.8f, 0.3f},
+                {1.0f, 0.0f},
+                {0.25f, 0.75f},
+        };
+        for (int k = 0; k < kChannelCount; ++k) {
+            QVector<CSAMPLE> buffer(kMaxSamples);
+            for (int i = 0; i < kMaxSamples; ++i) {
+                // Some deterministic values with a non-trivial binary representation
+                buffer[i] = static_cast<CSAMPLE>((i * 37 + k * 101) % 199) / 99.0f - 1.0f;
+            }
+            m_buffers.append(buffer);
+            const auto& gains = kGains[k % (sizeof(kGains) / sizeof(kGains[0]))];
+            m_oldGains.append(gains[0]);
+            m_newGains.append(gains[1]);
+        }
+    }
+
+    QVector<ChannelMixKernel::Input> inputs(int channelCount) const {
+        QVector<ChannelMixKernel::Input> inputs;
+        for (int k = 0; k < channelCount; ++k) {
+            ChannelMixKernel::Input input;
+            input.pBuffer = m_buffers[k].constData();
+            input.pWriteBack = nullptr;
+            input.oldGain = m_oldGains[k];
+            input.newGain = m_newGains[k];
+            inputs.append(input);
+        }
+        return inputs;
+    }
+
+    static constexpr int kChannelCount = 40;
+    static constexpr int kMaxSamples = 1030;
+
+    QVector<QVector<CSAMPLE>> m_buffers;
+    QVector<CSAMPLE_GAIN> m_oldGains;
+    QVector<CSAMPLE_GAIN> m_newGains;
+};
+
+TEST_F(ChannelMixKernelTest, MatchesAddWithRampingGain) {
+    for (int numSamples : {2, 6, 14, 64, 512, 1030}) {
+        for (int channelCount : {0, 1, 2, 3, 4, 8, 33, kChannelCount}) {
+            QVector<CSAMPLE> expected(numSamples, 0.125f);
+            for (int k = 0; k < channelCount; ++k) {
+                SampleUtil::addWithRampingGain(expected.data(),
+                        m_buffers[k].constData(),
+                        m_oldGains[k],
+                        m_newGains[k],
+                        numSamples);
+            }
+            const auto mixInputs = inputs(channelCount);
+            for (const auto isa : kAllIsas) {
+                if (!ChannelMixKernel::isSupported(isa)) {
+                    continue;
+                }
+                QVector<CSAMPLE> actual(numSamples, 0.125f);
+                ChannelMixKernel::mixWithRampingGain(isa,
+                        actual.data(),
+                        ChannelMixKernel::OutputMode::Add,
+                        mixInputs.constData(),
+                        channelCount,
+                        numSamples);
+                for (int i = 0; i < numSamples; ++i) {
+                    ASSERT_EQ(expected[i], actual[i])
+                            << CpuFeatures::isaName(isa)
+                            << ": " << channelCount << " channels, "
+                            << numSamples << " samples, index " << i;
+                }
+            }
+        }
+    }
+}
+
+TEST_F(ChannelMixKernelTest, ReplaceAndWriteBack) {
+    const int numSamples = 510;
+    const int channelCount = 7;
+    for (const auto isa : kAllIsas) {
+        if (!ChannelMixKernel::isSupported(isa)) {
+            continue;
+        }
+        // The gain is applied in place to copies of the channel buffers
+        QVector<QVector<CSAMPLE>> buffers;
+        for (int k = 0; k < channelCount; ++k) {
+            buffers.append(m_buffers[k].mid(0, numSamples));
+        }
+        QVector<ChannelMixKernel::Input> mixInputs = inputs(channelCount);
+        for (int k = 0; k < channelCount; ++k) {
+            mixInputs[k].pBuffer = buffers[k].constData();
+            mixInputs[k].pWriteBack = buffers[k].data();
+        }
+        QVector<CSAMPLE> actual(numSamples, 1000.0f);
+        ChannelMixKernel::mixWithRampingGain(isa,
+                actual.data(),
+                ChannelMixKernel::OutputMode::Replace,
+                mixInputs.constData(),
+                channelCount,
+                numSamples);
+
+        QVector<CSAMPLE> expected(numSamples, 0.0f);
+        for (int k = 0; k < channelCount; ++k) {
+            QVector<CSAMPLE> expectedBuffer = m_buffers[k].mid(0, numSamples);
+            SampleUtil::applyRampingGain(expectedBuffer.data(),
+                    m_oldGains[k],
+                    m_newGains[k],
+                    numSamples);
+            EXPECT_EQ(expectedBuffer, buffers[k]) << CpuFeatures::isaName(isa);
+            SampleUtil::add(expected.data(), expectedBuffer.constData(), numSamples);
+        }
+        EXPECT_EQ(expected, actual) << CpuFeatures::isaName(isa);
+    }
+}
+
+// Mixes state.range(1) channels sequentially like before with
+// SampleUtil::addWithRampingGain() as a reference.
+static void BM_SampleUtilAddWithRampingGain(benchmark::State& state) {
+    const SINT numSamples = static_cast<SINT>(state.range(0));
+    const int channelCount = static_cast<int>(state.range(1));
+    QVector<CSAMPLE*> buffers;
+    for (int k = 0; k < channelCount; ++k) {
+        CSAMPLE* buffer = SampleUtil::alloc(numSamples);
+        SampleUtil::fill(buffer, 0.1f, numSamples);
+        buffers.append(buffer);
+    }
+    CSAMPLE* pOutput = SampleUtil::alloc(numSamples);
+
+    while (state.KeepRunning()) {
+        SampleUtil::clear(pOutput, numSamples);
+        for (int k = 0; k < channelCount; ++k) {
+            SampleUtil::addWithRampingGain(pOutput, buffers[k], 0.5f, 0.75f, numSamples);
+        }
+        benchmark::DoNotOptimize(pOutput);
+    }
+
+    SampleUtil::free(pOutput);
+    for (CSAMPLE* buffer : buffers) {
+        SampleUtil::free(buffer);
+    }
+}
+BENCHMARK(BM_SampleUtilAddWithRampingGain)
+        ->ArgPair(512, 2)
+        ->ArgPair(512, 4)
+        ->ArgPair(512, 8)
+        ->ArgPair(512, 16)
+        ->ArgPair(2048, 4);
+
+static void BM_ChannelMixKernel(benchmark::State& state) {
+    const auto isa = static_cast<ChannelMixKernel::Isa>(state.range(0));
+    const SINT numSamples = static_cast<SINT>(state.range(1));
+    const int channelCount = static_cast<int>(state.range(2));
+    if (!ChannelMixKernel::isSupported(isa)) {
+        state.SkipWithError("Not supported by this CPU");
+        return;
+    }
+    state.SetLabel(CpuFeatures::isaName(isa));
+    QVector<ChannelMixKernel::Input> inputs;
+    for (int k = 0; k < channelCount; ++k) {
+        CSAMPLE* buffer = SampleUtil::alloc(numSamples);
+        SampleUtil::fill(buffer, 0.1f, numSamples);
+        inputs.append(ChannelMixKernel::Input{buffer, nullptr, 0.5f, 0.75f});
+    }
+    CSAMPLE* pOutput = SampleUtil::alloc(numSamples);
+
+    while (state.KeepRunning()) {
+        ChannelMixKernel::mixWithRampingGain(isa,
+                pOutput,
+                ChannelMixKernel::OutputMode::Replace,
+                inputs.constData(),
+                channelCount,
+                numSamples);
+        benchmark::DoNotOptimize(pOutput);
+    }
+
+    SampleUtil::free(pOutput);
+    for (const auto& input : inputs) {
+        SampleUtil::free(const_cast<CSAMPLE*>(input.pBuffer));
+    }
+}
+
+static void ChannelMixKernelArguments(benchmark::internal::Benchmark* b) {
+    for (const auto isa : kAllIsas) {
+        for (int channelCount : {2, 4, 8, 16}) {
+            b->Args({static_cast<int>(isa), 512, channelCount});
+        }
+        b->Args({static_cast<int>(isa), 2048, 4});
+    }
+}
+BENCHMARK(BM_ChannelMixKernel)->Apply(ChannelMixKernelArguments);
+
+} // namespace
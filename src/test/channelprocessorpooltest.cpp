@@ -0,0 +1,152 @@
+#include <gtest/gtest.h>
+
+#include <QtDebug>
+#include <atomic>
+#include <memory>
+#include <vector>
+
+#include "engine/channelhandle.h"
+#include "engine/channelprocessorpool.h"
+#include "engine/channels/enginechannel.h"
+#include "test/mixxxtest.h"
+#include "util/defs.h"
+#include "util/sample.h"
+
+namespace {
+
+// Counts how often it has been processed and fills its buffer with
+// the number of the current batch.
+class CountingEngineChannel : public EngineChannel {
+  public:
+    CountingEngineChannel(const ChannelHandleAndGroup& handleGroup)
+            : EngineChannel(handleGroup,
+                      EngineChannel::CENTER,
+                      nullptr,
+                      /*isTalkoverChannel*/ false,
+                      /*isPrimaryDeck*/ true),
+              m_processCount(0),
+              m_collectFeaturesCount(0) {
+    }
+
+    bool isActive() override {
+        return true;
+    }
+
+    bool supportsParallelProcessing() override {
+        return true;
+    }
+
+    void process(CSAMPLE* pInOut, const int iBufferSize) override {
+        const int processCount = m_processCount.fetch_add(1) + 1;
+        SampleUtil::fill(pInOut, static_cast<CSAMPLE>(processCount), iBufferSize);
+    }
+
+    void collectFeatures(GroupFeatureState* pGroupFeatures) const override {
+        Q_UNUSED(pGroupFeatures);
+        m_collectFeaturesCount.fetch_add(1);
+    }
+
+    void postProcess(const int iBufferSize) override {
+        Q_UNUSED(iBufferSize);
+    }
+
+    int processCount() const {
+        return m_processCount.load();
+    }
+
+    int collectFeaturesCount() const {
+        return m_collectFeaturesCount.load();
+    }
+
+  private:
+    std::atomic<int> m_processCount;
+    mutable std::atomic<int> m_collectFeaturesCount;
+};
+
+class ChannelProcessorPoolTest : public MixxxTest {
+  protected:
+    void addChannels(int channelCount) {
+        for (int i = 0; i < channelCount; ++i) {
+            const QString group = QString("[Channel%1]").arg(i + 1);
+            auto pChannel = std::make_unique<CountingEngineChannel>(
+                    ChannelHandleAndGroup(
+                            m_channelHandleFactory.getOrCreateHandle(group),
+                            group));
+            auto pChannelInfo = std::make_unique<EngineMaster::ChannelInfo>(i);
+            pChannelInfo->m_pChannel = pChannel.get();
+            pChannelInfo->m_pBuffer = SampleUtil::alloc(MAX_BUFFER_LEN);
+            m_channelInfos.push_back(pChannelInfo.get());
+            m_ownedChannelInfos.push_back(std::move(pChannelInfo));
+            m_channels.push_back(std::move(pChannel));
+        }
+    }
+
+    void TearDown() override {
+        for (const auto& pChannelInfo : m_ownedChannelInfos) {
+            SampleUtil::free(pChannelInfo->m_pBuffer);
+        }
+    }
+
+    void processBatches(ChannelProcessorPool* pPool, int batchCount, bool collectFeatures) {
+        for (int batch = 1; batch <= batchCount; ++batch) {
+            pPool->startBatch(
+                    m_channelInfos.data(),
+                    static_cast<int>(m_channelInfos.size()),
+                    kBufferSize,
+                    collectFeatures);
+            pPool->finishBatch();
+            // All channels must have been processed exactly once
+            // when returning from finishBatch()
+            for (const auto* pChannelInfo : m_channelInfos) {
+                ASSERT_EQ(static_cast<CSAMPLE>(batch), pChannelInfo->m_pBuffer[0]);
+                ASSERT_EQ(static_cast<CSAMPLE>(batch),
+                        pChannelInfo->m_pBuffer[kBufferSize - 1]);
+            }
+        }
+    }
+
+    static constexpr int kBufferSize = 512;
+
+    ChannelHandleFactory m_channelHandleFactory;
+    std::vector<std::unique_ptr<CountingEngineChannel>> m_channels;
+    std::vector<std::unique_ptr<EngineMaster::ChannelInfo>> m_ownedChannelInfos;
+    std::vector<EngineMaster::ChannelInfo*> m_channelInfos;
+};
+
+TEST_F(ChannelProcessorPoolTest, ProcessesEachChannelOncePerBatch) {
+    addChannels(8);
+    ChannelProcessorPool pool(3, -1);
+    pool.start();
+
+    const int kBatchCount = 1000;
+    processBatches(&pool, kBatchCount, true);
+
+    for (const auto& pChannel : m_channels) {
+        EXPECT_EQ(kBatchCount, pChannel->processCount());
+        EXPECT_EQ(kBatchCount, pChannel->collectFeaturesCount());
+    }
+}
+
+TEST_F(ChannelProcessorPoolTest, ProcessesOnCallingThreadWithoutPoolThreads) {
+    addChannels(4);
+    ChannelProcessorPool pool(0, -1);
+    pool.start();
+
+    const int kBatchCount = 10;
+    processBatches(&pool, kBatchCount, false);
+
+    for (const auto& pChannel : m_channels) {
+        EXPECT_EQ(kBatchCount, pChannel->processCount());
+        EXPECT_EQ(0, pChannel->collectFeaturesCount());
+    }
+}
+
+TEST_F(ChannelProcessorPoolTest, EmptyBatch) {
+    ChannelProcessorPool pool(2, -1);
+    pool.start();
+
+    pool.startBatch(nullptr, 0, kBufferSize, false);
+    pool.finishBatch();
+}
+
+} // namespace
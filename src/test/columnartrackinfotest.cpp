@@ -0,0 +1,152 @@
+#include <benchmark/benchmark.h>
+#include <gtest/gtest.h>
+
+#include <QDateTime>
+#include <QtDebug>
+#include <algorithm>
+
+#include "library/columnartrackinfo.h"
+
+namespace {
+
+class ColumnarTrackInfoTest : public testing::Test {
+  protected:
+    ColumnarTrackInfoTest()
+            : m_trackInfo(3) {
+    }
+
+    int insert(int id) {
+        return m_trackInfo.insert(TrackId(QVariant(id)));
+    }
+
+    ColumnarTrackInfo m_trackInfo;
+};
+
+TEST_F(ColumnarTrackInfoTest, SetGetValues) {
+    const int row1 = insert(1);
+    const int row2 = insert(2);
+    EXPECT_EQ(row1, insert(1));
+    EXPECT_EQ(2, m_trackInfo.size());
+
+    m_trackInfo.setValue(row1, 0, QVariant(true));
+    m_trackInfo.setValue(row2, 0, QVariant(false));
+    m_trackInfo.setValue(row1, 1, QVariant(128.5));
+    m_trackInfo.setValue(row1, 2, QVariant(QString("Artist")));
+
+    EXPECT_EQ(QVariant(true), m_trackInfo.value(row1, 0));
+    EXPECT_EQ(QVariant(false), m_trackInfo.value(row2, 0));
+    EXPECT_EQ(QVariant(128.5), m_trackInfo.value(row1, 1));
+    EXPECT_TRUE(m_trackInfo.value(row2, 1).isNull());
+    EXPECT_EQ(QVariant(QString("Artist")), m_trackInfo.value(row1, 2));
+    EXPECT_TRUE(m_trackInfo.value(row2, 2).isNull());
+    EXPECT_FALSE(m_trackInfo.value(row1, 3).isValid());
+
+    // New rows are null
+    const int row3 = insert(3);
+    EXPECT_TRUE(m_trackInfo.value(row3, 0).isNull());
+    EXPECT_TRUE(m_trackInfo.value(row3, 1).isNull());
+    EXPECT_TRUE(m_trackInfo.value(row3, 2).isNull());
+}
+
+TEST_F(ColumnarTrackInfoTest, MixedTypes) {
+    const int row1 = insert(1);
+    const int row2 = insert(2);
+    m_trackInfo.setValue(row1, 0, QVariant(1));
+    EXPECT_TRUE(m_trackInfo.isSortable(0));
+    m_trackInfo.setValue(row2, 0, QVariant(QString("two")));
+    EXPECT_FALSE(m_trackInfo.isSortable(0));
+    EXPECT_EQ(QVariant(1), m_trackInfo.value(row1, 0));
+    EXPECT_EQ(QVariant(QString("two")), m_trackInfo.value(row2, 0));
+}
+
+TEST_F(ColumnarTrackInfoTest, DateTimeAsText) {
+    // Dates are stored as text like in the database, regardless of
+    // whether they are loaded from the database or set by a track
+    const QDateTime dateTime(QDate(2021, 3, 4), QTime(5, 6, 7, 89), Qt::UTC);
+    const int row1 = insert(1);
+    const int row2 = insert(2);
+    m_trackInfo.setValue(row1, 0, QVariant(dateTime.toString(Qt::ISODateWithMs)));
+    m_trackInfo.setValue(row2, 0, QVariant(dateTime.addSecs(1)));
+    m_trackInfo.setValue(row1, 1, QVariant(dateTime));
+    EXPECT_TRUE(m_trackInfo.isSortable(0));
+    EXPECT_EQ(QVariant(dateTime.toString(Qt::ISODateWithMs)),
+            m_trackInfo.value(row1, 0));
+    EXPECT_EQ(QVariant(dateTime.addSecs(1).toString(Qt::ISODateWithMs)),
+            m_trackInfo.value(row2, 0));
+    EXPECT_EQ(QVariant(dateTime.toString(Qt::ISODateWithMs)),
+            m_trackInfo.value(row1, 1));
+}
+
+TEST_F(ColumnarTrackInfoTest, Remove) {
+    for (int id = 1; id <= 3; ++id) {
+        m_trackInfo.setValue(insert(id), 0, QVariant(10 * id));
+    }
+    m_trackInfo.remove(TrackId(QVariant(1)));
+    EXPECT_EQ(2, m_trackInfo.size());
+    EXPECT_FALSE(m_trackInfo.contains(TrackId(QVariant(1))));
+    for (int id = 2; id <= 3; ++id) {
+        const int row = m_trackInfo.row(TrackId(QVariant(id)));
+        ASSERT_LE(0, row);
+        EXPECT_EQ(TrackId(QVariant(id)), m_trackInfo.trackId(row));
+        EXPECT_EQ(QVariant(10 * id), m_trackInfo.value(row, 0));
+    }
+}
+
+TEST_F(ColumnarTrackInfoTest, Compare) {
+    const int row1 = insert(1);
+    const int row2 = insert(2);
+    const int row3 = insert(3);
+    m_trackInfo.setValue(row1, 0, QVariant(QString("beta")));
+    m_trackInfo.setValue(row2, 0, QVariant(QString("Alpha")));
+    m_trackInfo.setValue(row1, 1, QVariant(2.0));
+    m_trackInfo.setValue(row2, 1, QVariant(1.0));
+    for (int column = 0; column < m_trackInfo.columnCount(); ++column) {
+        m_trackInfo.updateSortRanks(column);
+    }
+
+    // Case-insensitive
+    EXPECT_LT(0, m_trackInfo.compare(0, row1, row2));
+    EXPECT_GT(0, m_trackInfo.compare(0, row2, row1));
+    EXPECT_EQ(0, m_trackInfo.compare(0, row1, row1));
+    EXPECT_LT(0, m_trackInfo.compare(1, row1, row2));
+    // Null values are ordered first
+    EXPECT_GT(0, m_trackInfo.compare(0, row3, row2));
+    EXPECT_GT(0, m_trackInfo.compare(1, row3, row2));
+    EXPECT_EQ(0, m_trackInfo.compare(2, row1, row2));
+
+    // The sort key takes precedence
+    m_trackInfo.setStringSortKeyFunction(0, [](const QString& value) {
+        return value.size();
+    });
+    m_trackInfo.updateSortRanks(0);
+    EXPECT_GT(0, m_trackInfo.compare(0, row1, row2));
+    // New strings are ranked
+    m_trackInfo.setValue(row3, 0, QVariant(QString("gamma ray")));
+    m_trackInfo.updateSortRanks(0);
+    EXPECT_LT(0, m_trackInfo.compare(0, row3, row2));
+}
+
+static void BM_ColumnarTrackInfoSort(benchmark::State& state) {
+    const int trackCount = static_cast<int>(state.range(0));
+    ColumnarTrackInfo trackInfo(1);
+    for (int i = 0; i < trackCount; ++i) {
+        const int row = trackInfo.insert(TrackId(QVariant(i + 1)));
+        // Many tracks share the same artist
+        trackInfo.setValue(row, 0, QString("Artist %1").arg((i * 7919) % (trackCount / 4 + 1)));
+    }
+    trackInfo.updateSortRanks(0);
+
+    QVector<int> rows(trackCount);
+    while (state.KeepRunning()) {
+        for (int i = 0; i < trackCount; ++i) {
+            rows[i] = i;
+        }
+        std::stable_sort(rows.begin(), rows.end(), [&trackInfo](int row1, int row2) {
+            return trackInfo.compare(0, row1, row2) < 0;
+        });
+    }
+    state.SetItemsProcessed(state.iterations() * trackCount);
+}
+BENCHMARK(BM_ColumnarTrackInfoSort)->Arg(1000)->Arg(120000);
+
+} // namespace
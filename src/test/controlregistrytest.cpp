@@ -0,0 +1,232 @@
+#include <benchmark/benchmark.h>
+#include <gtest/gtest.h>
+
+#include <QThread>
+#include <QtDebug>
+#include <atomic>
+#include <memory>
+#include <vector>
+
+#include "control/controlobject.h"
+#include "control/controlregistry.h"
+#include "test/mixxxtest.h"
+#include "util/mutex.h"
+
+namespace {
+
+ConfigKey keyAt(int index) {
+    return ConfigKey(QString("[Channel%1]").arg(index / 100),
+            QString("control%1").arg(index % 100));
+}
+
+class ControlRegistryTest : public MixxxTest {
+  protected:
+    void createControls(int count) {
+        for (int i = 0; i < count; ++i) {
+            m_controls.push_back(std::make_unique<ControlObject>(keyAt(i)));
+        }
+    }
+
+    QSharedPointer<ControlDoublePrivate> controlAt(int index) const {
+        return ControlDoublePrivate::getControl(keyAt(index));
+    }
+
+    std::vector<std::unique_ptr<ControlObject>> m_controls;
+};
+
+class LookupThread : public QThread {
+  public:
+    LookupThread(const ControlRegistry* pRegistry, int keyCount)
+            : m_pRegistry(pRegistry),
+              m_keyCount(keyCount),
+              m_stop(false),
+              m_missingCount(0) {
+    }
+
+    void stop() {
+        m_stop.store(true);
+    }
+
+    int missingCount() const {
+        return m_missingCount;
+    }
+
+    void run() override {
+        while (!m_stop.load(std::memory_order_relaxed)) {
+            for (int i = 0; i < m_keyCount; ++i) {
+                auto pControl = m_pRegistry->lookup(keyAt(i));
+                if (!pControl || pControl->getKey() != keyAt(i)) {
+                    ++m_missingCount;
+                }
+            }
+        }
+    }
+
+  private:
+    const ControlRegistry* const m_pRegistry;
+    const int m_keyCount;
+    std::atomic<bool> m_stop;
+    int m_missingCount;
+};
+
+TEST_F(ControlRegistryTest, InsertLookup) {
+    createControls(2);
+    ControlRegistry registry;
+    EXPECT_TRUE(registry.lookup(keyAt(0)).isNull());
+
+    registry.insert(keyAt(0), controlAt(0));
+    EXPECT_EQ(controlAt(0), registry.lookup(keyAt(0)));
+    EXPECT_TRUE(registry.lookup(keyAt(1)).isNull());
+
+    // Alias
+    registry.insert(keyAt(1), controlAt(0));
+    EXPECT_EQ(controlAt(0), registry.lookup(keyAt(1)));
+    EXPECT_EQ(2, registry.instances().size());
+
+    // Replace
+    registry.insert(keyAt(1), controlAt(1));
+    EXPECT_EQ(controlAt(1), registry.lookup(keyAt(1)));
+    EXPECT_EQ(2, registry.instances().size());
+}
+
+TEST_F(ControlRegistryTest, DeletedControlIsMissing) {
+    createControls(1);
+    ControlRegistry registry;
+    registry.insert(keyAt(0), controlAt(0));
+    m_controls.clear();
+    EXPECT_TRUE(registry.lookup(keyAt(0)).isNull());
+    EXPECT_TRUE(registry.instances().isEmpty());
+}
+
+TEST_F(ControlRegistryTest, Grow) {
+    const int count = 40000;
+    createControls(count);
+    ControlRegistry registry;
+    for (int i = 0; i < count; ++i) {
+        registry.insert(keyAt(i), controlAt(i));
+    }
+    for (int i = 0; i < count; ++i) {
+        EXPECT_EQ(controlAt(i), registry.lookup(keyAt(i)));
+    }
+    EXPECT_EQ(count, registry.instances().size());
+
+    EXPECT_EQ(count, registry.takeInstances().size());
+    EXPECT_TRUE(registry.lookup(keyAt(0)).isNull());
+}
+
+TEST_F(ControlRegistryTest, LookupWhileInserting) {
+    const int initialCount = 100;
+    const int count = 20000;
+    createControls(count);
+    ControlRegistry registry;
+    for (int i = 0; i < initialCount; ++i) {
+        registry.insert(keyAt(i), controlAt(i));
+    }
+
+    std::vector<std::unique_ptr<LookupThread>> threads;
+    for (int i = 0; i < 2; ++i) {
+        threads.push_back(std::make_unique<LookupThread>(&registry, initialCount));
+        threads.back()->start();
+    }
+    // Let the table grow while the keys are looked up
+    for (int i = initialCount; i < count; ++i) {
+        registry.insert(keyAt(i), controlAt(i));
+    }
+    for (const auto& pThread : threads) {
+        pThread->stop();
+        pThread->wait();
+        EXPECT_EQ(0, pThread->missingCount());
+    }
+}
+
+TEST_F(ControlRegistryTest, RecreateControl) {
+    auto pControl = std::make_unique<ControlObject>(keyAt(0));
+    pControl->set(1.0);
+    pControl.reset();
+    EXPECT_EQ(nullptr, ControlObject::getControl(keyAt(0), ControlFlag::NoAssertIfMissing));
+
+    pControl = std::make_unique<ControlObject>(keyAt(0));
+    EXPECT_EQ(pControl.get(), ControlObject::getControl(keyAt(0)));
+    EXPECT_DOUBLE_EQ(0.0, ControlObject::get(keyAt(0)));
+}
+
+TEST_F(ControlRegistryTest, LookupStats) {
+    createControls(3);
+    ControlDoublePrivate::ScopedLookupStats outerStats;
+    controlAt(0);
+    {
+        ControlDoublePrivate::ScopedLookupStats innerStats;
+        controlAt(1);
+        controlAt(2);
+        EXPECT_EQ(2, innerStats.count());
+    }
+    EXPECT_EQ(1, outerStats.count());
+}
+
+// The previous implementation with a mutex-guarded QHash
+class LockedHash {
+  public:
+    QSharedPointer<ControlDoublePrivate> lookup(const ConfigKey& key) const {
+        const MMutexLocker locker(&m_mutex);
+        return m_hash.value(key).lock();
+    }
+
+    void insert(const ConfigKey& key,
+            const QWeakPointer<ControlDoublePrivate>& pControl) {
+        const MMutexLocker locker(&m_mutex);
+        m_hash.insert(key, pControl);
+    }
+
+  private:
+    mutable MMutex m_mutex;
+    QHash<ConfigKey, QWeakPointer<ControlDoublePrivate>> m_hash;
+};
+
+// Looks up range(0) different keys on all benchmark threads, i.e.
+// similar to the skin parser and controller scripts.
+template<typename Registry>
+static void BM_ControlRegistryLookup(benchmark::State& state) {
+    static std::vector<std::unique_ptr<ControlObject>>* s_pControls = nullptr;
+    static Registry* s_pRegistry = nullptr;
+    const int keyCount = static_cast<int>(state.range(0));
+    if (state.thread_index == 0) {
+        s_pControls = new std::vector<std::unique_ptr<ControlObject>>();
+        s_pRegistry = new Registry();
+        for (int i = 0; i < keyCount; ++i) {
+            s_pControls->push_back(std::make_unique<ControlObject>(keyAt(i)));
+            s_pRegistry->insert(keyAt(i), ControlDoublePrivate::getControl(keyAt(i)));
+        }
+    }
+    std::vector<ConfigKey> keys;
+    for (int i = 0; i < keyCount; ++i) {
+        keys.push_back(keyAt(i));
+    }
+
+    int i = 0;
+    while (state.KeepRunning()) {
+        benchmark::DoNotOptimize(s_pRegistry->lookup(keys[i]));
+        if (++i == keyCount) {
+            i = 0;
+        }
+    }
+    state.SetItemsProcessed(state.iterations());
+
+    if (state.thread_index == 0) {
+        delete s_pRegistry;
+        s_pRegistry = nullptr;
+        delete s_pControls;
+        s_pControls = nullptr;
+        ControlDoublePrivate::takeAllInstances();
+    }
+}
+
+BENCHMARK_TEMPLATE(BM_ControlRegistryLookup, LockedHash)
+        ->Arg(4000)
+        ->ThreadRange(1, 8)
+        ->UseRealTime();
+BENCHMARK_TEMPLATE(BM_ControlRegistryLookup, ControlRegistry)
+        ->Arg(4000)
+        ->ThreadRange(1, 8)
+        ->UseRealTime();
+
+} // namespace
@@ -0,0 +1,185 @@
+#include <benchmark/benchmark.h>
+#include <gtest/gtest.h>
+
+#include <QThread>
+#include <QtDebug>
+#include <atomic>
+#include <memory>
+#include <vector>
+
+#include "control/controlvalue.h"
+
+namespace {
+
+// Wider than a pointer. The members of a consistent value are
+// multiples of each other.
+struct WideValue {
+    double a;
+    double b;
+    double c;
+
+    static WideValue create(double value) {
+        return WideValue{value, 2 * value, 3 * value};
+    }
+
+    bool isConsistent() const {
+        return b == 2 * a && c == 3 * a;
+    }
+};
+
+template<typename ControlValue>
+class WriterThread : public QThread {
+  public:
+    explicit WriterThread(ControlValue* pValue)
+            : m_pValue(pValue),
+              m_stop(false),
+              m_writeCount(0) {
+    }
+
+    void stop() {
+        m_stop.store(true);
+    }
+
+    int writeCount() const {
+        return m_writeCount.load();
+    }
+
+    void run() override {
+        int count = 0;
+        while (!m_stop.load(std::memory_order_relaxed)) {
+            m_pValue->setValue(WideValue::create(++count));
+            m_writeCount.store(count, std::memory_order_relaxed);
+        }
+    }
+
+  private:
+    ControlValue* const m_pValue;
+    std::atomic<bool> m_stop;
+    std::atomic<int> m_writeCount;
+};
+
+class ReaderThread : public QThread {
+  public:
+    ReaderThread(const ControlValueAtomic<WideValue>* pValue, int readCount)
+            : m_pValue(pValue),
+              m_readCount(readCount),
+              m_inconsistentCount(0) {
+    }
+
+    int inconsistentCount() const {
+        return m_inconsistentCount;
+    }
+
+    void run() override {
+        for (int i = 0; i < m_readCount; ++i) {
+            if (!m_pValue->getValue().isConsistent()) {
+                ++m_inconsistentCount;
+            }
+        }
+    }
+
+  private:
+    const ControlValueAtomic<WideValue>* const m_pValue;
+    const int m_readCount;
+    int m_inconsistentCount;
+};
+
+TEST(ControlValueTest, SetGet) {
+    ControlValueAtomic<WideValue> value;
+    EXPECT_EQ(0.0, value.getValue().a);
+    // More often than the size of the ring
+    for (int i = 1; i <= 3 * kDefaultRingSize; ++i) {
+        value.setValue(WideValue::create(i));
+        const WideValue result = value.getValue();
+        EXPECT_EQ(static_cast<double>(i), result.a);
+        EXPECT_TRUE(result.isConsistent());
+    }
+}
+
+TEST(ControlValueTest, SetGetAtomic) {
+    ControlValueAtomic<double> value;
+    value.setValue(1.5);
+    EXPECT_EQ(1.5, value.getValue());
+}
+
+TEST(ControlValueTest, ConsistentWithConcurrentWriters) {
+    ControlValueAtomic<WideValue> value;
+    std::vector<std::unique_ptr<WriterThread<ControlValueAtomic<WideValue>>>> writers;
+    for (int i = 0; i < 2; ++i) {
+        writers.push_back(
+                std::make_unique<WriterThread<ControlValueAtomic<WideValue>>>(
+                        &value));
+    }
+    std::vector<std::unique_ptr<ReaderThread>> readers;
+    for (int i = 0; i < 3; ++i) {
+        readers.push_back(std::make_unique<ReaderThread>(&value, 200000));
+    }
+
+    for (const auto& pWriter : writers) {
+        pWriter->start();
+    }
+    for (const auto& pReader : readers) {
+        pReader->start();
+    }
+    for (const auto& pReader : readers) {
+        pReader->wait();
+        EXPECT_EQ(0, pReader->inconsistentCount());
+    }
+    for (const auto& pWriter : writers) {
+        pWriter->stop();
+        pWriter->wait();
+    }
+    EXPECT_TRUE(value.getValue().isConsistent());
+}
+
+// Reads the value on all benchmark threads while another thread keeps
+// writing it if range(0) is not 0.
+template<typename ControlValue>
+static void BM_ControlValueGetValue(benchmark::State& state) {
+    static ControlValue* s_pValue = nullptr;
+    static WriterThread<ControlValue>* s_pWriter = nullptr;
+    if (state.thread_index == 0) {
+        s_pValue = new ControlValue();
+        s_pValue->setValue(WideValue::create(1));
+        if (state.range(0) != 0) {
+            s_pWriter = new WriterThread<ControlValue>(s_pValue);
+            s_pWriter->start();
+        }
+    }
+
+    while (state.KeepRunning()) {
+        benchmark::DoNotOptimize(s_pValue->getValue());
+    }
+
+    if (state.thread_index == 0) {
+        if (s_pWriter) {
+            s_pWriter->stop();
+            s_pWriter->wait();
+            state.counters["writes"] = s_pWriter->writeCount();
+            delete s_pWriter;
+            s_pWriter = nullptr;
+        }
+        delete s_pValue;
+        s_pValue = nullptr;
+    }
+}
+
+// The implementation that has been used before
+class RingControlValue : public ControlValueRingAtomic<WideValue, kDefaultRingSize> {
+};
+
+class SeqLockControlValue : public ControlValueAtomic<WideValue> {
+};
+
+BENCHMARK_TEMPLATE(BM_ControlValueGetValue, RingControlValue)
+        ->Arg(0)
+        ->Arg(1)
+        ->ThreadRange(1, 8)
+        ->UseRealTime();
+BENCHMARK_TEMPLATE(BM_ControlValueGetValue, SeqLockControlValue)
+        ->Arg(0)
+        ->Arg(1)
+        ->ThreadRange(1, 8)
+        ->UseRealTime();
+
+} // namespace
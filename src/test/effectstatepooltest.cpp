@@ -0,0 +1,122 @@
+#include <gtest/gtest.h>
+
+#include "effects/effectprocessor.h"
+#include "effects/effectstatepool.h"
+#include "test/baseeffecttest.h"
+
+namespace {
+
+int s_liveStates = 0;
+
+class CountedEffectState : public EffectState {
+  public:
+    CountedEffectState()
+            : EffectState(mixxx::EngineParameters(
+                      mixxx::audio::SampleRate(44100), 1024)) {
+        ++s_liveStates;
+    }
+    ~CountedEffectState() override {
+        --s_liveStates;
+    }
+};
+
+class EffectStatePoolTest : public testing::Test {
+  protected:
+    void SetUp() override {
+        s_liveStates = 0;
+        m_createdStates = 0;
+    }
+
+    EffectStatePool::CreateStateFunction createState() {
+        return [this]() -> EffectState* {
+            ++m_createdStates;
+            return new CountedEffectState();
+        };
+    }
+
+    int m_createdStates;
+};
+
+TEST_F(EffectStatePoolTest, ReuseReleasedStates) {
+    EffectStatePool pool(8, createState());
+    pool.fill(2);
+    EXPECT_EQ(2, m_createdStates);
+    EXPECT_EQ(2, pool.size());
+
+    // The filled states are reserved without allocating
+    pool.reserve(2);
+    EXPECT_EQ(2, m_createdStates);
+    EffectState* pState1 = pool.acquire();
+    EffectState* pState2 = pool.acquire();
+    EXPECT_NE(nullptr, pState1);
+    EXPECT_NE(nullptr, pState2);
+    EXPECT_EQ(0, pool.size());
+
+    // Released states are replaced by new states, which can be reserved
+    // again without allocating
+    pool.release(pState1);
+    pool.release(pState2);
+    EXPECT_EQ(4, m_createdStates);
+    EXPECT_EQ(2, s_liveStates);
+    pool.reserve(2);
+    EXPECT_EQ(4, m_createdStates);
+    pState1 = pool.acquire();
+    pState2 = pool.acquire();
+    EXPECT_NE(nullptr, pState1);
+    EXPECT_NE(nullptr, pState2);
+    EXPECT_EQ(nullptr, pool.acquire());
+    EXPECT_EQ(2, s_liveStates);
+
+    // The acquired states are owned by the caller
+    delete pState1;
+    delete pState2;
+}
+
+TEST_F(EffectStatePoolTest, AllocateWhenReservedStatesAreMissing) {
+    EffectStatePool pool(8, createState());
+    pool.fill(2);
+    // Reserving twice before the engine acquires the states must not
+    // promise the same states twice
+    pool.reserve(2);
+    pool.reserve(2);
+    EXPECT_EQ(4, m_createdStates);
+    EXPECT_EQ(4, pool.size());
+}
+
+TEST_F(EffectStatePoolTest, DeleteStatesThatDoNotFit) {
+    {
+        EffectStatePool pool(2, createState());
+        pool.fill(2);
+        pool.release(new CountedEffectState());
+        EXPECT_EQ(2, pool.size());
+        EXPECT_EQ(2, s_liveStates);
+    }
+    // The pooled states are deleted with the pool
+    EXPECT_EQ(0, s_liveStates);
+}
+
+class EffectStatePoolBackendTest : public BaseEffectTest {
+};
+
+TEST_F(EffectStatePoolBackendTest, PoolSizeFromManifest) {
+    registerTestBackend();
+
+    EffectManifestPointer pEffectManifest(new EffectManifest());
+    pEffectManifest->setId("org.mixxx.test.effect");
+    registerTestEffect(pEffectManifest, false);
+    EXPECT_EQ(1, pEffectManifest->pooledInputChannels());
+
+    EffectManifestPointer pEqManifest(new EffectManifest());
+    pEqManifest->setId("org.mixxx.test.eq");
+    pEqManifest->setIsMixingEQ(true);
+    registerTestEffect(pEqManifest, false);
+    EXPECT_EQ(0, pEqManifest->pooledInputChannels());
+
+    EffectManifestPointer pCustomManifest(new EffectManifest());
+    pCustomManifest->setId("org.mixxx.test.custom");
+    pCustomManifest->setPooledInputChannels(4);
+    registerTestEffect(pCustomManifest, false);
+    EXPECT_EQ(4, pCustomManifest->pooledInputChannels());
+}
+
+} // namespace
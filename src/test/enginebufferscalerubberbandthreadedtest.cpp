@@ -0,0 +1,169 @@
+#include <gtest/gtest.h>
+
+#include <QThread>
+#include <QtDebug>
+
+#include "engine/bufferscalers/enginebufferscalerubberbandthreaded.h"
+#include "engine/readaheadmanager.h"
+#include "test/mixxxtest.h"
+#include "util/math.h"
+#include "util/sample.h"
+#include "util/types.h"
+
+namespace {
+
+constexpr SINT kOutputBufferSize = 1024;
+constexpr SINT kSampleRate = 44100;
+constexpr double kToneFrequency = 440;
+constexpr CSAMPLE kToneAmplitude = 0.5f;
+
+// Returns a sine tone and counts the samples that have been read
+class ReadAheadManagerFake : public ReadAheadManager {
+  public:
+    ReadAheadManagerFake()
+            : ReadAheadManager(),
+              m_samplesRead(0) {
+    }
+
+    SINT getNextSamples(double dRate, CSAMPLE* buffer, SINT requested_samples) override {
+        Q_UNUSED(dRate);
+        const double omega = 2.0 * M_PI * kToneFrequency / kSampleRate;
+        for (SINT i = 0; i < requested_samples; i += 2) {
+            const SINT frame = (m_samplesRead + i) / 2;
+            buffer[i] = kToneAmplitude * static_cast<CSAMPLE>(sin(omega * frame));
+            buffer[i + 1] = buffer[i];
+        }
+        m_samplesRead += requested_samples;
+        return requested_samples;
+    }
+
+    SINT m_samplesRead;
+};
+
+class EngineBufferScaleRubberBandThreadedTest : public MixxxTest {
+  protected:
+    void SetUp() override {
+        m_pScaler = std::make_unique<EngineBufferScaleRubberBandThreaded>(
+                &m_readAheadManager);
+        m_pScaler->setSampleRate(mixxx::audio::SampleRate(kSampleRate));
+        m_pScaler->startWorker();
+    }
+
+    void setScaleParameters(double tempo, double pitch) {
+        double tempoRatio = tempo;
+        double pitchRatio = pitch;
+        m_pScaler->setScaleParameters(1.0, &tempoRatio, &pitchRatio);
+    }
+
+    // Runs the scaler like the audio callback and returns the frequency of
+    // the output after RubberBand has settled, which is estimated from the
+    // rising zero crossings of the left channel
+    double measureOutputFrequency() {
+        constexpr int kSettleBuffers = 50;
+        constexpr int kMeasuredBuffers = 40;
+        mixxx::SampleBuffer output(kOutputBufferSize);
+        for (int i = 0; i < kSettleBuffers; ++i) {
+            m_pScaler->scaleBuffer(output.data(), kOutputBufferSize);
+            // Give the worker time to catch up like between two callbacks
+            QThread::msleep(5);
+        }
+
+        int risingZeroCrossings = 0;
+        double sumOfSquares = 0;
+        CSAMPLE previousSample = output[kOutputBufferSize - 2];
+        for (int i = 0; i < kMeasuredBuffers; ++i) {
+            m_pScaler->scaleBuffer(output.data(), kOutputBufferSize);
+            QThread::msleep(5);
+            for (SINT j = 0; j < kOutputBufferSize; j += 2) {
+                const CSAMPLE sample = output[j];
+                if (previousSample < 0 && sample >= 0) {
+                    ++risingZeroCrossings;
+                }
+                previousSample = sample;
+                sumOfSquares += sample * sample;
+            }
+        }
+        const double frames = kMeasuredBuffers * kOutputBufferSize / 2.0;
+        // The tone is neither lost nor distorted into silence
+        EXPECT_NEAR(kToneAmplitude / sqrt(2.0), sqrt(sumOfSquares / frames), 0.1);
+        return risingZeroCrossings * kSampleRate / frames;
+    }
+
+    ReadAheadManagerFake m_readAheadManager;
+    std::unique_ptr<EngineBufferScaleRubberBandThreaded> m_pScaler;
+};
+
+TEST_F(EngineBufferScaleRubberBandThreadedTest, FramesReadFollowOutput) {
+    setScaleParameters(1.5, 1.0);
+    mixxx::SampleBuffer output(kOutputBufferSize);
+    double framesRead = 0;
+    for (int i = 0; i < 16; ++i) {
+        // The output is complete, whether or not the worker has caught up
+        framesRead += m_pScaler->scaleBuffer(output.data(), kOutputBufferSize);
+        EXPECT_DOUBLE_EQ(1.5 * (i + 1) * kOutputBufferSize / 2, framesRead);
+        for (SINT j = 0; j < kOutputBufferSize; ++j) {
+            EXPECT_LE(fabs(output.data()[j]), 1.0f);
+        }
+    }
+    // The input is read ahead of the output
+    EXPECT_LE(framesRead, m_readAheadManager.m_samplesRead / 2);
+}
+
+TEST_F(EngineBufferScaleRubberBandThreadedTest, StoppedDoesNotRead) {
+    setScaleParameters(0.0, 1.0);
+    mixxx::SampleBuffer output(kOutputBufferSize);
+    EXPECT_EQ(0.0, m_pScaler->scaleBuffer(output.data(), kOutputBufferSize));
+    EXPECT_EQ(0, m_readAheadManager.m_samplesRead);
+    for (SINT j = 0; j < kOutputBufferSize; ++j) {
+        EXPECT_EQ(0.0f, output.data()[j]);
+    }
+}
+
+TEST_F(EngineBufferScaleRubberBandThreadedTest, TempoChangeKeepsPitch) {
+    // Without keylock, e.g. if the output was interpolated from the input
+    // instead of being stretched by the worker, the tone would be at 660 Hz
+    setScaleParameters(1.5, 1.0);
+    EXPECT_NEAR(kToneFrequency, measureOutputFrequency(), 0.03 * kToneFrequency);
+}
+
+TEST_F(EngineBufferScaleRubberBandThreadedTest, PitchChangeKeepsTempo) {
+    setScaleParameters(1.0, 1.5);
+    mixxx::SampleBuffer output(kOutputBufferSize);
+    EXPECT_DOUBLE_EQ(kOutputBufferSize / 2,
+            m_pScaler->scaleBuffer(output.data(), kOutputBufferSize));
+    EXPECT_NEAR(1.5 * kToneFrequency, measureOutputFrequency(), 0.03 * 1.5 * kToneFrequency);
+}
+
+TEST_F(EngineBufferScaleRubberBandThreadedTest, RestartStoppedWorker) {
+    setScaleParameters(1.5, 1.0);
+    mixxx::SampleBuffer output(kOutputBufferSize);
+    m_pScaler->scaleBuffer(output.data(), kOutputBufferSize);
+
+    // The output is interpolated while keylock is idle and the worker has
+    // been stopped, until the main thread has restarted it
+    m_pScaler->stopWorker();
+    EXPECT_FALSE(m_pScaler->isWorkerRunning());
+    EXPECT_DOUBLE_EQ(1.5 * kOutputBufferSize / 2,
+            m_pScaler->scaleBuffer(output.data(), kOutputBufferSize));
+    EXPECT_FALSE(m_pScaler->isWorkerRunning());
+    // The main thread starts the requested worker
+    application()->processEvents();
+    EXPECT_TRUE(m_pScaler->isWorkerRunning());
+
+    // The restarted worker continues to stretch the input
+    EXPECT_NEAR(kToneFrequency, measureOutputFrequency(), 0.03 * kToneFrequency);
+}
+
+TEST_F(EngineBufferScaleRubberBandThreadedTest, StartWorkerOnRequest) {
+    EngineBufferScaleRubberBandThreaded scaler(&m_readAheadManager);
+    // Decks that never use keylock do not start a thread
+    EXPECT_FALSE(scaler.isWorkerRunning());
+    scaler.requestWorker();
+    EXPECT_FALSE(scaler.isWorkerRunning());
+    application()->processEvents();
+    EXPECT_TRUE(scaler.isWorkerRunning());
+    scaler.stopWorker();
+    EXPECT_FALSE(scaler.isWorkerRunning());
+}
+
+} // namespace
@@ -0,0 +1,228 @@
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+#include <QScopedPointer>
+#include <functional>
+#include <memory>
+
+#include "engine/effects/engineeffect.h"
+#include "engine/effects/engineeffectchain.h"
+#include "engine/engine.h"
+#include "test/baseeffecttest.h"
+#include "util/sample.h"
+#include "util/samplebuffer.h"
+
+using ::testing::_;
+using ::testing::Invoke;
+using ::testing::NiceMock;
+using ::testing::Return;
+
+namespace {
+
+constexpr unsigned int kSampleRate = 44100;
+constexpr unsigned int kFramesPerBuffer = 1024;
+constexpr unsigned int kSamplesPerBuffer = kFramesPerBuffer * mixxx::kEngineChannelCount;
+constexpr double kSecondsPerBuffer = static_cast<double>(kFramesPerBuffer) / kSampleRate;
+constexpr CSAMPLE kSignal = 0.5f;
+
+class EngineEffectChainTest : public BaseEffectTest {
+  protected:
+    EngineEffectChainTest()
+            : m_channel(m_pChannelHandleFactory->getOrCreateHandle("[Channel1]"),
+                      "[Channel1]"),
+              m_master(m_pChannelHandleFactory->getOrCreateHandle("[Master]"),
+                      "[Master]"),
+              m_inputHandle(m_channel.handle()),
+              m_input(kSamplesPerBuffer),
+              m_output(kSamplesPerBuffer) {
+        m_pEffectsManager->registerInputChannel(m_channel);
+        m_pEffectsManager->registerOutputChannel(m_master);
+
+        auto pipes = TwoWayMessagePipe<EffectsRequest*, EffectsResponse>::makeTwoWayMessagePipe(
+                16, 16);
+        m_pRequestPipe.reset(pipes.first);
+        m_pResponsePipe.reset(pipes.second);
+    }
+
+    // Creates an enabled chain with a single effect, which writes the output
+    // of generateOutput() for each buffer
+    void createChain(EffectManifestPointer pManifest,
+            std::function<void(const CSAMPLE* pInput, CSAMPLE* pOutput)> generateOutput) {
+        auto* pProcessor = new NiceMock<MockEffectProcessor>();
+        ON_CALL(*pProcessor, process(_, _, _, _, _, _, _))
+                .WillByDefault(Invoke([generateOutput](const ChannelHandle&,
+                                              const ChannelHandle&,
+                                              const CSAMPLE* pInput,
+                                              CSAMPLE* pOutput,
+                                              const mixxx::EngineParameters&,
+                                              const EffectEnableState,
+                                              const GroupFeatureState&) {
+                    generateOutput(pInput, pOutput);
+                }));
+        auto* pInstantiator = new MockEffectInstantiator();
+        EXPECT_CALL(*pInstantiator, instantiate(_, _))
+                .WillOnce(Return(pProcessor));
+
+        QSet<ChannelHandleAndGroup> activeInputChannels;
+        activeInputChannels.insert(m_channel);
+        m_pEffect = std::make_unique<EngineEffect>(pManifest,
+                activeInputChannels,
+                m_pEffectsManager.data(),
+                EffectInstantiatorPointer(pInstantiator));
+        m_pChain = std::make_unique<EngineEffectChain>("org.mixxx.test.chain",
+                m_pEffectsManager->registeredInputChannels(),
+                m_pEffectsManager->registeredOutputChannels());
+
+        EffectsRequest request;
+        request.type = EffectsRequest::ADD_EFFECT_TO_CHAIN;
+        request.AddEffectToChain.pEffect = m_pEffect.get();
+        request.AddEffectToChain.iIndex = 0;
+        ASSERT_TRUE(m_pChain->processEffectsRequest(request, m_pResponsePipe.data()));
+
+        request = EffectsRequest();
+        request.type = EffectsRequest::SET_EFFECT_PARAMETERS;
+        request.SetEffectParameters.enabled = true;
+        ASSERT_TRUE(m_pEffect->processEffectsRequest(request, m_pResponsePipe.data()));
+
+        setChainParameters(true, 1.0);
+
+        request = EffectsRequest();
+        request.type = EffectsRequest::ENABLE_EFFECT_CHAIN_FOR_INPUT_CHANNEL;
+        request.EnableInputChannelForChain.pChannelHandle = &m_inputHandle;
+        ASSERT_TRUE(m_pChain->processEffectsRequest(request, m_pResponsePipe.data()));
+    }
+
+    void setChainParameters(bool enabled, double mix) {
+        EffectsRequest request;
+        request.type = EffectsRequest::SET_EFFECT_CHAIN_PARAMETERS;
+        request.SetEffectChainParameters.enabled = enabled;
+        request.SetEffectChainParameters.mix_mode = EffectChainMixMode::DrySlashWet;
+        request.SetEffectChainParameters.mix = mix;
+        ASSERT_TRUE(m_pChain->processEffectsRequest(request, m_pResponsePipe.data()));
+    }
+
+    // Runs the chain for a buffer like the engine does and returns true if
+    // it has been bypassed. The output is left in m_output.
+    bool processBuffer(bool silentInput) {
+        m_input.fill(silentInput ? 0 : kSignal);
+        GroupFeatureState features;
+        features.is_silent = silentInput;
+        if (m_pChain->isBypassedForChannel(m_channel.handle(), m_master.handle(), features)) {
+            // The input is passed through unmodified
+            m_pChain->bypass(m_channel.handle(), m_master.handle());
+            SampleUtil::copy(m_output.data(), m_input.data(), kSamplesPerBuffer);
+            return true;
+        }
+        m_pChain->process(m_channel.handle(),
+                m_master.handle(),
+                m_input.data(),
+                m_output.data(),
+                kSamplesPerBuffer,
+                kSampleRate,
+                features);
+        return false;
+    }
+
+    ChannelHandleAndGroup m_channel;
+    ChannelHandleAndGroup m_master;
+    ChannelHandle m_inputHandle;
+    QScopedPointer<EffectsRequestPipe> m_pRequestPipe;
+    QScopedPointer<EffectsResponsePipe> m_pResponsePipe;
+    std::unique_ptr<EngineEffect> m_pEffect;
+    std::unique_ptr<EngineEffectChain> m_pChain;
+    mixxx::SampleBuffer m_input;
+    mixxx::SampleBuffer m_output;
+};
+
+EffectManifestPointer createManifest() {
+    EffectManifestPointer pManifest(new EffectManifest());
+    pManifest->setId("org.mixxx.test.effect");
+    pManifest->setName("Test Effect");
+    pManifest->setEffectRampsFromDry(true);
+    return pManifest;
+}
+
+TEST_F(EngineEffectChainTest, BypassAfterMaxOutputDelay) {
+    EffectManifestPointer pManifest = createManifest();
+    pManifest->setMaxOutputDelaySeconds(2.5 * kSecondsPerBuffer);
+    createChain(pManifest, [](const CSAMPLE* pInput, CSAMPLE* pOutput) {
+        SampleUtil::copy(pOutput, pInput, kSamplesPerBuffer);
+    });
+
+    EXPECT_FALSE(processBuffer(false));
+    EXPECT_FALSE(processBuffer(false));
+    EXPECT_FLOAT_EQ(kSignal, m_output[0]);
+
+    // The tail of the effect may last for up to its maximum delay
+    EXPECT_FALSE(processBuffer(true));
+    EXPECT_FALSE(processBuffer(true));
+    EXPECT_FALSE(processBuffer(true));
+    EXPECT_TRUE(processBuffer(true));
+    EXPECT_TRUE(processBuffer(true));
+
+    // The chain is processed again as soon as there is input
+    EXPECT_FALSE(processBuffer(false));
+    EXPECT_FLOAT_EQ(kSignal, m_output[0]);
+    EXPECT_FALSE(processBuffer(true));
+}
+
+TEST_F(EngineEffectChainTest, NoBypassForUnknownMaxOutputDelay) {
+    // Like the metronome, the effect generates a click from time to time,
+    // which needs to be played even if the input stays silent
+    int buffers = 0;
+    createChain(createManifest(), [&buffers](const CSAMPLE*, CSAMPLE* pOutput) {
+        SampleUtil::fill(pOutput, buffers++ % 8 == 0 ? kSignal : 0, kSamplesPerBuffer);
+    });
+
+    EXPECT_FALSE(processBuffer(false));
+    EXPECT_FALSE(processBuffer(false));
+    for (int i = 0; i < 32; ++i) {
+        EXPECT_FALSE(processBuffer(true));
+    }
+    EXPECT_EQ(34, buffers);
+}
+
+TEST_F(EngineEffectChainTest, BypassDisabledChain) {
+    int buffers = 0;
+    createChain(createManifest(), [&buffers](const CSAMPLE* pInput, CSAMPLE* pOutput) {
+        ++buffers;
+        SampleUtil::copy(pOutput, pInput, kSamplesPerBuffer);
+    });
+    EXPECT_FALSE(processBuffer(false));
+    EXPECT_FALSE(processBuffer(false));
+
+    // The effect gets a last disabling signal
+    setChainParameters(false, 1.0);
+    EXPECT_FALSE(processBuffer(false));
+    EXPECT_TRUE(processBuffer(false));
+    EXPECT_TRUE(processBuffer(true));
+    EXPECT_EQ(3, buffers);
+
+    setChainParameters(true, 1.0);
+    EXPECT_FALSE(processBuffer(false));
+    EXPECT_EQ(4, buffers);
+}
+
+TEST_F(EngineEffectChainTest, BypassFullyDryChain) {
+    int buffers = 0;
+    createChain(createManifest(), [&buffers](const CSAMPLE* pInput, CSAMPLE* pOutput) {
+        ++buffers;
+        SampleUtil::copy(pOutput, pInput, kSamplesPerBuffer);
+    });
+    EXPECT_FALSE(processBuffer(false));
+    EXPECT_FALSE(processBuffer(false));
+
+    // The mix knob ramps down to dry during one buffer and the effect gets
+    // a disabling signal in the next one
+    setChainParameters(true, 0.0);
+    EXPECT_FALSE(processBuffer(false));
+    EXPECT_FALSE(processBuffer(false));
+    EXPECT_TRUE(processBuffer(false));
+    EXPECT_EQ(4, buffers);
+
+    setChainParameters(true, 1.0);
+    EXPECT_FALSE(processBuffer(false));
+    EXPECT_EQ(5, buffers);
+}
+
+} // namespace
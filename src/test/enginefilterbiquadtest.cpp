@@ -1,10 +1,130 @@
+#include <benchmark/benchmark.h>
 #include <gtest/gtest.h>
 
+#include <algorithm>
+#include <cmath>
+#include <iterator>
+#include <vector>
+
+#include "engine/filters/enginefilterbessel4.h"
 #include "engine/filters/enginefilterbiquad1.h"
+#include "engine/filters/enginefilterlinkwitzriley8.h"
 
 namespace {
 
+constexpr int kSampleRate = 44100;
+constexpr int kBufferSize = 2048;
+
+// The outputs only differ if the compiler has reordered the operations
+// of one of the variants
+constexpr CSAMPLE kTolerance = 1e-5f;
+
+template<unsigned int SIZE, enum IIRPass PASS>
+constexpr unsigned int filterSize(const EngineFilterIIR<SIZE, PASS>*) {
+    return SIZE;
+}
+
+// Processes each channel with its own scalar state, like the filters did
+// before both channels have become lanes of a single vector.
+template<typename Filter>
+class ScalarReferenceFilter : public Filter {
+  public:
+    using Filter::Filter;
+
+    // Must be invoked after each setFrequencyCorners()
+    void initScalarBuffers() {
+        std::copy(std::begin(m_scalarBuf1), std::end(m_scalarBuf1), m_oldScalarBuf1);
+        std::copy(std::begin(m_scalarBuf2), std::end(m_scalarBuf2), m_oldScalarBuf2);
+        std::fill(std::begin(m_scalarBuf1), std::end(m_scalarBuf1), 0.0);
+        std::fill(std::begin(m_scalarBuf2), std::end(m_scalarBuf2), 0.0);
+    }
+
+    void processScalar(const CSAMPLE* pIn, CSAMPLE* pOutput, const int iBufferSize) {
+        if (!this->m_doRamping) {
+            for (int i = 0; i < iBufferSize; i += 2) {
+                pOutput[i] = static_cast<CSAMPLE>(this->processSample(
+                        this->m_coef, m_scalarBuf1, static_cast<double>(pIn[i])));
+                pOutput[i + 1] = static_cast<CSAMPLE>(this->processSample(
+                        this->m_coef, m_scalarBuf2, static_cast<double>(pIn[i + 1])));
+            }
+            return;
+        }
+        double cross_mix = 0.0;
+        double cross_inc = 4.0 / static_cast<double>(iBufferSize);
+        for (int i = 0; i < iBufferSize; i += 2) {
+            double old1 = 0;
+            double old2 = 0;
+            if (!this->m_doStart) {
+                old1 = this->processSample(
+                        this->m_oldCoef, m_oldScalarBuf1, static_cast<double>(pIn[i]));
+                old2 = this->processSample(
+                        this->m_oldCoef, m_oldScalarBuf2, static_cast<double>(pIn[i + 1]));
+            } else if (this->m_startFromDry) {
+                old1 = pIn[i];
+                old2 = pIn[i + 1];
+            }
+            double new1 = this->processSample(
+                    this->m_coef, m_scalarBuf1, static_cast<double>(pIn[i]));
+            double new2 = this->processSample(
+                    this->m_coef, m_scalarBuf2, static_cast<double>(pIn[i + 1]));
+            if (i < iBufferSize / 2) {
+                pOutput[i] = static_cast<CSAMPLE>(old1);
+                pOutput[i + 1] = static_cast<CSAMPLE>(old2);
+            } else {
+                pOutput[i] = static_cast<CSAMPLE>(new1 * cross_mix + old1 * (1.0 - cross_mix));
+                pOutput[i + 1] = static_cast<CSAMPLE>(new2 * cross_mix + old2 * (1.0 - cross_mix));
+                cross_mix += cross_inc;
+            }
+        }
+        this->m_doRamping = false;
+        this->m_doStart = false;
+    }
+
+  private:
+    static constexpr unsigned int kSize = filterSize(static_cast<Filter*>(nullptr));
+
+    double m_scalarBuf1[kSize] = {};
+    double m_scalarBuf2[kSize] = {};
+    double m_oldScalarBuf1[kSize] = {};
+    double m_oldScalarBuf2[kSize] = {};
+};
+
+// A different signal on each channel, so that swapped lanes are detected
+std::vector<CSAMPLE> makeInput() {
+    std::vector<CSAMPLE> input(kBufferSize);
+    for (int i = 0; i < kBufferSize; i += 2) {
+        input[i] = static_cast<CSAMPLE>(0.8 * std::sin(i * 0.01) + 0.1 * std::sin(i * 0.7));
+        input[i + 1] = static_cast<CSAMPLE>(0.5 * std::sin(i * 0.003) - 0.3 * std::sin(i * 0.2));
+    }
+    return input;
+}
+
 class EngineFilterBiquadTest : public testing::Test {
+  protected:
+    template<typename Filter, typename SetFrequencyCorners>
+    void expectScalarResults(
+            ScalarReferenceFilter<Filter>* pFilter,
+            ScalarReferenceFilter<Filter>* pReference,
+            SetFrequencyCorners setFrequencyCorners) {
+        const std::vector<CSAMPLE> input = makeInput();
+        std::vector<CSAMPLE> output(kBufferSize);
+        std::vector<CSAMPLE> expected(kBufferSize);
+        // The 1st buffer fades in from the start, the 3rd buffer cross-fades
+        // to the new coefficients and the others are not ramped.
+        for (int buffer = 0; buffer < 4; ++buffer) {
+            if (buffer == 2) {
+                setFrequencyCorners(pFilter);
+                setFrequencyCorners(pReference);
+                pReference->initScalarBuffers();
+            }
+            pFilter->process(input.data(), output.data(), kBufferSize);
+            pReference->processScalar(input.data(), expected.data(), kBufferSize);
+            for (int i = 0; i < kBufferSize; ++i) {
+                ASSERT_NEAR(expected[i], output[i], kTolerance)
+                        << "buffer " << buffer << " sample " << i;
+            }
+        }
+    }
 };
 
 TEST_F(EngineFilterBiquadTest, fidlibInputRespectsLocale) {
@@ -19,4 +139,68 @@ TEST_F(EngineFilterBiquadTest, fidspecLengthIsLongEnough) {
     ASSERT_TRUE(FIDSPEC_LENGTH > strlen("LsBq/1.2200000000/-12.0000000000"));
 }
 
+TEST_F(EngineFilterBiquadTest, peakingLanesMatchScalarFilter) {
+    ScalarReferenceFilter<EngineFilterBiquad1Peaking> filter(kSampleRate, 1000, 1.75);
+    ScalarReferenceFilter<EngineFilterBiquad1Peaking> reference(kSampleRate, 1000, 1.75);
+    expectScalarResults(&filter, &reference, [](EngineFilterBiquad1Peaking* pFilter) {
+        pFilter->setFrequencyCorners(kSampleRate, 1000, 1.75, -12.0);
+    });
+}
+
+TEST_F(EngineFilterBiquadTest, linkwitzRiley8LanesMatchScalarFilter) {
+    ScalarReferenceFilter<EngineFilterLinkwitzRiley8Low> filter(kSampleRate, 246);
+    ScalarReferenceFilter<EngineFilterLinkwitzRiley8Low> reference(kSampleRate, 246);
+    expectScalarResults(&filter, &reference, [](EngineFilterLinkwitzRiley8Low* pFilter) {
+        pFilter->setFrequencyCorners(kSampleRate, 2484);
+    });
+}
+
+TEST_F(EngineFilterBiquadTest, bessel4BandLanesMatchScalarFilter) {
+    ScalarReferenceFilter<EngineFilterBessel4Band> filter(kSampleRate, 246, 2484);
+    ScalarReferenceFilter<EngineFilterBessel4Band> reference(kSampleRate, 246, 2484);
+    expectScalarResults(&filter, &reference, [](EngineFilterBessel4Band* pFilter) {
+        pFilter->setFrequencyCorners(kSampleRate, 500, 5000);
+    });
+}
+
+template<typename Filter>
+static void BM_FilterProcess(benchmark::State& state, Filter* pFilter, bool scalar) {
+    const std::vector<CSAMPLE> input = makeInput();
+    std::vector<CSAMPLE> output(kBufferSize);
+    const int bufferSize = static_cast<int>(state.range(0));
+    while (state.KeepRunning()) {
+        if (scalar) {
+            pFilter->processScalar(input.data(), output.data(), bufferSize);
+        } else {
+            pFilter->process(input.data(), output.data(), bufferSize);
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * bufferSize);
+}
+
+static void BM_Biquad1Peaking(benchmark::State& state, bool scalar) {
+    ScalarReferenceFilter<EngineFilterBiquad1Peaking> filter(kSampleRate, 1000, 1.75);
+    filter.setFrequencyCorners(kSampleRate, 1000, 1.75, 6.0);
+    filter.assumeSettled();
+    BM_FilterProcess(state, &filter, scalar);
+}
+BENCHMARK_CAPTURE(BM_Biquad1Peaking, Lanes, false)->Arg(512)->Arg(2048);
+BENCHMARK_CAPTURE(BM_Biquad1Peaking, Scalar, true)->Arg(512)->Arg(2048);
+
+static void BM_Bessel4Low(benchmark::State& state, bool scalar) {
+    ScalarReferenceFilter<EngineFilterBessel4Low> filter(kSampleRate, 246);
+    filter.assumeSettled();
+    BM_FilterProcess(state, &filter, scalar);
+}
+BENCHMARK_CAPTURE(BM_Bessel4Low, Lanes, false)->Arg(512)->Arg(2048);
+BENCHMARK_CAPTURE(BM_Bessel4Low, Scalar, true)->Arg(512)->Arg(2048);
+
+static void BM_LinkwitzRiley8Low(benchmark::State& state, bool scalar) {
+    ScalarReferenceFilter<EngineFilterLinkwitzRiley8Low> filter(kSampleRate, 246);
+    filter.assumeSettled();
+    BM_FilterProcess(state, &filter, scalar);
+}
+BENCHMARK_CAPTURE(BM_LinkwitzRiley8Low, Lanes, false)->Arg(512)->Arg(2048);
+BENCHMARK_CAPTURE(BM_LinkwitzRiley8Low, Scalar, true)->Arg(512)->Arg(2048);
+
 } // namespace
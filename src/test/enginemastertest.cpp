@@ -1,8 +1,11 @@
+#include <benchmark/benchmark.h>
 #include <gtest/gtest.h>
 #include <gmock/gmock.h>
 
+#include <QTemporaryDir>
 #include <QtDebug>
 
+#include "control/control.h"
 #include "control/controlproxy.h"
 #include "engine/channels/enginechannel.h"
 #include "engine/enginemaster.h"
@@ -391,4 +394,164 @@ TEST_F(EngineMasterTest, ThreeChannelPFLOutputWorks) {
     assertHeadphoneBufferMatchesGolden(testName);
 }
 
+// Fills its buffer with a constant and may be processed by the pool
+// threads in the parallel engine mode.
+class EngineChannelConstantMock : public EngineChannel {
+  public:
+    EngineChannelConstantMock(const QString& group,
+            CSAMPLE value,
+            EngineMaster* pMaster)
+            : EngineChannel(pMaster->registerChannelGroup(group),
+                      EngineChannel::CENTER,
+                      nullptr,
+                      /*isTalkoverChannel*/ false,
+                      /*isPrimaryDeck*/ true),
+              m_value(value) {
+    }
+
+    bool isActive() override {
+        return true;
+    }
+
+    bool isMasterEnabled() const override {
+        return true;
+    }
+
+    bool supportsParallelProcessing() override {
+        return true;
+    }
+
+    void process(CSAMPLE* pInOut, const int iBufferSize) override {
+        SampleUtil::fill(pInOut, m_value, iBufferSize);
+    }
+
+    void collectFeatures(GroupFeatureState* pGroupFeatures) const override {
+        Q_UNUSED(pGroupFeatures);
+    }
+
+    void postProcess(const int iBufferSize) override {
+        Q_UNUSED(iBufferSize);
+    }
+
+  private:
+    const CSAMPLE m_value;
+};
+
+TEST_F(EngineMasterTest, ParallelProcessingDetectsSilentChannels) {
+    m_pEngineMaster->enableParallelProcessing(2);
+    m_pEngineMaster->addChannel(new EngineChannelConstantMock(
+            "[Test1]", 0.0f, m_pEngineMaster));
+    m_pEngineMaster->addChannel(new EngineChannelConstantMock(
+            "[Test2]", 0.1f, m_pEngineMaster));
+    m_pEngineMaster->addChannel(new EngineChannelConstantMock(
+            "[Test3]", 0.0f, m_pEngineMaster));
+
+    m_pEngineMaster->process(MAX_BUFFER_LEN);
+
+    // Effects are bypassed for silent channels, regardless of the thread
+    // that has processed them
+    ASSERT_NE(nullptr, m_pEngineMaster->getChannelFeatures("[Test1]"));
+    ASSERT_NE(nullptr, m_pEngineMaster->getChannelFeatures("[Test2]"));
+    ASSERT_NE(nullptr, m_pEngineMaster->getChannelFeatures("[Test3]"));
+    EXPECT_TRUE(m_pEngineMaster->getChannelFeatures("[Test1]")->is_silent);
+    EXPECT_FALSE(m_pEngineMaster->getChannelFeatures("[Test2]")->is_silent);
+    EXPECT_TRUE(m_pEngineMaster->getChannelFeatures("[Test3]")->is_silent);
+}
+
+// Emulates the processing load of a deck with keylock and effects
+// by applying a simple one-pole lowpass filter many times.
+class EngineChannelLoadMock : public EngineChannel {
+  public:
+    EngineChannelLoadMock(const QString& group,
+            EngineMaster* pMaster)
+            : EngineChannel(pMaster->registerChannelGroup(group),
+                      EngineChannel::CENTER,
+                      nullptr,
+                      /*isTalkoverChannel*/ false,
+                      /*isPrimaryDeck*/ true),
+              m_state(0) {
+    }
+
+    bool isActive() override {
+        return true;
+    }
+
+    bool isMasterEnabled() const override {
+        return true;
+    }
+
+    bool supportsParallelProcessing() override {
+        return true;
+    }
+
+    void process(CSAMPLE* pInOut, const int iBufferSize) override {
+        const int kPasses = 64;
+        for (int pass = 0; pass < kPasses; ++pass) {
+            for (int i = 0; i < iBufferSize; ++i) {
+                m_state += 0.1f * (static_cast<CSAMPLE>(i % 32) - m_state);
+                pInOut[i] = m_state;
+            }
+        }
+    }
+
+    void collectFeatures(GroupFeatureState* pGroupFeatures) const override {
+        Q_UNUSED(pGroupFeatures);
+    }
+
+    void postProcess(const int iBufferSize) override {
+        Q_UNUSED(iBufferSize);
+    }
+
+  private:
+    CSAMPLE m_state;
+};
+
+// Measures the callback time of EngineMaster with an increasing number
+// of decks in the sequential (0) and the parallel (1) engine mode.
+static void BM_EngineMasterProcess(benchmark::State& state) {
+    const int deckCount = static_cast<int>(state.range(0));
+    const bool parallel = state.range(1) != 0;
+    // 256 stereo frames
+    const int kBufferSize = 512;
+
+    const QTemporaryDir tempDir;
+    UserSettingsPointer pConfig(
+            new UserSettings(tempDir.filePath("benchmark.cfg")));
+    pConfig->setValue(ConfigKey("[Master]", "parallel_channel_processing"), parallel);
+    ControlDoublePrivate::setUserConfig(pConfig);
+    {
+        auto pChannelHandleFactory = std::make_shared<ChannelHandleFactory>();
+        ControlObject numDecks(ConfigKey("[Master]", "num_decks"));
+        EffectsManager effectsManager(nullptr, pConfig, pChannelHandleFactory);
+        TestEngineMaster engineMaster(pConfig,
+                "[Master]",
+                &effectsManager,
+                pChannelHandleFactory,
+                false);
+        for (int i = 0; i < deckCount; ++i) {
+            // Deleted by EngineMaster
+            engineMaster.addChannel(new EngineChannelLoadMock(
+                    QString("[Channel%1]").arg(i + 1), &engineMaster));
+        }
+
+        while (state.KeepRunning()) {
+            engineMaster.process(kBufferSize);
+        }
+        state.SetLabel(parallel ? "parallel" : "sequential");
+    }
+    const auto controls = ControlDoublePrivate::takeAllInstances();
+    for (auto pControl : controls) {
+        pControl->deleteCreatorCO();
+    }
+}
+
+static void EngineMasterProcessArguments(benchmark::internal::Benchmark* b) {
+    for (int parallel = 0; parallel <= 1; ++parallel) {
+        for (int deckCount = 1; deckCount <= 8; deckCount *= 2) {
+            b->Args({deckCount, parallel});
+        }
+    }
+}
+BENCHMARK(BM_EngineMasterProcess)->Apply(EngineMasterProcessArguments)->UseRealTime();
+
 }  // namespace
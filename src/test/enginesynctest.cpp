@@ -2464,3 +2464,49 @@ TEST_F(EngineSyncTest, BpmAdjustFactor) {
     ASSERT_TRUE(isFollower(m_sGroup2));
     ASSERT_TRUE(isSoftMaster(m_sInternalClockGroup));
 }
+
+TEST_F(EngineSyncTest, SyncRequestsInParallelEngineMode) {
+    // Decks without sync are processed concurrently, synchronized decks
+    // are processed on the engine thread.
+    m_pEngineMaster->enableParallelProcessing(2);
+
+    m_pTrack1->setBeats(BeatFactory::makeBeatGrid(*m_pTrack1, 130, 0.0));
+    m_pTrack2->setBeats(BeatFactory::makeBeatGrid(*m_pTrack2, 100, 0.0));
+    m_pTrack3->setBeats(BeatFactory::makeBeatGrid(*m_pTrack3, 140, 0.0));
+    ControlObject::set(ConfigKey(m_sGroup1, "play"), 1.0);
+    ControlObject::set(ConfigKey(m_sGroup2, "play"), 1.0);
+    ControlObject::set(ConfigKey(m_sGroup3, "play"), 1.0);
+    ProcessBuffer();
+
+    // The requests of playing decks are queued and processed by the engine
+    ControlObject::set(ConfigKey(m_sGroup1, "sync_enabled"), 1.0);
+    ControlObject::set(ConfigKey(m_sGroup2, "sync_enabled"), 1.0);
+    ControlObject::set(ConfigKey(m_sGroup3, "sync_enabled"), 1.0);
+    for (int i = 0; i < 10; ++i) {
+        ProcessBuffer();
+    }
+    EXPECT_FALSE(getMasterGroup().isEmpty());
+    EXPECT_TRUE(ControlObject::toBool(ConfigKey(m_sGroup1, "sync_enabled")));
+    EXPECT_TRUE(ControlObject::toBool(ConfigKey(m_sGroup2, "sync_enabled")));
+    EXPECT_TRUE(ControlObject::toBool(ConfigKey(m_sGroup3, "sync_enabled")));
+    const double bpm = ControlObject::get(ConfigKey(m_sGroup1, "bpm"));
+    EXPECT_GT(bpm, 0.0);
+    EXPECT_NEAR(bpm,
+            ControlObject::get(ConfigKey(m_sGroup2, "bpm")),
+            kMaxFloatingPointErrorLowPrecision);
+    EXPECT_NEAR(bpm,
+            ControlObject::get(ConfigKey(m_sGroup3, "bpm")),
+            kMaxFloatingPointErrorLowPrecision);
+
+    // Disabling sync returns the deck to the parallel processing
+    ControlObject::set(ConfigKey(m_sGroup3, "sync_enabled"), 0.0);
+    for (int i = 0; i < 10; ++i) {
+        ProcessBuffer();
+    }
+    assertSyncOff(m_sGroup3);
+    EXPECT_TRUE(ControlObject::toBool(ConfigKey(m_sGroup1, "sync_enabled")));
+    EXPECT_TRUE(ControlObject::toBool(ConfigKey(m_sGroup2, "sync_enabled")));
+    EXPECT_NEAR(ControlObject::get(ConfigKey(m_sGroup1, "bpm")),
+            ControlObject::get(ConfigKey(m_sGroup2, "bpm")),
+            kMaxFloatingPointErrorLowPrecision);
+}
@@ -0,0 +1,46 @@
+#include <gtest/gtest.h>
+
+#include <memory>
+#include <vector>
+
+#include "engine/engineworker.h"
+#include "engine/engineworkerscheduler.h"
+#include "test/mixxxtest.h"
+
+namespace {
+
+// The worker thread is never started, the test only checks if the
+// scheduler has woken up the worker.
+class FakeEngineWorker : public EngineWorker {
+  public:
+    bool waitUntilWoken() {
+        return m_semaRun.tryAcquire(1, 1000);
+    }
+};
+
+class EngineWorkerSchedulerTest : public MixxxTest {
+};
+
+TEST_F(EngineWorkerSchedulerTest, WakeMoreWorkersThanInitialCapacity) {
+    EngineWorkerScheduler scheduler;
+    scheduler.start();
+
+    const int kWorkerCount = 3 * MAX_ENGINE_WORKERS + 1;
+    std::vector<std::unique_ptr<FakeEngineWorker>> workers;
+    for (int i = 0; i < kWorkerCount; ++i) {
+        workers.push_back(std::make_unique<FakeEngineWorker>());
+        workers.back()->setScheduler(&scheduler);
+    }
+
+    for (int round = 0; round < 2; ++round) {
+        for (const auto& pWorker : workers) {
+            pWorker->workReady();
+        }
+        scheduler.runWorkers();
+        for (const auto& pWorker : workers) {
+            EXPECT_TRUE(pWorker->waitUntilWoken());
+        }
+    }
+}
+
+} // namespace
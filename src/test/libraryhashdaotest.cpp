@@ -0,0 +1,97 @@
+#include <gtest/gtest.h>
+
+#include <QtDebug>
+
+#include "library/dao/libraryhashdao.h"
+#include "test/mixxxdbtest.h"
+
+namespace {
+
+LibraryFileStatus fileStatus(const QString& location, qint64 modifiedAt) {
+    LibraryFileStatus fileStatus;
+    fileStatus.location = location;
+    fileStatus.size = 1000;
+    fileStatus.modifiedAt = modifiedAt;
+    fileStatus.inode = 42;
+    return fileStatus;
+}
+
+class LibraryHashDAOTest : public MixxxDbTest {
+  protected:
+    LibraryHashDAOTest() {
+        EXPECT_TRUE(MixxxDb::initDatabaseSchema(dbConnection()));
+        m_libraryHashDao.initialize(dbConnection());
+    }
+
+    bool needsVerification(const QString& dirPath) const {
+        QSqlQuery query(dbConnection());
+        query.prepare("SELECT needs_verification FROM LibraryHashes "
+                      "WHERE directory_path=:directory_path");
+        query.bindValue(":directory_path", dirPath);
+        EXPECT_TRUE(query.exec());
+        EXPECT_TRUE(query.next());
+        return query.value(0).toBool();
+    }
+
+    LibraryHashDAO m_libraryHashDao;
+};
+
+TEST_F(LibraryHashDAOTest, SaveFileStatuses) {
+    m_libraryHashDao.saveFileStatuses("/music/a",
+            {fileStatus("/music/a/1.mp3", 1), fileStatus("/music/a/2.mp3", 2)});
+    m_libraryHashDao.saveFileStatuses("/music/b",
+            {fileStatus("/music/b/1.mp3", 1)});
+
+    auto fileStatuses = m_libraryHashDao.getFileStatuses();
+    EXPECT_EQ(3, fileStatuses.size());
+    EXPECT_EQ(fileStatus("/music/a/2.mp3", 2), fileStatuses.value("/music/a/2.mp3"));
+
+    // Replace all file statuses of a directory
+    m_libraryHashDao.saveFileStatuses("/music/a",
+            {fileStatus("/music/a/1.mp3", 3)});
+    fileStatuses = m_libraryHashDao.getFileStatuses();
+    EXPECT_EQ(2, fileStatuses.size());
+    EXPECT_EQ(fileStatus("/music/a/1.mp3", 3), fileStatuses.value("/music/a/1.mp3"));
+    EXPECT_FALSE(fileStatuses.contains("/music/a/2.mp3"));
+}
+
+TEST_F(LibraryHashDAOTest, InvalidateDirectories) {
+    const QStringList dirPaths = {
+            "/music/a",
+            "/music/a/b",
+            "/music/a/b/c",
+            "/music/a b",
+            "/music/ab"};
+    for (const auto& dirPath : dirPaths) {
+        m_libraryHashDao.saveDirectoryHash(dirPath, 1);
+    }
+    m_libraryHashDao.updateDirectoryStatuses(dirPaths, false, true);
+
+    m_libraryHashDao.invalidateDirectories({"/music/a"}, false);
+    EXPECT_TRUE(needsVerification("/music/a"));
+    EXPECT_FALSE(needsVerification("/music/a/b"));
+
+    m_libraryHashDao.invalidateDirectories({"/music/a/b"}, true);
+    EXPECT_TRUE(needsVerification("/music/a/b"));
+    EXPECT_TRUE(needsVerification("/music/a/b/c"));
+    // Directories with the same prefix are not subdirectories
+    EXPECT_FALSE(needsVerification("/music/a b"));
+    EXPECT_FALSE(needsVerification("/music/ab"));
+}
+
+TEST_F(LibraryHashDAOTest, RemoveDeletedDirectoryHashes) {
+    m_libraryHashDao.saveDirectoryHash("/music/a", 1);
+    m_libraryHashDao.saveDirectoryHash("/music/b", 1);
+    m_libraryHashDao.saveFileStatuses("/music/a", {fileStatus("/music/a/1.mp3", 1)});
+    m_libraryHashDao.saveFileStatuses("/music/b", {fileStatus("/music/b/1.mp3", 1)});
+    m_libraryHashDao.updateDirectoryStatuses({"/music/a", "/music/b"}, false, true);
+
+    m_libraryHashDao.invalidateDirectories({"/music/a"}, true);
+    m_libraryHashDao.markUnverifiedDirectoriesAsDeleted();
+    m_libraryHashDao.removeDeletedDirectoryHashes();
+
+    EXPECT_EQ(QStringList{"/music/b"}, m_libraryHashDao.getDirectoryHashes().keys());
+    EXPECT_EQ(QStringList{"/music/b/1.mp3"}, m_libraryHashDao.getFileStatuses().keys());
+}
+
+} // namespace
@@ -4,12 +4,36 @@
 #include <QtDebug>
 #include <QList>
 #include <QPair>
+#include <QVector>
 
 #include "util/sample.h"
 #include "util/timer.h"
 
 namespace {
 
+const CpuFeatures::Isa kAllIsas[] = {
+        CpuFeatures::Isa::Generic,
+        CpuFeatures::Isa::Sse2,
+        CpuFeatures::Isa::Avx2,
+        CpuFeatures::Isa::Avx512,
+        CpuFeatures::Isa::Neon,
+};
+
+// Selects the implementation of SampleUtil until going out of scope
+class ScopedSampleUtilIsa {
+  public:
+    explicit ScopedSampleUtilIsa(CpuFeatures::Isa isa)
+            : m_previousIsa(SampleUtil::isa()) {
+        SampleUtil::setIsa(isa);
+    }
+    ~ScopedSampleUtilIsa() {
+        SampleUtil::setIsa(m_previousIsa);
+    }
+
+  private:
+    const CpuFeatures::Isa m_previousIsa;
+};
+
 class SampleUtilTest : public testing::Test {
   protected:
     void SetUp() override {
@@ -303,6 +327,22 @@ TEST_F(SampleUtilTest, sumAbsPerChannel) {
     }
 }
 
+TEST_F(SampleUtilTest, maxAbsAmplitude) {
+    for (int i = 0; i < buffers.size(); ++i) {
+        CSAMPLE* buffer = buffers[i];
+        int size = sizes[i];
+        ClearBuffer(buffer, size);
+        EXPECT_FLOAT_EQ(0.0f, SampleUtil::maxAbsAmplitude(buffer, size));
+        EXPECT_TRUE(SampleUtil::isSilent(buffer, size));
+        buffer[size / 2] = -0.5f;
+        buffer[size - 1] = 0.25f;
+        EXPECT_FLOAT_EQ(0.5f, SampleUtil::maxAbsAmplitude(buffer, size));
+        EXPECT_FALSE(SampleUtil::isSilent(buffer, size));
+        FillBuffer(buffer, SampleUtil::kSilenceThreshold / 2, size);
+        EXPECT_TRUE(SampleUtil::isSilent(buffer, size));
+    }
+}
+
 TEST_F(SampleUtilTest, interleaveBuffer) {
     for (int i = 0; i < buffers.size(); ++i) {
         CSAMPLE* buffer = buffers[i];
@@ -397,6 +437,89 @@ TEST_F(SampleUtilTest, copyReverse) {
     }
 }
 
+TEST_F(SampleUtilTest, allIsasProduceSameResults) {
+    // The results of each implementation must be bit-identical
+    for (int i = 0; i < evenBuffers.size(); ++i) {
+        const int size = sizes[evenBuffers[i]];
+        QVector<CSAMPLE> input(size);
+        QVector<CSAMPLE> dest(size);
+        for (int j = 0; j < size; ++j) {
+            input[j] = static_cast<CSAMPLE>((j % 37) - 18) / 12.0f;
+            dest[j] = static_cast<CSAMPLE>((j % 11) - 5) / 7.0f;
+        }
+
+        QVector<CSAMPLE> expectedRamped = dest;
+        QVector<CSAMPLE> expectedMixed = dest;
+        QVector<CSAMPLE> expectedClamped(size);
+        CSAMPLE expectedSumL, expectedSumR;
+        SampleUtil::CLIP_STATUS expectedClipping;
+        CSAMPLE expectedMaxAbs;
+        {
+            ScopedSampleUtilIsa scopedIsa(CpuFeatures::Isa::Generic);
+            SampleUtil::addWithRampingGain(expectedRamped.data(),
+                    input.constData(),
+                    0.25f,
+                    0.75f,
+                    size);
+            SampleUtil::add3WithGain(expectedMixed.data(),
+                    input.constData(),
+                    0.3f,
+                    dest.constData(),
+                    -0.7f,
+                    input.constData(),
+                    1.1f,
+                    size);
+            SampleUtil::copyClampBuffer(expectedClamped.data(), input.constData(), size);
+            expectedClipping = SampleUtil::sumAbsPerChannel(
+                    &expectedSumL, &expectedSumR, input.constData(), size);
+            expectedMaxAbs = SampleUtil::maxAbsAmplitude(input.constData(), size);
+        }
+
+        for (const auto isa : kAllIsas) {
+            if (!SampleUtil::isSupported(isa)) {
+                continue;
+            }
+            ScopedSampleUtilIsa scopedIsa(isa);
+
+            QVector<CSAMPLE> ramped = dest;
+            SampleUtil::addWithRampingGain(ramped.data(),
+                    input.constData(),
+                    0.25f,
+                    0.75f,
+                    size);
+            QVector<CSAMPLE> mixed = dest;
+            SampleUtil::add3WithGain(mixed.data(),
+                    input.constData(),
+                    0.3f,
+                    dest.constData(),
+                    -0.7f,
+                    input.constData(),
+                    1.1f,
+                    size);
+            QVector<CSAMPLE> clamped(size);
+            SampleUtil::copyClampBuffer(clamped.data(), input.constData(), size);
+            CSAMPLE sumL, sumR;
+            const auto clipping = SampleUtil::sumAbsPerChannel(
+                    &sumL, &sumR, input.constData(), size);
+
+            for (int j = 0; j < size; ++j) {
+                ASSERT_EQ(expectedRamped[j], ramped[j])
+                        << CpuFeatures::isaName(isa) << " " << j;
+                ASSERT_EQ(expectedMixed[j], mixed[j])
+                        << CpuFeatures::isaName(isa) << " " << j;
+                ASSERT_EQ(expectedClamped[j], clamped[j])
+                        << CpuFeatures::isaName(isa) << " " << j;
+            }
+            EXPECT_EQ(expectedSumL, sumL) << CpuFeatures::isaName(isa);
+            EXPECT_EQ(expectedSumR, sumR) << CpuFeatures::isaName(isa);
+            EXPECT_EQ(expectedClipping, clipping) << CpuFeatures::isaName(isa);
+            EXPECT_EQ(expectedMaxAbs,
+                    SampleUtil::maxAbsAmplitude(input.constData(), size))
+                    << CpuFeatures::isaName(isa);
+        }
+    }
+}
+
 static void BM_MemCpy(benchmark::State& state) {
     SINT size = static_cast<SINT>(state.range(0));
     CSAMPLE* buffer = SampleUtil::alloc(size);
@@ -583,4 +706,92 @@ static void BM_Copy2WithRampingGain(benchmark::State& state) {
 }
 BENCHMARK(BM_Copy2WithRampingGain)->Range(64, 4096);
 
+// Benchmarks the implementation of SampleUtil for each instruction set.
+// The throughput is reported for the processed input samples.
+static void SampleUtilIsaArguments(benchmark::internal::Benchmark* b) {
+    for (const auto isa : kAllIsas) {
+        for (int size : {256, 1024, 4096}) {
+            b->ArgPair(static_cast<int>(isa), size);
+        }
+    }
+}
+
+template<typename Function>
+static void runSampleUtilIsaBenchmark(benchmark::State& state, Function function) {
+    const auto isa = static_cast<CpuFeatures::Isa>(state.range(0));
+    const SINT size = static_cast<SINT>(state.range(1));
+    if (!SampleUtil::isSupported(isa)) {
+        state.SkipWithError("Not supported by this CPU");
+        return;
+    }
+    ScopedSampleUtilIsa scopedIsa(isa);
+    state.SetLabel(CpuFeatures::isaName(isa));
+    CSAMPLE* buffer = SampleUtil::alloc(size);
+    SampleUtil::fill(buffer, 0.5f, size);
+    CSAMPLE* buffer2 = SampleUtil::alloc(size);
+    SampleUtil::fill(buffer2, 0.25f, size);
+
+    while (state.KeepRunning()) {
+        function(buffer, buffer2, size);
+        benchmark::DoNotOptimize(buffer);
+    }
+    state.SetItemsProcessed(state.iterations() * size);
+    state.SetBytesProcessed(state.iterations() * size * sizeof(CSAMPLE));
+
+    SampleUtil::free(buffer);
+    SampleUtil::free(buffer2);
+}
+
+static void BM_ApplyRampingGain(benchmark::State& state) {
+    runSampleUtilIsaBenchmark(state, [](CSAMPLE* pDest, const CSAMPLE*, SINT size) {
+        SampleUtil::applyRampingGain(pDest, 0.999f, 1.0f, size);
+    });
+}
+BENCHMARK(BM_ApplyRampingGain)->Apply(SampleUtilIsaArguments);
+
+static void BM_AddWithRampingGain(benchmark::State& state) {
+    runSampleUtilIsaBenchmark(state, [](CSAMPLE* pDest, const CSAMPLE* pSrc, SINT size) {
+        SampleUtil::addWithRampingGain(pDest, pSrc, 0.5f, 0.75f, size);
+    });
+}
+BENCHMARK(BM_AddWithRampingGain)->Apply(SampleUtilIsaArguments);
+
+static void BM_CopyClampBuffer(benchmark::State& state) {
+    runSampleUtilIsaBenchmark(state, [](CSAMPLE* pDest, const CSAMPLE* pSrc, SINT size) {
+        SampleUtil::copyClampBuffer(pDest, pSrc, size);
+    });
+}
+BENCHMARK(BM_CopyClampBuffer)->Apply(SampleUtilIsaArguments);
+
+static void BM_SumAbsPerChannel(benchmark::State& state) {
+    runSampleUtilIsaBenchmark(state, [](CSAMPLE*, const CSAMPLE* pSrc, SINT size) {
+        CSAMPLE sumL, sumR;
+        benchmark::DoNotOptimize(SampleUtil::sumAbsPerChannel(&sumL, &sumR, pSrc, size));
+    });
+}
+BENCHMARK(BM_SumAbsPerChannel)->Apply(SampleUtilIsaArguments);
+
+static void BM_MaxAbsAmplitude(benchmark::State& state) {
+    runSampleUtilIsaBenchmark(state, [](CSAMPLE*, const CSAMPLE* pSrc, SINT size) {
+        benchmark::DoNotOptimize(SampleUtil::maxAbsAmplitude(pSrc, size));
+    });
+}
+BENCHMARK(BM_MaxAbsAmplitude)->Apply(SampleUtilIsaArguments);
+
+static void BM_InterleaveBuffer(benchmark::State& state) {
+    runSampleUtilIsaBenchmark(state, [](CSAMPLE* pDest, const CSAMPLE* pSrc, SINT size) {
+        // Both halves of pSrc are interleaved into pDest
+        SampleUtil::interleaveBuffer(pDest, pSrc, pSrc + size / 2, size / 2);
+    });
+}
+BENCHMARK(BM_InterleaveBuffer)->Apply(SampleUtilIsaArguments);
+
+static void BM_ConvertS16ToFloat32(benchmark::State& state) {
+    runSampleUtilIsaBenchmark(state, [](CSAMPLE* pDest, const CSAMPLE* pSrc, SINT size) {
+        // The input buffer is large enough for the same number of S16 samples
+        SampleUtil::convertS16ToFloat32(pDest, reinterpret_cast<const SAMPLE*>(pSrc), size);
+    });
+}
+BENCHMARK(BM_ConvertS16ToFloat32)->Apply(SampleUtilIsaArguments);
+
 }  // namespace
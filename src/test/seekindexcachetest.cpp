@@ -0,0 +1,171 @@
+#include <gtest/gtest.h>
+
+#include <QDateTime>
+#include <QFile>
+#include <QFileInfo>
+#include <QTemporaryDir>
+#include <QtDebug>
+
+#include "sources/seekindexcache.h"
+
+namespace {
+
+class SeekIndexCacheTest : public testing::Test {
+  protected:
+    void SetUp() override {
+        ASSERT_TRUE(m_tempDir.isValid());
+        mixxx::SeekIndexCache::setDirectory(m_tempDir.filePath("cache"));
+        m_audioFilePath = m_tempDir.filePath("audio.mp3");
+        writeAudioFile(QByteArray(200 * 1024, 'a'));
+    }
+
+    void TearDown() override {
+        mixxx::SeekIndexCache::setDirectory(QString());
+    }
+
+    void writeAudioFile(const QByteArray& data) {
+        writeFile(m_audioFilePath, data);
+    }
+
+    static void writeFile(const QString& filePath, const QByteArray& data) {
+        QFile file(filePath);
+        ASSERT_TRUE(file.open(QIODevice::WriteOnly));
+        ASSERT_EQ(data.size(), file.write(data));
+    }
+
+    static void setLastUsed(const QString& filePath, const QDateTime& dateTime) {
+        QFile file(filePath);
+        ASSERT_TRUE(file.open(QIODevice::Append));
+        ASSERT_TRUE(file.setFileTime(dateTime, QFileDevice::FileModificationTime));
+    }
+
+    static mixxx::SeekIndex createIndex() {
+        mixxx::SeekIndex index;
+        index.channelCount = 2;
+        index.sampleRate = 44100;
+        index.bitrate = 320;
+        index.frameLength = 1152 * 100;
+        for (int i = 0; i < 100; ++i) {
+            index.entries.push_back(mixxx::SeekIndex::Entry{1152 * i, 1044 * i + 10});
+        }
+        return index;
+    }
+
+    QTemporaryDir m_tempDir;
+    QString m_audioFilePath;
+};
+
+TEST_F(SeekIndexCacheTest, SaveLoad) {
+    const mixxx::SeekIndex index = createIndex();
+    {
+        const mixxx::SeekIndexCache cache(m_audioFilePath, "mp3");
+        mixxx::SeekIndex loaded;
+        EXPECT_FALSE(cache.load(&loaded));
+        EXPECT_TRUE(cache.save(index));
+    }
+
+    const mixxx::SeekIndexCache cache(m_audioFilePath, "mp3");
+    mixxx::SeekIndex loaded;
+    ASSERT_TRUE(cache.load(&loaded));
+    EXPECT_EQ(index.channelCount, loaded.channelCount);
+    EXPECT_EQ(index.sampleRate, loaded.sampleRate);
+    EXPECT_EQ(index.bitrate, loaded.bitrate);
+    EXPECT_EQ(index.frameLength, loaded.frameLength);
+    ASSERT_EQ(index.entries.size(), loaded.entries.size());
+    for (size_t i = 0; i < index.entries.size(); ++i) {
+        EXPECT_EQ(index.entries[i].frameIndex, loaded.entries[i].frameIndex);
+        EXPECT_EQ(index.entries[i].byteOffset, loaded.entries[i].byteOffset);
+    }
+
+    // Indexes of different types are stored separately
+    const mixxx::SeekIndexCache otherCache(m_audioFilePath, "ffmpeg");
+    EXPECT_FALSE(otherCache.load(&loaded));
+}
+
+TEST_F(SeekIndexCacheTest, ModifiedFileIsInvalid) {
+    EXPECT_TRUE(mixxx::SeekIndexCache(m_audioFilePath, "mp3").save(createIndex()));
+
+    // Same size, but different content at the end of the file
+    QByteArray data(200 * 1024, 'a');
+    data[data.size() - 1] = 'b';
+    writeAudioFile(data);
+
+    mixxx::SeekIndex loaded;
+    EXPECT_FALSE(mixxx::SeekIndexCache(m_audioFilePath, "mp3").load(&loaded));
+}
+
+TEST_F(SeekIndexCacheTest, CompactEntries) {
+    mixxx::SeekIndex index = createIndex();
+    // Variable frame sizes
+    for (size_t i = 1; i < index.entries.size(); ++i) {
+        index.entries[i].byteOffset = index.entries[i - 1].byteOffset +
+                (i % 3 == 0 ? 417 : 1044);
+    }
+    const mixxx::SeekIndexCache cache(m_audioFilePath, "mp3");
+    ASSERT_TRUE(cache.save(index));
+    // At most 4 bytes per entry after the header
+    EXPECT_GE(72 + 4 * static_cast<qint64>(index.entries.size()),
+            QFileInfo(cache.cacheFilePath()).size());
+
+    mixxx::SeekIndex loaded;
+    ASSERT_TRUE(cache.load(&loaded));
+    ASSERT_EQ(index.entries.size(), loaded.entries.size());
+    for (size_t i = 0; i < index.entries.size(); ++i) {
+        EXPECT_EQ(index.entries[i].frameIndex, loaded.entries[i].frameIndex);
+        EXPECT_EQ(index.entries[i].byteOffset, loaded.entries[i].byteOffset);
+    }
+
+    // Truncated files are invalid
+    QFile file(cache.cacheFilePath());
+    ASSERT_TRUE(file.resize(file.size() - 1));
+    EXPECT_FALSE(cache.load(&loaded));
+}
+
+TEST_F(SeekIndexCacheTest, EvictLeastRecentlyUsed) {
+    const QString otherAudioFilePath = m_tempDir.filePath("other.mp3");
+    writeFile(otherAudioFilePath, QByteArray(100 * 1024, 'b'));
+    const QString thirdAudioFilePath = m_tempDir.filePath("third.mp3");
+    writeFile(thirdAudioFilePath, QByteArray(50 * 1024, 'c'));
+    const mixxx::SeekIndexCache cache(m_audioFilePath, "mp3");
+    const mixxx::SeekIndexCache otherCache(otherAudioFilePath, "mp3");
+    const mixxx::SeekIndexCache thirdCache(thirdAudioFilePath, "mp3");
+    ASSERT_TRUE(cache.save(createIndex()));
+    const qint64 fileSize = QFileInfo(cache.cacheFilePath()).size();
+
+    // Only two files fit into the cache
+    mixxx::SeekIndexCache::setDirectory(m_tempDir.filePath("cache"), 2 * fileSize + 1);
+    ASSERT_TRUE(otherCache.save(createIndex()));
+    EXPECT_TRUE(QFile::exists(cache.cacheFilePath()));
+    const auto now = QDateTime::currentDateTimeUtc();
+    setLastUsed(cache.cacheFilePath(), now.addSecs(-120));
+    setLastUsed(otherCache.cacheFilePath(), now.addSecs(-60));
+
+    // Loading an index marks it as used
+    mixxx::SeekIndex loaded;
+    ASSERT_TRUE(cache.load(&loaded));
+    ASSERT_TRUE(thirdCache.save(createIndex()));
+    EXPECT_TRUE(QFile::exists(cache.cacheFilePath()));
+    EXPECT_FALSE(QFile::exists(otherCache.cacheFilePath()));
+    EXPECT_TRUE(QFile::exists(thirdCache.cacheFilePath()));
+}
+
+TEST_F(SeekIndexCacheTest, Remove) {
+    const mixxx::SeekIndexCache cache(m_audioFilePath, "mp3");
+    const mixxx::SeekIndexCache otherCache(m_audioFilePath, "ffmpeg");
+    ASSERT_TRUE(cache.save(createIndex()));
+    ASSERT_TRUE(otherCache.save(createIndex()));
+
+    mixxx::SeekIndexCache::remove(m_audioFilePath);
+    EXPECT_FALSE(QFile::exists(cache.cacheFilePath()));
+    EXPECT_FALSE(QFile::exists(otherCache.cacheFilePath()));
+}
+
+TEST_F(SeekIndexCacheTest, Disabled) {
+    mixxx::SeekIndexCache::setDirectory(QString());
+    EXPECT_FALSE(mixxx::SeekIndexCache::isEnabled());
+    const mixxx::SeekIndexCache cache(m_audioFilePath, "mp3");
+    EXPECT_TRUE(cache.cacheFilePath().isEmpty());
+    EXPECT_FALSE(cache.save(createIndex()));
+}
+
+} // namespace
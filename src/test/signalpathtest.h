@@ -53,6 +53,10 @@ class TestEngineMaster : public EngineMaster {
     CSAMPLE* masterBuffer() {
         return m_pMaster;
     }
+
+    void enableParallelProcessing(int threadCount) {
+        startChannelProcessorPool(threadCount);
+    }
 };
 
 class BaseSignalPathTest : public MixxxTest {
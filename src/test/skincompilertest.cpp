@@ -0,0 +1,126 @@
+#include <QDomDocument>
+#include <QFile>
+
+#include "skin/skincompiler.h"
+#include "skin/skincontext.h"
+#include "test/mixxxtest.h"
+
+namespace {
+
+class SkinCompilerTest : public MixxxTest {
+  protected:
+    void SetUp() override {
+        ASSERT_TRUE(m_skinDir.isValid());
+        writeFile("template.xml",
+                "<Template>"
+                "<SetVariable name=\"label\">Deck <Variable name=\"deck\"/></SetVariable>"
+                "<Label><Text><Variable name=\"label\"/></Text></Label>"
+                "</Template>");
+        writeFile("skin.xml",
+                "<skin>"
+                "<Layout>horizontal</Layout>"
+                "<Children>"
+                "<SetVariable name=\"deck\">1</SetVariable>"
+                "<Template src=\"" + m_skinDir.filePath("template.xml") + "\">"
+                "<SetVariable name=\"deck\">2</SetVariable>"
+                "</Template>"
+                "<PushButton>"
+                "<State>"
+                "<SetVariable name=\"deck\">3</SetVariable>"
+                "<Text><Variable name=\"deck\"/></Text>"
+                "</State>"
+                "<Group>[Channel<Variable name=\"deck\"/>]</Group>"
+                "</PushButton>"
+                "</Children>"
+                "</skin>");
+    }
+
+    void writeFile(const QString& fileName, const QString& contents) {
+        QFile file(m_skinDir.filePath(fileName));
+        ASSERT_TRUE(file.open(QIODevice::WriteOnly));
+        file.write(contents.toUtf8());
+    }
+
+    QDomElement openSkin() {
+        QFile file(m_skinDir.filePath("skin.xml"));
+        EXPECT_TRUE(file.open(QIODevice::ReadOnly));
+        EXPECT_TRUE(m_document.setContent(&file));
+        return m_document.documentElement();
+    }
+
+    QDomElement compileSkin(SkinCompiler* pCompiler) {
+        QDomElement skinDocument = openSkin();
+        SkinContext context(config(), m_skinDir.filePath("skin.xml"));
+        pCompiler->compile(skinDocument, &context);
+        return skinDocument;
+    }
+
+    QTemporaryDir m_skinDir;
+    QDomDocument m_document;
+};
+
+TEST_F(SkinCompilerTest, ExpandTemplatesAndVariables) {
+    SkinCompiler compiler(config(), m_skinDir.path());
+    QDomElement skinDocument = compileSkin(&compiler);
+
+    QDomElement children = skinDocument.firstChildElement("Children");
+    EXPECT_TRUE(children.firstChildElement("SetVariable").isNull());
+    EXPECT_TRUE(children.firstChildElement("Template").isNull());
+
+    QDomElement label = children.firstChildElement();
+    EXPECT_QSTRING_EQ("Label", label.tagName());
+    EXPECT_QSTRING_EQ("Deck 2", label.firstChildElement("Text").text());
+
+    // The variables of the template do not leak into the skin
+    QDomElement button = label.nextSiblingElement();
+    EXPECT_QSTRING_EQ("PushButton", button.tagName());
+    EXPECT_QSTRING_EQ("[Channel1]", button.firstChildElement("Group").text());
+
+    // The variables of a state only apply to the state
+    QDomElement state = button.firstChildElement("State");
+    EXPECT_TRUE(state.firstChildElement("SetVariable").isNull());
+    EXPECT_QSTRING_EQ("3", state.firstChildElement("Text").text());
+}
+
+TEST_F(SkinCompilerTest, SerializeTree) {
+    SkinCompiler compiler(config(), m_skinDir.path());
+    QDomElement skinDocument = compileSkin(&compiler);
+
+    const QByteArray data = SkinCompiler::serializeTree(skinDocument);
+    QDomDocument document;
+    QDomElement restored = SkinCompiler::deserializeTree(&document, data);
+    ASSERT_FALSE(restored.isNull());
+    EXPECT_EQ(data, SkinCompiler::serializeTree(restored));
+
+    // Corrupt data is rejected
+    EXPECT_TRUE(SkinCompiler::deserializeTree(&document, data.left(data.size() / 2)).isNull());
+}
+
+TEST_F(SkinCompilerTest, CacheIsInvalidatedByChanges) {
+    SkinCompiler compiler(config(), m_skinDir.path());
+    QDomElement skinDocument = compileSkin(&compiler);
+    EXPECT_TRUE(compiler.loadCached().isNull());
+    ASSERT_TRUE(compiler.saveCached(skinDocument));
+
+    SkinCompiler cachedCompiler(config(), m_skinDir.path());
+    QDomElement cachedSkinDocument = cachedCompiler.loadCached();
+    ASSERT_FALSE(cachedSkinDocument.isNull());
+    EXPECT_EQ(SkinCompiler::serializeTree(skinDocument),
+            SkinCompiler::serializeTree(cachedSkinDocument));
+    EXPECT_QSTRING_EQ(m_skinDir.path(), cachedCompiler.templatePath());
+
+    // Selecting another color scheme uses another cache entry
+    config()->set(ConfigKey("[Config]", "Scheme"), ConfigValue("Dark"));
+    EXPECT_TRUE(SkinCompiler(config(), m_skinDir.path()).loadCached().isNull());
+    config()->set(ConfigKey("[Config]", "Scheme"), ConfigValue(""));
+    EXPECT_FALSE(SkinCompiler(config(), m_skinDir.path()).loadCached().isNull());
+
+    // Templates are part of the key
+    writeFile("template.xml",
+            "<Template>"
+            "<Label><Text>Changed</Text></Label>"
+            "</Template>");
+    EXPECT_TRUE(SkinCompiler(config(), m_skinDir.path()).loadCached().isNull());
+}
+
+} // namespace
@@ -1,8 +1,18 @@
+#include <QFile>
+#include <QTemporaryDir>
 #include <QTemporaryFile>
 #include <QtDebug>
 
 #include "sources/audiosourcestereoproxy.h"
+#include "sources/seekindexcache.h"
+#ifdef __FFMPEG__
+#include "sources/soundsourceffmpeg.h"
+#endif
+#ifdef __MAD__
+#include "sources/soundsourcemp3.h"
+#endif
 #include "sources/soundsourceproxy.h"
+#include "test/librarytest.h"
 #include "test/mixxxtest.h"
 #include "track/track.h"
 #include "track/trackmetadata.h"
@@ -33,6 +43,17 @@ const SINT kMaxReadFrameCount = kBufferSizes[sizeof(kBufferSizes) / sizeof(kBuff
 
 const CSAMPLE kMaxDecodingError = 0.01f;
 
+// Enables the global seek index cache while in scope
+class ScopedSeekIndexCacheDirectory {
+  public:
+    explicit ScopedSeekIndexCacheDirectory(const QString& dirPath) {
+        mixxx::SeekIndexCache::setDirectory(dirPath);
+    }
+    ~ScopedSeekIndexCacheDirectory() {
+        mixxx::SeekIndexCache::setDirectory(QString());
+    }
+};
+
 } // anonymous namespace
 
 class SoundSourceProxyTest : public MixxxTest {
@@ -231,6 +252,45 @@ TEST_F(SoundSourceProxyTest, TOAL_TPE2) {
     EXPECT_TRUE(trackMetadata.getTrackInfo().getComment().isNull());
 }
 
+// Track objects can only be resolved with a GlobalTrackCache
+class SoundSourceProxyImportTest : public LibraryTest {
+};
+
+TEST_F(SoundSourceProxyImportTest, prepareTrackImport) {
+    const TrackFile trackFile(kTestDir, "cover-test-png.mp3");
+
+    const auto preparedImport = SoundSourceProxy::prepareTrackImport(trackFile);
+    ASSERT_TRUE(preparedImport.isValid());
+    auto pTrack = Track::newTemporary(trackFile);
+    EXPECT_TRUE(SoundSourceProxy(pTrack).updateTrackFromPreparedImport(preparedImport));
+    // The track has already been initialized
+    EXPECT_FALSE(SoundSourceProxy(pTrack).updateTrackFromPreparedImport(preparedImport));
+
+    // Same result as parsing the file for the track object
+    auto pExpectedTrack = Track::newTemporary(trackFile);
+    SoundSourceProxy(pExpectedTrack).updateTrackFromSource();
+    EXPECT_EQ(pExpectedTrack->getType(), pTrack->getType());
+    mixxx::TrackMetadata trackMetadata;
+    bool metadataSynchronized = false;
+    pTrack->readTrackMetadata(&trackMetadata, &metadataSynchronized);
+    mixxx::TrackMetadata expectedTrackMetadata;
+    pExpectedTrack->readTrackMetadata(&expectedTrackMetadata);
+    EXPECT_TRUE(metadataSynchronized);
+    EXPECT_EQ(expectedTrackMetadata, trackMetadata);
+    EXPECT_EQ(pExpectedTrack->getCoverInfo(), pTrack->getCoverInfo());
+}
+
+TEST_F(SoundSourceProxyImportTest, prepareTrackImportOfCachedTrack) {
+    const TrackFile trackFile(kTestDir, "cover-test-png.mp3");
+    const auto pTrack = getOrAddTrackByLocation(trackFile.location());
+    ASSERT_TRUE(pTrack);
+
+    // The file is parsed while the cache is locked instead
+    const auto preparedImport = SoundSourceProxy::prepareTrackImport(trackFile);
+    EXPECT_FALSE(preparedImport.isValid());
+    EXPECT_EQ(trackFile.location(), preparedImport.trackFile.location());
+}
+
 TEST_F(SoundSourceProxyTest, seekForwardBackward) {
     const SINT kReadFrameCount = 10000;
 
@@ -323,6 +383,148 @@ TEST_F(SoundSourceProxyTest, seekForwardBackward) {
     }
 }
 
+TEST_F(SoundSourceProxyTest, seekWithCachedSeekIndex) {
+    const SINT kReadFrameCount = 4096;
+    const SINT kSeekFrameStep = 33333;
+
+    // An artificial bitrate that is stored in the cached seek index to
+    // detect if the file is opened from the cached seek index
+    const auto kCachedBitrate = mixxx::audio::Bitrate(1234);
+
+    QTemporaryDir cacheDir;
+    ASSERT_TRUE(cacheDir.isValid());
+    const ScopedSeekIndexCacheDirectory scopedCacheDirectory(cacheDir.path());
+
+#ifdef __FFMPEG__
+    // The number of AAC files with a cached FFmpeg seek index
+    int ffmpegAacFileCount = 0;
+#endif
+
+    const QStringList filePaths = getFilePaths();
+    for (const auto& filePath : filePaths) {
+        qDebug() << "Seek with cached seek index test:" << filePath;
+
+        const auto fileUrl = QUrl::fromLocalFile(filePath);
+        const auto providerRegistrations =
+                SoundSourceProxy::allProviderRegistrationsForUrl(fileUrl);
+        for (const auto& providerRegistration : providerRegistrations) {
+            // Decoding the whole file creates the seek index
+            mixxx::AudioSourcePointer pContReadSource = openAudioSource(
+                    filePath,
+                    providerRegistration.getProvider());
+            if (!pContReadSource) {
+                // skip test file
+                continue;
+            }
+            mixxx::SampleBuffer contReadData(
+                    pContReadSource->getSignalInfo().frames2samples(
+                            pContReadSource->frameLength()));
+            const auto contSampleFrames =
+                    pContReadSource->readSampleFrames(
+                            mixxx::WritableSampleFrames(
+                                    pContReadSource->frameIndexRange(),
+                                    mixxx::SampleBuffer::WritableSlice(contReadData)));
+            ASSERT_EQ(pContReadSource->frameIndexRange(), contSampleFrames.frameIndexRange());
+
+            const QString providerName = providerRegistration.getProvider()->getDisplayName();
+            bool usesSeekIndexCache = false;
+#ifdef __MAD__
+            usesSeekIndexCache = providerName == mixxx::SoundSourceProviderMp3::kDisplayName;
+#endif
+            bool usesFFmpegSeekIndexCache = false;
+#ifdef __FFMPEG__
+            // Not all containers provide the byte offsets of their packets
+            usesFFmpegSeekIndexCache =
+                    providerName == mixxx::SoundSourceProviderFFmpeg::kDisplayName &&
+                    filePath.endsWith(QStringLiteral("-aac.m4a"));
+#endif
+            if (usesFFmpegSeekIndexCache) {
+                const mixxx::SeekIndexCache seekIndexCache(filePath, QStringLiteral("ffmpeg"));
+                ASSERT_TRUE(QFile::exists(seekIndexCache.cacheFilePath()));
+            }
+            if (usesSeekIndexCache) {
+                const mixxx::SeekIndexCache seekIndexCache(filePath, QStringLiteral("mp3"));
+                ASSERT_TRUE(QFile::exists(seekIndexCache.cacheFilePath()));
+                mixxx::SeekIndex seekIndex;
+                ASSERT_TRUE(seekIndexCache.load(&seekIndex));
+                ASSERT_NE(kCachedBitrate, pContReadSource->getBitrate());
+                seekIndex.bitrate = kCachedBitrate;
+                ASSERT_TRUE(seekIndexCache.save(seekIndex));
+            }
+
+            // Seeking uses the cached seek index if available
+            mixxx::AudioSourcePointer pSeekReadSource = openAudioSource(
+                    filePath,
+                    providerRegistration.getProvider());
+            ASSERT_FALSE(!pSeekReadSource);
+            ASSERT_EQ(pContReadSource->frameIndexRange(), pSeekReadSource->frameIndexRange());
+            if (usesSeekIndexCache) {
+                // The file has not been scanned again
+                EXPECT_EQ(kCachedBitrate, pSeekReadSource->getBitrate());
+            }
+            mixxx::SampleBuffer seekReadData(
+                    pSeekReadSource->getSignalInfo().frames2samples(kReadFrameCount));
+
+            // Jump backward and forward through the file
+            for (SINT step : {5, 1, 4, 2, 3}) {
+                const SINT frameIndex = pSeekReadSource->frameIndexMin() +
+                        (step * kSeekFrameStep) % pSeekReadSource->frameLength();
+                const auto readFrameIndexRange = intersect(
+                        mixxx::IndexRange::forward(frameIndex, kReadFrameCount),
+                        pSeekReadSource->frameIndexRange());
+                const auto seekSampleFrames =
+                        pSeekReadSource->readSampleFrames(
+                                mixxx::WritableSampleFrames(
+                                        readFrameIndexRange,
+                                        mixxx::SampleBuffer::WritableSlice(seekReadData)));
+                ASSERT_EQ(readFrameIndexRange, seekSampleFrames.frameIndexRange());
+                expectDecodedSamplesEqual(
+                        pSeekReadSource->getSignalInfo().frames2samples(
+                                readFrameIndexRange.length()),
+                        &contReadData[pContReadSource->getSignalInfo().frames2samples(
+                                readFrameIndexRange.start() -
+                                pContReadSource->frameIndexMin())],
+                        &seekReadData[0],
+                        "Decoding mismatch after seeking with seek index");
+            }
+
+#ifdef __FFMPEG__
+            if (usesFFmpegSeekIndexCache) {
+                // The mono test files are wrapped into a stereo proxy by
+                // openAudioSource(), so the source is opened directly
+                const auto pFFmpegSource = std::dynamic_pointer_cast<mixxx::SoundSourceFFmpeg>(
+                        providerRegistration.getProvider()->newSoundSource(fileUrl));
+                ASSERT_FALSE(!pFFmpegSource);
+                ASSERT_EQ(mixxx::AudioSource::OpenResult::Succeeded,
+                        pFFmpegSource->open(mixxx::AudioSource::OpenMode::Strict));
+                mixxx::SampleBuffer ffmpegReadData(
+                        pFFmpegSource->getSignalInfo().frames2samples(kReadFrameCount));
+                const auto readFrameIndexRange = intersect(
+                        mixxx::IndexRange::forward(
+                                pFFmpegSource->frameIndexMin() +
+                                        pFFmpegSource->frameLength() / 2,
+                                kReadFrameCount),
+                        pFFmpegSource->frameIndexRange());
+                const auto ffmpegSampleFrames =
+                        pFFmpegSource->readSampleFrames(
+                                mixxx::WritableSampleFrames(
+                                        readFrameIndexRange,
+                                        mixxx::SampleBuffer::WritableSlice(ffmpegReadData)));
+                ASSERT_EQ(readFrameIndexRange, ffmpegSampleFrames.frameIndexRange());
+                // The packet has been found in the cached seek index
+                // instead of seeking by timestamp
+                EXPECT_LT(0, pFFmpegSource->indexedSeekCount());
+                pFFmpegSource->close();
+                ++ffmpegAacFileCount;
+            }
+#endif
+        }
+    }
+#ifdef __FFMPEG__
+    EXPECT_LT(0, ffmpegAacFileCount);
+#endif
+}
+
 TEST_F(SoundSourceProxyTest, skipAndRead) {
     for (auto kReadFrameCount : kBufferSizes) {
         const QStringList filePaths = getFilePaths();
@@ -0,0 +1,209 @@
+#include <benchmark/benchmark.h>
+#include <gtest/gtest.h>
+
+#include <QSqlQuery>
+#include <QTemporaryDir>
+#include <QtDebug>
+
+#include "database/mixxxdb.h"
+#include "library/dao/playlistdao.h"
+#include "test/mixxxdbtest.h"
+#include "util/db/dbconnectionpool.h"
+#include "util/db/dbconnectionpooled.h"
+#include "util/db/dbconnectionpooler.h"
+#include "util/db/fwdsqlquery.h"
+#include "util/db/sqlstatementcache.h"
+#include "util/db/sqltransaction.h"
+
+namespace {
+
+const QString kSelectStatement = QStringLiteral("SELECT :value AS value");
+
+class SqlStatementCacheTest : public MixxxDbTest {
+  protected:
+    mixxx::SqlStatementCache* statementCache() const {
+        return mixxx::SqlStatementCache::forDatabase(dbConnection());
+    }
+};
+
+TEST_F(SqlStatementCacheTest, ReuseStatement) {
+    ASSERT_NE(nullptr, statementCache());
+    const int initialSize = statementCache()->size();
+    {
+        FwdSqlQuery query(dbConnection(), kSelectStatement);
+        query.bindValue(QStringLiteral(":value"), 1);
+        ASSERT_TRUE(query.execPrepared());
+        ASSERT_TRUE(query.next());
+        EXPECT_EQ(1, query.fieldValue(0).toInt());
+        // The statement is in use
+        EXPECT_EQ(initialSize, statementCache()->size());
+    }
+    EXPECT_EQ(initialSize + 1, statementCache()->size());
+    {
+        FwdSqlQuery query(dbConnection(), kSelectStatement);
+        EXPECT_EQ(initialSize, statementCache()->size());
+        // Values from the previous execution have been reset
+        ASSERT_TRUE(query.execPrepared());
+        ASSERT_TRUE(query.next());
+        EXPECT_TRUE(query.fieldValue(0).isNull());
+    }
+    EXPECT_EQ(initialSize + 1, statementCache()->size());
+}
+
+TEST_F(SqlStatementCacheTest, ConcurrentStatements) {
+    const int initialSize = statementCache()->size();
+    {
+        FwdSqlQuery query1(dbConnection(), kSelectStatement);
+        query1.bindValue(QStringLiteral(":value"), 1);
+        ASSERT_TRUE(query1.execPrepared());
+        FwdSqlQuery query2(dbConnection(), kSelectStatement);
+        query2.bindValue(QStringLiteral(":value"), 2);
+        ASSERT_TRUE(query2.execPrepared());
+        ASSERT_TRUE(query1.next());
+        ASSERT_TRUE(query2.next());
+        EXPECT_EQ(1, query1.fieldValue(0).toInt());
+        EXPECT_EQ(2, query2.fieldValue(0).toInt());
+    }
+    // Both queries share the same entry
+    EXPECT_EQ(initialSize + 1, statementCache()->size());
+}
+
+TEST_F(SqlStatementCacheTest, MoveQuery) {
+    const int initialSize = statementCache()->size();
+    {
+        FwdSqlQuery query(dbConnection(), kSelectStatement);
+        {
+            const FwdSqlQuery copiedQuery(query);
+        }
+        // Copies never return the statement
+        EXPECT_EQ(initialSize, statementCache()->size());
+        {
+            const FwdSqlQuery movedQuery(std::move(query));
+        }
+        EXPECT_EQ(initialSize + 1, statementCache()->size());
+    }
+    // Moved queries do not return the statement twice
+    EXPECT_EQ(initialSize + 1, statementCache()->size());
+}
+
+// Opens a database file in a temporary directory
+class BenchmarkDatabase {
+  public:
+    // The default settings of SQLite are restored for comparison
+    // if the performance profile is disabled.
+    explicit BenchmarkDatabase(bool performanceProfile)
+            : m_pDbConnectionPool(mixxx::DbConnectionPool::create(
+                      params(m_tempDir), connectionName())),
+              m_dbConnectionPooler(m_pDbConnectionPool) {
+        if (!performanceProfile) {
+            QSqlQuery query(database());
+            query.exec(QStringLiteral("PRAGMA journal_mode=DELETE"));
+            query.exec(QStringLiteral("PRAGMA synchronous=FULL"));
+            query.exec(QStringLiteral("PRAGMA mmap_size=0"));
+            query.exec(QStringLiteral("PRAGMA cache_size=-2000"));
+        }
+    }
+
+    QSqlDatabase database() const {
+        return mixxx::DbConnectionPooled(m_pDbConnectionPool);
+    }
+
+  private:
+    static mixxx::DbConnection::Params params(const QTemporaryDir& tempDir) {
+        mixxx::DbConnection::Params params;
+        params.type = QStringLiteral("QSQLITE");
+        params.filePath = tempDir.filePath(QStringLiteral("benchmark.sqlite"));
+        return params;
+    }
+
+    static QString connectionName() {
+        static int s_counter = 0;
+        return QStringLiteral("BENCHMARK%1").arg(++s_counter);
+    }
+
+    const QTemporaryDir m_tempDir;
+    const mixxx::DbConnectionPoolPtr m_pDbConnectionPool;
+    const mixxx::DbConnectionPooler m_dbConnectionPooler;
+};
+
+// Compares preparing a QSqlQuery for each execution with a cached
+// FwdSqlQuery. The statement is similar to the many lookups by id
+// in the DAOs.
+static void BM_SqlSelectById(benchmark::State& state) {
+    const BenchmarkDatabase benchmarkDatabase(true);
+    const QSqlDatabase database = benchmarkDatabase.database();
+    QSqlQuery(database).exec(QStringLiteral(
+            "CREATE TABLE Items (id INTEGER PRIMARY KEY, name TEXT)"));
+    QSqlQuery(database).exec(QStringLiteral(
+            "INSERT INTO Items (name) VALUES ('item')"));
+    const QString statement = QStringLiteral(
+            "SELECT Items.id, Items.name FROM Items "
+            "WHERE Items.id=:id AND Items.name IS NOT NULL");
+
+    const bool cached = state.range(0) != 0;
+    while (state.KeepRunning()) {
+        if (cached) {
+            FwdSqlQuery query(database, statement);
+            query.bindValue(QStringLiteral(":id"), 1);
+            query.execPrepared();
+            benchmark::DoNotOptimize(query.next());
+        } else {
+            QSqlQuery query(database);
+            query.setForwardOnly(true);
+            query.prepare(statement);
+            query.bindValue(QStringLiteral(":id"), 1);
+            query.exec();
+            benchmark::DoNotOptimize(query.next());
+        }
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_SqlSelectById)->Arg(0)->Arg(1);
+
+// Appends single tracks like adding tracks to Auto DJ or the history
+// playlist. Each track is appended in a separate transaction.
+static void BM_PlaylistDaoAppendTrack(benchmark::State& state) {
+    const BenchmarkDatabase benchmarkDatabase(state.range(0) != 0);
+    const QSqlDatabase database = benchmarkDatabase.database();
+    MixxxDb::initDatabaseSchema(database);
+    PlaylistDAO playlistDao;
+    playlistDao.initialize(database);
+    const int playlistId = playlistDao.createPlaylist(QStringLiteral("Benchmark"));
+
+    int trackId = 0;
+    while (state.KeepRunning()) {
+        playlistDao.appendTrackToPlaylist(TrackId(QVariant(++trackId)), playlistId);
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_PlaylistDaoAppendTrack)->Arg(0)->Arg(1);
+
+// Removes many tracks from a playlist in a single transaction
+static void BM_PlaylistDaoRemoveTracks(benchmark::State& state) {
+    const BenchmarkDatabase benchmarkDatabase(state.range(0) != 0);
+    const QSqlDatabase database = benchmarkDatabase.database();
+    MixxxDb::initDatabaseSchema(database);
+    PlaylistDAO playlistDao;
+    playlistDao.initialize(database);
+    const int playlistId = playlistDao.createPlaylist(QStringLiteral("Benchmark"));
+
+    const int trackCount = static_cast<int>(state.range(1));
+    QList<TrackId> trackIds;
+    QList<int> positions;
+    for (int i = 1; i <= trackCount; ++i) {
+        trackIds.append(TrackId(QVariant(i)));
+        positions.append(i);
+    }
+    while (state.KeepRunning()) {
+        state.PauseTiming();
+        playlistDao.appendTracksToPlaylist(trackIds, playlistId);
+        state.ResumeTiming();
+        playlistDao.removeTracksFromPlaylist(playlistId, positions);
+    }
+    state.SetItemsProcessed(state.iterations() * trackCount);
+}
+BENCHMARK(BM_PlaylistDaoRemoveTracks)
+        ->Args({0, 1000})
+        ->Args({1, 1000});
+
+} // namespace
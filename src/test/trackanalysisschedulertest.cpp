@@ -0,0 +1,50 @@
+#include "analyzer/trackanalysisscheduler.h"
+
+#include <gtest/gtest.h>
+
+namespace {
+
+constexpr int kMaxWorkerCount = 4;
+
+int adjust(int activeWorkerCount, bool anyDeckPlaying, double audioLatencyUsage) {
+    return TrackAnalysisScheduler::adjustActiveWorkerCount(
+            activeWorkerCount,
+            kMaxWorkerCount,
+            anyDeckPlaying,
+            audioLatencyUsage);
+}
+
+TEST(TrackAnalysisSchedulerTest, AllWorkersActiveWhileNotPlaying) {
+    EXPECT_EQ(kMaxWorkerCount, adjust(0, false, 0.0));
+    EXPECT_EQ(kMaxWorkerCount, adjust(1, false, 0.9));
+    EXPECT_EQ(kMaxWorkerCount, adjust(kMaxWorkerCount, false, 0.9));
+}
+
+TEST(TrackAnalysisSchedulerTest, RemoveWorkersOnHighEngineLoad) {
+    EXPECT_EQ(kMaxWorkerCount - 1, adjust(kMaxWorkerCount, true, 0.9));
+    EXPECT_EQ(1, adjust(2, true, 0.9));
+    // At least one worker remains active
+    EXPECT_EQ(1, adjust(1, true, 0.9));
+}
+
+TEST(TrackAnalysisSchedulerTest, AddWorkersOnLowEngineLoad) {
+    EXPECT_EQ(3, adjust(2, true, 0.1));
+    EXPECT_EQ(kMaxWorkerCount, adjust(kMaxWorkerCount, true, 0.1));
+}
+
+TEST(TrackAnalysisSchedulerTest, ResumeSingleWorkerAfterPause) {
+    // Workers that have been paused after an overload are resumed one
+    // by one and only added while the load is low
+    EXPECT_EQ(1, adjust(0, true, 0.1));
+    EXPECT_EQ(1, adjust(0, true, 0.45));
+    EXPECT_EQ(1, adjust(0, true, 0.9));
+    EXPECT_EQ(2, adjust(1, true, 0.1));
+    EXPECT_EQ(1, adjust(1, true, 0.45));
+}
+
+TEST(TrackAnalysisSchedulerTest, KeepWorkersOnModerateEngineLoad) {
+    EXPECT_EQ(2, adjust(2, true, 0.45));
+    EXPECT_EQ(kMaxWorkerCount, adjust(kMaxWorkerCount, true, 0.45));
+}
+
+} // namespace
@@ -0,0 +1,73 @@
+#include <gtest/gtest.h>
+
+#include <QtDebug>
+
+#include "waveform/waveform.h"
+
+namespace {
+
+WaveformPointer createWaveform() {
+    WaveformPointer pWaveform(new Waveform(44100, 44100 * 2 * 60 * 15, 441, -1));
+    WaveformData* pData = pWaveform->data();
+    for (int i = 0; i < pWaveform->getDataSize(); ++i) {
+        pData[i].filtered.low = static_cast<unsigned char>(i);
+        pData[i].filtered.mid = static_cast<unsigned char>(i >> 8);
+        pData[i].filtered.high = static_cast<unsigned char>(i >> 16);
+        pData[i].filtered.all = 0xFF;
+    }
+    pWaveform->setCompletion(pWaveform->getDataSize());
+    return pWaveform;
+}
+
+void expectEqualData(const Waveform& expected, const Waveform& actual) {
+    ASSERT_EQ(expected.getDataSize(), actual.getDataSize());
+    EXPECT_EQ(expected.getTextureStride(), actual.getTextureStride());
+    EXPECT_DOUBLE_EQ(expected.getAudioVisualRatio(), actual.getAudioVisualRatio());
+    for (int i = 0; i < expected.getDataSize(); ++i) {
+        ASSERT_EQ(expected.get(i).m_i, actual.get(i).m_i) << "at index " << i;
+    }
+}
+
+TEST(WaveformTest, BinaryRoundTrip) {
+    const WaveformPointer pWaveform = createWaveform();
+    const QByteArray data = pWaveform->toByteArray();
+    EXPECT_EQ(Waveform::kBinaryHeaderSize +
+                    pWaveform->getDataSize() * static_cast<int>(sizeof(WaveformData)),
+            data.size());
+
+    const Waveform loaded(data);
+    EXPECT_TRUE(loaded.isValid());
+    EXPECT_EQ(loaded.getDataSize(), loaded.getCompletion());
+    EXPECT_EQ(Waveform::SaveState::Saved, loaded.saveState());
+    expectEqualData(*pWaveform, loaded);
+}
+
+TEST(WaveformTest, ReadBinaryChunks) {
+    const WaveformPointer pWaveform = createWaveform();
+    const QByteArray data = pWaveform->toByteArray();
+    const auto* pData = reinterpret_cast<const uchar*>(data.constData());
+
+    const WaveformPointer pLoaded = Waveform::fromBinaryHeader(pData, data.size());
+    ASSERT_FALSE(pLoaded.isNull());
+    EXPECT_EQ(0, pLoaded->getCompletion());
+    EXPECT_NE(Waveform::SaveState::Saved, pLoaded->saveState());
+
+    int previousCompletion = 0;
+    while (pLoaded->readBinaryChunk(pData, data.size())) {
+        EXPECT_LT(previousCompletion, pLoaded->getCompletion());
+        EXPECT_GT(pLoaded->getDataSize(), pLoaded->getCompletion());
+        previousCompletion = pLoaded->getCompletion();
+    }
+    EXPECT_EQ(pLoaded->getDataSize(), pLoaded->getCompletion());
+    EXPECT_EQ(Waveform::SaveState::Saved, pLoaded->saveState());
+    expectEqualData(*pWaveform, *pLoaded);
+}
+
+TEST(WaveformTest, RejectTruncatedBinary) {
+    const QByteArray data = createWaveform()->toByteArray();
+    const auto* pData = reinterpret_cast<const uchar*>(data.constData());
+    EXPECT_TRUE(Waveform::fromBinaryHeader(pData, data.size() - 1).isNull());
+    EXPECT_TRUE(Waveform::fromBinaryHeader(pData, Waveform::kBinaryHeaderSize - 1).isNull());
+}
+
+} // namespace
@@ -0,0 +1,180 @@
+#include <benchmark/benchmark.h>
+#include <gtest/gtest.h>
+
+#include <QImage>
+#include <QPainter>
+#include <QtDebug>
+#include <cmath>
+#include <vector>
+
+#include "waveform/renderers/waveformtilecache.h"
+
+namespace {
+
+constexpr int kLength = 1000;
+constexpr int kBreadth = 100;
+
+// Similar to the Qt painter renderers: one line per column, each with
+// its own color
+void rasterizeColumns(QPainter* pPainter,
+        int firstColumn,
+        int columnCount,
+        double samplesPerColumn = 1.0) {
+    QPen pen;
+    pen.setCapStyle(Qt::FlatCap);
+    for (int x = 0; x < columnCount; ++x) {
+        const int sample = static_cast<int>((firstColumn + x) * samplesPerColumn);
+        const int height = (sample * 7919) % kBreadth;
+        pen.setColor(QColor::fromHsv(sample % 360, 255, 255));
+        pPainter->setPen(pen);
+        pPainter->drawLine(x, (kBreadth - height) / 2, x, (kBreadth + height) / 2);
+    }
+}
+
+class WaveformTileCacheTest : public testing::Test {
+  protected:
+    WaveformTileCacheTest()
+            : m_image(kLength, kBreadth, QImage::Format_ARGB32_Premultiplied),
+              m_rasterizedColumnCount(0) {
+    }
+
+    void draw(WaveformTileCache* pCache, double firstColumn, int completeColumns) {
+        QPainter painter(&m_image);
+        pCache->draw(&painter,
+                firstColumn,
+                kLength,
+                kBreadth,
+                1.0,
+                completeColumns,
+                [this](QPainter* pPainter, int tileFirstColumn, int columnCount) {
+                    m_rasterizedColumnCount += columnCount;
+                    rasterizeColumns(pPainter, tileFirstColumn, columnCount);
+                });
+    }
+
+    QImage m_image;
+    int m_rasterizedColumnCount;
+};
+
+TEST_F(WaveformTileCacheTest, ReuseTilesWhileScrolling) {
+    WaveformTileCache cache;
+    draw(&cache, 0.0, kLength * 10);
+    // Columns 0..999 are covered by 4 tiles
+    EXPECT_EQ(4, cache.rasterizedTileCount());
+    EXPECT_EQ(4 * WaveformTileCache::kTileWidth, m_rasterizedColumnCount);
+
+    draw(&cache, 100.5, kLength * 10);
+    EXPECT_EQ(5, cache.rasterizedTileCount());
+    draw(&cache, 0.0, kLength * 10);
+    EXPECT_EQ(5, cache.rasterizedTileCount());
+    EXPECT_EQ(5, cache.tileCount());
+
+    cache.clear();
+    draw(&cache, 0.0, kLength * 10);
+    EXPECT_EQ(9, cache.rasterizedTileCount());
+}
+
+TEST_F(WaveformTileCacheTest, RasterizeIncompleteTilesAgain) {
+    WaveformTileCache cache;
+    // Only the first tile is complete
+    draw(&cache, 0.0, WaveformTileCache::kTileWidth);
+    EXPECT_EQ(4, cache.rasterizedTileCount());
+    draw(&cache, 0.0, WaveformTileCache::kTileWidth);
+    EXPECT_EQ(4, cache.rasterizedTileCount());
+
+    draw(&cache, 0.0, WaveformTileCache::kTileWidth + 1);
+    EXPECT_EQ(7, cache.rasterizedTileCount());
+}
+
+TEST_F(WaveformTileCacheTest, EvictLeastRecentlyDrawnTiles) {
+    WaveformTileCache cache(6);
+    draw(&cache, 0.0, kLength * 10);
+    draw(&cache, 4.0 * WaveformTileCache::kTileWidth, kLength * 10);
+    EXPECT_EQ(6, cache.tileCount());
+    EXPECT_EQ(8, cache.rasterizedTileCount());
+
+    // The most recently drawn tiles are still cached
+    draw(&cache, 4.0 * WaveformTileCache::kTileWidth, kLength * 10);
+    EXPECT_EQ(8, cache.rasterizedTileCount());
+    draw(&cache, 0.0, kLength * 10);
+    EXPECT_EQ(10, cache.rasterizedTileCount());
+}
+
+TEST_F(WaveformTileCacheTest, QuantizeSamplesPerColumn) {
+    EXPECT_EQ(2.0, WaveformTileCache::quantizeSamplesPerColumn(2.0));
+    // Slight changes of the zoom, e.g. by the rate, map to the same value
+    EXPECT_EQ(2.0, WaveformTileCache::quantizeSamplesPerColumn(2.002));
+    EXPECT_EQ(2.0, WaveformTileCache::quantizeSamplesPerColumn(1.998));
+    for (double samplesPerPixel = 0.01; samplesPerPixel < 1000.0; samplesPerPixel *= 1.01) {
+        const double samplesPerColumn =
+                WaveformTileCache::quantizeSamplesPerColumn(samplesPerPixel);
+        EXPECT_NEAR(1.0, samplesPerColumn / samplesPerPixel, 0.003);
+    }
+}
+
+// The time for drawing a frame of range(0) scrolling decks. The zoom
+// and the gain vary slightly with every frame, like when the rate or
+// the gain of a deck is adjusted.
+static void BM_WaveformFrame(benchmark::State& state, bool useTiles) {
+    const int deckCount = static_cast<int>(state.range(0));
+    std::vector<QImage> images(deckCount,
+            QImage(kLength, kBreadth, QImage::Format_ARGB32_Premultiplied));
+    std::vector<WaveformTileCache> caches(deckCount);
+    std::vector<double> cachedSamplesPerColumn(deckCount, 0.0);
+
+    int frame = 0;
+    double offset = 0.0;
+    while (state.KeepRunning()) {
+        const double samplesPerPixel = 2.0 * (1.0 + 0.001 * std::sin(frame * 0.1));
+        const double gain = 1.0 + 0.1 * std::sin(frame * 0.05);
+        for (int deck = 0; deck < deckCount; ++deck) {
+            QPainter painter(&images[deck]);
+            if (useTiles) {
+                // Like WaveformRendererRGB
+                const double samplesPerColumn =
+                        WaveformTileCache::quantizeSamplesPerColumn(samplesPerPixel);
+                if (samplesPerColumn != cachedSamplesPerColumn[deck]) {
+                    caches[deck].clear();
+                    cachedSamplesPerColumn[deck] = samplesPerColumn;
+                }
+                const double columnWidth = samplesPerColumn / samplesPerPixel;
+                painter.scale(columnWidth, 1.0);
+                painter.translate(0.0, kBreadth / 2.0);
+                painter.scale(1.0, gain);
+                painter.translate(0.0, -kBreadth / 2.0);
+                caches[deck].draw(&painter,
+                        offset / samplesPerColumn,
+                        static_cast<int>(std::ceil(kLength / columnWidth)),
+                        kBreadth,
+                        1.0,
+                        kLength * 1000,
+                        [samplesPerColumn](QPainter* pPainter,
+                                int firstColumn,
+                                int columnCount) {
+                            rasterizeColumns(pPainter,
+                                    firstColumn,
+                                    columnCount,
+                                    samplesPerColumn);
+                        });
+            } else {
+                const double firstColumn = offset / samplesPerPixel;
+                painter.translate(-(firstColumn - std::floor(firstColumn)), 0.0);
+                painter.translate(0.0, kBreadth / 2.0);
+                painter.scale(1.0, gain);
+                painter.translate(0.0, -kBreadth / 2.0);
+                rasterizeColumns(&painter,
+                        static_cast<int>(std::floor(firstColumn)),
+                        kLength + 1,
+                        samplesPerPixel);
+            }
+        }
+        // About 4 pixels per frame at 60 fps
+        offset += 4.3 * samplesPerPixel;
+        ++frame;
+    }
+    state.SetItemsProcessed(state.iterations() * deckCount);
+}
+BENCHMARK_CAPTURE(BM_WaveformFrame, Direct, false)->Arg(1)->Arg(2)->Arg(4);
+BENCHMARK_CAPTURE(BM_WaveformFrame, Tiles, true)->Arg(1)->Arg(2)->Arg(4);
+
+} // namespace
@@ -7,7 +7,7 @@ class Counter {
     Counter(const QString& tag)
     : m_tag(tag) {
     }
-    void increment(int by=1) {
+    void increment(int by=1) const {
         Stat::ComputeFlags flags = Stat::experimentFlags(
             Stat::COUNT | Stat::SUM | Stat::AVERAGE |
             Stat::SAMPLE_VARIANCE | Stat::MIN | Stat::MAX);
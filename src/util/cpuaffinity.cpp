@@ -0,0 +1,99 @@
+#include "util/cpuaffinity.h"
+
+#include <QThread>
+
+#include "util/logger.h"
+
+#ifdef __LINUX__
+extern "C" {
+#include <pthread.h>
+#include <sched.h>
+}
+#endif
+
+namespace {
+
+mixxx::Logger kLogger("CpuAffinity");
+
+} // anonymous namespace
+
+#ifdef __LINUX__
+
+namespace {
+
+bool setCurrentThreadAffinity(const cpu_set_t& cpuSet) {
+    const int error = pthread_setaffinity_np(
+            pthread_self(), sizeof(cpu_set_t), &cpuSet);
+    if (error != 0) {
+        kLogger.warning()
+                << "Failed to set CPU affinity of thread"
+                << QThread::currentThread()->objectName()
+                << "- error code" << error;
+        return false;
+    }
+    return true;
+}
+
+} // anonymous namespace
+
+// static
+int CpuAffinity::availableCpuCount() {
+    cpu_set_t cpuSet;
+    CPU_ZERO(&cpuSet);
+    if (sched_getaffinity(0, sizeof(cpu_set_t), &cpuSet) != 0) {
+        return QThread::idealThreadCount();
+    }
+    return CPU_COUNT(&cpuSet);
+}
+
+// static
+bool CpuAffinity::pinCurrentThreadToCpu(int cpu) {
+    if (cpu < 0 || cpu >= CPU_SETSIZE) {
+        return false;
+    }
+    cpu_set_t cpuSet;
+    CPU_ZERO(&cpuSet);
+    CPU_SET(cpu, &cpuSet);
+    return setCurrentThreadAffinity(cpuSet);
+}
+
+// static
+bool CpuAffinity::excludeCpuFromCurrentThread(int cpu) {
+    if (cpu < 0 || cpu >= CPU_SETSIZE) {
+        return false;
+    }
+    cpu_set_t cpuSet;
+    CPU_ZERO(&cpuSet);
+    if (sched_getaffinity(0, sizeof(cpu_set_t), &cpuSet) != 0) {
+        return false;
+    }
+    CPU_CLR(cpu, &cpuSet);
+    if (CPU_COUNT(&cpuSet) == 0) {
+        // Don't starve the thread on single core machines
+        return false;
+    }
+    return setCurrentThreadAffinity(cpuSet);
+}
+
+#else
+
+// static
+int CpuAffinity::availableCpuCount() {
+    return QThread::idealThreadCount();
+}
+
+// static
+bool CpuAffinity::pinCurrentThreadToCpu(int cpu) {
+    Q_UNUSED(cpu);
+    kLogger.debug() << "Setting the CPU affinity is not supported";
+    return false;
+}
+
+// static
+bool CpuAffinity::excludeCpuFromCurrentThread(int cpu) {
+    Q_UNUSED(cpu);
+    kLogger.debug() << "Setting the CPU affinity is not supported";
+    return false;
+}
+
+#endif // __LINUX__
@@ -0,0 +1,17 @@
+#pragma once
+
+/// Restricts the CPU cores on which the current thread may run.
+///
+/// Currently only supported on Linux. On other platforms all functions
+/// return false and the thread remains unrestricted.
+class CpuAffinity {
+  public:
+    /// Returns the number of CPU cores available for the process.
+    static int availableCpuCount();
+
+    /// Runs the current thread only on the given core.
+    static bool pinCurrentThreadToCpu(int cpu);
+
+    /// Runs the current thread on all available cores except the given one.
+    static bool excludeCpuFromCurrentThread(int cpu);
+};
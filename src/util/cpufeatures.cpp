@@ -0,0 +1,128 @@
+#include "util/cpufeatures.h"
+
+#if defined(MIXXX_CPU_X86) && defined(_MSC_VER)
+#include <immintrin.h>
+#include <intrin.h>
+#endif
+
+namespace {
+
+#if defined(MIXXX_CPU_X86) && defined(_MSC_VER)
+
+struct CpuidFlags {
+    CpuidFlags()
+            : sse2(false),
+              avx2(false),
+              avx512(false) {
+        int info[4];
+        __cpuid(info, 0);
+        const int maxLeaf = info[0];
+        __cpuid(info, 1);
+        sse2 = (info[3] & (1 << 26)) != 0;
+        const bool osxsave = (info[2] & (1 << 27)) != 0;
+        if (!osxsave || maxLeaf < 7) {
+            return;
+        }
+        // The OS must save the YMM (bits 1 and 2) and for AVX-512
+        // additionally the ZMM registers (bits 5 to 7).
+        const unsigned long long xcr0 = _xgetbv(0);
+        const bool ymmEnabled = (xcr0 & 0x06) == 0x06;
+        const bool zmmEnabled = (xcr0 & 0xe6) == 0xe6;
+        __cpuidex(info, 7, 0);
+        avx2 = ymmEnabled && (info[1] & (1 << 5)) != 0;
+        avx512 = zmmEnabled && (info[1] & (1 << 16)) != 0;
+    }
+
+    bool sse2;
+    bool avx2;
+    bool avx512;
+};
+
+const CpuidFlags& cpuidFlags() {
+    static const CpuidFlags flags;
+    return flags;
+}
+
+#endif
+
+} // anonymous namespace
+
+// static
+bool CpuFeatures::isSupported(Isa isa) {
+    switch (isa) {
+    case Isa::Generic:
+        return true;
+    case Isa::Sse2:
+        return hasSse2();
+    case Isa::Avx2:
+        return hasAvx2();
+    case Isa::Avx512:
+        return hasAvx512();
+    case Isa::Neon:
+        return hasNeon();
+    }
+    return false;
+}
+
+// static
+const char* CpuFeatures::isaName(Isa isa) {
+    switch (isa) {
+    case Isa::Generic:
+        return "Generic";
+    case Isa::Sse2:
+        return "SSE2";
+    case Isa::Avx2:
+        return "AVX2";
+    case Isa::Avx512:
+        return "AVX-512";
+    case Isa::Neon:
+        return "NEON";
+    }
+    return "Unknown";
+}
+
+// static
+bool CpuFeatures::hasSse2() {
+#if defined(MIXXX_CPU_X86) && defined(_MSC_VER)
+    return cpuidFlags().sse2;
+#elif defined(MIXXX_CPU_X86)
+    __builtin_cpu_init(); // might be invoked during static initialization
+    return __builtin_cpu_supports("sse2");
+#else
+    return false;
+#endif
+}
+
+// static
+bool CpuFeatures::hasAvx2() {
+#if defined(MIXXX_CPU_X86) && defined(_MSC_VER)
+    return cpuidFlags().avx2;
+#elif defined(MIXXX_CPU_X86)
+    __builtin_cpu_init(); // might be invoked during static initialization
+    return __builtin_cpu_supports("avx2");
+#else
+    return false;
+#endif
+}
+
+// static
+bool CpuFeatures::hasAvx512() {
+#if defined(MIXXX_CPU_X86) && defined(_MSC_VER)
+    return cpuidFlags().avx512;
+#elif defined(MIXXX_CPU_X86)
+    __builtin_cpu_init(); // might be invoked during static initialization
+    return __builtin_cpu_supports("avx512f");
+#else
+    return false;
+#endif
+}
+
+// static
+bool CpuFeatures::hasNeon() {
+#if defined(MIXXX_CPU_NEON)
+    // Only available if the whole application has been compiled for NEON
+    return true;
+#else
+    return false;
+#endif
+}
@@ -0,0 +1,69 @@
+#pragma once
+
+// Compile-time detection of the instruction set architecture and helper
+// macros for functions that are compiled for a specific instruction set
+// and only invoked after checking CpuFeatures at runtime.
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define MIXXX_CPU_X86
+#endif
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#define MIXXX_CPU_NEON
+#endif
+
+#if defined(MIXXX_CPU_X86) && (defined(__GNUC__) || defined(__clang__))
+#define MIXXX_TARGET_SSE2 __attribute__((target("sse2")))
+#define MIXXX_TARGET_AVX2 __attribute__((target("avx2")))
+#define MIXXX_TARGET_AVX512 __attribute__((target("avx512f")))
+#else
+// MSVC allows to use all intrinsics without enabling them explicitly
+#define MIXXX_TARGET_SSE2
+#define MIXXX_TARGET_AVX2
+#define MIXXX_TARGET_AVX512
+#endif
+
+// Compiles all functions between MIXXX_PUSH_TARGET() and MIXXX_POP_TARGET()
+// for the given instruction set, e.g. for compiling the same source code
+// multiple times with the compiler's auto-vectorizer. Only available
+// if MIXXX_TARGET_PRAGMAS is defined.
+#if defined(MIXXX_CPU_X86) && (defined(__GNUC__) || defined(__clang__))
+#define MIXXX_TARGET_PRAGMAS
+#define MIXXX_PRAGMA(x) _Pragma(#x)
+#if defined(__clang__)
+#define MIXXX_PUSH_TARGET(isa) \
+    MIXXX_PRAGMA(clang attribute push(__attribute__((target(isa))), apply_to = function))
+#define MIXXX_POP_TARGET() MIXXX_PRAGMA(clang attribute pop)
+#else
+#define MIXXX_PUSH_TARGET(isa)     \
+    MIXXX_PRAGMA(GCC push_options) \
+    MIXXX_PRAGMA(GCC target(isa))
+#define MIXXX_POP_TARGET() MIXXX_PRAGMA(GCC pop_options)
+#endif
+#endif
+
+/// Detects the SIMD instruction sets that are supported by the CPU
+/// at runtime.
+///
+/// Our release builds only target the common baseline of each platform.
+/// Performance critical kernels are compiled for multiple instruction
+/// sets and select the best implementation once at startup.
+class CpuFeatures {
+  public:
+    enum class Isa {
+        // Compiled for the target of the build without enabling any
+        // additional instruction sets
+        Generic,
+        Sse2,
+        Avx2,
+        Avx512,
+        Neon,
+    };
+
+    static bool isSupported(Isa isa);
+    static const char* isaName(Isa isa);
+
+    static bool hasSse2();
+    static bool hasAvx2();
+    static bool hasAvx512();
+    static bool hasNeon();
+};
@@ -3,6 +3,7 @@
 #include <QSqlDatabase>
 #include <QtDebug>
 
+#include "util/db/sqlstatementcache.h"
 #include "util/string.h"
 
 namespace mixxx {
@@ -63,6 +64,7 @@ class DbConnection final {
 
     QSqlDatabase m_sqlDatabase;
     mixxx::StringCollator m_collator;
+    SqlStatementCache m_statementCache;
 };
 
 } // namespace mixxx
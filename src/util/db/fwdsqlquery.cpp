@@ -2,6 +2,7 @@
 
 #include <QSqlRecord>
 
+#include "util/db/sqlstatementcache.h"
 #include "util/performancetimer.h"
 #include "util/logger.h"
 #include "util/assert.h"
@@ -32,11 +33,22 @@ bool prepareQuery(QSqlQuery& query, const QString& statement) {
 
 } // anonymous namespace
 
+FwdSqlQuery::FwdSqlQuery()
+        : m_prepared(false) {
+}
+
 FwdSqlQuery::FwdSqlQuery(
         const QSqlDatabase& database,
         const QString& statement)
         : QSqlQuery(database),
-          m_prepared(prepareQuery(*this, statement)) {
+          m_prepared(false) {
+    auto* pStatementCache = mixxx::SqlStatementCache::forDatabase(database);
+    if (pStatementCache && pStatementCache->take(statement, this)) {
+        DEBUG_ASSERT(isForwardOnly());
+        m_prepared = true;
+    } else {
+        m_prepared = prepareQuery(*this, statement);
+    }
     if (!m_prepared) {
         DEBUG_ASSERT(!database.isOpen() || hasError());
         kLogger.critical()
@@ -44,7 +56,75 @@ FwdSqlQuery::FwdSqlQuery(
                 << statement
                 << ":"
                 << lastError();
+        return;
+    }
+    if (pStatementCache) {
+        m_cachedConnectionName = database.connectionName();
+        m_cachedStatement = statement;
+    }
+}
+
+FwdSqlQuery::FwdSqlQuery(const FwdSqlQuery& other)
+        : QSqlQuery(other),
+          m_prepared(other.m_prepared) {
+}
+
+FwdSqlQuery::FwdSqlQuery(FwdSqlQuery&& other)
+        : QSqlQuery(other), // implicitly shared (not moved)
+          m_prepared(other.m_prepared),
+          m_cachedConnectionName(std::move(other.m_cachedConnectionName)),
+          m_cachedStatement(std::move(other.m_cachedStatement)) {
+    other.m_cachedConnectionName.clear();
+    other.m_cachedStatement.clear();
+}
+
+FwdSqlQuery::~FwdSqlQuery() {
+    returnToStatementCache();
+}
+
+FwdSqlQuery& FwdSqlQuery::operator=(const FwdSqlQuery& other) {
+    if (this != &other) {
+        returnToStatementCache();
+        QSqlQuery::operator=(other);
+        m_prepared = other.m_prepared;
+    }
+    return *this;
+}
+
+FwdSqlQuery& FwdSqlQuery::operator=(FwdSqlQuery&& other) {
+    if (this != &other) {
+        returnToStatementCache();
+        QSqlQuery::operator=(other); // implicitly shared (not moved)
+        m_prepared = other.m_prepared;
+        m_cachedConnectionName = std::move(other.m_cachedConnectionName);
+        m_cachedStatement = std::move(other.m_cachedStatement);
+        other.m_cachedConnectionName.clear();
+        other.m_cachedStatement.clear();
+    }
+    return *this;
+}
+
+void FwdSqlQuery::returnToStatementCache() {
+    if (m_cachedStatement.isEmpty()) {
+        return;
+    }
+    const QString connectionName = std::move(m_cachedConnectionName);
+    const QString statement = std::move(m_cachedStatement);
+    m_cachedConnectionName.clear();
+    m_cachedStatement.clear();
+    if (hasError()) {
+        // Failed statements are prepared again
+        return;
+    }
+    // The connection might have been closed in the meantime
+    auto* pStatementCache = mixxx::SqlStatementCache::forConnection(connectionName);
+    if (!pStatementCache) {
+        return;
     }
+    // Release the locks and resources of the active statement.
+    // Otherwise readers would prevent checkpoints of the WAL.
+    finish();
+    pStatementCache->put(statement, *this);
 }
 
 bool FwdSqlQuery::execPrepared() {
@@ -30,6 +30,11 @@ class FwdSqlQuerySelectResult;
 //
 // Please note that forward-only queries don't provide information
 // about the size of the result set!
+//
+// Prepared statements are reused if the connection provides a
+// mixxx::SqlStatementCache. The statement is returned into the cache
+// when the query is destroyed. Only moving the query transfers this
+// responsibility, copies never return the statement.
 class FwdSqlQuery: protected QSqlQuery {
     friend class SqlQueryFinisher;
     friend class FwdSqlQuerySelectResult;
@@ -38,6 +43,12 @@ class FwdSqlQuery: protected QSqlQuery {
     FwdSqlQuery(
             const QSqlDatabase& database,
             const QString& statement);
+    FwdSqlQuery(const FwdSqlQuery& other);
+    FwdSqlQuery(FwdSqlQuery&& other);
+    ~FwdSqlQuery();
+
+    FwdSqlQuery& operator=(const FwdSqlQuery& other);
+    FwdSqlQuery& operator=(FwdSqlQuery&& other);
 
     bool isPrepared() const {
         return m_prepared;
@@ -106,7 +117,14 @@ class FwdSqlQuery: protected QSqlQuery {
     bool fieldValueBoolean(DbFieldIndex fieldIndex) const;
 
   private:
-    FwdSqlQuery() = default; // hidden
+    FwdSqlQuery(); // hidden
+
+    void returnToStatementCache();
 
     bool m_prepared;
+
+    // Only set while the statement needs to be returned into
+    // the cache of the connection
+    QString m_cachedConnectionName;
+    QString m_cachedStatement;
 };
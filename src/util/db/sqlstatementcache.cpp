@@ -0,0 +1,74 @@
+#include "util/db/sqlstatementcache.h"
+
+#include <QHash>
+
+#include "util/assert.h"
+
+namespace mixxx {
+
+namespace {
+
+// All caches that have been attached in the current thread
+// by connection name
+thread_local QHash<QString, SqlStatementCache*> t_statementCaches;
+
+} // anonymous namespace
+
+SqlStatementCache::SqlStatementCache(int maxSize)
+        : m_queries(maxSize) {
+}
+
+SqlStatementCache::~SqlStatementCache() {
+    DEBUG_ASSERT(m_connectionName.isEmpty());
+}
+
+//static
+SqlStatementCache* SqlStatementCache::forConnection(const QString& connectionName) {
+    if (t_statementCaches.isEmpty()) {
+        return nullptr;
+    }
+    return t_statementCaches.value(connectionName, nullptr);
+}
+
+void SqlStatementCache::attach(const QString& connectionName) {
+    DEBUG_ASSERT(m_connectionName.isEmpty());
+    DEBUG_ASSERT(!t_statementCaches.contains(connectionName));
+    m_connectionName = connectionName;
+    t_statementCaches.insert(m_connectionName, this);
+}
+
+void SqlStatementCache::detach() {
+    if (m_connectionName.isEmpty()) {
+        return;
+    }
+    DEBUG_ASSERT(t_statementCaches.value(m_connectionName) == this);
+    t_statementCaches.remove(m_connectionName);
+    m_connectionName.clear();
+    m_queries.clear();
+}
+
+bool SqlStatementCache::take(const QString& statement, QSqlQuery* pQuery) {
+    DEBUG_ASSERT(pQuery);
+    QSqlQuery* pCachedQuery = m_queries.take(statement);
+    if (!pCachedQuery) {
+        return false;
+    }
+    *pQuery = *pCachedQuery;
+    delete pCachedQuery;
+    // Values that have been bound during the previous execution
+    // must not leak into the next execution.
+    const int boundValueCount = pQuery->boundValues().size();
+    for (int i = 0; i < boundValueCount; ++i) {
+        pQuery->bindValue(i, QVariant());
+    }
+    return true;
+}
+
+void SqlStatementCache::put(const QString& statement, const QSqlQuery& query) {
+    DEBUG_ASSERT(!query.isActive());
+    // Replaces and finalizes a previous statement with the same
+    // SQL text that has been used concurrently
+    m_queries.insert(statement, new QSqlQuery(query));
+}
+
+} // namespace mixxx
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <QCache>
+#include <QSqlDatabase>
+#include <QSqlQuery>
+#include <QString>
+
+namespace mixxx {
+
+// Keeps prepared statements of a database connection for reuse,
+// keyed by their SQL text. Preparing a statement requires SQLite
+// to parse and plan the query, which is often more expensive than
+// actually executing simple queries.
+//
+// Each statement is handed out exclusively by take() and must be
+// returned by put() after use. The least recently used statements
+// are finalized if the cache is full.
+//
+// Database connections are thread-local and so are their caches.
+// The cache of a connection is only accessible from the thread
+// that has opened the connection.
+class SqlStatementCache final {
+  public:
+    explicit SqlStatementCache(int maxSize);
+    ~SqlStatementCache();
+
+    // Returns the cache of the connection if it has been registered
+    // in the current thread or nullptr otherwise.
+    static SqlStatementCache* forConnection(const QString& connectionName);
+    static SqlStatementCache* forDatabase(const QSqlDatabase& database) {
+        return forConnection(database.connectionName());
+    }
+
+    // Registers the cache for the connection in the current thread
+    void attach(const QString& connectionName);
+    // Unregisters the cache and finalizes all statements. Must be
+    // invoked before closing the connection.
+    void detach();
+
+    // Returns false if the statement is not cached
+    bool take(const QString& statement, QSqlQuery* pQuery);
+    // The query must have been prepared with the statement
+    void put(const QString& statement, const QSqlQuery& query);
+
+    int size() const {
+        return m_queries.size();
+    }
+
+  private:
+    SqlStatementCache(const SqlStatementCache&) = delete;
+    SqlStatementCache(SqlStatementCache&&) = delete;
+
+    QString m_connectionName;
+    QCache<QString, QSqlQuery> m_queries;
+};
+
+} // namespace mixxx
@@ -0,0 +1,109 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+
+#include "util/assert.h"
+#include "util/class.h"
+#include "util/math.h"
+
+namespace mixxx {
+
+/// A bounded, lock-free queue for multiple producers and multiple consumers.
+///
+/// Based on the well-known algorithm by Dmitry Vyukov. Each cell carries a
+/// sequence number that tells producers and consumers whether the cell is
+/// ready for writing or reading. Neither pushing nor popping allocates memory
+/// or blocks, i.e. both operations are safe to be called from the engine
+/// callback.
+///
+/// The value type must be default-constructible and copyable.
+template<typename T>
+class MpmcQueue final {
+  public:
+    /// The capacity is rounded up to the next power of 2.
+    explicit MpmcQueue(int capacity)
+            : m_capacity(roundUpToPowerOf2(math_max(capacity, 2))),
+              m_mask(m_capacity - 1),
+              m_cells(std::make_unique<Cell[]>(m_capacity)),
+              m_enqueuePos(0),
+              m_dequeuePos(0) {
+        for (size_t i = 0; i < m_capacity; ++i) {
+            m_cells[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    int capacity() const {
+        return static_cast<int>(m_capacity);
+    }
+
+    /// Returns false if the queue is full.
+    bool tryPush(const T& value) {
+        size_t pos = m_enqueuePos.load(std::memory_order_relaxed);
+        for (;;) {
+            Cell& cell = m_cells[pos & m_mask];
+            const size_t sequence = cell.sequence.load(std::memory_order_acquire);
+            const auto diff = static_cast<std::ptrdiff_t>(sequence) -
+                    static_cast<std::ptrdiff_t>(pos);
+            if (diff == 0) {
+                if (m_enqueuePos.compare_exchange_weak(
+                            pos, pos + 1, std::memory_order_relaxed)) {
+                    cell.value = value;
+                    cell.sequence.store(pos + 1, std::memory_order_release);
+                    return true;
+                }
+            } else if (diff < 0) {
+                return false;
+            } else {
+                pos = m_enqueuePos.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    /// Returns false if the queue is empty.
+    bool tryPop(T* pValue) {
+        DEBUG_ASSERT(pValue);
+        size_t pos = m_dequeuePos.load(std::memory_order_relaxed);
+        for (;;) {
+            Cell& cell = m_cells[pos & m_mask];
+            const size_t sequence = cell.sequence.load(std::memory_order_acquire);
+            const auto diff = static_cast<std::ptrdiff_t>(sequence) -
+                    static_cast<std::ptrdiff_t>(pos + 1);
+            if (diff == 0) {
+                if (m_dequeuePos.compare_exchange_weak(
+                            pos, pos + 1, std::memory_order_relaxed)) {
+                    *pValue = cell.value;
+                    cell.sequence.store(pos + m_mask + 1, std::memory_order_release);
+                    return true;
+                }
+            } else if (diff < 0) {
+                return false;
+            } else {
+                pos = m_dequeuePos.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+  private:
+    struct Cell {
+        std::atomic<size_t> sequence;
+        T value;
+    };
+
+    // Producers and consumers should modify different cache lines. Padding
+    // is used instead of alignas() to avoid depending on aligned operator new.
+    static constexpr size_t kCacheLineSize = 64;
+
+    const size_t m_capacity;
+    const size_t m_mask;
+    const std::unique_ptr<Cell[]> m_cells;
+    char m_padding0[kCacheLineSize];
+    std::atomic<size_t> m_enqueuePos;
+    char m_padding1[kCacheLineSize - sizeof(std::atomic<size_t>)];
+    std::atomic<size_t> m_dequeuePos;
+
+    DISALLOW_COPY_AND_ASSIGN(MpmcQueue);
+};
+
+} // namespace mixxx
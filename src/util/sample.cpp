@@ -1,3 +1,4 @@
+#include <atomic>
 #include <cstdlib>
 #include <cstddef>
 
@@ -10,15 +11,128 @@ typedef qint64 int64_t;
 typedef qint32 int32_t;
 #endif
 
-// LOOP VECTORIZED below marks the loops that are processed with the 128 bit SSE
-// registers as tested with gcc 4.6 and the -ftree-vectorizer-verbose=2 flag on
-// an Intel i5 CPU. When changing, be careful to not disturb the vectorization.
-// https://gcc.gnu.org/projects/tree-ssa/vectorization.html
-// This also utilizes AVX registers when compiled for a recent 64-bit CPU
-// using scons optimize=native.
+// The loops of most functions are located in util/sample_kernels.h. They are
+// compiled for the target of the build and additionally for newer instruction
+// sets that are only used if they are supported by the CPU at runtime. The
+// compiler's auto-vectorizer utilizes the wider registers of these instruction
+// sets without maintaining a separate implementation for each of them.
 
 namespace {
 
+struct SampleKernels {
+    void (*applyGain)(CSAMPLE*, CSAMPLE_GAIN, SINT);
+    void (*applyRampingGain)(CSAMPLE*, CSAMPLE_GAIN, CSAMPLE_GAIN, SINT);
+    void (*applyAlternatingGain)(CSAMPLE*, CSAMPLE, CSAMPLE, SINT);
+    void (*add)(CSAMPLE*, const CSAMPLE*, SINT);
+    void (*addWithGain)(CSAMPLE*, const CSAMPLE*, CSAMPLE_GAIN, SINT);
+    void (*addWithRampingGain)(CSAMPLE*, const CSAMPLE*, CSAMPLE_GAIN, CSAMPLE_GAIN, SINT);
+    void (*add2WithGain)(CSAMPLE*,
+            const CSAMPLE*,
+            CSAMPLE_GAIN,
+            const CSAMPLE*,
+            CSAMPLE_GAIN,
+            SINT);
+    void (*add3WithGain)(CSAMPLE*,
+            const CSAMPLE*,
+            CSAMPLE_GAIN,
+            const CSAMPLE*,
+            CSAMPLE_GAIN,
+            const CSAMPLE*,
+            CSAMPLE_GAIN,
+            SINT);
+    void (*copyWithGain)(CSAMPLE*, const CSAMPLE*, CSAMPLE_GAIN, SINT);
+    void (*copyWithRampingGain)(CSAMPLE*, const CSAMPLE*, CSAMPLE_GAIN, CSAMPLE_GAIN, SINT);
+    void (*convertS16ToFloat32)(CSAMPLE*, const SAMPLE*, SINT);
+    void (*convertFloat32ToS16)(SAMPLE*, const CSAMPLE*, SINT);
+    SampleUtil::CLIP_STATUS (*sumAbsPerChannel)(CSAMPLE*, CSAMPLE*, const CSAMPLE*, SINT);
+    CSAMPLE (*maxAbsAmplitude)(const CSAMPLE*, SINT);
+    void (*copyClampBuffer)(CSAMPLE*, const CSAMPLE*, SINT);
+    void (*interleaveBuffer)(CSAMPLE*, const CSAMPLE*, const CSAMPLE*, SINT);
+    void (*deinterleaveBuffer)(CSAMPLE*, CSAMPLE*, const CSAMPLE*, SINT);
+    void (*linearCrossfadeBuffersOut)(CSAMPLE*, const CSAMPLE*, SINT);
+    void (*linearCrossfadeBuffersIn)(CSAMPLE*, const CSAMPLE*, SINT);
+    void (*mixStereoToMono)(CSAMPLE*, const CSAMPLE*, SINT);
+    void (*copyMonoToDualMono)(CSAMPLE*, const CSAMPLE*, SINT);
+    void (*addMonoToStereo)(CSAMPLE*, const CSAMPLE*, SINT);
+};
+
+namespace generic {
+#include "util/sample_kernels.h"
+} // namespace generic
+
+#if defined(MIXXX_TARGET_PRAGMAS)
+
+MIXXX_PUSH_TARGET("sse2")
+namespace sse2 {
+#include "util/sample_kernels.h"
+} // namespace sse2
+MIXXX_POP_TARGET()
+
+MIXXX_PUSH_TARGET("avx2")
+namespace avx2 {
+#include "util/sample_kernels.h"
+} // namespace avx2
+MIXXX_POP_TARGET()
+
+MIXXX_PUSH_TARGET("avx512f")
+namespace avx512 {
+#include "util/sample_kernels.h"
+} // namespace avx512
+MIXXX_POP_TARGET()
+
+#endif // MIXXX_TARGET_PRAGMAS
+
+// Returns nullptr if the kernels have not been compiled for the
+// given instruction set.
+const SampleKernels* sampleKernelsForIsa(CpuFeatures::Isa isa) {
+    switch (isa) {
+    case CpuFeatures::Isa::Generic:
+        return &generic::kSampleKernels;
+#if defined(MIXXX_TARGET_PRAGMAS)
+    case CpuFeatures::Isa::Sse2:
+        return &sse2::kSampleKernels;
+    case CpuFeatures::Isa::Avx2:
+        return &avx2::kSampleKernels;
+    case CpuFeatures::Isa::Avx512:
+        return &avx512::kSampleKernels;
+#endif
+    default:
+        return nullptr;
+    }
+}
+
+CpuFeatures::Isa bestSampleKernelsIsa() {
+    for (const auto isa : {CpuFeatures::Isa::Avx512,
+                 CpuFeatures::Isa::Avx2,
+                 CpuFeatures::Isa::Sse2}) {
+        if (SampleUtil::isSupported(isa)) {
+            return isa;
+        }
+    }
+    return CpuFeatures::Isa::Generic;
+}
+
+struct ActiveSampleKernels {
+    ActiveSampleKernels()
+            : isa(bestSampleKernelsIsa()),
+              pKernels(sampleKernelsForIsa(isa)) {
+    }
+
+    std::atomic<CpuFeatures::Isa> isa;
+    std::atomic<const SampleKernels*> pKernels;
+};
+
+// Initialized on first use, because SampleUtil might already be
+// used during static initialization.
+ActiveSampleKernels& activeSampleKernels() {
+    static ActiveSampleKernels s_activeKernels;
+    return s_activeKernels;
+}
+
+inline const SampleKernels& kernels() {
+    return *activeSampleKernels().pKernels.load(std::memory_order_relaxed);
+}
+
 #ifdef __AVX__
 constexpr size_t kAlignment = 32;
 #else
@@ -36,6 +150,25 @@ constexpr bool useAlignedAlloc() {
 
 } // anonymous namespace
 
+// static
+CpuFeatures::Isa SampleUtil::isa() {
+    return activeSampleKernels().isa.load();
+}
+
+// static
+bool SampleUtil::isSupported(CpuFeatures::Isa isa) {
+    return sampleKernelsForIsa(isa) && CpuFeatures::isSupported(isa);
+}
+
+// static
+void SampleUtil::setIsa(CpuFeatures::Isa isa) {
+    VERIFY_OR_DEBUG_ASSERT(isSupported(isa)) {
+        return;
+    }
+    activeSampleKernels().isa.store(isa);
+    activeSampleKernels().pKernels.store(sampleKernelsForIsa(isa));
+}
+
 // static
 CSAMPLE* SampleUtil::alloc(SINT size) {
     // To speed up vectorization we align our sample buffers to 16-byte (128
@@ -117,10 +250,7 @@ void SampleUtil::applyGain(CSAMPLE* pBuffer, CSAMPLE_GAIN gain,
         return;
     }
 
-    // note: LOOP VECTORIZED.
-    for (SINT i = 0; i < numSamples; ++i) {
-        pBuffer[i] *= gain;
-    }
+    kernels().applyGain(pBuffer, gain, numSamples);
 }
 
 // static
@@ -134,23 +264,7 @@ void SampleUtil::applyRampingGain(CSAMPLE* pBuffer, CSAMPLE_GAIN old_gain,
         return;
     }
 
-    const CSAMPLE_GAIN gain_delta = (new_gain - old_gain)
-            / CSAMPLE_GAIN(numSamples / 2);
-    if (gain_delta != 0) {
-        const CSAMPLE_GAIN start_gain = old_gain + gain_delta;
-        // note: LOOP VECTORIZED.
-        for (int i = 0; i < numSamples / 2; ++i) {
-            const CSAMPLE_GAIN gain = start_gain + gain_delta * i;
-            // a loop counter i += 2 prevents vectorizing.
-            pBuffer[i * 2] *= gain;
-            pBuffer[i * 2 + 1] *= gain;
-        }
-    } else {
-        // note: LOOP VECTORIZED.
-        for (int i = 0; i < numSamples; ++i) {
-            pBuffer[i] *= old_gain;
-        }
-    }
+    kernels().applyRampingGain(pBuffer, old_gain, new_gain, numSamples);
 }
 
 // static
@@ -162,11 +276,7 @@ void SampleUtil::applyAlternatingGain(CSAMPLE* pBuffer, CSAMPLE gain1,
         return;
     }
 
-    // note: LOOP VECTORIZED.
-    for (SINT i = 0; i < numSamples / 2; ++i) {
-        pBuffer[i * 2] *= gain1;
-        pBuffer[i * 2 + 1] *= gain2;
-    }
+    kernels().applyAlternatingGain(pBuffer, gain1, gain2, numSamples);
 }
 
 
@@ -215,10 +325,7 @@ void SampleUtil::applyRampingAlternatingGain(CSAMPLE* pBuffer,
 void SampleUtil::add(CSAMPLE* M_RESTRICT pDest,
         const CSAMPLE* M_RESTRICT pSrc,
         SINT numSamples) {
-    // note: LOOP VECTORIZED.
-    for (SINT i = 0; i < numSamples; ++i) {
-        pDest[i] += pSrc[i];
-    }
+    kernels().add(pDest, pSrc, numSamples);
 }
 
 // static
@@ -229,10 +336,7 @@ void SampleUtil::addWithGain(CSAMPLE* M_RESTRICT pDest,
         return;
     }
 
-    // note: LOOP VECTORIZED.
-    for (SINT i = 0; i < numSamples; ++i) {
-        pDest[i] += pSrc[i] * gain;
-    }
+    kernels().addWithGain(pDest, pSrc, gain, numSamples);
 }
 
 void SampleUtil::addWithRampingGain(CSAMPLE* M_RESTRICT pDest,
@@ -243,22 +347,7 @@ void SampleUtil::addWithRampingGain(CSAMPLE* M_RESTRICT pDest,
         return;
     }
 
-    const CSAMPLE_GAIN gain_delta = (new_gain - old_gain)
-            / CSAMPLE_GAIN(numSamples / 2);
-    if (gain_delta != 0) {
-        const CSAMPLE_GAIN start_gain = old_gain + gain_delta;
-        // note: LOOP VECTORIZED.
-        for (int i = 0; i < numSamples / 2; ++i) {
-            const CSAMPLE_GAIN gain = start_gain + gain_delta * i;
-            pDest[i * 2] += pSrc[i * 2] * gain;
-            pDest[i * 2 + 1] += pSrc[i * 2 + 1] * gain;
-        }
-    } else {
-        // note: LOOP VECTORIZED.
-        for (int i = 0; i < numSamples; ++i) {
-            pDest[i] += pSrc[i] * old_gain;
-        }
-    }
+    kernels().addWithRampingGain(pDest, pSrc, old_gain, new_gain, numSamples);
 }
 
 // static
@@ -274,10 +363,7 @@ void SampleUtil::add2WithGain(CSAMPLE* M_RESTRICT pDest,
         return;
     }
 
-    // note: LOOP VECTORIZED.
-    for (int i = 0; i < numSamples; ++i) {
-        pDest[i] += pSrc1[i] * gain1 + pSrc2[i] * gain2;
-    }
+    kernels().add2WithGain(pDest, pSrc1, gain1, pSrc2, gain2, numSamples);
 }
 
 // static
@@ -297,10 +383,7 @@ void SampleUtil::add3WithGain(CSAMPLE* pDest,
         return;
     }
 
-    // note: LOOP VECTORIZED.
-    for (SINT i = 0; i < numSamples; ++i) {
-        pDest[i] += pSrc1[i] * gain1 + pSrc2[i] * gain2 + pSrc3[i] * gain3;
-    }
+    kernels().add3WithGain(pDest, pSrc1, gain1, pSrc2, gain2, pSrc3, gain3, numSamples);
 }
 
 // static
@@ -316,10 +399,7 @@ void SampleUtil::copyWithGain(CSAMPLE* M_RESTRICT pDest,
         return;
     }
 
-    // note: LOOP VECTORIZED.
-    for (SINT i = 0; i < numSamples; ++i) {
-        pDest[i] = pSrc[i] * gain;
-    }
+    kernels().copyWithGain(pDest, pSrc, gain, numSamples);
 
     // OR! need to test which fares better
     // copy(pDest, pSrc, iNumSamples);
@@ -341,22 +421,7 @@ void SampleUtil::copyWithRampingGain(CSAMPLE* M_RESTRICT pDest,
         return;
     }
 
-    const CSAMPLE_GAIN gain_delta = (new_gain - old_gain)
-            / CSAMPLE_GAIN(numSamples / 2);
-    if (gain_delta != 0) {
-        const CSAMPLE_GAIN start_gain = old_gain + gain_delta;
-        // note: LOOP VECTORIZED only with "int i"
-        for (int i = 0; i < numSamples / 2; ++i) {
-            const CSAMPLE_GAIN gain = start_gain + gain_delta * i;
-            pDest[i * 2] = pSrc[i * 2] * gain;
-            pDest[i * 2 + 1] = pSrc[i * 2 + 1] * gain;
-        }
-    } else {
-        // note: LOOP VECTORIZED.
-        for (SINT i = 0; i < numSamples; ++i) {
-            pDest[i] = pSrc[i] * old_gain;
-        }
-    }
+    kernels().copyWithRampingGain(pDest, pSrc, old_gain, new_gain, numSamples);
 
     // OR! need to test which fares better
     // copy(pDest, pSrc, iNumSamples);
@@ -370,62 +435,31 @@ void SampleUtil::convertS16ToFloat32(CSAMPLE* M_RESTRICT pDest,
     // is the highest valid sample. Note that this means that although some
     // sample values convert to -1.0, none will convert to +1.0.
     DEBUG_ASSERT(-SAMPLE_MIN >= SAMPLE_MAX);
-    const CSAMPLE kConversionFactor = -SAMPLE_MIN;
-    // note: LOOP VECTORIZED.
-    for (SINT i = 0; i < numSamples; ++i) {
-        pDest[i] = CSAMPLE(pSrc[i]) / kConversionFactor;
-    }
+    kernels().convertS16ToFloat32(pDest, pSrc, numSamples);
 }
 
 //static
 void SampleUtil::convertFloat32ToS16(SAMPLE* pDest, const CSAMPLE* pSrc,
         SINT numSamples) {
     DEBUG_ASSERT(-SAMPLE_MIN >= SAMPLE_MAX);
-    const CSAMPLE kConversionFactor = -SAMPLE_MIN;
-    // note: LOOP VECTORIZED only with "int i"
-    for (int i = 0; i < numSamples; ++i) {
-        pDest[i] = SAMPLE(pSrc[i] * kConversionFactor);
-    }
+    kernels().convertFloat32ToS16(pDest, pSrc, numSamples);
 }
 
 // static
 SampleUtil::CLIP_STATUS SampleUtil::sumAbsPerChannel(CSAMPLE* pfAbsL,
         CSAMPLE* pfAbsR, const CSAMPLE* pBuffer, SINT numSamples) {
-    CSAMPLE fAbsL = CSAMPLE_ZERO;
-    CSAMPLE fAbsR = CSAMPLE_ZERO;
-    CSAMPLE clippedL = 0;
-    CSAMPLE clippedR = 0;
-
-    // note: LOOP VECTORIZED.
-    for (SINT i = 0; i < numSamples / 2; ++i) {
-        CSAMPLE absl = fabs(pBuffer[i * 2]);
-        fAbsL += absl;
-        clippedL += absl > CSAMPLE_PEAK ? 1 : 0;
-        CSAMPLE absr = fabs(pBuffer[i * 2 + 1]);
-        fAbsR += absr;
-        // Replacing the code with a bool clipped will prevent vetorizing
-        clippedR += absr > CSAMPLE_PEAK ? 1 : 0;
-    }
+    return kernels().sumAbsPerChannel(pfAbsL, pfAbsR, pBuffer, numSamples);
+}
 
-    *pfAbsL = fAbsL;
-    *pfAbsR = fAbsR;
-    SampleUtil::CLIP_STATUS clipping = SampleUtil::NO_CLIPPING;
-    if (clippedL > 0) {
-        clipping |= SampleUtil::CLIPPING_LEFT;
-    }
-    if (clippedR > 0) {
-        clipping |= SampleUtil::CLIPPING_RIGHT;
-    }
-    return clipping;
+// static
+CSAMPLE SampleUtil::maxAbsAmplitude(const CSAMPLE* pBuffer, SINT numSamples) {
+    return kernels().maxAbsAmplitude(pBuffer, numSamples);
 }
 
 // static
 void SampleUtil::copyClampBuffer(CSAMPLE* M_RESTRICT pDest,
         const CSAMPLE* M_RESTRICT pSrc, SINT iNumSamples) {
-    // note: LOOP VECTORIZED.
-    for (SINT i = 0; i < iNumSamples; ++i) {
-        pDest[i] = clampSample(pSrc[i]);
-    }
+    kernels().copyClampBuffer(pDest, pSrc, iNumSamples);
 }
 
 // static
@@ -433,11 +467,7 @@ void SampleUtil::interleaveBuffer(CSAMPLE* M_RESTRICT pDest,
         const CSAMPLE* M_RESTRICT pSrc1,
         const CSAMPLE* M_RESTRICT pSrc2,
         SINT numFrames) {
-    // note: LOOP VECTORIZED.
-    for (SINT i = 0; i < numFrames; ++i) {
-        pDest[2 * i] = pSrc1[i];
-        pDest[2 * i + 1] = pSrc2[i];
-    }
+    kernels().interleaveBuffer(pDest, pSrc1, pSrc2, numFrames);
 }
 
 // static
@@ -445,11 +475,7 @@ void SampleUtil::deinterleaveBuffer(CSAMPLE* M_RESTRICT pDest1,
         CSAMPLE* M_RESTRICT pDest2,
         const CSAMPLE* M_RESTRICT pSrc,
         SINT numFrames) {
-    // note: LOOP VECTORIZED.
-    for (SINT i = 0; i < numFrames; ++i) {
-        pDest1[i] = pSrc[i * 2];
-        pDest2[i] = pSrc[i * 2 + 1];
-    }
+    kernels().deinterleaveBuffer(pDest1, pDest2, pSrc, numFrames);
 }
 
 // static
@@ -457,17 +483,7 @@ void SampleUtil::linearCrossfadeBuffersOut(
         CSAMPLE* pDestSrcFadeOut,
         const CSAMPLE* pSrcFadeIn,
         SINT numSamples) {
-    // M_RESTRICT unoptimizes the function for some reason.
-    const CSAMPLE_GAIN cross_inc = CSAMPLE_GAIN_ONE
-            / CSAMPLE_GAIN(numSamples / 2);
-    // note: LOOP VECTORIZED. only with "int i"
-    for (int i = 0; i < numSamples / 2; ++i) {
-        const CSAMPLE_GAIN cross_mix = cross_inc * i;
-        pDestSrcFadeOut[i * 2] *= (CSAMPLE_GAIN_ONE - cross_mix);
-        pDestSrcFadeOut[i * 2] += pSrcFadeIn[i * 2] * cross_mix;
-        pDestSrcFadeOut[i * 2 + 1] *= (CSAMPLE_GAIN_ONE - cross_mix);
-        pDestSrcFadeOut[i * 2 + 1] += pSrcFadeIn[i * 2 + 1] * cross_mix;
-    }
+    kernels().linearCrossfadeBuffersOut(pDestSrcFadeOut, pSrcFadeIn, numSamples);
 }
 
 // static
@@ -475,28 +491,13 @@ void SampleUtil::linearCrossfadeBuffersIn(
         CSAMPLE* pDestSrcFadeIn,
         const CSAMPLE* pSrcFadeOut,
         SINT numSamples) {
-    // M_RESTRICT unoptimizes the function for some reason.
-    const CSAMPLE_GAIN cross_inc = CSAMPLE_GAIN_ONE / CSAMPLE_GAIN(numSamples / 2);
-    // note: LOOP VECTORIZED. only with "int i"
-    for (int i = 0; i < numSamples / 2; ++i) {
-        const CSAMPLE_GAIN cross_mix = cross_inc * i;
-        pDestSrcFadeIn[i * 2] *= cross_mix;
-        pDestSrcFadeIn[i * 2] += pSrcFadeOut[i * 2] * (CSAMPLE_GAIN_ONE - cross_mix);
-        pDestSrcFadeIn[i * 2 + 1] *= cross_mix;
-        pDestSrcFadeIn[i * 2 + 1] += pSrcFadeOut[i * 2 + 1] * (CSAMPLE_GAIN_ONE - cross_mix);
-    }
+    kernels().linearCrossfadeBuffersIn(pDestSrcFadeIn, pSrcFadeOut, numSamples);
 }
 
 // static
 void SampleUtil::mixStereoToMono(CSAMPLE* pDest, const CSAMPLE* pSrc,
         SINT numSamples) {
-    const CSAMPLE_GAIN mixScale = CSAMPLE_GAIN_ONE
-            / (CSAMPLE_GAIN_ONE + CSAMPLE_GAIN_ONE);
-    // note: LOOP VECTORIZED
-    for (SINT i = 0; i < numSamples / 2; ++i) {
-        pDest[i * 2] = (pSrc[i * 2] + pSrc[i * 2 + 1]) * mixScale;
-        pDest[i * 2 + 1] = pDest[i * 2];
-    }
+    kernels().mixStereoToMono(pDest, pSrc, numSamples);
 }
 
 // static
@@ -514,25 +515,13 @@ void SampleUtil::doubleMonoToDualMono(CSAMPLE* pBuffer, SINT numFrames) {
 // static
 void SampleUtil::copyMonoToDualMono(CSAMPLE* M_RESTRICT pDest,
         const CSAMPLE* M_RESTRICT pSrc, SINT numFrames) {
-    // forward loop
-    // note: LOOP VECTORIZED
-    for (SINT i = 0; i < numFrames; ++i) {
-        const CSAMPLE s = pSrc[i];
-        pDest[i * 2] = s;
-        pDest[i * 2 + 1] = s;
-    }
+    kernels().copyMonoToDualMono(pDest, pSrc, numFrames);
 }
 
 // static
 void SampleUtil::addMonoToStereo(CSAMPLE* M_RESTRICT pDest,
         const CSAMPLE* M_RESTRICT pSrc, SINT numFrames) {
-    // forward loop
-    // note: LOOP VECTORIZED
-    for (SINT i = 0; i < numFrames; ++i) {
-        const CSAMPLE s = pSrc[i];
-        pDest[i * 2] += s;
-        pDest[i * 2 + 1] += s;
-    }
+    kernels().addMonoToStereo(pDest, pSrc, numFrames);
 }
 
 // static
@@ -5,6 +5,7 @@
 
 #include <QFlags>
 
+#include "util/cpufeatures.h"
 #include "util/types.h"
 #include "util/platform.h"
 
@@ -25,6 +26,17 @@ class SampleUtil {
     // This is some legacy, we cannot easily revert.
     static constexpr double kPlayPositionChannels = 2.0;
 
+    // Samples below this amplitude (-120 dBFS) are considered silent
+    static constexpr CSAMPLE kSilenceThreshold = 1e-6f;
+
+    // The instruction set of the implementation that is used by most of
+    // the functions below. The best instruction set that is supported by
+    // the CPU is selected on first use.
+    static CpuFeatures::Isa isa();
+    static bool isSupported(CpuFeatures::Isa isa);
+    // Only intended for testing and benchmarking!
+    static void setIsa(CpuFeatures::Isa isa);
+
     // Allocated a buffer of CSAMPLE's with length size. Ensures that the buffer
     // is 16-byte aligned for SSE enhancement.
     static CSAMPLE* alloc(SINT size);
@@ -201,6 +213,15 @@ class SampleUtil {
     static CLIP_STATUS sumAbsPerChannel(CSAMPLE* pfAbsL, CSAMPLE* pfAbsR,
             const CSAMPLE* pBuffer, SINT numSamples);
 
+    // Returns the largest absolute value of all samples in pBuffer.
+    static CSAMPLE maxAbsAmplitude(const CSAMPLE* pBuffer, SINT numSamples);
+
+    // Returns true if all samples in pBuffer are below kSilenceThreshold,
+    // i.e. the buffer contains nothing audible.
+    static bool isSilent(const CSAMPLE* pBuffer, SINT numSamples) {
+        return maxAbsAmplitude(pBuffer, numSamples) < kSilenceThreshold;
+    }
+
     // Copies every sample in pSrc to pDest, limiting the values in pDest
     // to the valid range of CSAMPLE. If pDest and pSrc are aliases, will
     // not copy will only clamp. Returns true if any samples in pSrc were
@@ -0,0 +1,347 @@
+// Intentionally without include guard!
+//
+// The loops of the SampleUtil functions that are compiled once for each
+// instruction set. This file is included multiple times by util/sample.cpp,
+// each time into a different namespace and with a different target. It must
+// not include any other headers.
+//
+// Special cases like a gain of 0 or 1 are handled by the public functions
+// in SampleUtil before invoking the kernels.
+//
+// All instruction sets must produce bit-identical results. The file is
+// compiled without contracting multiply-adds into FMA instructions and
+// without reordering floating point operations, see CMakeLists.txt.
+//
+// LOOP VECTORIZED below marks the loops that are processed with the 128 bit SSE
+// registers as tested with gcc 4.6 and the -ftree-vectorizer-verbose=2 flag on
+// an Intel i5 CPU. When changing, be careful to not disturb the vectorization.
+// https://gcc.gnu.org/projects/tree-ssa/vectorization.html
+
+void applyGain(CSAMPLE* pBuffer, CSAMPLE_GAIN gain, SINT numSamples) {
+    // note: LOOP VECTORIZED.
+    for (SINT i = 0; i < numSamples; ++i) {
+        pBuffer[i] *= gain;
+    }
+}
+
+void applyRampingGain(CSAMPLE* pBuffer, CSAMPLE_GAIN old_gain,
+        CSAMPLE_GAIN new_gain, SINT numSamples) {
+    const CSAMPLE_GAIN gain_delta = (new_gain - old_gain)
+            / CSAMPLE_GAIN(numSamples / 2);
+    if (gain_delta != 0) {
+        const CSAMPLE_GAIN start_gain = old_gain + gain_delta;
+        // note: LOOP VECTORIZED.
+        for (int i = 0; i < numSamples / 2; ++i) {
+            const CSAMPLE_GAIN gain = start_gain + gain_delta * i;
+            // a loop counter i += 2 prevents vectorizing.
+            pBuffer[i * 2] *= gain;
+            pBuffer[i * 2 + 1] *= gain;
+        }
+    } else {
+        // note: LOOP VECTORIZED.
+        for (int i = 0; i < numSamples; ++i) {
+            pBuffer[i] *= old_gain;
+        }
+    }
+}
+
+void applyAlternatingGain(CSAMPLE* pBuffer, CSAMPLE gain1,
+        CSAMPLE gain2, SINT numSamples) {
+    // note: LOOP VECTORIZED.
+    for (SINT i = 0; i < numSamples / 2; ++i) {
+        pBuffer[i * 2] *= gain1;
+        pBuffer[i * 2 + 1] *= gain2;
+    }
+}
+
+void add(CSAMPLE* M_RESTRICT pDest,
+        const CSAMPLE* M_RESTRICT pSrc,
+        SINT numSamples) {
+    // note: LOOP VECTORIZED.
+    for (SINT i = 0; i < numSamples; ++i) {
+        pDest[i] += pSrc[i];
+    }
+}
+
+void addWithGain(CSAMPLE* M_RESTRICT pDest,
+        const CSAMPLE* M_RESTRICT pSrc,
+        CSAMPLE_GAIN gain, SINT numSamples) {
+    // note: LOOP VECTORIZED.
+    for (SINT i = 0; i < numSamples; ++i) {
+        pDest[i] += pSrc[i] * gain;
+    }
+}
+
+void addWithRampingGain(CSAMPLE* M_RESTRICT pDest,
+        const CSAMPLE* M_RESTRICT pSrc,
+        CSAMPLE_GAIN old_gain, CSAMPLE_GAIN new_gain,
+        SINT numSamples) {
+    const CSAMPLE_GAIN gain_delta = (new_gain - old_gain)
+            / CSAMPLE_GAIN(numSamples / 2);
+    if (gain_delta != 0) {
+        const CSAMPLE_GAIN start_gain = old_gain + gain_delta;
+        // note: LOOP VECTORIZED.
+        for (int i = 0; i < numSamples / 2; ++i) {
+            const CSAMPLE_GAIN gain = start_gain + gain_delta * i;
+            pDest[i * 2] += pSrc[i * 2] * gain;
+            pDest[i * 2 + 1] += pSrc[i * 2 + 1] * gain;
+        }
+    } else {
+        // note: LOOP VECTORIZED.
+        for (int i = 0; i < numSamples; ++i) {
+            pDest[i] += pSrc[i] * old_gain;
+        }
+    }
+}
+
+void add2WithGain(CSAMPLE* M_RESTRICT pDest,
+        const CSAMPLE* M_RESTRICT pSrc1, CSAMPLE_GAIN gain1,
+        const CSAMPLE* M_RESTRICT pSrc2, CSAMPLE_GAIN gain2,
+        SINT numSamples) {
+    // note: LOOP VECTORIZED.
+    for (int i = 0; i < numSamples; ++i) {
+        pDest[i] += pSrc1[i] * gain1 + pSrc2[i] * gain2;
+    }
+}
+
+void add3WithGain(CSAMPLE* pDest,
+        const CSAMPLE* M_RESTRICT pSrc1, CSAMPLE_GAIN gain1,
+        const CSAMPLE* M_RESTRICT pSrc2, CSAMPLE_GAIN gain2,
+        const CSAMPLE* M_RESTRICT pSrc3, CSAMPLE_GAIN gain3,
+        SINT numSamples) {
+    // note: LOOP VECTORIZED.
+    for (SINT i = 0; i < numSamples; ++i) {
+        pDest[i] += pSrc1[i] * gain1 + pSrc2[i] * gain2 + pSrc3[i] * gain3;
+    }
+}
+
+void copyWithGain(CSAMPLE* M_RESTRICT pDest,
+        const CSAMPLE* M_RESTRICT pSrc,
+        CSAMPLE_GAIN gain, SINT numSamples) {
+    // note: LOOP VECTORIZED.
+    for (SINT i = 0; i < numSamples; ++i) {
+        pDest[i] = pSrc[i] * gain;
+    }
+}
+
+void copyWithRampingGain(CSAMPLE* M_RESTRICT pDest,
+        const CSAMPLE* M_RESTRICT pSrc,
+        CSAMPLE_GAIN old_gain,
+        CSAMPLE_GAIN new_gain,
+        SINT numSamples) {
+    const CSAMPLE_GAIN gain_delta = (new_gain - old_gain)
+            / CSAMPLE_GAIN(numSamples / 2);
+    if (gain_delta != 0) {
+        const CSAMPLE_GAIN start_gain = old_gain + gain_delta;
+        // note: LOOP VECTORIZED only with "int i"
+        for (int i = 0; i < numSamples / 2; ++i) {
+            const CSAMPLE_GAIN gain = start_gain + gain_delta * i;
+            pDest[i * 2] = pSrc[i * 2] * gain;
+            pDest[i * 2 + 1] = pSrc[i * 2 + 1] * gain;
+        }
+    } else {
+        // note: LOOP VECTORIZED.
+        for (SINT i = 0; i < numSamples; ++i) {
+            pDest[i] = pSrc[i] * old_gain;
+        }
+    }
+}
+
+void convertS16ToFloat32(CSAMPLE* M_RESTRICT pDest,
+        const SAMPLE* M_RESTRICT pSrc, SINT numSamples) {
+    const CSAMPLE kConversionFactor = -SAMPLE_MIN;
+    // note: LOOP VECTORIZED.
+    for (SINT i = 0; i < numSamples; ++i) {
+        pDest[i] = CSAMPLE(pSrc[i]) / kConversionFactor;
+    }
+}
+
+void convertFloat32ToS16(SAMPLE* pDest, const CSAMPLE* pSrc,
+        SINT numSamples) {
+    const CSAMPLE kConversionFactor = -SAMPLE_MIN;
+    // note: LOOP VECTORIZED only with "int i"
+    for (int i = 0; i < numSamples; ++i) {
+        pDest[i] = SAMPLE(pSrc[i] * kConversionFactor);
+    }
+}
+
+SampleUtil::CLIP_STATUS sumAbsPerChannel(CSAMPLE* pfAbsL,
+        CSAMPLE* pfAbsR, const CSAMPLE* pBuffer, SINT numSamples) {
+    // The samples are added up into a fixed number of interleaved partial
+    // sums that does not depend on the vector width of the instruction set.
+    // The loop is vectorized without reordering the additions.
+    constexpr SINT kPartialSums = 16;
+    CSAMPLE sums[kPartialSums] = {};
+    CSAMPLE clipped[kPartialSums] = {};
+    const SINT numStereoSamples = (numSamples / 2) * 2;
+    const SINT numBlockSamples = (numStereoSamples / kPartialSums) * kPartialSums;
+
+    // note: LOOP VECTORIZED.
+    for (SINT i = 0; i < numBlockSamples; i += kPartialSums) {
+        for (SINT j = 0; j < kPartialSums; ++j) {
+            const CSAMPLE absValue = fabs(pBuffer[i + j]);
+            sums[j] += absValue;
+            // Replacing the code with a bool clipped will prevent vetorizing
+            clipped[j] += absValue > CSAMPLE_PEAK ? 1 : 0;
+        }
+    }
+    for (SINT i = numBlockSamples; i < numStereoSamples; ++i) {
+        const CSAMPLE absValue = fabs(pBuffer[i]);
+        sums[i - numBlockSamples] += absValue;
+        clipped[i - numBlockSamples] += absValue > CSAMPLE_PEAK ? 1 : 0;
+    }
+
+    // Even partial sums belong to the left and odd to the right channel
+    CSAMPLE fAbsL = CSAMPLE_ZERO;
+    CSAMPLE fAbsR = CSAMPLE_ZERO;
+    CSAMPLE clippedL = 0;
+    CSAMPLE clippedR = 0;
+    for (SINT j = 0; j < kPartialSums; j += 2) {
+        fAbsL += sums[j];
+        fAbsR += sums[j + 1];
+        clippedL += clipped[j];
+        clippedR += clipped[j + 1];
+    }
+
+    *pfAbsL = fAbsL;
+    *pfAbsR = fAbsR;
+    SampleUtil::CLIP_STATUS clipping = SampleUtil::NO_CLIPPING;
+    if (clippedL > 0) {
+        clipping |= SampleUtil::CLIPPING_LEFT;
+    }
+    if (clippedR > 0) {
+        clipping |= SampleUtil::CLIPPING_RIGHT;
+    }
+    return clipping;
+}
+
+CSAMPLE maxAbsAmplitude(const CSAMPLE* pBuffer, SINT numSamples) {
+    CSAMPLE maxAbs = CSAMPLE_ZERO;
+    // note: LOOP VECTORIZED.
+    for (SINT i = 0; i < numSamples; ++i) {
+        const CSAMPLE absSample = fabs(pBuffer[i]);
+        maxAbs = absSample > maxAbs ? absSample : maxAbs;
+    }
+    return maxAbs;
+}
+
+void copyClampBuffer(CSAMPLE* M_RESTRICT pDest,
+        const CSAMPLE* M_RESTRICT pSrc, SINT iNumSamples) {
+    // note: LOOP VECTORIZED.
+    for (SINT i = 0; i < iNumSamples; ++i) {
+        pDest[i] = SampleUtil::clampSample(pSrc[i]);
+    }
+}
+
+void interleaveBuffer(CSAMPLE* M_RESTRICT pDest,
+        const CSAMPLE* M_RESTRICT pSrc1,
+        const CSAMPLE* M_RESTRICT pSrc2,
+        SINT numFrames) {
+    // note: LOOP VECTORIZED.
+    for (SINT i = 0; i < numFrames; ++i) {
+        pDest[2 * i] = pSrc1[i];
+        pDest[2 * i + 1] = pSrc2[i];
+    }
+}
+
+void deinterleaveBuffer(CSAMPLE* M_RESTRICT pDest1,
+        CSAMPLE* M_RESTRICT pDest2,
+        const CSAMPLE* M_RESTRICT pSrc,
+        SINT numFrames) {
+    // note: LOOP VECTORIZED.
+    for (SINT i = 0; i < numFrames; ++i) {
+        pDest1[i] = pSrc[i * 2];
+        pDest2[i] = pSrc[i * 2 + 1];
+    }
+}
+
+void linearCrossfadeBuffersOut(
+        CSAMPLE* pDestSrcFadeOut,
+        const CSAMPLE* pSrcFadeIn,
+        SINT numSamples) {
+    // M_RESTRICT unoptimizes the function for some reason.
+    const CSAMPLE_GAIN cross_inc = CSAMPLE_GAIN_ONE
+            / CSAMPLE_GAIN(numSamples / 2);
+    // note: LOOP VECTORIZED. only with "int i"
+    for (int i = 0; i < numSamples / 2; ++i) {
+        const CSAMPLE_GAIN cross_mix = cross_inc * i;
+        pDestSrcFadeOut[i * 2] *= (CSAMPLE_GAIN_ONE - cross_mix);
+        pDestSrcFadeOut[i * 2] += pSrcFadeIn[i * 2] * cross_mix;
+        pDestSrcFadeOut[i * 2 + 1] *= (CSAMPLE_GAIN_ONE - cross_mix);
+        pDestSrcFadeOut[i * 2 + 1] += pSrcFadeIn[i * 2 + 1] * cross_mix;
+    }
+}
+
+void linearCrossfadeBuffersIn(
+        CSAMPLE* pDestSrcFadeIn,
+        const CSAMPLE* pSrcFadeOut,
+        SINT numSamples) {
+    // M_RESTRICT unoptimizes the function for some reason.
+    const CSAMPLE_GAIN cross_inc = CSAMPLE_GAIN_ONE / CSAMPLE_GAIN(numSamples / 2);
+    // note: LOOP VECTORIZED. only with "int i"
+    for (int i = 0; i < numSamples / 2; ++i) {
+        const CSAMPLE_GAIN cross_mix = cross_inc * i;
+        pDestSrcFadeIn[i * 2] *= cross_mix;
+        pDestSrcFadeIn[i * 2] += pSrcFadeOut[i * 2] * (CSAMPLE_GAIN_ONE - cross_mix);
+        pDestSrcFadeIn[i * 2 + 1] *= cross_mix;
+        pDestSrcFadeIn[i * 2 + 1] += pSrcFadeOut[i * 2 + 1] * (CSAMPLE_GAIN_ONE - cross_mix);
+    }
+}
+
+void mixStereoToMono(CSAMPLE* pDest, const CSAMPLE* pSrc,
+        SINT numSamples) {
+    const CSAMPLE_GAIN mixScale = CSAMPLE_GAIN_ONE
+            / (CSAMPLE_GAIN_ONE + CSAMPLE_GAIN_ONE);
+    // note: LOOP VECTORIZED
+    for (SINT i = 0; i < numSamples / 2; ++i) {
+        pDest[i * 2] = (pSrc[i * 2] + pSrc[i * 2 + 1]) * mixScale;
+        pDest[i * 2 + 1] = pDest[i * 2];
+    }
+}
+
+void copyMonoToDualMono(CSAMPLE* M_RESTRICT pDest,
+        const CSAMPLE* M_RESTRICT pSrc, SINT numFrames) {
+    // forward loop
+    // note: LOOP VECTORIZED
+    for (SINT i = 0; i < numFrames; ++i) {
+        const CSAMPLE s = pSrc[i];
+        pDest[i * 2] = s;
+        pDest[i * 2 + 1] = s;
+    }
+}
+
+void addMonoToStereo(CSAMPLE* M_RESTRICT pDest,
+        const CSAMPLE* M_RESTRICT pSrc, SINT numFrames) {
+    // forward loop
+    // note: LOOP VECTORIZED
+    for (SINT i = 0; i < numFrames; ++i) {
+        const CSAMPLE s = pSrc[i];
+        pDest[i * 2] += s;
+        pDest[i * 2 + 1] += s;
+    }
+}
+
+const SampleKernels kSampleKernels = {
+        applyGain,
+        applyRampingGain,
+        applyAlternatingGain,
+        add,
+        addWithGain,
+        addWithRampingGain,
+        add2WithGain,
+        add3WithGain,
+        copyWithGain,
+        copyWithRampingGain,
+        convertS16ToFloat32,
+        convertFloat32ToS16,
+        sumAbsPerChannel,
+        maxAbsAmplitude,
+        copyClampBuffer,
+        interleaveBuffer,
+        deinterleaveBuffer,
+        linearCrossfadeBuffersOut,
+        linearCrossfadeBuffersIn,
+        mixStereoToMono,
+        copyMonoToDualMono,
+        addMonoToStereo,
+};
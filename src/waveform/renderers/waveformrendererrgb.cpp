@@ -1,5 +1,7 @@
 #include "waveformrendererrgb.h"
 
+#include <cmath>
+
 #include "waveformwidgetrenderer.h"
 #include "waveform/waveform.h"
 #include "waveform/waveformwidgetfactory.h"
@@ -11,13 +13,16 @@
 
 WaveformRendererRGB::WaveformRendererRGB(
         WaveformWidgetRenderer* waveformWidgetRenderer)
-        : WaveformRendererSignalBase(waveformWidgetRenderer) {
+        : WaveformRendererSignalBase(waveformWidgetRenderer),
+          m_tileCacheKey() {
 }
 
 WaveformRendererRGB::~WaveformRendererRGB() {
 }
 
 void WaveformRendererRGB::onSetup(const QDomNode& /* node */) {
+    // The colors might have changed
+    m_tileCache.clear();
 }
 
 void WaveformRendererRGB::draw(QPainter* painter,
@@ -67,113 +72,201 @@ void WaveformRendererRGB::draw(QPainter* painter,
     float allGain(1.0), lowGain(1.0), midGain(1.0), highGain(1.0);
     getGains(&allGain, &lowGain, &midGain, &highGain);
 
-    QColor color;
-
-    QPen pen;
-    pen.setCapStyle(Qt::FlatCap);
-    pen.setWidthF(math_max(1.0, 1.0 / m_waveformRenderer->getVisualSamplePerPixel()));
-
     const int breadth = m_waveformRenderer->getBreadth();
     const float halfBreadth = static_cast<float>(breadth) / 2.0f;
 
-    const float heightFactor = allGain * halfBreadth / sqrtf(255 * 255 * 3);
-
     // Draw reference line
     painter->setPen(m_pColors->getAxesColor());
     painter->drawLine(QLineF(0, halfBreadth, m_waveformRenderer->getLength(), halfBreadth));
 
-    for (int x = 0; x < m_waveformRenderer->getLength(); ++x) {
-        // Width of the x position in visual indices.
-        const double xSampleWidth = gain * x;
-
-        // Effective visual index of x
-        const double xVisualSampleIndex = xSampleWidth + offset;
-
-        // Our current pixel (x) corresponds to a number of visual samples
-        // (visualSamplerPerPixel) in our waveform object. We take the max of
-        // all the data points on either side of xVisualSampleIndex within a
-        // window of 'maxSamplingRange' visual samples to measure the maximum
-        // data point contained by this pixel.
-        double maxSamplingRange = gain / 2.0;
-
-        // Since xVisualSampleIndex is in visual-samples (e.g. R,L,R,L) we want
-        // to check +/- maxSamplingRange frames, not samples. To do this, divide
-        // xVisualSampleIndex by 2. Since frames indices are integers, we round
-        // to the nearest integer by adding 0.5 before casting to int.
-        int visualFrameStart = int(xVisualSampleIndex / 2.0 - maxSamplingRange + 0.5);
-        int visualFrameStop = int(xVisualSampleIndex / 2.0 + maxSamplingRange + 0.5);
-        const int lastVisualFrame = dataSize / 2 - 1;
-
-        // We now know that some subset of [visualFrameStart, visualFrameStop]
-        // lies within the valid range of visual frames. Clamp
-        // visualFrameStart/Stop to within [0, lastVisualFrame].
-        visualFrameStart = math_clamp(visualFrameStart, 0, lastVisualFrame);
-        visualFrameStop = math_clamp(visualFrameStop, 0, lastVisualFrame);
-
-        int visualIndexStart = visualFrameStart * 2;
-        int visualIndexStop  = visualFrameStop * 2;
-
-        unsigned char maxLow  = 0;
-        unsigned char maxMid  = 0;
-        unsigned char maxHigh = 0;
-        float maxAll = 0.;
-        float maxAllNext = 0.;
-
-        for (int i = visualIndexStart;
-             i >= 0 && i + 1 < dataSize && i + 1 <= visualIndexStop; i += 2) {
-            const WaveformData& waveformData = data[i];
-            const WaveformData& waveformDataNext = data[i + 1];
-
-            maxLow  = math_max3(maxLow,  waveformData.filtered.low,  waveformDataNext.filtered.low);
-            maxMid  = math_max3(maxMid,  waveformData.filtered.mid,  waveformDataNext.filtered.mid);
-            maxHigh = math_max3(maxHigh, waveformData.filtered.high, waveformDataNext.filtered.high);
-            float all = static_cast<float>(pow(waveformData.filtered.low * lowGain, 2) +
-                    pow(waveformData.filtered.mid * midGain, 2) +
-                    pow(waveformData.filtered.high * highGain, 2));
-            maxAll = math_max(maxAll, all);
-            float allNext = static_cast<float>(pow(waveformDataNext.filtered.low * lowGain, 2) +
-                    pow(waveformDataNext.filtered.mid * midGain, 2) +
-                    pow(waveformDataNext.filtered.high * highGain, 2));
-            maxAllNext = math_max(maxAllNext, allNext);
-        }
+    // Paints the columns with the given number of visual samples per column
+    auto rasterize = [&](QPainter* pPainter,
+            int firstColumn,
+            int columnCount,
+            double samplesPerColumn,
+            float columnAllGain,
+            float columnLowGain,
+            float columnMidGain,
+            float columnHighGain) {
+        const float heightFactor = columnAllGain * halfBreadth / sqrtf(255 * 255 * 3);
+
+        QColor color;
+
+        QPen pen;
+        pen.setCapStyle(Qt::FlatCap);
+        pen.setWidthF(math_max(1.0, 1.0 / samplesPerColumn));
+
+        for (int x = 0; x < columnCount; ++x) {
+            // Effective visual index of x
+            const double xVisualSampleIndex = samplesPerColumn * (firstColumn + x);
+            if (xVisualSampleIndex < 0 || xVisualSampleIndex >= dataSize) {
+                continue;
+            }
 
-        qreal maxLowF = maxLow * lowGain;
-        qreal maxMidF = maxMid * midGain;
-        qreal maxHighF = maxHigh * highGain;
-
-        qreal red   = maxLowF * m_rgbLowColor_r + maxMidF * m_rgbMidColor_r + maxHighF * m_rgbHighColor_r;
-        qreal green = maxLowF * m_rgbLowColor_g + maxMidF * m_rgbMidColor_g + maxHighF * m_rgbHighColor_g;
-        qreal blue  = maxLowF * m_rgbLowColor_b + maxMidF * m_rgbMidColor_b + maxHighF * m_rgbHighColor_b;
-
-        // Compute maximum (needed for value normalization)
-        qreal max = math_max3(red, green, blue);
-
-        // Prevent division by zero
-        if (max > 0.0f) {
-            // Set color
-            color.setRgbF(red / max, green / max, blue / max);
-
-            pen.setColor(color);
-
-            painter->setPen(pen);
-            switch (m_alignment) {
-                case Qt::AlignBottom:
-                case Qt::AlignRight:
-                    painter->drawLine(
-                        x, breadth,
-                        x, breadth - (int)(heightFactor * sqrtf(math_max(maxAll, maxAllNext))));
-                    break;
-                case Qt::AlignTop:
-                case Qt::AlignLeft:
-                    painter->drawLine(
-                        x, 0,
-                        x, (int)(heightFactor * sqrtf(math_max(maxAll, maxAllNext))));
-                    break;
-                default:
-                    painter->drawLine(
-                        x, (int)(halfBreadth - heightFactor * sqrtf(maxAll)),
-                        x, (int)(halfBreadth + heightFactor * sqrtf(maxAllNext)));
+            // Our current pixel (x) corresponds to a number of visual samples
+            // (visualSamplerPerPixel) in our waveform object. We take the max of
+            // all the data points on either side of xVisualSampleIndex within a
+            // window of 'maxSamplingRange' visual samples to measure the maximum
+            // data point contained by this pixel.
+            double maxSamplingRange = samplesPerColumn / 2.0;
+
+            // Since xVisualSampleIndex is in visual-samples (e.g. R,L,R,L) we want
+            // to check +/- maxSamplingRange frames, not samples. To do this, divide
+            // xVisualSampleIndex by 2. Since frames indices are integers, we round
+            // to the nearest integer by adding 0.5 before casting to int.
+            int visualFrameStart = int(xVisualSampleIndex / 2.0 - maxSamplingRange + 0.5);
+            int visualFrameStop = int(xVisualSampleIndex / 2.0 + maxSamplingRange + 0.5);
+            const int lastVisualFrame = dataSize / 2 - 1;
+
+            // We now know that some subset of [visualFrameStart, visualFrameStop]
+            // lies within the valid range of visual frames. Clamp
+            // visualFrameStart/Stop to within [0, lastVisualFrame].
+            visualFrameStart = math_clamp(visualFrameStart, 0, lastVisualFrame);
+            visualFrameStop = math_clamp(visualFrameStop, 0, lastVisualFrame);
+
+            int visualIndexStart = visualFrameStart * 2;
+            int visualIndexStop  = visualFrameStop * 2;
+
+            unsigned char maxLow  = 0;
+            unsigned char maxMid  = 0;
+            unsigned char maxHigh = 0;
+            float maxAll = 0.;
+            float maxAllNext = 0.;
+
+            for (int i = visualIndexStart;
+                 i >= 0 && i + 1 < dataSize && i + 1 <= visualIndexStop; i += 2) {
+                const WaveformData& waveformData = data[i];
+                const WaveformData& waveformDataNext = data[i + 1];
+
+                maxLow  = math_max3(maxLow,  waveformData.filtered.low,  waveformDataNext.filtered.low);
+                maxMid  = math_max3(maxMid,  waveformData.filtered.mid,  waveformDataNext.filtered.mid);
+                maxHigh = math_max3(maxHigh, waveformData.filtered.high, waveformDataNext.filtered.high);
+                float all = static_cast<float>(pow(waveformData.filtered.low * columnLowGain, 2) +
+                        pow(waveformData.filtered.mid * columnMidGain, 2) +
+                        pow(waveformData.filtered.high * columnHighGain, 2));
+                maxAll = math_max(maxAll, all);
+                float allNext = static_cast<float>(pow(waveformDataNext.filtered.low * columnLowGain, 2) +
+                        pow(waveformDataNext.filtered.mid * columnMidGain, 2) +
+                        pow(waveformDataNext.filtered.high * columnHighGain, 2));
+                maxAllNext = math_max(maxAllNext, allNext);
+            }
+
+            qreal maxLowF = maxLow * columnLowGain;
+            qreal maxMidF = maxMid * columnMidGain;
+            qreal maxHighF = maxHigh * columnHighGain;
+
+            qreal red   = maxLowF * m_rgbLowColor_r + maxMidF * m_rgbMidColor_r + maxHighF * m_rgbHighColor_r;
+            qreal green = maxLowF * m_rgbLowColor_g + maxMidF * m_rgbMidColor_g + maxHighF * m_rgbHighColor_g;
+            qreal blue  = maxLowF * m_rgbLowColor_b + maxMidF * m_rgbMidColor_b + maxHighF * m_rgbHighColor_b;
+
+            // Compute maximum (needed for value normalization)
+            qreal max = math_max3(red, green, blue);
+
+            // Prevent division by zero
+            if (max > 0.0f) {
+                // Set color
+                color.setRgbF(red / max, green / max, blue / max);
+
+                pen.setColor(color);
+
+                pPainter->setPen(pen);
+                switch (m_alignment) {
+                    case Qt::AlignBottom:
+                    case Qt::AlignRight:
+                        pPainter->drawLine(
+                            x, breadth,
+                            x, breadth - (int)(heightFactor * sqrtf(math_max(maxAll, maxAllNext))));
+                        break;
+                    case Qt::AlignTop:
+                    case Qt::AlignLeft:
+                        pPainter->drawLine(
+                            x, 0,
+                            x, (int)(heightFactor * sqrtf(math_max(maxAll, maxAllNext))));
+                        break;
+                    default:
+                        pPainter->drawLine(
+                            x, (int)(halfBreadth - heightFactor * sqrtf(maxAll)),
+                            x, (int)(halfBreadth + heightFactor * sqrtf(maxAllNext)));
+                }
             }
         }
+    };
+
+    float unadjustedLowGain(1.0), unadjustedMidGain(1.0), unadjustedHighGain(1.0);
+    getUnadjustedBandGains(&unadjustedLowGain, &unadjustedMidGain, &unadjustedHighGain);
+    if (lowGain != unadjustedLowGain ||
+            midGain != unadjustedMidGain ||
+            highGain != unadjustedHighGain) {
+        // The EQ gains change the colors and the shape of the waveform.
+        // Instead of rasterizing the tiles again for every change of the
+        // EQs, the waveform is drawn directly until they are reset.
+        const double firstColumn = offset / gain;
+        const double firstWholeColumn = std::floor(firstColumn);
+        painter->translate(firstWholeColumn - firstColumn, 0.0);
+        rasterize(painter,
+                static_cast<int>(firstWholeColumn),
+                m_waveformRenderer->getLength() + 1,
+                gain,
+                allGain,
+                lowGain,
+                midGain,
+                highGain);
+        return;
+    }
+
+    // The zoom changes slightly with the rate. The tiles are rasterized
+    // with a quantized zoom and scaled to the actual zoom.
+    const double samplesPerColumn = WaveformTileCache::quantizeSamplesPerColumn(gain);
+    const TileCacheKey tileCacheKey = {data,
+            dataSize,
+            samplesPerColumn,
+            breadth,
+            unadjustedLowGain,
+            unadjustedMidGain,
+            unadjustedHighGain};
+    if (tileCacheKey != m_tileCacheKey) {
+        m_tileCache.clear();
+        m_tileCacheKey = tileCacheKey;
+    }
+    const double columnWidth = samplesPerColumn / gain;
+    painter->scale(columnWidth, 1.0);
+
+    // The gain only scales the waveform vertically, towards the alignment
+    switch (m_alignment) {
+    case Qt::AlignBottom:
+    case Qt::AlignRight:
+        painter->translate(0.0, breadth);
+        painter->scale(1.0, allGain);
+        painter->translate(0.0, -breadth);
+        break;
+    case Qt::AlignTop:
+    case Qt::AlignLeft:
+        painter->scale(1.0, allGain);
+        break;
+    default:
+        painter->translate(0.0, halfBreadth);
+        painter->scale(1.0, allGain);
+        painter->translate(0.0, -halfBreadth);
     }
+
+    // The columns are rasterized once into tiles that are scrolled
+    const double firstColumn = offset / samplesPerColumn;
+    const int completeColumns = static_cast<int>(
+            waveform->getCompletion() / samplesPerColumn);
+    m_tileCache.draw(painter,
+            firstColumn,
+            static_cast<int>(std::ceil(m_waveformRenderer->getLength() / columnWidth)),
+            breadth,
+            m_waveformRenderer->getDevicePixelRatio(),
+            completeColumns,
+            [&](QPainter* pPainter, int tileFirstColumn, int columnCount) {
+                rasterize(pPainter,
+                        tileFirstColumn,
+                        columnCount,
+                        samplesPerColumn,
+                        1.0f,
+                        unadjustedLowGain,
+                        unadjustedMidGain,
+                        unadjustedHighGain);
+            });
 }
@@ -1,8 +1,11 @@
 #pragma once
 
 #include "util/class.h"
+#include "waveform/renderers/waveformtilecache.h"
 #include "waveformrenderersignalbase.h"
 
+union WaveformData;
+
 class WaveformRendererRGB : public WaveformRendererSignalBase {
   public:
     explicit WaveformRendererRGB(
@@ -13,5 +16,35 @@ class WaveformRendererRGB : public WaveformRendererSignalBase {
     virtual void draw(QPainter* painter, QPaintEvent* event);
 
   private:
+    // Everything that changes the appearance of the cached tiles. The
+    // tiles are rasterized without the gain and the EQ gains, see draw().
+    struct TileCacheKey {
+        const WaveformData* data;
+        int dataSize;
+        // Quantized, see WaveformTileCache::quantizeSamplesPerColumn()
+        double samplesPerColumn;
+        int breadth;
+        // The visual gains from the preferences
+        float lowGain;
+        float midGain;
+        float highGain;
+
+        bool operator==(const TileCacheKey& other) const {
+            return data == other.data &&
+                    dataSize == other.dataSize &&
+                    samplesPerColumn == other.samplesPerColumn &&
+                    breadth == other.breadth &&
+                    lowGain == other.lowGain &&
+                    midGain == other.midGain &&
+                    highGain == other.highGain;
+        }
+        bool operator!=(const TileCacheKey& other) const {
+            return !(*this == other);
+        }
+    };
+
+    WaveformTileCache m_tileCache;
+    TileCacheKey m_tileCacheKey;
+
     DISALLOW_COPY_AND_ASSIGN(WaveformRendererRGB);
 };
@@ -172,6 +172,23 @@ void WaveformRendererSignalBase::setup(const QDomNode& node,
     onSetup(node);
 }
 
+void WaveformRendererSignalBase::getUnadjustedBandGains(
+        float* pLowGain, float* pMidGain, float* pHighGain) {
+    *pLowGain = 1.0;
+    *pMidGain = 1.0;
+    *pHighGain = 1.0;
+    // Only adjust low/mid/high gains if EQs are enabled.
+    if (m_pEQEnabled->get() > 0.0) {
+        WaveformWidgetFactory* factory = WaveformWidgetFactory::instance();
+        *pLowGain = static_cast<CSAMPLE_GAIN>(
+                factory->getVisualGain(WaveformWidgetFactory::Low));
+        *pMidGain = static_cast<CSAMPLE_GAIN>(
+                factory->getVisualGain(WaveformWidgetFactory::Mid));
+        *pHighGain = static_cast<CSAMPLE_GAIN>(
+                factory->getVisualGain(WaveformWidgetFactory::High));
+    }
+}
+
 void WaveformRendererSignalBase::getGains(float* pAllGain, float* pLowGain,
                                           float* pMidGain, float* pHighGain) {
     WaveformWidgetFactory* factory = WaveformWidgetFactory::instance();
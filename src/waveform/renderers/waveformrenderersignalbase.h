@@ -23,6 +23,9 @@ public:
 
     void getGains(float* pAllGain, float* pLowGain, float* pMidGain,
                   float* highGain);
+    // The per-band gains of getGains() while the EQ knobs are centered,
+    // which only change with the visual gains from the preferences
+    void getUnadjustedBandGains(float* pLowGain, float* pMidGain, float* pHighGain);
 
   protected:
     ControlProxy* m_pEQEnabled;
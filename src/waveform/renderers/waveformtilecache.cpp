@@ -0,0 +1,91 @@
+#include "waveform/renderers/waveformtilecache.h"
+
+#include <cmath>
+
+#include "util/assert.h"
+
+WaveformTileCache::WaveformTileCache(int maxTileCount)
+        : m_maxTileCount(maxTileCount),
+          m_breadth(0),
+          m_devicePixelRatio(1.0),
+          m_drawCount(0),
+          m_rasterizedTileCount(0) {
+    DEBUG_ASSERT(m_maxTileCount > 0);
+}
+
+//static
+double WaveformTileCache::quantizeSamplesPerColumn(double samplesPerPixel) {
+    DEBUG_ASSERT(samplesPerPixel > 0.0);
+    constexpr double kStepsPerOctave = 128.0;
+    return std::exp2(std::round(std::log2(samplesPerPixel) * kStepsPerOctave) /
+            kStepsPerOctave);
+}
+
+void WaveformTileCache::clear() {
+    m_tiles.clear();
+}
+
+void WaveformTileCache::draw(QPainter* pPainter,
+        double firstColumn,
+        int length,
+        int breadth,
+        qreal devicePixelRatio,
+        int completeColumns,
+        const RasterizeFunction& rasterize) {
+    if (length <= 0 || breadth <= 0) {
+        return;
+    }
+    if (breadth != m_breadth || devicePixelRatio != m_devicePixelRatio) {
+        clear();
+        m_breadth = breadth;
+        m_devicePixelRatio = devicePixelRatio;
+    }
+    ++m_drawCount;
+
+    const int firstTile = static_cast<int>(std::floor(firstColumn / kTileWidth));
+    const int lastTile = static_cast<int>(std::floor((firstColumn + length - 1) / kTileWidth));
+    for (int tileIndex = firstTile; tileIndex <= lastTile; ++tileIndex) {
+        const int tileFirstColumn = tileIndex * kTileWidth;
+        auto it = m_tiles.find(tileIndex);
+        if (it == m_tiles.end()) {
+            it = m_tiles.insert(tileIndex, Tile{QImage(), completeColumns, 0});
+        } else if (it->completeColumns != completeColumns &&
+                it->completeColumns < tileFirstColumn + kTileWidth) {
+            // The tile contained columns that were not complete
+            it->image = QImage();
+        }
+        if (it->image.isNull()) {
+            it->image = QImage(
+                    static_cast<int>(std::ceil(kTileWidth * devicePixelRatio)),
+                    static_cast<int>(std::ceil(breadth * devicePixelRatio)),
+                    QImage::Format_ARGB32_Premultiplied);
+            it->image.setDevicePixelRatio(devicePixelRatio);
+            it->image.fill(Qt::transparent);
+            QPainter tilePainter(&it->image);
+            tilePainter.setRenderHints(QPainter::Antialiasing, false);
+            rasterize(&tilePainter, tileFirstColumn, kTileWidth);
+            it->completeColumns = completeColumns;
+            ++m_rasterizedTileCount;
+        }
+        it->lastDrawn = m_drawCount;
+        pPainter->drawImage(QPointF(tileFirstColumn - firstColumn, 0.0), it->image);
+    }
+
+    evictTiles();
+}
+
+void WaveformTileCache::evictTiles() {
+    while (m_tiles.size() > m_maxTileCount) {
+        auto oldest = m_tiles.begin();
+        for (auto it = m_tiles.begin(); it != m_tiles.end(); ++it) {
+            if (it->lastDrawn < oldest->lastDrawn) {
+                oldest = it;
+            }
+        }
+        // Tiles that are visible are never evicted
+        if (oldest->lastDrawn == m_drawCount) {
+            return;
+        }
+        m_tiles.erase(oldest);
+    }
+}
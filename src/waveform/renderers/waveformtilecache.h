@@ -0,0 +1,76 @@
+#pragma once
+
+#include <QHash>
+#include <QImage>
+#include <QPainter>
+#include <functional>
+
+/// Caches the pixel columns of a waveform in pre-rasterized tiles.
+///
+/// Column n of the waveform is painted at x = n - firstColumn. The columns
+/// are rasterized once into images of kTileWidth columns, which are then
+/// drawn while the waveform is scrolled. This is much cheaper than drawing
+/// each column every frame when there is no OpenGL.
+///
+/// The cache does not know what is painted. The owner must clear() it
+/// whenever the appearance of the columns changes, e.g. for a different
+/// track, zoom level, size or colors. Values that change continuously,
+/// like the zoom while the rate is adjusted, need to be quantized for
+/// reusing the tiles.
+class WaveformTileCache {
+  public:
+    /// Paints columnCount columns of the waveform, starting with column
+    /// firstColumn at x = 0.
+    typedef std::function<void(QPainter* pPainter, int firstColumn, int columnCount)>
+            RasterizeFunction;
+
+    static constexpr int kTileWidth = 256;
+
+    explicit WaveformTileCache(int maxTileCount = 32);
+
+    /// Rounds the number of samples per pixel to the nearest of 128 steps
+    /// per octave. The tiles are rasterized with the returned number of
+    /// samples per column and scaled horizontally by less than 0.3% to
+    /// match the actual zoom.
+    static double quantizeSamplesPerColumn(double samplesPerPixel);
+
+    void clear();
+
+    /// Draws length columns with column firstColumn at x = 0. Tiles are
+    /// rasterized again if they contain columns at or after completeColumns,
+    /// i.e. of a waveform that is still analyzed or loaded, and
+    /// completeColumns has changed since.
+    void draw(QPainter* pPainter,
+            double firstColumn,
+            int length,
+            int breadth,
+            qreal devicePixelRatio,
+            int completeColumns,
+            const RasterizeFunction& rasterize);
+
+    int tileCount() const {
+        return m_tiles.size();
+    }
+
+    /// The number of tiles that have been rasterized since the cache
+    /// has been created
+    int rasterizedTileCount() const {
+        return m_rasterizedTileCount;
+    }
+
+  private:
+    struct Tile {
+        QImage image;
+        int completeColumns;
+        quint64 lastDrawn;
+    };
+
+    void evictTiles();
+
+    const int m_maxTileCount;
+    QHash<int, Tile> m_tiles;
+    int m_breadth;
+    qreal m_devicePixelRatio;
+    quint64 m_drawCount;
+    int m_rasterizedTileCount;
+};
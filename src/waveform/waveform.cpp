@@ -1,12 +1,51 @@
 #include <QtDebug>
+#include <QtEndian>
+#include <cstring>
+#include <limits>
 
 #include "waveform/waveform.h"
 #include "proto/waveform.pb.h"
+#include "util/assert.h"
+#include "util/math.h"
 
 using namespace mixxx::track;
 
 const int kNumChannels = 2;
 
+namespace {
+
+// Layout of the binary header, all numbers in little endian:
+//  0: magic
+//  4: format version (quint32)
+//  8: data size (quint32)
+// 12: reserved (quint32)
+// 16: visual sample rate (double)
+// 24: audio/visual ratio (double)
+const char kBinaryMagic[4] = {'M', 'X', 'W', 'F'};
+constexpr quint32 kBinaryFormatVersion = 1;
+
+// The number of data elements that are copied at once when reading
+// the binary format, i.e. 256 KiB
+constexpr int kBinaryChunkSize = 64 * 1024;
+
+static_assert(sizeof(WaveformData) == 4,
+        "The binary format stores WaveformData as is");
+
+void writeDouble(uchar* pDest, double value) {
+    quint64 bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    qToLittleEndian(bits, pDest);
+}
+
+double readDouble(const uchar* pSrc) {
+    const auto bits = qFromLittleEndian<quint64>(pSrc);
+    double value;
+    std::memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+} // anonymous namespace
+
 // Return the smallest power of 2 which is greater than the desired size when
 // squared.
 int computeTextureStride(int size) {
@@ -64,66 +103,91 @@ Waveform::Waveform(int audioSampleRate, int audioSamples,
     setCompletion(0);
 }
 
+Waveform::Waveform(double visualSampleRate, double audioVisualRatio, int dataSize)
+        : m_id(-1),
+          m_saveState(SaveState::NotSaved),
+          m_dataSize(0),
+          m_visualSampleRate(visualSampleRate),
+          m_audioVisualRatio(audioVisualRatio),
+          m_textureStride(computeTextureStride(0)),
+          m_completion(0) {
+    assign(dataSize, 0);
+    // Not saved before all data has been read
+    m_saveState = SaveState::NotSaved;
+}
+
 Waveform::~Waveform() {
 }
 
-QByteArray Waveform::toByteArray() const {
-    io::Waveform waveform;
-    waveform.set_visual_sample_rate(m_visualSampleRate);
-    waveform.set_audio_visual_ratio(m_audioVisualRatio);
-
-    io::Waveform::Signal* all = waveform.mutable_signal_all();
-    io::Waveform::FilteredSignal* filtered = waveform.mutable_signal_filtered();
-    // TODO(rryan) get the actual cutoff values from analyzerwaveform.cpp so
-    // that if they change we don't have to remember to update these.
-
-    // Frequency cutoffs for butterworth filters:
-    // filtered->set_low_cutoff_frequency(200);
-    // filtered->set_mid_low_cutoff_frequency(200);
-    // filtered->set_mid_high_cutoff_frequency(2000);
-    // filtered->set_high_cutoff_frequency(2000);
-
-    // Frequency cutoff for bessel_lowpass4
-    filtered->set_low_cutoff_frequency(600);
-    // Frequency cutoff for bessel_bandpass
-    filtered->set_mid_low_cutoff_frequency(600);
-    filtered->set_mid_high_cutoff_frequency(4000);
-    // Frequency cutoff for bessel_highpass4
-    filtered->set_high_cutoff_frequency(4000);
-
-    io::Waveform::Signal* low = filtered->mutable_low();
-    io::Waveform::Signal* mid = filtered->mutable_mid();
-    io::Waveform::Signal* high = filtered->mutable_high();
-
-    // TODO(vrince) set max/min for each signal
-    int numChannels = kNumChannels;
-    all->set_units(io::Waveform::RMS);
-    all->set_channels(numChannels);
-    low->set_units(io::Waveform::RMS);
-    low->set_channels(numChannels);
-    mid->set_units(io::Waveform::RMS);
-    mid->set_channels(numChannels);
-    high->set_units(io::Waveform::RMS);
-    high->set_channels(numChannels);
+//static
+WaveformPointer Waveform::fromBinaryHeader(const uchar* pData, qint64 size) {
+    if (!pData || size < kBinaryHeaderSize ||
+            std::memcmp(pData, kBinaryMagic, sizeof(kBinaryMagic)) != 0) {
+        return WaveformPointer();
+    }
+    const auto formatVersion = qFromLittleEndian<quint32>(pData + 4);
+    if (formatVersion != kBinaryFormatVersion) {
+        qWarning() << "Unsupported binary waveform format version" << formatVersion;
+        return WaveformPointer();
+    }
+    const auto dataSize = qFromLittleEndian<quint32>(pData + 8);
+    const double visualSampleRate = readDouble(pData + 16);
+    const double audioVisualRatio = readDouble(pData + 24);
+    if (dataSize > static_cast<quint32>(std::numeric_limits<int>::max()) ||
+            size != kBinaryHeaderSize +
+                            static_cast<qint64>(dataSize) * sizeof(WaveformData)) {
+        qWarning() << "Binary waveform data is truncated:"
+                   << size << "bytes for" << dataSize << "elements";
+        return WaveformPointer();
+    }
+    return WaveformPointer(new Waveform(
+            visualSampleRate, audioVisualRatio, static_cast<int>(dataSize)));
+}
 
-    int dataSize = getDataSize();
-    for (int i = 0; i < dataSize; ++i) {
-        const WaveformData& datum = m_data.at(i);
-        all->add_value(datum.filtered.all);
-        low->add_value(datum.filtered.low);
-        mid->add_value(datum.filtered.mid);
-        high->add_value(datum.filtered.high);
+bool Waveform::readBinaryChunk(const uchar* pData, qint64 size) {
+    const int completion = math_max(getCompletion(), 0);
+    const int count = math_min(kBinaryChunkSize, m_dataSize - completion);
+    if (count <= 0) {
+        return false;
+    }
+    const qint64 offset = kBinaryHeaderSize +
+            static_cast<qint64>(completion) * sizeof(WaveformData);
+    VERIFY_OR_DEBUG_ASSERT(offset + count * sizeof(WaveformData) <=
+            static_cast<quint64>(size)) {
+        return false;
     }
+    std::memcpy(&m_data[completion], pData + offset, count * sizeof(WaveformData));
+    // Publish the data to renderers on other threads
+    m_completion.storeRelease(completion + count);
+    if (completion + count == m_dataSize) {
+        m_saveState = SaveState::Saved;
+        return false;
+    }
+    return true;
+}
 
-    qDebug() << "Writing waveform from byte array:"
+QByteArray Waveform::toByteArray() const {
+    const int dataSize = getDataSize();
+    QByteArray data(kBinaryHeaderSize +
+                    dataSize * static_cast<int>(sizeof(WaveformData)),
+            '\0');
+    auto* pHeader = reinterpret_cast<uchar*>(data.data());
+    std::memcpy(pHeader, kBinaryMagic, sizeof(kBinaryMagic));
+    qToLittleEndian(kBinaryFormatVersion, pHeader + 4);
+    qToLittleEndian(static_cast<quint32>(dataSize), pHeader + 8);
+    qToLittleEndian(quint32(0), pHeader + 12);
+    writeDouble(pHeader + 16, m_visualSampleRate);
+    writeDouble(pHeader + 24, m_audioVisualRatio);
+    if (dataSize > 0) {
+        std::memcpy(pHeader + kBinaryHeaderSize,
+                m_data.data(),
+                dataSize * sizeof(WaveformData));
+    }
+    qDebug() << "Writing waveform to byte array:"
              << "dataSize" << dataSize
-             << "allSignalSize" << all->value_size()
-             << "visualSampleRate" << waveform.visual_sample_rate()
-             << "audioVisualRatio" << waveform.audio_visual_ratio();
-
-    std::string output;
-    waveform.SerializeToString(&output);
-    return QByteArray(output.data(), static_cast<int>(output.length()));
+             << "visualSampleRate" << m_visualSampleRate
+             << "audioVisualRatio" << m_audioVisualRatio;
+    return data;
 }
 
 void Waveform::readByteArray(const QByteArray& data) {
@@ -131,6 +195,25 @@ void Waveform::readByteArray(const QByteArray& data) {
         return;
     }
 
+    const auto* pData = reinterpret_cast<const uchar*>(data.constData());
+    const auto pBinaryWaveform = fromBinaryHeader(pData, data.size());
+    if (!pBinaryWaveform) {
+        readProtobuf(data);
+        return;
+    }
+    m_visualSampleRate = pBinaryWaveform->m_visualSampleRate;
+    m_audioVisualRatio = pBinaryWaveform->m_audioVisualRatio;
+    assign(pBinaryWaveform->m_dataSize, 0);
+    m_completion = 0;
+    while (readBinaryChunk(pData, data.size())) {
+    }
+    m_completion = m_dataSize;
+    m_saveState = SaveState::Saved;
+}
+
+// The legacy format of analyses that have been stored before
+// Waveform-6.0 and WaveformSummary-6.0
+void Waveform::readProtobuf(const QByteArray& data) {
     io::Waveform waveform;
 
     if (!waveform.ParseFromArray(data.constData(), data.size())) {
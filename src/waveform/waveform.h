@@ -28,6 +28,10 @@ union WaveformData {
     WaveformData(int i) { m_i = i;}
 };
 
+class Waveform;
+typedef QSharedPointer<Waveform> WaveformPointer;
+typedef QSharedPointer<const Waveform> ConstWaveformPointer;
+
 class Waveform {
   public:
     enum class SaveState {
@@ -36,10 +40,21 @@ class Waveform {
         Saved
     };
 
+    // Reads both the binary format and the legacy protobuf format
     explicit Waveform(const QByteArray& pData = QByteArray());
     Waveform(int audioSampleRate, int audioSamples,
              int desiredVisualSampleRate, int maxVisualSamples);
 
+    // The binary format consists of a fixed-size header followed by
+    // the uncompressed data in the same layout as in memory. It can
+    // be memory-mapped and copied in chunks without any parsing.
+    static constexpr int kBinaryHeaderSize = 32;
+
+    // Creates a waveform without any data from the header of the
+    // binary format. Returns nullptr if the data is not in binary
+    // format or if it is truncated.
+    static WaveformPointer fromBinaryHeader(const uchar* pData, qint64 size);
+
     virtual ~Waveform();
 
     int getId() const {
@@ -72,8 +87,14 @@ class Waveform {
         m_description = description;
     }
 
+    // Returns the waveform in binary format
     QByteArray toByteArray() const;
 
+    // Copies the next chunk of data from the binary format and advances
+    // the completion accordingly. Returns false after all data has been
+    // copied. The waveform must have been created by fromBinaryHeader().
+    bool readBinaryChunk(const uchar* pData, qint64 size);
+
     // We do not lock the mutex since m_dataSize and m_visualSampleRate are not
     // changed after the constructor runs.
     bool isValid() const {
@@ -135,7 +156,10 @@ class Waveform {
     void dump() const;
 
   private:
+    Waveform(double visualSampleRate, double audioVisualRatio, int dataSize);
+
     void readByteArray(const QByteArray& data);
+    void readProtobuf(const QByteArray& data);
     void resize(int size);
     void assign(int size, int value = 0);
 
@@ -181,6 +205,3 @@ class Waveform {
 
     DISALLOW_COPY_AND_ASSIGN(Waveform);
 };
-
-typedef QSharedPointer<Waveform> WaveformPointer;
-typedef QSharedPointer<const Waveform> ConstWaveformPointer;
@@ -1,12 +1,62 @@
+#include <QFile>
 #include <QtDebug>
 
 #include "waveform/waveformfactory.h"
 #include "waveform/waveform.h"
 
+namespace {
+
+WaveformPointer mapWaveformFromFile(
+        const QString& fileName,
+        const WaveformFactory::LoadingStartedCallback& loadingStarted) {
+    QFile file(fileName);
+    if (!file.open(QIODevice::ReadOnly)) {
+        qWarning() << "Failed to open waveform file" << fileName;
+        return WaveformPointer();
+    }
+    const qint64 size = file.size();
+    const uchar* pData = file.map(0, size);
+    if (!pData) {
+        // Fall back to reading the whole file
+        return WaveformPointer(new Waveform(file.readAll()));
+    }
+    WaveformPointer pWaveform = Waveform::fromBinaryHeader(pData, size);
+    if (pWaveform) {
+        if (loadingStarted) {
+            loadingStarted(pWaveform);
+        }
+        while (pWaveform->readBinaryChunk(pData, size)) {
+        }
+    } else {
+        qWarning() << "Invalid waveform file" << fileName;
+    }
+    file.unmap(const_cast<uchar*>(pData));
+    return pWaveform;
+}
+
+} // anonymous namespace
+
 // static
-Waveform* WaveformFactory::loadWaveformFromAnalysis(
-        const AnalysisDao::AnalysisInfo& analysis) {
-    Waveform* pWaveform = new Waveform(analysis.data);
+WaveformPointer WaveformFactory::loadWaveformFromAnalysis(
+        const AnalysisDao::AnalysisInfo& analysis,
+        const LoadingStartedCallback& loadingStarted) {
+    WaveformPointer pWaveform;
+    if (analysis.dataFormat == AnalysisDao::DataFormat::Uncompressed) {
+        pWaveform = mapWaveformFromFile(analysis.dataPath,
+                [&analysis, &loadingStarted](const WaveformPointer& pLoadingWaveform) {
+                    pLoadingWaveform->setId(analysis.analysisId);
+                    pLoadingWaveform->setVersion(analysis.version);
+                    pLoadingWaveform->setDescription(analysis.description);
+                    if (loadingStarted) {
+                        loadingStarted(pLoadingWaveform);
+                    }
+                });
+    } else {
+        pWaveform = WaveformPointer(new Waveform(analysis.data));
+    }
+    if (!pWaveform || !pWaveform->isValid()) {
+        return WaveformPointer();
+    }
     pWaveform->setId(analysis.analysisId);
     pWaveform->setVersion(analysis.version);
     pWaveform->setDescription(analysis.description);
@@ -20,6 +70,11 @@ WaveformFactory::VersionClass WaveformFactory::waveformVersionToVersionClass(con
         return VC_USE;
     }
 
+    if (version == WAVEFORM_5_VERSION) {
+        // compressed legacy format of the same data
+        return VC_CONVERT;
+    }
+
     if (version == WAVEFORM_4_VERSION) {
         // Used in Mixxx 1.12 beta, suffers Bug lp:1406389
         return VC_REMOVE;
@@ -46,6 +101,11 @@ WaveformFactory::VersionClass WaveformFactory::waveformSummaryVersionToVersionCl
         return VC_USE;
     }
 
+    if (version == WAVEFORMSUMMARY_5_VERSION) {
+        // compressed legacy format of the same data
+        return VC_CONVERT;
+    }
+
     if (version == WAVEFORMSUMMARY_4_VERSION) {
         // Used in Mixxx 1.12 beta, suffers Bug lp:1406389
         return VC_REMOVE;
@@ -1,8 +1,9 @@
 #pragma once
 
-#include "library/dao/analysisdao.h"
+#include <functional>
 
-class Waveform;
+#include "library/dao/analysisdao.h"
+#include "waveform/waveform.h"
 
 #define WAVEFORM_2_VERSION "Waveform-2.0"
 #define WAVEFORMSUMMARY_2_VERSION "WaveformSummary-2.0"
@@ -27,22 +28,38 @@ class Waveform;
 #define WAVEFORM_5_DESCRIPTION "Waveform 5.0"
 #define WAVEFORMSUMMARY_5_DESCRIPTION "WaveformSummary 5.0"
 
-#define WAVEFORM_CURRENT_VERSION WAVEFORM_5_VERSION
-#define WAVEFORMSUMMARY_CURRENT_VERSION WAVEFORMSUMMARY_5_VERSION
-#define WAVEFORM_CURRENT_DESCRIPTION WAVEFORM_5_DESCRIPTION
-#define WAVEFORMSUMMARY_CURRENT_DESCRIPTION WAVEFORMSUMMARY_5_DESCRIPTION
+// Same data as 5.0, but stored uncompressed in binary format
+#define WAVEFORM_6_VERSION "Waveform-6.0"
+#define WAVEFORMSUMMARY_6_VERSION "WaveformSummary-6.0"
+#define WAVEFORM_6_DESCRIPTION "Waveform 6.0"
+#define WAVEFORMSUMMARY_6_DESCRIPTION "WaveformSummary 6.0"
+
+#define WAVEFORM_CURRENT_VERSION WAVEFORM_6_VERSION
+#define WAVEFORMSUMMARY_CURRENT_VERSION WAVEFORMSUMMARY_6_VERSION
+#define WAVEFORM_CURRENT_DESCRIPTION WAVEFORM_6_DESCRIPTION
+#define WAVEFORMSUMMARY_CURRENT_DESCRIPTION WAVEFORMSUMMARY_6_DESCRIPTION
 
 
 class WaveformFactory {
   public:
     enum VersionClass {
         VC_USE,
+        // Use and store again in the current version, unless an
+        // analysis with the current version exists
+        VC_CONVERT,
         VC_KEEP,
         VC_REMOVE
     };
 
-    static Waveform* loadWaveformFromAnalysis(
-            const AnalysisDao::AnalysisInfo& analysis);
+    // Invoked before loading the data of the waveform, i.e. the waveform
+    // could already be displayed while its completion is increasing.
+    typedef std::function<void(const WaveformPointer&)> LoadingStartedCallback;
+
+    // Waveforms in binary format are memory-mapped and copied in chunks.
+    // Returns nullptr on failure.
+    static WaveformPointer loadWaveformFromAnalysis(
+            const AnalysisDao::AnalysisInfo& analysis,
+            const LoadingStartedCallback& loadingStarted = nullptr);
     static VersionClass waveformVersionToVersionClass(const QString& version);
     static VersionClass waveformSummaryVersionToVersionClass(const QString& version);
     static QString currentWaveformVersion();